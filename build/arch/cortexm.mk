@@ -18,10 +18,12 @@ ifeq ($(IS_CLANG_TOOLCHAIN),)
 TARGET_AR = $(CORTEXM_TOOLS_PREFIX)/bin/arm-none-eabi-ar
 TARGET_CC = $(CORTEXM_TOOLS_PREFIX)/bin/arm-none-eabi-g++
 TARGET_LD = $(CORTEXM_TOOLS_PREFIX)/bin/arm-none-eabi-ld
+TARGET_OBJCOPY = $(CORTEXM_TOOLS_PREFIX)/bin/arm-none-eabi-objcopy
 else
 TARGET_AR = $(CLANG_TOOLCHAIN_PATH)/bin/llvm-ar
 TARGET_CC = $(CLANG_TOOLCHAIN_PATH)/bin/clang
 TARGET_LD = $(CLANG_TOOLCHAIN_PATH)/bin/ld.lld
+TARGET_OBJCOPY = $(CLANG_TOOLCHAIN_PATH)/bin/llvm-objcopy
 endif
 
 # Cortex-M Compiler Flags ######################################################
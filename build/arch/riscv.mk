@@ -20,6 +20,7 @@ endif
 TARGET_AR = $(RISCV_TOOLCHAIN_PATH)/bin/llvm-ar
 TARGET_CC = $(RISCV_TOOLCHAIN_PATH)/bin/clang
 TARGET_LD = $(RISCV_TOOLCHAIN_PATH)/bin/ld.lld
+TARGET_OBJCOPY = $(RISCV_TOOLCHAIN_PATH)/bin/llvm-objcopy
 
 # Shared Object Linker Flags ###################################################
 
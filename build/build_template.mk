@@ -43,6 +43,9 @@
 #                                  after the objects produced by this build.
 #     $13 - TARGET_PLATFORM_ID   - The ID of the platform that this nanoapp
 #                                  build targets.
+#     $14 - TARGET_SO_POST_LINK_CMD - An optional command that post-processes
+#                                  the shared object in place once linked. The
+#                                  path of the shared object is appended.
 #
 ################################################################################
 
@@ -241,6 +244,7 @@ $$($(1)_SO): $$($(1)_CC_DEPS) \
               $$($(1)_CC_OBJS) $$($(1)_CPP_OBJS) $$($(1)_C_OBJS) \
               $$($(1)_S_OBJS) | $$(OUT)/$(1) $$($(1)_DIRS)
 	$(V)$(5) $(4) -o $$@ $(11) $$(filter %.o, $$^) $(12)
+	$(if $(strip $(14)),$(V)$(14) $$@)
 
 $$($(1)_BIN): $$($(1)_CC_DEPS) \
                $$($(1)_CPP_DEPS) $$($(1)_C_DEPS) $$($(1)_S_DEPS) \
@@ -311,7 +315,8 @@ $(eval $(call BUILD_TEMPLATE,$(TARGET_NAME), \
                              $(TARGET_BIN_LDFLAGS), \
                              $(TARGET_SO_EARLY_LIBS), \
                              $(TARGET_SO_LATE_LIBS), \
-                             $(TARGET_PLATFORM_ID)))
+                             $(TARGET_PLATFORM_ID), \
+                             $(TARGET_SO_POST_LINK_CMD)))
 
 # Debug Template Invocation ####################################################
 
@@ -329,4 +334,5 @@ $(eval $(call BUILD_TEMPLATE,$(TARGET_NAME)_debug, \
                              $(TARGET_BIN_LDFLAGS), \
                              $(TARGET_SO_EARLY_LIBS), \
                              $(TARGET_SO_LATE_LIBS), \
-                             $(TARGET_PLATFORM_ID)))
+                             $(TARGET_PLATFORM_ID), \
+                             $(TARGET_SO_POST_LINK_CMD)))
@@ -10,9 +10,11 @@ TARGET_SO_LDFLAGS =
 TARGET_LD =
 TARGET_ARFLAGS =
 TARGET_AR =
+TARGET_OBJCOPY =
 TARGET_VARIANT_SRCS =
 TARGET_BUILD_BIN =
 TARGET_BIN_LDFLAGS =
 TARGET_SO_EARLY_LIBS =
 TARGET_SO_LATE_LIBS =
 TARGET_PLATFORM_ID =
+TARGET_SO_POST_LINK_CMD =
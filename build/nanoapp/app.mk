@@ -133,6 +133,16 @@ DSO_SUPPORT_LIB_SRCS = $(DSO_SUPPORT_LIB_PATH)/nanoapp_support_lib_dso.cc
 # directory and symlinks to effectively hide them from nanoapps
 DSO_SUPPORT_LIB_CFLAGS = -I$(CHRE_PREFIX)/platform/shared/nanoapp/include
 
+# Optionally embeds a relocation manifest once the nanoapp is linked so that the
+# shared nanoapp loader resolves each imported symbol once rather than once per
+# relocation. Requires a python interpreter at build time. TARGET_OBJCOPY is
+# provided by the arch makefile of the variant.
+ifeq ($(CHRE_NANOAPP_RELOCATION_MANIFEST_ENABLED), true)
+DSO_SUPPORT_LIB_POST_LINK_CMD = $(PYTHON) \
+    $(CHRE_PREFIX)/build/nanoapp/relocation_manifest.py \
+    --objcopy $(TARGET_OBJCOPY)
+endif
+
 GOOGLE_HEXAGONV62_SLPI_SRCS += $(DSO_SUPPORT_LIB_SRCS)
 GOOGLE_HEXAGONV62_SLPI-UIMG_SRCS += $(DSO_SUPPORT_LIB_SRCS)
 GOOGLE_HEXAGONV65_ADSP-SEE_SRCS += $(DSO_SUPPORT_LIB_SRCS)
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+#
+# Copyright 2024, The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Embeds a relocation manifest into a nanoapp shared object.
+
+The nanoapp loader resolves every relocation against an imported symbol by
+looking up the symbol name, so a symbol used from many places (e.g. memcpy or
+chreLog) is looked up once per place. The manifest groups these relocations by
+symbol, letting the loader resolve each symbol once and patch all of its sites.
+
+The manifest is stored in the .chre_reloc_manifest section, which is not
+loaded into memory and has no alignment requirement, as little-endian 32-bit
+words:
+
+struct RelocationManifestHeader {
+  uint32_t magic;       // "CRLM"
+  uint32_t version;     // 0x1 for this version
+  uint32_t numSymbols;  // Number of RelocationManifestSymbol entries
+  uint32_t numSites;    // Total number of relocation sites
+};
+
+Followed by numSymbols entries, sorted by symbol index:
+
+struct RelocationManifestSymbol {
+  uint32_t symbolIndex;  // Index of the symbol in .dynsym
+  uint32_t numSites;     // Number of sites patched with this symbol
+};
+
+Followed by numSites offsets (r_offset) of the relocation sites, grouped by
+symbol in the order of the entries above and sorted within each group.
+
+Only the relocations the loader resolves by name are described: R_ARM_GLOB_DAT
+and R_ARM_JUMP_SLOT for ARM, R_RISCV_JUMP_SLOT for RISC-V. If one of them has a
+non-zero addend, no manifest is added and the loader falls back to resolving
+each relocation.
+
+Usage: relocation_manifest.py --objcopy <objcopy> <nanoapp.so>
+"""
+
+import argparse
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+from collections import defaultdict
+
+SECTION_NAME = '.chre_reloc_manifest'
+MANIFEST_MAGIC = 0x4d4c5243  # "CRLM"
+MANIFEST_VERSION = 1
+
+EM_ARM = 40
+EM_RISCV = 243
+
+SHT_RELA = 4
+SHT_REL = 9
+SHT_DYNSYM = 11
+
+# Relocation types resolved through a symbol name lookup, per machine.
+SYMBOL_RELOCATION_TYPES = {
+    EM_ARM: {21, 22},  # R_ARM_GLOB_DAT, R_ARM_JUMP_SLOT
+    EM_RISCV: {5},  # R_RISCV_JUMP_SLOT
+}
+
+
+class ElfFile:
+  """Minimal reader for the section and relocation tables of an ELF file."""
+
+  def __init__(self, data):
+    if data[:4] != b'\x7fELF':
+      raise ValueError('not an ELF file')
+    if data[5] != 1:
+      raise ValueError('only little-endian ELF files are supported')
+    self.data = data
+    self.is64 = data[4] == 2
+    self.machine = struct.unpack_from('<H', data, 18)[0]
+    if self.is64:
+      self.shoff = struct.unpack_from('<Q', data, 40)[0]
+      self.shentsize, self.shnum = struct.unpack_from('<HH', data, 58)
+    else:
+      self.shoff = struct.unpack_from('<I', data, 32)[0]
+      self.shentsize, self.shnum = struct.unpack_from('<HH', data, 46)
+
+  def sections(self):
+    """Yields (index, sh_type, sh_offset, sh_size, sh_link) per section."""
+    fmt = '<IIQQQQII' if self.is64 else '<IIIIIIII'
+    for i in range(self.shnum):
+      fields = struct.unpack_from(fmt, self.data,
+                                  self.shoff + i * self.shentsize)
+      yield i, fields[1], fields[4], fields[5], fields[6]
+
+  def relocations(self, sh_type, offset, size):
+    """Yields (r_offset, symbol index, type, addend) for a relocation table."""
+    if self.is64:
+      fmt = '<QQq' if sh_type == SHT_RELA else '<QQ'
+    else:
+      fmt = '<IIi' if sh_type == SHT_RELA else '<II'
+    entry_size = struct.calcsize(fmt)
+    for pos in range(offset, offset + size - entry_size + 1, entry_size):
+      fields = struct.unpack_from(fmt, self.data, pos)
+      r_offset, r_info = fields[0], fields[1]
+      addend = fields[2] if sh_type == SHT_RELA else 0
+      if self.is64:
+        yield r_offset, r_info >> 32, r_info & 0xffffffff, addend
+      else:
+        yield r_offset, r_info >> 8, r_info & 0xff, addend
+
+
+def build_manifest(elf):
+  """Returns the manifest bytes, or None if the binary can't use one."""
+  symbol_types = SYMBOL_RELOCATION_TYPES.get(elf.machine)
+  if symbol_types is None:
+    print('No relocation manifest for ELF machine %d' % elf.machine)
+    return None
+
+  sections = list(elf.sections())
+  dynsym_indices = {s[0] for s in sections if s[1] == SHT_DYNSYM}
+  sites_by_symbol = defaultdict(list)
+  for _, sh_type, offset, size, link in sections:
+    if sh_type not in (SHT_REL, SHT_RELA) or link not in dynsym_indices:
+      continue
+    for r_offset, symbol, r_type, addend in elf.relocations(
+        sh_type, offset, size):
+      if r_type not in symbol_types:
+        continue
+      if addend != 0:
+        print('Relocation at 0x%x has an addend, skipping the manifest' %
+              r_offset)
+        return None
+      sites_by_symbol[symbol].append(r_offset)
+
+  if not sites_by_symbol:
+    return None
+
+  symbols = sorted(sites_by_symbol)
+  num_sites = sum(len(sites) for sites in sites_by_symbol.values())
+  manifest = struct.pack('<IIII', MANIFEST_MAGIC, MANIFEST_VERSION,
+                         len(symbols), num_sites)
+  for symbol in symbols:
+    manifest += struct.pack('<II', symbol, len(sites_by_symbol[symbol]))
+  for symbol in symbols:
+    sites = sorted(sites_by_symbol[symbol])
+    manifest += struct.pack('<%dI' % len(sites), *sites)
+
+  print('Relocation manifest: %d symbol relocations resolved through %d '
+        'symbols' % (num_sites, len(symbols)))
+  return manifest
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+  parser.add_argument('--objcopy', required=True,
+                      help='objcopy used to add the manifest section')
+  parser.add_argument('binary', help='nanoapp shared object to update')
+  args = parser.parse_args()
+
+  with open(args.binary, 'rb') as f:
+    manifest = build_manifest(ElfFile(f.read()))
+  if manifest is None:
+    return 0
+
+  with tempfile.NamedTemporaryFile(suffix='.bin', delete=False) as f:
+    f.write(manifest)
+    manifest_path = f.name
+  try:
+    subprocess.run([
+        args.objcopy, '--remove-section', SECTION_NAME, '--add-section',
+        '%s=%s' % (SECTION_NAME, manifest_path), args.binary
+    ], check=True)
+  finally:
+    os.remove(manifest_path)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
@@ -76,6 +76,7 @@ TARGET_VARIANT_SRCS += $(ARM_SRCS)
 TARGET_VARIANT_SRCS += $(DSO_SUPPORT_LIB_SRCS)
 
 TARGET_CFLAGS += $(DSO_SUPPORT_LIB_CFLAGS)
+TARGET_SO_POST_LINK_CMD = $(DSO_SUPPORT_LIB_POST_LINK_CMD)
 
 TARGET_PLATFORM_ID = 0x476F6F676C002000
 
@@ -59,6 +59,7 @@ TARGET_CFLAGS += -I$(CHRE_PREFIX)/platform/shared/include/chre/platform/shared/l
 
 TARGET_VARIANT_SRCS += $(DSO_SUPPORT_LIB_SRCS)
 TARGET_CFLAGS += $(DSO_SUPPORT_LIB_CFLAGS)
+TARGET_SO_POST_LINK_CMD = $(DSO_SUPPORT_LIB_POST_LINK_CMD)
 
 ifeq ($(CHRE_TCM_ENABLED),true)
 TARGET_CFLAGS += -DCHRE_TCM_ENABLED
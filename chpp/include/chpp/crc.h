@@ -28,7 +28,16 @@ extern "C" {
  * Calculates IEEE CRC-32, initialized to (~crc), on an input data buffer.
  *
  * It is expected that the implementation be optimized based on individual
- * platforms, e.g. by reusing HW/SW optimized CRC functionality.
+ * platforms, e.g. by reusing HW/SW optimized CRC functionality. The default
+ * implementation uses a 64 byte nibble-wise lookup table, and can be configured
+ * with the following macros:
+ *  - CHPP_CRC32_SLICING_BY_8: Use an 8 KiB slicing-by-8 lookup table, which
+ *    processes 8 bytes per iteration.
+ *  - CHPP_CRC32_HW_ACCEL: Use the PCLMULQDQ instruction on x86 (if supported
+ *    by the CPU at runtime) or the ARMv8 CRC32 instructions (if enabled at
+ *    compile time), falling back to the lookup table otherwise and for input
+ *    not covered by the instructions.
+ * All implementations produce identical results.
  *
  * @param crc CRC initialization value. This may be used to calculate a CRC on
  * daisy-chained input data. Otherwise, it can be set to zero to initialize to
@@ -78,6 +78,20 @@ extern "C" {
 #define CHPP_TRANSPORT_MAX_RESET UINT16_C(3)
 #endif
 
+/**
+ * CHPP Transport layer maximum TX window size, i.e. the maximum number of
+ * payload-bearing packets that may be sent out before waiting for an ACK. The
+ * window that is used is the minimum of this value and the one advertised by
+ * the remote endpoint in its reset or reset-ack configuration, so a window of 1
+ * (stop-and-wait) is used with CHPP 1.0.0 endpoints that do not advertise one.
+ *
+ * Packets lost within a window are recovered with go-back-N retransmissions.
+ * Must be less than half of the 8-bit sequence number space.
+ */
+#ifndef CHPP_TRANSPORT_MAX_TX_WINDOW_SIZE
+#define CHPP_TRANSPORT_MAX_TX_WINDOW_SIZE UINT8_C(1)
+#endif
+
 /**
  * CHPP Transport layer predefined timeout values.
  */
@@ -288,8 +302,10 @@ struct ChppTransportConfiguration {
   //! CHPP 1.0.0 unused "Receive MTU size".
   uint16_t reserved1;
 
-  //! CHPP 1.0.0 unused "window size".
-  uint16_t reserved2;
+  //! Maximum number of unacknowledged payload-bearing packets that the sender
+  //! of this configuration supports in either direction. CHPP 1.0.0 endpoints
+  //! leave this unused (i.e. 0), which is treated as a window size of 1.
+  uint16_t windowSize;
 
   //! CHPP 1.0.0 unused "Transport layer timeout in milliseconds".
   uint16_t reserved3;
@@ -321,6 +337,11 @@ struct ChppRxStatus {
   //! Location counter in bytes within the current Rx datagram.
   size_t locInDatagram;
 
+  //! Allocated size of the current Rx datagram payload in bytes. This may
+  //! exceed its length, as the payload of a fragmented datagram is grown
+  //! geometrically rather than reallocated for every packet.
+  size_t datagramCapacity;
+
   //! The total number of data received in chppRxDataCb.
   size_t numTotalDataBytes;
 
@@ -347,19 +368,38 @@ struct ChppTxStatus {
   //! Error code, if any, of the next packet the transport layer will send out.
   uint8_t packetCodeToSend;
 
-  //! How many times the last sent sequence number has been (re-)sent.
+  //! How many times the oldest unacknowledged packet has been (re-)sent.
   size_t txAttempts;
 
   //! Time when the last packet was sent to the link layer.
   uint64_t lastTxTimeNs;
 
-  //! How many bytes of the front-of-queue datagram has been sent out
+  //! How many bytes of the datagram being sent have been sent out
   size_t sentLocInDatagram;
 
-  //! Note: For a future ACK window >1, sentLocInDatagram doesn't always apply
-  //! to the front-of-queue datagram. Instead, we need to track the queue
-  //! position the datagram being sent as well (relative to the front-of-queue).
-  //! e.g. uint8_t datagramBeingSent
+  //! Queue position of the datagram being sent, relative to the front-of-queue.
+  //! With a TX window of 1, this is always the front-of-queue datagram.
+  uint8_t datagramBeingSent;
+
+  //! Number of payload-bearing packets sent since the last ACKed one, i.e. the
+  //! position of the next packet to send within the TX window. This is reset
+  //! to 0 to retransmit the window (go-back-N).
+  uint8_t packetsInFlight;
+
+  //! Number of distinct payload-bearing packets that have been sent but not
+  //! yet ACKed. Unlike packetsInFlight, this is not reset by a retransmission,
+  //! so that ACKs for packets sent before it are still accepted.
+  uint8_t packetsUnacked;
+
+  //! Whether the TX window is to be retransmitted from the last ACKed packet,
+  //! i.e. after a NACK or an ACK timeout. Only used with a TX window >1, as a
+  //! window of 1 always resends the last ACKed packet.
+  bool retransmitPending;
+
+  //! Whether a retransmission has already been started for the current
+  //! receivedAckSeq, so that repeated NACKs for the same loss (e.g. one per
+  //! out-of-order packet in the window) only rewind the window once.
+  bool retransmittedForAckSeq;
 
   //! How many bytes of the front-of-queue datagram has been acked
   size_t ackedLocInDatagram;
@@ -405,6 +445,7 @@ struct ChppTransportState {
 
   struct ChppTxStatus txStatus;                // Tx state
   struct ChppTxDatagramQueue txDatagramQueue;  // Queue of datagrams to be Tx
+  uint8_t txWindowSize;  // TX window size negotiated at reset, in packets
 
   size_t linkBufferSize;  // Number of bytes currently in the Tx Buffer
   void *linkContext;      // Pointer to the link layer state
@@ -33,6 +33,11 @@ void chppClearTotalAllocBytes(void);
  */
 size_t chppGetTotalAllocBytes(void);
 
+/**
+ * @return The number of allocations and reallocations made by CHPP so far.
+ */
+size_t chppGetTotalAllocCount(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,6 +32,7 @@ struct ChppAllocHeader {
 };
 
 static atomic_size_t gTotalAllocBytes = 0;
+static atomic_size_t gTotalAllocCount = 0;
 
 void *chppMalloc(const size_t size) {
   void *ptr = NULL;
@@ -45,6 +46,7 @@ void *chppMalloc(const size_t size) {
       ptr = header;
 
       gTotalAllocBytes += size;
+      gTotalAllocCount++;
     }
   }
 
@@ -87,6 +89,7 @@ void *chppRealloc(void *oldPtr, const size_t newSize, const size_t oldSize) {
       newHeader++;
       ptr = newHeader;
 
+      gTotalAllocCount++;
       if (newSize > oldSize) {
         gTotalAllocBytes += (newSize - oldSize);
       } else {
@@ -110,3 +113,7 @@ void chppClearTotalAllocBytes(void) {
 size_t chppGetTotalAllocBytes(void) {
   return gTotalAllocBytes;
 }
+
+size_t chppGetTotalAllocCount(void) {
+  return gTotalAllocCount;
+}
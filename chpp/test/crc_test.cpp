@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "chpp/crc.h"
+
+namespace {
+
+#if defined(CHPP_CRC32_HW_ACCEL)
+constexpr char kImplementationName[] = "hardware accelerated";
+#elif defined(CHPP_CRC32_SLICING_BY_8)
+constexpr char kImplementationName[] = "slicing-by-8";
+#else
+constexpr char kImplementationName[] = "nibble table";
+#endif
+
+/**
+ * Bitwise reference implementation of the IEEE CRC-32, with the same
+ * initialization semantics as chppCrc32().
+ */
+uint32_t referenceCrc32(uint32_t crc, const uint8_t *buf, size_t len) {
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= buf[i];
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+  }
+  return ~crc;
+}
+
+std::vector<uint8_t> makeTestData(size_t len) {
+  std::vector<uint8_t> data(len);
+  // 32-bit xorshift, for reproducible data without short periods.
+  uint32_t state = 0x12345678;
+  for (size_t i = 0; i < len; i++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    data[i] = static_cast<uint8_t>(state);
+  }
+  return data;
+}
+
+}  // namespace
+
+/**
+ * The configured implementation must match the reference for every length and
+ * alignment, including lengths that do not fill a full block of the faster
+ * implementations.
+ */
+TEST(Crc32Test, MatchesReferenceForAllLengthsAndAlignments) {
+  constexpr size_t kMaxLen = 600;
+  constexpr size_t kMaxOffset = 16;
+  std::vector<uint8_t> data = makeTestData(kMaxLen + kMaxOffset);
+
+  for (size_t offset = 0; offset < kMaxOffset; offset++) {
+    for (size_t len = 0; len <= kMaxLen; len++) {
+      ASSERT_EQ(chppCrc32(0, &data[offset], len),
+                referenceCrc32(0, &data[offset], len))
+          << "offset " << offset << " len " << len;
+    }
+  }
+}
+
+TEST(Crc32Test, MatchesReferenceWhenDaisyChained) {
+  constexpr size_t kLen = 4096;
+  std::vector<uint8_t> data = makeTestData(kLen);
+  uint32_t expected = referenceCrc32(0, data.data(), kLen);
+
+  for (size_t partition : {1, 7, 63, 64, 65, 1000, 4095}) {
+    uint32_t crc = chppCrc32(0, data.data(), partition);
+    EXPECT_EQ(chppCrc32(crc, &data[partition], kLen - partition), expected)
+        << "partition " << partition;
+  }
+}
+
+/**
+ * Measures the throughput of chppCrc32() for payload sizes seen on the
+ * transport, from a bare header up to a full 1 KiB packet.
+ */
+TEST(Crc32Test, DISABLED_Benchmark) {
+  constexpr size_t kBytesPerMeasurement = 64 * 1024 * 1024;
+  std::vector<uint8_t> data = makeTestData(1024);
+
+  for (size_t len : {6, 64, 256, 1024}) {
+    size_t iterations = kBytesPerMeasurement / len;
+    uint32_t crc = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+      // Chain the CRCs so the calls can't be elided.
+      crc = chppCrc32(crc, data.data(), len);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    uint64_t elapsedNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    EXPECT_NE(elapsedNs, 0);
+
+    printf("CRC-32 (%s), %zu byte buffers: %" PRIu64 " MB/s (crc 0x%08" PRIx32
+           ")\n",
+           kImplementationName, len,
+           static_cast<uint64_t>(iterations * len * 1000 /
+                                 (elapsedNs == 0 ? 1 : elapsedNs)),
+           crc);
+  }
+}
@@ -16,7 +16,12 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <cinttypes>
 #include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <iostream>
 #include <thread>
 #include <type_traits>
@@ -101,7 +106,8 @@ class FakeLinkSyncTests : public testing::Test {
     ASSERT_TRUE(comparePacket(resetPkt, generateResetPacket()))
         << "Full packet: " << asResetPacket(resetPkt);
 
-    ChppResetPacket resetAck = generateResetAckPacket();
+    ChppResetPacket resetAck = generateResetAckPacket(
+        /*ackSeq=*/1, /*seq=*/0, getRemoteWindowSize());
     chppRxDataCb(&mTransportContext, reinterpret_cast<uint8_t *>(&resetAck),
                  sizeof(resetAck));
 
@@ -111,6 +117,13 @@ class FakeLinkSyncTests : public testing::Test {
         << "Full packet: " << asChpp(ackPkt);
   }
 
+  //! The TX window size advertised in the reset-ack of the fake remote
+  //! endpoint. Defaults to none, i.e. a CHPP 1.0.0 endpoint, so the transport
+  //! uses a TX window of 1.
+  virtual uint16_t getRemoteWindowSize() {
+    return 0;
+  }
+
   void TearDown() override {
     chppWorkThreadStop(&mTransportContext);
     mWorkThread.join();
@@ -183,4 +196,176 @@ TEST_F(FakeLinkSyncTests, MultipleNotifications) {
   EXPECT_FALSE(mFakeLink->waitForTxPacket());
 }
 
+/**
+ * Negotiates the TX window size given as the test parameter, and acts as a
+ * remote endpoint with a fixed round trip time to transfer datagrams.
+ */
+class FakeLinkWindowTests : public FakeLinkSyncTests,
+                            public testing::WithParamInterface<uint16_t> {
+ protected:
+  //! Round trip time of the emulated link, i.e. from a packet being sent until
+  //! its ACK is received. This is well below the TX timeout.
+  static constexpr auto kRoundTripTime = 4ms;
+
+  uint16_t getRemoteWindowSize() override {
+    return GetParam();
+  }
+
+  /**
+   * Sends a datagram and receives it as the remote endpoint would, i.e.
+   * discarding and NACKing out of order packets, with each ACK / NACK delivered
+   * kRoundTripTime after the packet was sent.
+   *
+   * @param len Length of the datagram in bytes.
+   * @param dropSeq Sequence number of a packet to drop the first time it is
+   *     sent, or -1 to not drop any packet.
+   *
+   * @return Time from enqueuing the datagram until it was received in full.
+   */
+  std::chrono::nanoseconds transferDatagram(size_t len, int dropSeq = -1) {
+    struct PendingAck {
+      std::chrono::steady_clock::time_point deliveryTime;
+      ChppEmptyPacket packet;
+    };
+    std::deque<PendingAck> pendingAcks;
+
+    std::vector<uint8_t> expected(len);
+    for (size_t i = 0; i < len; i++) {
+      expected[i] = static_cast<uint8_t>(i * 7);
+    }
+    auto *payload = static_cast<uint8_t *>(chppMalloc(len));
+    memcpy(payload, expected.data(), len);
+
+    uint8_t expectedSeq = 1;  // The handshake used sequence number 0
+    uint8_t deliveredAckSeq = 1;
+    size_t receivedLen = 0;
+    bool dropped = false;
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start;
+    EXPECT_TRUE(chppEnqueueTxDatagramOrFail(&mTransportContext, payload, len));
+
+    while (receivedLen < len || !pendingAcks.empty()) {
+      auto now = std::chrono::steady_clock::now();
+      if (now - start > 100 * FakeLink::kDefaultTimeout) {
+        ADD_FAILURE() << "Received " << receivedLen << " of " << len;
+        break;
+      }
+
+      auto timeout = FakeLink::kDefaultTimeout;
+      if (!pendingAcks.empty()) {
+        timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+            pendingAcks.front().deliveryTime - now);
+      }
+      if (mFakeLink->waitForTxPacket(std::max(timeout, 0ms))) {
+        std::vector<uint8_t> pkt = mFakeLink->popTxPacket();
+        ChppTransportHeader &header = getHeader(pkt);
+        if (header.length > 0) {
+          mPacketsReceived++;
+
+          // The sender may not have seen all delivered ACKs yet, so this only
+          // bounds packets sent after the last delivered ACK.
+          int packetsAheadOfAck =
+              static_cast<int8_t>(header.seq - deliveredAckSeq) + 1;
+          EXPECT_LE(packetsAheadOfAck, GetParam());
+          mMaxPacketsInFlight = std::max(mMaxPacketsInFlight, packetsAheadOfAck);
+
+          if (header.seq == dropSeq && !dropped) {
+            dropped = true;
+            continue;
+          }
+
+          uint8_t error = CHPP_TRANSPORT_ERROR_NONE;
+          if (header.seq == expectedSeq) {
+            const uint8_t *data =
+                &pkt[CHPP_PREAMBLE_LEN_BYTES + sizeof(ChppTransportHeader)];
+            EXPECT_EQ(memcmp(data, &expected[receivedLen], header.length), 0);
+            receivedLen += header.length;
+            expectedSeq++;
+            if (receivedLen == len) {
+              end = std::chrono::steady_clock::now();
+            }
+          } else {
+            error = CHPP_TRANSPORT_ERROR_ORDER;
+          }
+          pendingAcks.push_back(
+              {std::chrono::steady_clock::now() + kRoundTripTime,
+               generateEmptyPacket(expectedSeq, /*seq=*/0, error)});
+        }
+      }
+
+      while (!pendingAcks.empty() && pendingAcks.front().deliveryTime <=
+                                         std::chrono::steady_clock::now()) {
+        deliveredAckSeq = pendingAcks.front().packet.header.ackSeq;
+        chppRxDataCb(&mTransportContext,
+                     reinterpret_cast<uint8_t *>(&pendingAcks.front().packet),
+                     sizeof(ChppEmptyPacket));
+        pendingAcks.pop_front();
+      }
+    }
+
+    // Discard retransmissions that crossed paths with the final ACK
+    while (mFakeLink->waitForTxPacket(2 * FakeLink::kTransportTimeout)) {
+      mFakeLink->popTxPacket();
+    }
+
+    return end - start;
+  }
+
+  size_t mPacketsReceived = 0;
+  int mMaxPacketsInFlight = 0;
+};
+
+TEST_P(FakeLinkWindowTests, PacketsInFlightLimitedByWindow) {
+  constexpr size_t kNumPackets = 32;
+  size_t len = kNumPackets * chppTransportTxMtuSize(&mTransportContext);
+
+  transferDatagram(len);
+
+  // A stalled test thread can let the TX timeout expire, so retransmissions
+  // are tolerated here.
+  EXPECT_GE(mPacketsReceived, kNumPackets);
+  EXPECT_LE(mMaxPacketsInFlight, GetParam());
+  if (GetParam() > 1) {
+    EXPECT_GT(mMaxPacketsInFlight, 1);
+  } else {
+    EXPECT_EQ(mMaxPacketsInFlight, 1);
+  }
+}
+
+/**
+ * Measures the throughput for a datagram spanning many packets. Stop-and-wait
+ * can not do better than one packet per round trip, which a larger window is
+ * expected to beat.
+ */
+TEST_P(FakeLinkWindowTests, DISABLED_Throughput) {
+  constexpr size_t kNumPackets = 32;
+  size_t len = kNumPackets * chppTransportTxMtuSize(&mTransportContext);
+
+  std::chrono::nanoseconds elapsed = transferDatagram(len);
+  auto elapsedUs =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  printf("TX window %" PRIu16 ", %lld ms round trip: %zu bytes in %lld us, "
+         "%lld bytes/s, max %d packets in flight\n",
+         GetParam(), static_cast<long long>(kRoundTripTime.count()), len,
+         static_cast<long long>(elapsedUs),
+         static_cast<long long>(len * 1000000 /
+                                (elapsedUs == 0 ? 1 : elapsedUs)),
+         mMaxPacketsInFlight);
+}
+
+TEST_P(FakeLinkWindowTests, LostPacketIsRetransmitted) {
+  constexpr size_t kNumPackets = 12;
+  size_t len = kNumPackets * chppTransportTxMtuSize(&mTransportContext);
+
+  transferDatagram(len, /*dropSeq=*/3);
+
+  // At least the lost packet is sent again, and with go-back-N, each packet
+  // sent after it within the window as well.
+  EXPECT_GT(mPacketsReceived, kNumPackets);
+}
+
+INSTANTIATE_TEST_SUITE_P(WindowSizes, FakeLinkWindowTests,
+                         testing::Values(1, 4, 8));
+
 }  // namespace chpp::test
@@ -42,7 +42,8 @@ ChppEmptyPacket generateEmptyPacket(uint8_t ackSeq, uint8_t seq,
   return pkt;
 }
 
-ChppResetPacket generateResetPacket(uint8_t ackSeq, uint8_t seq) {
+ChppResetPacket generateResetPacket(uint8_t ackSeq, uint8_t seq,
+                                    uint16_t windowSize) {
   // clang-format off
   ChppResetPacket pkt = {
     .preamble = kPreamble,
@@ -64,7 +65,7 @@ ChppResetPacket generateResetPacket(uint8_t ackSeq, uint8_t seq) {
         .patch = 0,
       },
       .reserved1 = 0,
-      .reserved2 = 0,
+      .windowSize = windowSize,
       .reserved3 = 0,
     }
   };
@@ -73,8 +74,9 @@ ChppResetPacket generateResetPacket(uint8_t ackSeq, uint8_t seq) {
   return pkt;
 }
 
-ChppResetPacket generateResetAckPacket(uint8_t ackSeq, uint8_t seq) {
-  ChppResetPacket pkt = generateResetPacket(ackSeq, seq);
+ChppResetPacket generateResetAckPacket(uint8_t ackSeq, uint8_t seq,
+                                       uint16_t windowSize) {
+  ChppResetPacket pkt = generateResetPacket(ackSeq, seq, windowSize);
   pkt.header.packetCode =
       static_cast<uint8_t>(CHPP_ATTR_AND_ERROR_TO_PACKET_CODE(
           CHPP_TRANSPORT_ATTR_RESET_ACK, CHPP_TRANSPORT_ERROR_NONE));
@@ -219,6 +221,7 @@ void dumpConfig(std::ostream &os, const ChppTransportConfiguration &cfg) {
      << "  version: " << std::dec << (unsigned)cfg.version.major << "."
      << std::dec << (unsigned)cfg.version.minor << "." << std::dec
      << cfg.version.patch << std::endl
+     << "  windowSize: " << std::dec << cfg.windowSize << std::endl
      << "}" << std::endl;
 }
 
@@ -1079,6 +1079,59 @@ TEST_F(TransportTests, DiscardedPacketTest) {
   t1.join();
 }
 
+/*
+ * A fragmented datagram is reassembled correctly, without reallocating its
+ * payload for every packet.
+ */
+TEST_F(TransportTests, FragmentedDatagramAllocations) {
+  constexpr size_t kNumPackets = 16;
+  const size_t packetLen = chppTransportRxMtuSize(&mTransportContext);
+  size_t allocCountBefore = chppGetTotalAllocCount();
+
+  for (size_t i = 0; i < kNumPackets; i++) {
+    size_t loc = 0;
+    addPreambleToBuf(mBuf, &loc);
+    ChppTransportHeader *transHeader = addTransportHeaderToBuf(mBuf, &loc);
+    transHeader->flags = (i + 1 < kNumPackets)
+                             ? CHPP_TRANSPORT_FLAG_UNFINISHED_DATAGRAM
+                             : CHPP_TRANSPORT_FLAG_FINISHED_DATAGRAM;
+    transHeader->seq = static_cast<uint8_t>(i);
+    transHeader->length = static_cast<uint16_t>(packetLen);
+    for (size_t j = 0; j < packetLen; j++) {
+      mBuf[loc++] = static_cast<uint8_t>(i + j);
+    }
+    addTransportFooterToBuf(mBuf, &loc);
+
+    // Hold back the footer of the last packet, which would hand the datagram
+    // over to the app layer.
+    if (i + 1 == kNumPackets) {
+      loc -= sizeof(ChppTransportFooter);
+    }
+    chppRxDataCb(&mTransportContext, mBuf, loc);
+  }
+
+  ASSERT_EQ(mTransportContext.rxDatagram.length, kNumPackets * packetLen);
+  ASSERT_EQ(mTransportContext.rxStatus.locInDatagram, kNumPackets * packetLen);
+  for (size_t i = 0; i < kNumPackets; i++) {
+    for (size_t j = 0; j < packetLen; j++) {
+      ASSERT_EQ(mTransportContext.rxDatagram.payload[i * packetLen + j],
+                static_cast<uint8_t>(i + j));
+    }
+  }
+
+  // One allocation for the first packet, after which the capacity doubles.
+  size_t allocCount = chppGetTotalAllocCount() - allocCountBefore;
+  EXPECT_LE(allocCount, 5);
+  EXPECT_GE(mTransportContext.rxStatus.datagramCapacity,
+            mTransportContext.rxDatagram.length);
+
+  // Discarding the last packet keeps the rest of the datagram.
+  chppRxPacketCompleteCb(&mTransportContext);
+  EXPECT_EQ(mTransportContext.rxDatagram.length,
+            (kNumPackets - 1) * packetLen);
+  EXPECT_EQ(mTransportContext.rxStatus.expectedSeq, kNumPackets - 1);
+}
+
 /*
  * Correctly handle messages directed to clients / services with an invalid
  * handle number.
@@ -61,10 +61,18 @@ static void chppProcessResetAck(struct ChppTransportState *context);
 static void chppProcessRxPacket(struct ChppTransportState *context);
 static void chppProcessRxPayload(struct ChppTransportState *context);
 static void chppClearRxDatagram(struct ChppTransportState *context);
+static bool chppReserveRxDatagram(struct ChppTransportState *context,
+                                  size_t length);
 static bool chppRxChecksumIsOk(const struct ChppTransportState *context);
 static enum ChppTransportErrorCode chppRxHeaderCheck(
     const struct ChppTransportState *context);
 static void chppRegisterRxAck(struct ChppTransportState *context);
+static uint8_t chppGetNegotiatedTxWindowSize(
+    const struct ChppTransportState *context);
+static void chppRewindTxWindow(struct ChppTransportState *context);
+static uint8_t chppGetTxWindowSize(const struct ChppTransportState *context);
+static bool chppTxWindowHasRoom(const struct ChppTransportState *context);
+static bool chppTxAckIsPending(const struct ChppTransportState *context);
 
 static void chppEnqueueTxPacket(struct ChppTransportState *context,
                                 uint8_t packetCode);
@@ -75,6 +83,7 @@ static void chppAddPayload(struct ChppTransportState *context);
 static void chppAddFooter(struct ChppTransportState *context);
 size_t chppDequeueTxDatagram(struct ChppTransportState *context);
 static void chppClearTxDatagramQueue(struct ChppTransportState *context);
+static bool chppTransportSendNextPacket(struct ChppTransportState *context);
 static void chppTransportDoWork(struct ChppTransportState *context);
 static void chppAppendToPendingTxPacket(struct ChppTransportState *context,
                                         const uint8_t *buf, size_t len);
@@ -202,25 +211,12 @@ static size_t chppConsumeHeader(struct ChppTransportState *context,
 
     } else {
       // Payload bearing packet
-      uint8_t *tempPayload;
-
-      if (context->rxDatagram.length == 0) {
-        // Packet is a new datagram
-        tempPayload = chppMalloc(context->rxHeader.length);
-      } else {
-        // Packet is a continuation of a fragmented datagram
-        tempPayload =
-            chppRealloc(context->rxDatagram.payload,
-                        context->rxDatagram.length + context->rxHeader.length,
-                        context->rxDatagram.length);
-      }
-
-      if (tempPayload == NULL) {
+      if (!chppReserveRxDatagram(
+              context, context->rxDatagram.length + context->rxHeader.length)) {
         CHPP_LOG_OOM();
         chppEnqueueTxPacket(context, CHPP_TRANSPORT_ERROR_OOM);
         chppSetRxState(context, CHPP_STATE_PREAMBLE);
       } else {
-        context->rxDatagram.payload = tempPayload;
         context->rxDatagram.length += context->rxHeader.length;
         chppSetRxState(context, CHPP_STATE_PAYLOAD);
       }
@@ -401,19 +397,10 @@ static void chppAbortRxPacket(struct ChppTransportState *context) {
     if (context->rxDatagram.length == 0) {
       // Discarding this packet == discarding entire datagram
       CHPP_FREE_AND_NULLIFY(context->rxDatagram.payload);
-
-    } else {
-      // Discarding this packet == discarding part of datagram
-      uint8_t *tempPayload =
-          chppRealloc(context->rxDatagram.payload, context->rxDatagram.length,
-                      context->rxDatagram.length + undoLen);
-
-      if (tempPayload == NULL) {
-        CHPP_LOG_OOM();
-      } else {
-        context->rxDatagram.payload = tempPayload;
-      }
+      context->rxStatus.datagramCapacity = 0;
     }
+    // Otherwise, discarding this packet == discarding part of datagram. The
+    // spare capacity is reused by the retransmitted packet.
   }
 
   chppSetRxState(context, CHPP_STATE_PREAMBLE);
@@ -542,7 +529,8 @@ static void chppProcessResetAck(struct ChppTransportState *context) {
   context->rxStatus.expectedSeq = context->rxHeader.seq + 1;
   chppRegisterRxAck(context);
 
-  // TODO: Configure transport layer based on (optional?) received config
+  context->txWindowSize = chppGetNegotiatedTxWindowSize(context);
+  CHPP_LOGI("TX window size=%" PRIu8, context->txWindowSize);
 
   chppDatagramProcessDoneCb(context, context->rxDatagram.payload);
   chppClearRxDatagram(context);
@@ -572,6 +560,17 @@ static void chppProcessRxPacket(struct ChppTransportState *context) {
   context->rxStatus.receivedPacketCode = context->rxHeader.packetCode;
   chppRegisterRxAck(context);
 
+  if (context->txWindowSize > 1 && context->txDatagramQueue.pending > 0 &&
+      CHPP_TRANSPORT_GET_ERROR(context->rxHeader.packetCode) !=
+          CHPP_TRANSPORT_ERROR_NONE &&
+      !context->txStatus.retransmittedForAckSeq) {
+    // Explicit NACK. Go back to the last ACKed packet, but only once per ACKed
+    // sequence number, as a single loss within the window may be NACKed by
+    // every following packet.
+    context->txStatus.retransmitPending = true;
+    context->txStatus.retransmittedForAckSeq = true;
+  }
+
   enum ChppTransportErrorCode errorCode = CHPP_TRANSPORT_ERROR_NONE;
   if (context->rxHeader.length > 0 &&
       context->rxHeader.seq != context->rxStatus.expectedSeq) {
@@ -582,8 +581,8 @@ static void chppProcessRxPacket(struct ChppTransportState *context) {
   if (context->txDatagramQueue.pending > 0 ||
       errorCode == CHPP_TRANSPORT_ERROR_ORDER) {
     // There are packets to send out (could be new or retx)
-    // Note: For a future ACK window > 1, makes more sense to cap the NACKs
-    // to one instead of flooding with out of order NACK errors.
+    // Note: With a TX window >1, the remote endpoint only retransmits once per
+    // ACKed sequence number, so repeated out of order NACKs are harmless.
     chppEnqueueTxPacket(context, CHPP_ATTR_AND_ERROR_TO_PACKET_CODE(
                                      CHPP_TRANSPORT_ATTR_NONE, errorCode));
   }
@@ -661,10 +660,52 @@ static void chppProcessRxPayload(struct ChppTransportState *context) {
  */
 static void chppClearRxDatagram(struct ChppTransportState *context) {
   context->rxStatus.locInDatagram = 0;
+  context->rxStatus.datagramCapacity = 0;
   context->rxDatagram.length = 0;
   context->rxDatagram.payload = NULL;
 }
 
+/**
+ * Ensures that the payload of the incoming datagram can hold the given number
+ * of bytes.
+ *
+ * The first packet of a datagram is allocated at its exact size, so that
+ * unfragmented datagrams don't use more memory than needed. Continuations of a
+ * fragmented datagram at least double the allocation, so that the bytes
+ * received so far are copied a bounded number of times rather than for every
+ * packet. The datagram is always reassembled into one contiguous buffer, as
+ * expected by the app layer and the service parsers.
+ *
+ * @param context Maintains state for each transport layer instance.
+ * @param length Required length of the datagram payload in bytes.
+ *
+ * @return False if out of memory, in which case the current payload is kept.
+ */
+static bool chppReserveRxDatagram(struct ChppTransportState *context,
+                                  size_t length) {
+  size_t capacity = context->rxStatus.datagramCapacity;
+  if (length <= capacity) {
+    return true;
+  }
+
+  uint8_t *tempPayload;
+  if (capacity == 0) {
+    // Packet is a new datagram
+    tempPayload = chppMalloc(length);
+  } else {
+    // Packet is a continuation of a fragmented datagram
+    length = MAX(length, 2 * capacity);
+    tempPayload = chppRealloc(context->rxDatagram.payload, length, capacity);
+  }
+
+  if (tempPayload == NULL) {
+    return false;
+  }
+  context->rxDatagram.payload = tempPayload;
+  context->rxStatus.datagramCapacity = length;
+  return true;
+}
+
 /**
  * Validates the checksum of an incoming packet.
  *
@@ -719,18 +760,19 @@ static enum ChppTransportErrorCode chppRxHeaderCheck(
 }
 
 /**
- * Registers a received ACK. If an outgoing datagram is fully ACKed, it is
- * popped from the TX queue.
+ * Registers a received ACK. ACKs are cumulative, i.e. with a TX window >1, a
+ * single ACK may cover several packets. If an outgoing datagram is fully ACKed,
+ * it is popped from the TX queue.
  *
  * @param context Maintains state for each transport layer instance.
  */
 static void chppRegisterRxAck(struct ChppTransportState *context) {
   uint8_t rxAckSeq = context->rxHeader.ackSeq;
+  uint8_t numAcked = (uint8_t)(rxAckSeq - context->rxStatus.receivedAckSeq);
 
-  if (context->rxStatus.receivedAckSeq != rxAckSeq) {
-    // A previously sent packet was actually ACKed
-    // Note: For a future ACK window >1, we should loop by # of ACKed packets
-    if ((uint8_t)(context->rxStatus.receivedAckSeq + 1) != rxAckSeq) {
+  if (numAcked != 0) {
+    // One or more previously sent packets were actually ACKed
+    if (numAcked > MAX(context->txStatus.packetsUnacked, 1)) {
       CHPP_LOGE("Out of order ACK: last=%" PRIu8 " rx=%" PRIu8,
                 context->rxStatus.receivedAckSeq, rxAckSeq);
     } else {
@@ -750,29 +792,125 @@ static void chppRegisterRxAck(struct ChppTransportState *context) {
                   context->rxHeader.seq, context->txStatus.txAttempts - 1);
       }
       context->txStatus.txAttempts = 0;
+      context->txStatus.retransmittedForAckSeq = false;
+      context->txStatus.packetsUnacked -=
+          MIN(numAcked, context->txStatus.packetsUnacked);
 
-      // Process and if necessary pop from Tx datagram queue
-      context->txStatus.ackedLocInDatagram += chppTransportTxMtuSize(context);
-      if (context->txStatus.ackedLocInDatagram >=
-          context->txDatagramQueue.datagram[context->txDatagramQueue.front]
-              .length) {
-        // We are done with datagram
-
-        context->txStatus.ackedLocInDatagram = 0;
-        context->txStatus.sentLocInDatagram = 0;
-
-        // Note: For a future ACK window >1, we need to update the queue
-        // position of the datagram being sent as well (relative to the
-        // front-of-queue). e.g. context->txStatus.datagramBeingSent--;
+      // If the window was rewound after the ACKed packets were sent, the next
+      // packet to send is now the first unACKed one.
+      bool rewind = (numAcked > context->txStatus.packetsInFlight);
 
-        if (chppDequeueTxDatagram(context) == 0) {
-          context->txStatus.hasPacketsToSend = false;
+      // Process and if necessary pop from Tx datagram queue
+      for (uint8_t i = 0; i < numAcked; i++) {
+        context->txStatus.ackedLocInDatagram += chppTransportTxMtuSize(context);
+        if (context->txStatus.ackedLocInDatagram >=
+            context->txDatagramQueue.datagram[context->txDatagramQueue.front]
+                .length) {
+          // We are done with datagram
+
+          context->txStatus.ackedLocInDatagram = 0;
+          if (context->txStatus.datagramBeingSent > 0) {
+            context->txStatus.datagramBeingSent--;
+          }
+
+          if (chppDequeueTxDatagram(context) == 0) {
+            context->txStatus.hasPacketsToSend = false;
+            break;
+          }
         }
       }
+
+      if (rewind) {
+        chppRewindTxWindow(context);
+      } else {
+        context->txStatus.packetsInFlight -= numAcked;
+      }
     }
   }  // else {nothing was ACKed}
 }
 
+/**
+ * Determines the TX window size from the configuration of a received reset or
+ * reset-ack packet. Must be called before the received datagram is freed.
+ *
+ * @param context Maintains state for each transport layer instance.
+ *
+ * @return The smaller of the local and the remote window sizes, in packets.
+ */
+static uint8_t chppGetNegotiatedTxWindowSize(
+    const struct ChppTransportState *context) {
+  uint16_t windowSize = 1;
+
+  if (context->rxHeader.length >= sizeof(struct ChppTransportConfiguration) &&
+      context->rxStatus.locInDatagram >= context->rxHeader.length &&
+      context->rxDatagram.payload != NULL) {
+    struct ChppTransportConfiguration config;
+    memcpy(&config,
+           &context->rxDatagram.payload[context->rxStatus.locInDatagram -
+                                        context->rxHeader.length],
+           sizeof(config));
+
+    // CHPP 1.0.0 endpoints do not advertise a window size
+    windowSize = MIN(MAX(config.windowSize, 1),
+                     (uint16_t)CHPP_TRANSPORT_MAX_TX_WINDOW_SIZE);
+  }
+
+  return (uint8_t)windowSize;
+}
+
+/**
+ * Moves the position of the next packet to send back to the first unACKed
+ * packet, i.e. for a retransmission.
+ *
+ * @param context Maintains state for each transport layer instance.
+ */
+static void chppRewindTxWindow(struct ChppTransportState *context) {
+  context->txStatus.retransmitPending = false;
+  context->txStatus.packetsInFlight = 0;
+  context->txStatus.datagramBeingSent = 0;
+  context->txStatus.sentLocInDatagram = context->txStatus.ackedLocInDatagram;
+}
+
+/**
+ * Packet attributes (e.g. of a reset-ack) only apply to the datagram at the
+ * front of the queue, so such a datagram is sent on its own, i.e. with a TX
+ * window of 1, until it is ACKed.
+ *
+ * @param context Maintains state for each transport layer instance.
+ *
+ * @return The TX window size that currently applies, in packets.
+ */
+static uint8_t chppGetTxWindowSize(const struct ChppTransportState *context) {
+  return (CHPP_TRANSPORT_GET_ATTR(context->txStatus.packetCodeToSend) ==
+          CHPP_TRANSPORT_ATTR_NONE)
+             ? context->txWindowSize
+             : 1;
+}
+
+/**
+ * @param context Maintains state for each transport layer instance.
+ *
+ * @return True if there is a payload that has not been sent yet and the TX
+ * window allows for it to be sent before the pending ones are ACKed.
+ */
+static bool chppTxWindowHasRoom(const struct ChppTransportState *context) {
+  return context->txStatus.packetsInFlight < chppGetTxWindowSize(context) &&
+         context->txStatus.datagramBeingSent < context->txDatagramQueue.pending;
+}
+
+/**
+ * @param context Maintains state for each transport layer instance.
+ *
+ * @return True if the remote endpoint needs to be sent a packet even without a
+ * payload, i.e. an ACK for a received payload, a NACK, or packet attributes.
+ */
+static bool chppTxAckIsPending(const struct ChppTransportState *context) {
+  return context->txStatus.sentAckSeq != context->rxStatus.expectedSeq ||
+         context->txStatus.packetCodeToSend !=
+             CHPP_ATTR_AND_ERROR_TO_PACKET_CODE(CHPP_TRANSPORT_ATTR_NONE,
+                                                CHPP_TRANSPORT_ERROR_NONE);
+}
+
 /**
  * Enqueues an outgoing packet with the specified error code. The error code
  * refers to the optional reason behind a NACK, if any. An error code of
@@ -842,7 +980,8 @@ static struct ChppTransportHeader *chppAddHeader(
 }
 
 /**
- * Adds the packet payload to link tx buffer.
+ * Adds the packet payload to link tx buffer, starting from the location of the
+ * next packet to send, and advances that location.
  *
  * @param context Maintains state for each transport layer instance.
  */
@@ -851,9 +990,13 @@ static void chppAddPayload(struct ChppTransportState *context) {
   struct ChppTransportHeader *txHeader =
       (struct ChppTransportHeader *)&linkTxBuffer[CHPP_PREAMBLE_LEN_BYTES];
 
+  const struct ChppDatagram *datagram =
+      &context->txDatagramQueue
+           .datagram[(context->txDatagramQueue.front +
+                      context->txStatus.datagramBeingSent) %
+                     CHPP_TX_DATAGRAM_QUEUE_LEN];
   size_t remainingBytes =
-      context->txDatagramQueue.datagram[context->txDatagramQueue.front].length -
-      context->txStatus.ackedLocInDatagram;
+      datagram->length - context->txStatus.sentLocInDatagram;
 
   CHPP_LOGD("Adding payload to seq=%" PRIu8 ", remainingBytes=%" PRIuSIZE
             " of pending datagrams=%" PRIu8,
@@ -871,14 +1014,18 @@ static void chppAddPayload(struct ChppTransportState *context) {
 
   // Copy payload
   chppAppendToPendingTxPacket(
-      context,
-      context->txDatagramQueue.datagram[context->txDatagramQueue.front]
-              .payload +
-          context->txStatus.ackedLocInDatagram,
+      context, datagram->payload + context->txStatus.sentLocInDatagram,
       txHeader->length);
 
-  context->txStatus.sentLocInDatagram =
-      context->txStatus.ackedLocInDatagram + txHeader->length;
+  context->txStatus.sentLocInDatagram += txHeader->length;
+  if (context->txStatus.sentLocInDatagram >= datagram->length) {
+    // The next packet starts the next datagram in the queue
+    context->txStatus.sentLocInDatagram = 0;
+    context->txStatus.datagramBeingSent++;
+  }
+  context->txStatus.packetsInFlight++;
+  context->txStatus.packetsUnacked =
+      MAX(context->txStatus.packetsUnacked, context->txStatus.packetsInFlight);
 }
 
 /**
@@ -953,22 +1100,50 @@ static void chppClearTxDatagramQueue(struct ChppTransportState *context) {
  * chppEnqueueTxPacket().
  *
  * A payload may or may not be included be according the following:
- * No payload: If Tx datagram queue is empty OR we are waiting on a pending ACK.
- * New payload: If there is one or more pending Tx datagrams and we are not
- * waiting on a pending ACK.
+ * No payload: If Tx datagram queue is empty OR the TX window is full.
+ * New payload: If there is one or more pending Tx datagrams that have not been
+ * sent out yet and the TX window is not full.
  * Repeat payload: If we haven't received an ACK yet for our previous payload,
- * i.e. we have registered an explicit or implicit NACK.
+ * i.e. we have registered an explicit or implicit NACK. With a TX window of 1,
+ * this is the case for every packet sent before the pending ACK is received.
+ * With a larger window, all unACKed packets are resent (go-back-N).
+ *
+ * With a TX window >1, no packet is sent if the TX window is full and there is
+ * no ACK / NACK to send.
  *
  * @param context Maintains state for each transport layer instance.
+ *
+ * @return True if the TX window allows for another payload to be sent right
+ * away, i.e. this function should be called again.
  */
-static void chppTransportDoWork(struct ChppTransportState *context) {
+static bool chppTransportSendNextPacket(struct ChppTransportState *context) {
   bool havePacketForLinkLayer = false;
+  bool canSendMore = false;
   struct ChppTransportHeader *txHeader;
 
-  // Note: For a future ACK window >1, there needs to be a loop outside the lock
   chppMutexLock(&context->mutex);
 
-  if (context->txStatus.hasPacketsToSend && !context->txStatus.linkBusy) {
+  bool canSend =
+      context->txStatus.hasPacketsToSend && !context->txStatus.linkBusy;
+  bool addPayload = false;
+  if (canSend && context->txDatagramQueue.pending > 0) {
+    if (chppGetTxWindowSize(context) <= 1 ||
+        context->txStatus.retransmitPending) {
+      chppRewindTxWindow(context);
+    }
+    addPayload = chppTxWindowHasRoom(context);
+  }
+
+  if (canSend && !addPayload && context->txDatagramQueue.pending > 0 &&
+      !chppTxAckIsPending(context)) {
+    // The TX window is full or all pending datagrams have been sent. Wait for
+    // an ACK or a timeout.
+    CHPP_LOGD("TX waiting on ACK. RX ACK=%" PRIu8 ", TX seq=%" PRIu8
+              ", in flight=%" PRIu8,
+              context->rxStatus.receivedAckSeq, context->txStatus.sentSeq,
+              context->txStatus.packetsInFlight);
+
+  } else if (canSend) {
     // There are pending outgoing packets and the link isn't busy
     havePacketForLinkLayer = true;
     context->txStatus.linkBusy = true;
@@ -986,17 +1161,14 @@ static void chppTransportDoWork(struct ChppTransportState *context) {
     txHeader = chppAddHeader(context);
 
     // If applicable, add payload
-    if ((context->txDatagramQueue.pending > 0)) {
-      // Note: For a future ACK window >1, we need to rewrite this payload
-      // adding code to base the next packet on the sent location within the
-      // last sent datagram, except for the case of a NACK (explicit or
-      // timeout). For a NACK, we would need to base the next packet off the
-      // last ACKed location.
-
-      txHeader->seq = context->rxStatus.receivedAckSeq;
+    if (addPayload) {
+      txHeader->seq = (uint8_t)(context->rxStatus.receivedAckSeq +
+                                context->txStatus.packetsInFlight);
       context->txStatus.sentSeq = txHeader->seq;
 
-      if (context->txStatus.txAttempts > CHPP_TRANSPORT_MAX_RETX &&
+      bool isOldestUnacked = (context->txStatus.packetsInFlight == 0);
+      if (isOldestUnacked &&
+          context->txStatus.txAttempts > CHPP_TRANSPORT_MAX_RETX &&
           context->resetState != CHPP_RESET_STATE_RESETTING) {
         CHPP_LOGE("Resetting after %d reTX", CHPP_TRANSPORT_MAX_RETX);
         havePacketForLinkLayer = false;
@@ -1008,10 +1180,14 @@ static void chppTransportDoWork(struct ChppTransportState *context) {
 
       } else {
         chppAddPayload(context);
-        context->txStatus.txAttempts++;
+        if (isOldestUnacked) {
+          context->txStatus.txAttempts++;
+        }
+        canSendMore =
+            chppGetTxWindowSize(context) > 1 && chppTxWindowHasRoom(context);
       }
 
-    } else {
+    } else if (context->txDatagramQueue.pending == 0) {
       // No payload
       context->txStatus.hasPacketsToSend = false;
     }
@@ -1043,9 +1219,27 @@ static void chppTransportDoWork(struct ChppTransportState *context) {
       // error occurred. In either case, we should call chppLinkSendDoneCb()
       // here to release the contents of tx link buffer.
       chppLinkSendDoneCb(context, error);
+    } else {
+      // The link is busy until chppLinkSendDoneCb(), which signals the work
+      // thread again if the window allows for more packets.
+      canSendMore = false;
     }
   }
 
+  return canSendMore;
+}
+
+/**
+ * Sends out pending outgoing packets, i.e. a single packet with a TX window of
+ * 1 or as many as the TX window allows for otherwise, and processes client
+ * request timeouts.
+ *
+ * @param context Maintains state for each transport layer instance.
+ */
+static void chppTransportDoWork(struct ChppTransportState *context) {
+  while (chppTransportSendNextPacket(context)) {
+  }
+
 #ifdef CHPP_CLIENT_ENABLED
   {  // create a scope to declare timeoutResponse (C89).
     struct ChppAppHeader *timeoutResponse =
@@ -1156,6 +1350,11 @@ static bool chppEnqueueTxDatagram(struct ChppTransportState *context,
       if (context->txDatagramQueue.pending == 1) {
         // Queue was empty prior. Need to kickstart transmission.
         chppEnqueueTxPacket(context, packetCode);
+      } else if (chppGetTxWindowSize(context) > 1 &&
+                 chppTxWindowHasRoom(context)) {
+        // The TX window allows for the new datagram to be sent before the
+        // pending ones are ACKed.
+        chppNotifierSignal(&context->notifier, CHPP_TRANSPORT_SIGNAL_EVENT);
       }
 
       success = true;
@@ -1199,6 +1398,7 @@ static void chppResetTransportContext(struct ChppTransportState *context) {
 
   context->txStatus.sentSeq =
       UINT8_MAX;  // So that the seq # of the first TX packet is 0
+  context->txWindowSize = 1;  // Until negotiated by the reset handshake
   context->resetState = CHPP_RESET_STATE_RESETTING;
 }
 
@@ -1220,13 +1420,17 @@ static void chppResetTransportContext(struct ChppTransportState *context) {
 static void chppReset(struct ChppTransportState *transportContext,
                       enum ChppTransportPacketAttributes resetType,
                       enum ChppTransportErrorCode error) {
-  // TODO: Configure transport layer based on (optional?) received config before
-  // datagram is wiped
-
   chppMutexLock(&transportContext->mutex);
   struct ChppAppState *appContext = transportContext->appContext;
   transportContext->resetState = CHPP_RESET_STATE_RESETTING;
 
+  // Configure the transport layer based on the received reset, if any, before
+  // the datagram is wiped
+  uint8_t txWindowSize =
+      (resetType == CHPP_TRANSPORT_ATTR_RESET_ACK)
+          ? chppGetNegotiatedTxWindowSize(transportContext)
+          : 1;
+
   // Reset asynchronous link layer if busy
   if (transportContext->txStatus.linkBusy == true) {
     // TODO: Give time for link layer to finish before resorting to a reset
@@ -1237,6 +1441,7 @@ static void chppReset(struct ChppTransportState *transportContext,
   // Free memory allocated for any ongoing rx datagrams
   if (transportContext->rxDatagram.length > 0) {
     transportContext->rxDatagram.length = 0;
+    transportContext->rxStatus.datagramCapacity = 0;
     CHPP_FREE_AND_NULLIFY(transportContext->rxDatagram.payload);
   }
 
@@ -1254,6 +1459,7 @@ static void chppReset(struct ChppTransportState *transportContext,
   transportContext->rxStatus.receivedPacketCode =
       transportContext->rxHeader.packetCode;
   transportContext->rxStatus.expectedSeq = transportContext->rxHeader.seq + 1;
+  transportContext->txWindowSize = txWindowSize;
 
   // Send reset or reset-ACK
   chppMutexUnlock(&transportContext->mutex);
@@ -1617,6 +1823,10 @@ bool chppWorkThreadHandleSignal(struct ChppTransportState *context,
           CHPP_TRANSPORT_TX_TIMEOUT_NS) {
         CHPP_LOGE("ACK timeout. Tx t=%" PRIu64,
                   context->txStatus.lastTxTimeNs / CHPP_NSEC_PER_MSEC);
+        chppMutexLock(&context->mutex);
+        context->txStatus.retransmitPending = true;
+        context->txStatus.retransmittedForAckSeq = true;
+        chppMutexUnlock(&context->mutex);
         chppTransportDoWork(context);
       }
 
@@ -1666,6 +1876,12 @@ void chppLinkSendDoneCb(struct ChppTransportState *context,
   // No need to free anything as link Tx buffer is static. Likewise, we
   // keep linkBufferSize to assist testing.
 
+  if (chppGetTxWindowSize(context) > 1 &&
+      (chppTxWindowHasRoom(context) || context->txStatus.retransmitPending)) {
+    // More packets can be sent before the pending ones are ACKed
+    chppNotifierSignal(&context->notifier, CHPP_TRANSPORT_SIGNAL_EVENT);
+  }
+
   chppMutexUnlock(&context->mutex);
 }
 
@@ -1773,7 +1989,7 @@ void chppTransportSendReset(struct ChppTransportState *context,
     config->version.patch = 0;
 
     config->reserved1 = 0;
-    config->reserved2 = 0;
+    config->windowSize = CHPP_TRANSPORT_MAX_TX_WINDOW_SIZE;
     config->reserved3 = 0;
 
     if (resetType == CHPP_TRANSPORT_ATTR_RESET_ACK) {
@@ -74,6 +74,7 @@ void DebugDumpManager::collectFrameworkDebugDumps() {
   eventLoopManager->getMemoryManager().logStateToBuffer(mDebugDump);
   eventLoopManager->getEventLoop().handleNanoappWakeupBuckets();
   eventLoopManager->getEventLoop().logStateToBuffer(mDebugDump);
+  eventLoopManager->getHostCommsManager().logStateToBuffer(mDebugDump);
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
   eventLoopManager->getSensorRequestManager().logStateToBuffer(mDebugDump);
 #endif  // CHRE_SENSORS_SUPPORT_ENABLED
@@ -20,12 +20,12 @@
 
 namespace chre {
 
-uint16_t Event::getTimeMillis() {
-  Milliseconds now = SystemTime::getMonotonicTime();
+uint32_t Event::getTimeMicros() {
+  Microseconds now = SystemTime::getMonotonicTime();
   // Truncating, but we want to save space and really only care about delta time
-  // between pending events (for debugging), which shouldn't get close to 65
-  // seconds unless something is very wrong
-  return static_cast<uint16_t>(now.getMilliseconds());
+  // between pending events and until their delivery, which shouldn't get close
+  // to 71 minutes unless something is very wrong
+  return static_cast<uint32_t>(now.getMicroseconds());
 }
 
 }  // namespace chre
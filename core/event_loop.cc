@@ -28,11 +28,15 @@
 #include "chre/platform/system_time.h"
 #include "chre/util/conditional_lock_guard.h"
 #include "chre/util/lock_guard.h"
+#include "chre/util/nested_data_ptr.h"
 #include "chre/util/system/debug_dump.h"
 #include "chre/util/system/event_callbacks.h"
 #include "chre/util/system/stats_container.h"
 #include "chre/util/time.h"
+#include "chre_api/chre/audio.h"
+#include "chre_api/chre/sensor.h"
 #include "chre_api/chre/version.h"
+#include "chre_api/chre/wifi.h"
 
 namespace chre {
 
@@ -41,6 +45,12 @@ constexpr Nanoseconds EventLoop::kIntervalWakeupBucket;
 
 namespace {
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+//! The event loop running on the current thread, set for the duration of
+//! EventLoop::run().
+thread_local EventLoop *gCurrentThreadEventLoop = nullptr;
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
 #ifndef CHRE_STATIC_EVENT_LOOP
 using DynamicMemoryPool =
     SynchronizedExpandableMemoryPool<Event, CHRE_EVENT_PER_BLOCK,
@@ -81,13 +91,83 @@ bool populateNanoappInfo(const Nanoapp *app, struct chreNanoappInfo *info) {
   return success;
 }
 
+//! The longest that an event of each EventPriority is expected to wait behind
+//! events of lower priority classes, in microseconds.
+constexpr uint32_t kEventPriorityMaxDelayMicros[kNumEventPriorities] = {
+    0,      // System
+    1000,   // Realtime
+    10000,  // Normal
+    50000,  // Background
+};
+
+EventPriority getEventPriority(const Event *event) {
+  EventPriority priority;
+  if (event->targetInstanceId == kSystemInstanceId) {
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+    if (event->eventType ==
+        static_cast<uint16_t>(SystemCallbackType::ForwardEvent)) {
+      // Scheduled like the nanoapp event being forwarded
+      return getEventPriority(static_cast<const Event *>(event->eventData));
+    }
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+    priority = EventPriority::System;
+  } else if ((event->eventType >= CHRE_EVENT_SENSOR_DATA_EVENT_BASE &&
+              event->eventType < CHRE_EVENT_SENSOR_OTHER_EVENTS_BASE) ||
+             event->eventType == CHRE_EVENT_AUDIO_DATA) {
+    priority = EventPriority::Realtime;
+  } else if (event->senderInstanceId != kSystemInstanceId ||
+             event->eventType == CHRE_EVENT_WIFI_SCAN_RESULT) {
+    priority = EventPriority::Background;
+  } else {
+    priority = EventPriority::Normal;
+  }
+  return priority;
+}
+
+/**
+ * @return The first event type of the range owned by the subsystem that a
+ *         system event type belongs to.
+ */
+uint16_t getSubsystemFirstEventType(uint16_t eventType) {
+  uint16_t firstEventType;
+  if (eventType < CHRE_EVENT_SENSOR_FIRST_EVENT) {
+    // Core events, e.g. timers and messages from the host
+    firstEventType = 0;
+  } else if (eventType <= CHRE_EVENT_SENSOR_LAST_EVENT) {
+    firstEventType = CHRE_EVENT_SENSOR_FIRST_EVENT;
+  } else {
+    // The other subsystems each own a range of 16 event types
+    firstEventType = eventType & ~UINT16_C(0x000F);
+  }
+  return firstEventType;
+}
+
+/**
+ * @return true if both events were sent by the same nanoapp, or are system
+ *         events of the same subsystem.
+ */
+bool isFromSameSource(const Event *event, const Event *other) {
+  return event->senderInstanceId == other->senderInstanceId &&
+         (event->senderInstanceId != kSystemInstanceId ||
+          getSubsystemFirstEventType(event->eventType) ==
+              getSubsystemFirstEventType(other->eventType));
+}
+
 #ifndef CHRE_STATIC_EVENT_LOOP
 /**
  * @return true if a event is a low priority event.
  */
 bool isLowPriorityEvent(Event *event) {
-  CHRE_ASSERT_NOT_NULL(event);
-  return event->isLowPriority;
+  // Null events are only used to wake the event loop, and are not counted
+  // against the event pool
+  return (event != nullptr && event->isLowPriority);
+}
+
+bool isEvictableEvent(Event *event) {
+  // Events diverted from an event source lane are kept, as later events of the
+  // source are held back until run() schedules them
+  return isLowPriorityEvent(event) &&
+         event->divertedFromSource == EventLoop::kInvalidEventSourceId;
 }
 
 void deallocateFromMemoryPool(Event *event, void *memoryPool) {
@@ -97,10 +177,16 @@ void deallocateFromMemoryPool(Event *event, void *memoryPool) {
 
 }  // anonymous namespace
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+EventLoop *EventLoop::getCurrentThreadEventLoop() {
+  return gCurrentThreadEventLoop;
+}
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
 bool EventLoop::findNanoappInstanceIdByAppId(uint64_t appId,
                                              uint16_t *instanceId) const {
   CHRE_ASSERT(instanceId != nullptr);
-  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inEventLoopThread());
+  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inThisEventLoopThread());
 
   bool found = false;
   for (const UniquePtr<Nanoapp> &app : mNanoapps) {
@@ -115,7 +201,7 @@ bool EventLoop::findNanoappInstanceIdByAppId(uint64_t appId,
 }
 
 void EventLoop::forEachNanoapp(NanoappCallbackFunction *callback, void *data) {
-  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inEventLoopThread());
+  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inThisEventLoopThread());
 
   for (const UniquePtr<Nanoapp> &nanoapp : mNanoapps) {
     callback(nanoapp.get(), data);
@@ -127,6 +213,21 @@ void EventLoop::invokeMessageFreeFunction(uint64_t appId,
                                           void *message, size_t messageSize) {
   Nanoapp *nanoapp = lookupAppByAppId(appId);
   if (nanoapp == nullptr) {
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+    // The nanoapp may run on another event loop, where the callback must be
+    // invoked from
+    EventLoopManager *eventLoopManager = EventLoopManagerSingleton::get();
+    uint16_t instanceId;
+    EventLoop *eventLoop = nullptr;
+    if (eventLoopManager->findNanoappInstanceIdByAppId(appId, &instanceId)) {
+      eventLoop = eventLoopManager->findEventLoopByInstanceId(instanceId);
+    }
+    if (eventLoop != nullptr && eventLoop != this &&
+        forwardMessageFreeFunction(*eventLoop, appId, freeFunction, message,
+                                   messageSize)) {
+      return;
+    }
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
     LOGE("Couldn't find app 0x%016" PRIx64 " for message free callback", appId);
   } else {
     auto prevCurrentApp = mCurrentApp;
@@ -138,28 +239,58 @@ void EventLoop::invokeMessageFreeFunction(uint64_t appId,
 
 void EventLoop::run() {
   LOGI("EventLoop start");
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  gCurrentThreadEventLoop = this;
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
 
   while (mRunning) {
-    // Events are delivered in a single stage: they arrive in the inbound event
-    // queue mEvents (potentially posted from another thread), then within
-    // this context these events are distributed to all interested Nanoapps,
-    // with their free callback invoked after distribution.
-    mEventPoolUsage.addValue(static_cast<uint32_t>(mEvents.size()));
-
-    // mEvents.pop() will be a blocking call if mEvents.empty()
-    Event *event = mEvents.pop();
-    // Need size() + 1 since the to-be-processed event has already been removed.
-    mPowerControlManager.preEventLoopProcess(mEvents.size() + 1);
-    distributeEvent(event);
+    // Events are delivered in two stages: they arrive in the inbound event
+    // queue mEvents (potentially posted from another thread) or in the lane of
+    // a registered event source, and are moved into the scheduler, which keeps
+    // a queue per EventPriority. Then within this context the scheduler picks
+    // the most urgent events, which are distributed to all interested
+    // Nanoapps, with their free callback invoked after distribution. Events
+    // are moved and distributed in batches so the queue lock and power control
+    // hooks are only taken once for a burst of events.
+    pullInboundEvents();
+    size_t numPending = mNumScheduledEvents + mEvents.size();
+    mEventPoolUsage.addValue(static_cast<uint32_t>(numPending));
+    mPowerControlManager.preEventLoopProcess(numPending);
+
+    mBatchStartTimeMicros = Event::getTimeMicros();
+    for (size_t i = 0; i < mEventBatchSize && mRunning; i++) {
+      Event *event = popScheduledEvent();
+      if (event == nullptr) {
+        break;
+      }
+      distributeEvent(event);
+    }
 
-    mPowerControlManager.postEventLoopProcess(mEvents.size());
+    mPowerControlManager.postEventLoopProcess(mNumScheduledEvents +
+                                              mEvents.size());
   }
 
-  // Purge the main queue of events pending distribution. All nanoapps should be
-  // prevented from sending events or messages at this point via
-  // currentNanoappIsStopping() returning true.
+  // Purge the scheduler and the main queue of events pending distribution. All
+  // nanoapps should be prevented from sending events or messages at this point
+  // via currentNanoappIsStopping() returning true.
+  Event *event;
+  while ((event = popScheduledEvent()) != nullptr) {
+    freeEvent(event);
+  }
+  while (mEventBatchHead < mEventBatchCount) {
+    event = mEventBatch[mEventBatchHead++];
+    if (event != nullptr) {
+      freeEvent(event);
+    }
+  }
+  while (popEventSourceLanes(&event, 1) > 0) {
+    freeEvent(event);
+  }
   while (!mEvents.empty()) {
-    freeEvent(mEvents.pop());
+    event = mEvents.pop();
+    if (event != nullptr) {
+      freeEvent(event);
+    }
   }
 
   // Unload all running nanoapps
@@ -167,15 +298,33 @@ void EventLoop::run() {
     unloadNanoappAtIndex(mNanoapps.size() - 1);
   }
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  gCurrentThreadEventLoop = nullptr;
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
   LOGI("Exiting EventLoop");
 }
 
+void EventLoop::setEventBatchSize(size_t batchSize) {
+  if (batchSize == 0) {
+    mEventBatchSize = 1;
+  } else if (batchSize > kMaxEventBatchSize) {
+    mEventBatchSize = kMaxEventBatchSize;
+  } else {
+    mEventBatchSize = batchSize;
+  }
+}
+
 bool EventLoop::startNanoapp(UniquePtr<Nanoapp> &nanoapp) {
   CHRE_ASSERT(!nanoapp.isNull());
   bool success = false;
   auto *eventLoopManager = EventLoopManagerSingleton::get();
-  EventLoop &eventLoop = eventLoopManager->getEventLoop();
   uint16_t existingInstanceId;
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  EventLoop *affinityEventLoop =
+      nanoapp.isNull()
+          ? this
+          : &eventLoopManager->getEventLoopForAppId(nanoapp->getAppId());
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
 
   if (nanoapp.isNull()) {
     // no-op, invalid argument
@@ -185,10 +334,14 @@ bool EventLoop::startNanoapp(UniquePtr<Nanoapp> &nanoapp) {
          ", first supported ver 0x%" PRIx32 ")",
          nanoapp->getTargetApiVersion(),
          static_cast<uint32_t>(CHRE_FIRST_SUPPORTED_API_VERSION));
-  } else if (eventLoop.findNanoappInstanceIdByAppId(nanoapp->getAppId(),
-                                                    &existingInstanceId)) {
+  } else if (eventLoopManager->findNanoappInstanceIdByAppId(
+                 nanoapp->getAppId(), &existingInstanceId)) {
     LOGE("App with ID 0x%016" PRIx64 " already exists as instance ID %" PRIu16,
          nanoapp->getAppId(), existingInstanceId);
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  } else if (affinityEventLoop != this) {
+    success = startNanoappOnEventLoop(*affinityEventLoop, nanoapp);
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
   } else if (!mNanoapps.prepareForPush()) {
     LOG_OOM();
   } else {
@@ -216,6 +369,7 @@ bool EventLoop::startNanoapp(UniquePtr<Nanoapp> &nanoapp) {
       // Note that this lock protects against concurrent read and modification
       // of mNanoapps, but we are assured that no new nanoapps were added since
       // we pushed the new nanoapp
+      removeAllBroadcastSubscriptions(newNanoapp);
       LockGuard<Mutex> lock(mNanoappsLock);
       mNanoapps.pop_back();
     } else {
@@ -255,6 +409,12 @@ bool EventLoop::unloadNanoapp(uint16_t instanceId,
         // directly), but nanoapps won't get it until after the unload completes
         notifyAppStatusChange(CHRE_EVENT_NANOAPP_STOPPED, *mStoppingNanoapp);
 
+        // The nanoapp can no longer send messages, so stop tracking its share
+        // of the host message pool
+        EventLoopManagerSingleton::get()
+            ->getHostCommsManager()
+            .onNanoappUnloaded(mStoppingNanoapp->getAppId());
+
         // Finally, we are at a point where there should not be any pending
         // events or messages sent by the app that could potentially reference
         // the nanoapp's memory, so we are safe to unload it
@@ -264,10 +424,25 @@ bool EventLoop::unloadNanoapp(uint16_t instanceId,
         LOGD("Unloaded nanoapp with instanceId %" PRIu16, instanceId);
         unloaded = true;
       }
-      break;
+      return unloaded;
     }
   }
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  EventLoop *eventLoop =
+      EventLoopManagerSingleton::get()->findEventLoopByInstanceId(instanceId);
+  if (eventLoop != nullptr && eventLoop != this) {
+    auto callback = [](uint16_t /*type*/, void *data, void *extraData) {
+      EventLoopManagerSingleton::get()->getEventLoop().unloadNanoapp(
+          NestedDataPtr<uint16_t>(data), NestedDataPtr<bool>(extraData));
+    };
+    unloaded = eventLoop->postSystemEvent(
+        static_cast<uint16_t>(SystemCallbackType::UnloadNanoappOnEventLoop),
+        NestedDataPtr<uint16_t>(instanceId), callback,
+        NestedDataPtr<bool>(allowSystemNanoappUnload));
+  }
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
   return unloaded;
 }
 
@@ -280,8 +455,17 @@ bool EventLoop::removeLowPriorityEventsFromBack(size_t removeNum) {
   }
 
   size_t numRemovedEvent = mEvents.removeMatchedFromBack(
-      isLowPriorityEvent, removeNum, deallocateFromMemoryPool, &mEventPool);
-  if (numRemovedEvent == 0 || numRemovedEvent == SIZE_MAX) {
+      isEvictableEvent, removeNum, deallocateFromMemoryPool, &mEventPool);
+  if (numRemovedEvent == SIZE_MAX) {
+    numRemovedEvent = 0;
+  }
+  // The scheduler holds events that were posted before those in mEvents
+  if (numRemovedEvent < removeNum) {
+    numRemovedEvent +=
+        removeLowPriorityScheduledEvents(removeNum - numRemovedEvent);
+  }
+
+  if (numRemovedEvent == 0) {
     LOGW("Cannot remove any low priority event");
   } else {
     mNumDroppedLowPriEvents += numRemovedEvent;
@@ -290,6 +474,42 @@ bool EventLoop::removeLowPriorityEventsFromBack(size_t removeNum) {
 #endif
 }
 
+#ifndef CHRE_STATIC_EVENT_LOOP
+size_t EventLoop::removeLowPriorityScheduledEvents(size_t removeNum) {
+  LockGuard<Mutex> lock(mScheduledEventsLock);
+  size_t numRemoved = 0;
+  while (numRemoved < removeNum) {
+    // Finds the most recently scheduled low priority event across the classes
+    size_t priority = kNumEventPriorities;
+    size_t index = 0;
+    for (size_t i = 0; i < kNumEventPriorities; i++) {
+      for (size_t j = mScheduledEvents[i].size(); j > 0; j--) {
+        const ScheduledEvent &entry = mScheduledEvents[i][j - 1];
+        if (isLowPriorityEvent(entry.event)) {
+          if (priority == kNumEventPriorities ||
+              static_cast<int32_t>(
+                  entry.sequence -
+                  mScheduledEvents[priority][index].sequence) > 0) {
+            priority = i;
+            index = j - 1;
+          }
+          break;
+        }
+      }
+    }
+    if (priority == kNumEventPriorities) {
+      break;
+    }
+
+    mEventPool.deallocate(mScheduledEvents[priority][index].event);
+    mScheduledEvents[priority].remove(index);
+    mNumScheduledEvents.fetch_decrement();
+    numRemoved++;
+  }
+  return numRemoved;
+}
+#endif  // CHRE_STATIC_EVENT_LOOP
+
 bool EventLoop::hasNoSpaceForHighPriorityEvent() {
   return mEventPool.full() &&
          !removeLowPriorityEventsFromBack(targetLowPriorityEventRemove);
@@ -312,6 +532,90 @@ void EventLoop::postEventOrDie(uint16_t eventType, void *eventData,
   }
 }
 
+EventLoop::EventSourceId EventLoop::registerEventSource(const char *name) {
+  EventSourceId sourceId = kInvalidEventSourceId;
+  uint32_t numSources = mNumEventSources.load();
+  if (numSources < kMaxEventSources) {
+    mEventSourceLanes[numSources].name = name;
+    mNumEventSources = numSources + 1;
+    sourceId = static_cast<EventSourceId>(numSources);
+  } else {
+    LOGW("No event source lane left for %s", name);
+  }
+  return sourceId;
+}
+
+void EventLoop::postEventFromSource(EventSourceId sourceId, bool isLowPriority,
+                                    uint16_t eventType, void *eventData,
+                                    chreEventCompleteFunction *freeCallback,
+                                    uint16_t targetInstanceId,
+                                    uint16_t targetGroupMask) {
+  if (sourceId >= mNumEventSources.load()) {
+    if (isLowPriority) {
+      postLowPriorityEventOrFree(eventType, eventData, freeCallback,
+                                 kSystemInstanceId, targetInstanceId,
+                                 targetGroupMask);
+    } else {
+      postEventOrDie(eventType, eventData, freeCallback, targetInstanceId,
+                     targetGroupMask);
+    }
+    return;
+  }
+
+  EventSourceLane &lane = mEventSourceLanes[sourceId];
+  bool pushedToLane = false;
+  // The lane is bypassed while earlier events of this source are in mEvents,
+  // as run() drains the lanes ahead of it
+  if (lane.numDiverted.load() == 0 && !lane.producerBusy.exchange(true)) {
+    pushedToLane =
+        pushToEventSourceLane(lane, isLowPriority, eventType, eventData,
+                              freeCallback, targetInstanceId, targetGroupMask);
+    lane.producerBusy = false;
+  }
+
+  if (!pushedToLane && mRunning) {
+    lane.numOverflows.fetch_increment();
+
+    // Counted ahead of the push, as run() releases it once it takes the event
+    // out of mEvents
+    lane.numDiverted.fetch_increment();
+    bool posted = false;
+    if (isLowPriority) {
+      posted = hasSpaceForLowPriorityEvent() &&
+               allocateAndPostEvent(eventType, eventData, freeCallback,
+                                    true /*isLowPriority*/, kSystemInstanceId,
+                                    targetInstanceId, targetGroupMask,
+                                    sourceId);
+      if (!posted) {
+        ++mNumDroppedLowPriEvents;
+      }
+    } else if (hasNoSpaceForHighPriorityEvent() ||
+               !allocateAndPostEvent(eventType, eventData, freeCallback,
+                                     false /*isLowPriority*/,
+                                     kSystemInstanceId, targetInstanceId,
+                                     targetGroupMask, sourceId)) {
+      FATAL_ERROR("Failed to post critical system event 0x%" PRIx16, eventType);
+    } else {
+      posted = true;
+    }
+
+    if (!posted) {
+      lane.numDiverted.fetch_decrement();
+      if (freeCallback != nullptr) {
+        freeCallback(eventType, eventData);
+      }
+    }
+  } else if (!pushedToLane && freeCallback != nullptr) {
+    freeCallback(eventType, eventData);
+  }
+}
+
+uint32_t EventLoop::getMaxEventSourceDepth(EventSourceId sourceId) const {
+  return (sourceId < mNumEventSources.load())
+             ? mEventSourceLanes[sourceId].depth.getMax()
+             : 0;
+}
+
 bool EventLoop::postSystemEvent(uint16_t eventType, void *eventData,
                                 SystemEventCallbackFunction *callback,
                                 void *extraData) {
@@ -332,6 +636,7 @@ bool EventLoop::postSystemEvent(uint16_t eventType, void *eventData,
                 ": out of memory",
                 eventType);
   }
+  mNumEventsPosted.fetch_increment();
 
   return true;
 }
@@ -343,12 +648,7 @@ bool EventLoop::postLowPriorityEventOrFree(
   bool eventPosted = false;
 
   if (mRunning) {
-#ifdef CHRE_STATIC_EVENT_LOOP
-    if (mEventPool.getFreeBlockCount() > kMinReservedHighPriorityEventCount)
-#else
-    if (mEventPool.getFreeSpaceCount() > kMinReservedHighPriorityEventCount)
-#endif
-    {
+    if (hasSpaceForLowPriorityEvent()) {
       eventPosted = allocateAndPostEvent(
           eventType, eventData, freeCallback, true /*isLowPriority*/,
           senderInstanceId, targetInstanceId, targetGroupMask);
@@ -383,20 +683,20 @@ void EventLoop::onStopComplete() {
 }
 
 Nanoapp *EventLoop::findNanoappByInstanceId(uint16_t instanceId) const {
-  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inEventLoopThread());
+  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inThisEventLoopThread());
   return lookupAppByInstanceId(instanceId);
 }
 
 bool EventLoop::populateNanoappInfoForAppId(
     uint64_t appId, struct chreNanoappInfo *info) const {
-  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inEventLoopThread());
+  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inThisEventLoopThread());
   Nanoapp *app = lookupAppByAppId(appId);
   return populateNanoappInfo(app, info);
 }
 
 bool EventLoop::populateNanoappInfoForInstanceId(
     uint16_t instanceId, struct chreNanoappInfo *info) const {
-  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inEventLoopThread());
+  ConditionalLockGuard<Mutex> lock(mNanoappsLock, !inThisEventLoopThread());
   Nanoapp *app = lookupAppByInstanceId(instanceId);
   return populateNanoappInfo(app, info);
 }
@@ -413,6 +713,24 @@ void EventLoop::logStateToBuffer(DebugDumpWrapper &debugDump) const {
                   mNumDroppedLowPriEvents);
   debugDump.print("  Mean event pool usage: %" PRIu32 "/%zu\n",
                   mEventPoolUsage.getMean(), kMaxEventCount);
+  debugDump.print("  Number of events posted: %" PRIu32 "\n",
+                  mNumEventsPosted.load());
+  static const char *const kEventPriorityNames[kNumEventPriorities] = {
+      "system", "realtime", "normal", "background"};
+  for (size_t i = 0; i < kNumEventPriorities; i++) {
+    debugDump.print("  Events of %s priority: dispatched=%" PRIu32
+                    ", late=%" PRIu32 "\n",
+                    kEventPriorityNames[i],
+                    mEventPriorityStats[i].numDispatched,
+                    mEventPriorityStats[i].numLate);
+  }
+  for (size_t i = 0; i < mNumEventSources.load(); i++) {
+    const EventSourceLane &lane = mEventSourceLanes[i];
+    debugDump.print("  Event source %s: depth max=%" PRIu32 " mean=%" PRIu32
+                    "/%zu, overflows=%" PRIu32 "\n",
+                    lane.name, lane.depth.getMax(), lane.depth.getMean(),
+                    lane.events.capacity(), lane.numOverflows.load());
+  }
 
   Nanoseconds timeSince =
       SystemTime::getMonotonicTime() - mTimeLastWakeupBucketCycled;
@@ -424,6 +742,8 @@ void EventLoop::logStateToBuffer(DebugDumpWrapper &debugDump) const {
                   "mins ago, bucketDuration=%" PRIu64 "mins\n",
                   timeSinceMins, durationMins);
 
+  mTimerPool.logStateToBuffer(debugDump);
+
   debugDump.print("\nNanoapps:\n");
   for (const UniquePtr<Nanoapp> &app : mNanoapps) {
     app->logStateToBuffer(debugDump);
@@ -435,36 +755,137 @@ bool EventLoop::allocateAndPostEvent(uint16_t eventType, void *eventData,
                                      bool isLowPriority,
                                      uint16_t senderInstanceId,
                                      uint16_t targetInstanceId,
-                                     uint16_t targetGroupMask) {
+                                     uint16_t targetGroupMask,
+                                     EventSourceId divertedFromSource) {
   bool success = false;
 
   Event *event =
       mEventPool.allocate(eventType, eventData, freeCallback, isLowPriority,
                           senderInstanceId, targetInstanceId, targetGroupMask);
   if (event != nullptr) {
+    event->divertedFromSource = divertedFromSource;
     success = mEvents.push(event);
   }
+  if (success) {
+    mNumEventsPosted.fetch_increment();
+  }
 
   return success;
 }
 
-void EventLoop::deliverNextEvent(const UniquePtr<Nanoapp> &app, Event *event) {
+void EventLoop::addBroadcastSubscriber(uint16_t eventType, Nanoapp *nanoapp) {
+  CHRE_ASSERT(nanoapp != nullptr);
+  CHRE_ASSERT(nanoapp->getInstanceId() != kInvalidInstanceId);
+  uint16_t instanceId = nanoapp->getInstanceId();
+  size_t index = broadcastSubscriberLowerBound(eventType, instanceId);
+  if (index < mBroadcastSubscribers.size() &&
+      mBroadcastSubscribers[index].eventType == eventType &&
+      mBroadcastSubscribers[index].instanceId == instanceId) {
+    // Already subscribed
+  } else if (!mBroadcastSubscribers.insert(
+                 index, BroadcastSubscriber(eventType, nanoapp))) {
+    FATAL_ERROR_OOM();
+  }
+}
+
+void EventLoop::removeBroadcastSubscriber(uint16_t eventType,
+                                          const Nanoapp *nanoapp) {
+  CHRE_ASSERT(nanoapp != nullptr);
+  size_t index =
+      broadcastSubscriberLowerBound(eventType, nanoapp->getInstanceId());
+  if (index < mBroadcastSubscribers.size() &&
+      mBroadcastSubscribers[index].nanoapp == nanoapp &&
+      mBroadcastSubscribers[index].eventType == eventType) {
+    mBroadcastSubscribers.erase(index);
+  }
+}
+
+size_t EventLoop::broadcastSubscriberLowerBound(uint16_t eventType,
+                                                uint16_t instanceId) const {
+  size_t low = 0;
+  size_t high = mBroadcastSubscribers.size();
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    const BroadcastSubscriber &subscriber = mBroadcastSubscribers[mid];
+    if (subscriber.eventType < eventType ||
+        (subscriber.eventType == eventType &&
+         subscriber.instanceId < instanceId)) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+void EventLoop::removeAllBroadcastSubscriptions(const Nanoapp *nanoapp) {
+  size_t i = 0;
+  while (i < mBroadcastSubscribers.size()) {
+    if (mBroadcastSubscribers[i].nanoapp == nanoapp) {
+      mBroadcastSubscribers.erase(i);
+    } else {
+      ++i;
+    }
+  }
+}
+
+void EventLoop::deliverNextEvent(Nanoapp *app, Event *event) {
+  Nanoseconds dispatchTime = SystemTime::getMonotonicTime();
+
   // TODO: cleaner way to set/clear this? RAII-style?
-  mCurrentApp = app.get();
+  mCurrentApp = app;
   app->processEvent(event);
   mCurrentApp = nullptr;
+
+  Nanoseconds returnTime = SystemTime::getMonotonicTime();
+  // Wraps around like receivedTimeMicros, so the difference is still correct
+  uint32_t queueDelayMicros =
+      static_cast<uint32_t>(Microseconds(dispatchTime).getMicroseconds()) -
+      event->receivedTimeMicros;
+  app->recordEventLatency(event->eventType, queueDelayMicros,
+                          returnTime - dispatchTime);
 }
 
-void EventLoop::distributeEvent(Event *event) {
+bool EventLoop::distributeBroadcastEvent(Event *event) {
   bool eventDelivered = false;
-  for (const UniquePtr<Nanoapp> &app : mNanoapps) {
-    if ((event->targetInstanceId == chre::kBroadcastInstanceId &&
-         app->isRegisteredForBroadcastEvent(event)) ||
-        event->targetInstanceId == app->getInstanceId()) {
+
+  // A nanoapp may (un)subscribe while handling the event, which modifies
+  // mBroadcastSubscribers, so re-locate our position after each delivery by
+  // searching for the next subscriber after the last visited instance ID.
+  size_t index = broadcastSubscriberLowerBound(event->eventType,
+                                               0 /* instanceId */);
+  while (index < mBroadcastSubscribers.size() &&
+         mBroadcastSubscribers[index].eventType == event->eventType) {
+    Nanoapp *app = mBroadcastSubscribers[index].nanoapp;
+    uint16_t instanceId = mBroadcastSubscribers[index].instanceId;
+    if (app->isRegisteredForBroadcastEvent(event)) {
       eventDelivered = true;
       deliverNextEvent(app, event);
     }
+    // Instance IDs are always less than kBroadcastInstanceId, so this can't
+    // overflow
+    index = broadcastSubscriberLowerBound(event->eventType, instanceId + 1);
+  }
+
+  return eventDelivered;
+}
+
+void EventLoop::distributeEvent(Event *event) {
+  if (mEventDispatchHook != nullptr &&
+      event->senderInstanceId == kSystemInstanceId &&
+      event->eventType >= mFirstHookedEventType &&
+      event->eventType <= mLastHookedEventType) {
+    mEventDispatchHook(event->eventType, event->eventData);
+  }
+
+  bool eventDelivered = deliverEvent(event);
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  // A unicast event the other event loop fails to deliver is logged there
+  if ((event->targetInstanceId == kBroadcastInstanceId || !eventDelivered) &&
+      event->targetInstanceId != kSystemInstanceId && forwardEvent(event)) {
+    eventDelivered = true;
   }
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
   // Log if an event unicast to a nanoapp isn't delivered, as this is could be
   // a bug (e.g. something isn't properly keeping track of when nanoapps are
   // unloaded), though it could just be a harmless transient issue (e.g. race
@@ -475,13 +896,460 @@ void EventLoop::distributeEvent(Event *event) {
     LOGW("Dropping event 0x%" PRIx16 " from instanceId %" PRIu16 "->%" PRIu16,
          event->eventType, event->senderInstanceId, event->targetInstanceId);
   }
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  if (!event->isUnreferenced()) {
+    // Freed by releaseForwardedEvent()
+    return;
+  }
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
   CHRE_ASSERT(event->isUnreferenced());
   freeEvent(event);
 }
 
+bool EventLoop::deliverEvent(Event *event) {
+  bool eventDelivered = false;
+  if (event->targetInstanceId == kBroadcastInstanceId) {
+    eventDelivered = distributeBroadcastEvent(event);
+  } else if (event->targetInstanceId != kSystemInstanceId) {
+    Nanoapp *app = lookupAppByInstanceId(event->targetInstanceId);
+    if (app != nullptr) {
+      eventDelivered = true;
+      deliverNextEvent(app, event);
+    }
+  }
+  return eventDelivered;
+}
+
+bool EventLoop::inThisEventLoopThread() const {
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  return (gCurrentThreadEventLoop == this);
+#else
+  return inEventLoopThread();
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+}
+
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+bool EventLoop::forwardEvent(Event *event) {
+  auto callback = [](uint16_t /*type*/, void *data, void *extraData) {
+    EventLoopManagerSingleton::get()->getEventLoop().distributeForwardedEvent(
+        static_cast<Event *>(data), static_cast<EventLoop *>(extraData));
+  };
+
+  bool isBroadcast = (event->targetInstanceId == kBroadcastInstanceId);
+  EventLoopManager *eventLoopManager = EventLoopManagerSingleton::get();
+  for (size_t i = 0; i < eventLoopManager->getEventLoopCount(); i++) {
+    EventLoop &eventLoop = eventLoopManager->getEventLoop(i);
+    if (&eventLoop == this ||
+        (!isBroadcast &&
+         eventLoop.findNanoappByInstanceId(event->targetInstanceId) ==
+             nullptr)) {
+      continue;
+    }
+
+    if (event->isLowPriority && !eventLoop.hasSpaceForLowPriorityEvent()) {
+      ++eventLoop.mNumDroppedLowPriEvents;
+    } else {
+      event->incrementRefCount();
+      if (!eventLoop.postSystemEvent(
+              static_cast<uint16_t>(SystemCallbackType::ForwardEvent), event,
+              callback, this)) {
+        event->decrementRefCount();
+      }
+    }
+
+    if (!isBroadcast) {
+      break;
+    }
+  }
+
+  return !event->isUnreferenced();
+}
+
+void EventLoop::distributeForwardedEvent(Event *event, EventLoop *origin) {
+  if (!deliverEvent(event) && event->targetInstanceId != kBroadcastInstanceId) {
+    LOGW("Dropping forwarded event 0x%" PRIx16 " from instanceId %" PRIu16
+         "->%" PRIu16,
+         event->eventType, event->senderInstanceId, event->targetInstanceId);
+  }
+
+  auto callback = [](uint16_t /*type*/, void *data, void *extraData) {
+    static_cast<EventLoop *>(extraData)->releaseForwardedEvent(
+        static_cast<Event *>(data));
+  };
+  if (!origin->postSystemEvent(
+          static_cast<uint16_t>(SystemCallbackType::ForwardedEventComplete),
+          event, callback, origin)) {
+    LOGW("Origin of forwarded event 0x%" PRIx16 " is stopping",
+         event->eventType);
+  }
+}
+
+void EventLoop::releaseForwardedEvent(Event *event) {
+  event->decrementRefCount();
+  if (event->isUnreferenced()) {
+    freeEvent(event);
+  }
+}
+
+bool EventLoop::forwardMessageFreeFunction(
+    EventLoop &eventLoop, uint64_t appId, chreMessageFreeFunction *freeFunction,
+    void *message, size_t messageSize) {
+  auto callback = [](uint16_t /*type*/, void *data, void * /*extraData*/) {
+    auto *freeData = static_cast<MessageFreeData *>(data);
+    EventLoopManagerSingleton::get()->getEventLoop().invokeMessageFreeFunction(
+        freeData->appId, freeData->freeFunction, freeData->message,
+        freeData->messageSize);
+    memoryFree(freeData);
+  };
+
+  bool success = false;
+  auto *freeData = memoryAlloc<MessageFreeData>();
+  if (freeData == nullptr) {
+    LOG_OOM();
+  } else {
+    *freeData = {appId, freeFunction, message, messageSize};
+    success = eventLoop.postSystemEvent(
+        static_cast<uint16_t>(SystemCallbackType::ForwardMessageFreeFunction),
+        freeData, callback, nullptr /* extraData */);
+    if (!success) {
+      memoryFree(freeData);
+    }
+  }
+  return success;
+}
+
+bool EventLoop::startNanoappOnEventLoop(EventLoop &eventLoop,
+                                        UniquePtr<Nanoapp> &nanoapp) {
+  auto callback = [](uint16_t /*type*/, void *data, void * /*extraData*/) {
+    UniquePtr<Nanoapp> nanoapp(static_cast<Nanoapp *>(data));
+    uint64_t appId = nanoapp->getAppId();
+    if (!EventLoopManagerSingleton::get()->getEventLoop().startNanoapp(
+            nanoapp)) {
+      LOGE("Failed to start app ID 0x%016" PRIx64 " on its event loop", appId);
+    }
+  };
+
+  Nanoapp *app = nanoapp.release();
+  bool success = eventLoop.postSystemEvent(
+      static_cast<uint16_t>(SystemCallbackType::StartNanoappOnEventLoop), app,
+      callback, nullptr /* extraData */);
+  if (!success) {
+    nanoapp = UniquePtr<Nanoapp>(app);
+  }
+  return success;
+}
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
+size_t EventLoop::popEventSourceLanes(Event **events, size_t maxCount) {
+  size_t count = 0;
+  size_t numSources = mNumEventSources.load();
+  for (size_t i = 0; i < numSources && count < maxCount; i++) {
+    EventSourceLane &lane =
+        mEventSourceLanes[(mNextEventSourceLane + i) % numSources];
+    auto consumer = lane.events.consumer();
+    size_t depth = consumer.size();
+    if (depth > 0) {
+      lane.depth.addValue(static_cast<uint32_t>(depth));
+      count += consumer.extract(&events[count], maxCount - count);
+    }
+  }
+
+  if (numSources > 0) {
+    mNextEventSourceLane = (mNextEventSourceLane + 1) % numSources;
+  }
+  return count;
+}
+
+void EventLoop::releaseDivertedEvent(const Event *event, bool schedule) {
+  if (event->divertedFromSource < mNumEventSources.load()) {
+    // Whatever is left in the lane was posted before the event, which may have
+    // been taken out of mEvents after the lanes were last drained
+    EventSourceLane &lane = mEventSourceLanes[event->divertedFromSource];
+    Event *laneEvent;
+    while (lane.events.consumer().extract(&laneEvent, 1) > 0) {
+      if (schedule) {
+        scheduleEvent(laneEvent);
+      } else {
+        distributeEvent(laneEvent);
+      }
+    }
+    lane.numDiverted.fetch_decrement();
+  }
+}
+
+bool EventLoop::pushToEventSourceLane(EventSourceLane &lane,
+                                      bool isLowPriority, uint16_t eventType,
+                                      void *eventData,
+                                      chreEventCompleteFunction *freeCallback,
+                                      uint16_t targetInstanceId,
+                                      uint16_t targetGroupMask) {
+  // Anything that would need the slow path (shutting down, evicting low
+  // priority events, or dropping this one) is left to the shared queue.
+  auto producer = lane.events.producer();
+  if (!mRunning || producer.full() ||
+      (isLowPriority ? !hasSpaceForLowPriorityEvent() : mEventPool.full())) {
+    return false;
+  }
+
+  Event *event = mEventPool.allocate(eventType, eventData, freeCallback,
+                                     isLowPriority, kSystemInstanceId,
+                                     targetInstanceId, targetGroupMask);
+  if (event == nullptr) {
+    return false;
+  }
+
+  producer.push(event);
+  mNumEventsPosted.fetch_increment();
+  if (mWaitingForEvents.exchange(false)) {
+    // The push can only fail if mEvents is full, in which case run() is not
+    // blocked on it
+    mEvents.push(nullptr);
+  }
+  return true;
+}
+
+bool EventLoop::hasSpaceForLowPriorityEvent() {
+#ifdef CHRE_STATIC_EVENT_LOOP
+  return mEventPool.getFreeBlockCount() > kMinReservedHighPriorityEventCount;
+#else
+  return mEventPool.getFreeSpaceCount() > kMinReservedHighPriorityEventCount;
+#endif
+}
+
+void EventLoop::pullInboundEvents() {
+  size_t count;
+  size_t maxCount;
+  do {
+    maxCount = kMaxScheduledEventCount - mNumScheduledEvents;
+    if (maxCount > mEventBatchSize) {
+      maxCount = mEventBatchSize;
+    }
+    if (maxCount == 0) {
+      break;
+    }
+
+    // The lanes are drained first, and the loop only blocks on mEvents once
+    // they and the scheduler are empty.
+    count = popEventSourceLanes(mEventBatch, maxCount);
+    if (count < maxCount) {
+      // Set before the lanes are last checked, so that an event source posting
+      // after that point knows to wake the loop through mEvents.
+      mWaitingForEvents = true;
+      if (count == 0) {
+        count = popEventSourceLanes(mEventBatch, maxCount);
+      }
+      if ((count == 0 && mNumScheduledEvents == 0) || !mEvents.empty()) {
+        // mEvents.popMultiple() will be a blocking call if mEvents.empty()
+        count += mEvents.popMultiple(&mEventBatch[count], maxCount - count);
+      }
+      mWaitingForEvents = false;
+    }
+
+    mEventBatchCount = count;
+    mEventBatchHead = 0;
+    scheduleEventBatch();
+  } while (count == maxCount);
+}
+
+void EventLoop::scheduleEventBatch() {
+  while (mEventBatchHead < mEventBatchCount) {
+    Event *event = mEventBatch[mEventBatchHead++];
+    // Null events are pushed by an event source only to wake the loop
+    if (event != nullptr) {
+      releaseDivertedEvent(event, true /* schedule */);
+      scheduleEvent(event);
+    }
+  }
+}
+
+void EventLoop::scheduleEvent(Event *event) {
+  // The batch leaves room for its own events, but not for those taken out of a
+  // lane ahead of a diverted event
+  if (mNumScheduledEvents == kMaxScheduledEventCount) {
+    Event *oldest = popScheduledEvent();
+    if (oldest != nullptr) {
+      distributeEvent(oldest);
+    }
+  }
+
+  size_t priority = static_cast<size_t>(getEventPriority(event));
+  Event *eventsToFree[2] = {nullptr, nullptr};
+  {
+    LockGuard<Mutex> lock(mScheduledEventsLock);
+    if (!coalesceEvent(event, mScheduledEvents[priority], eventsToFree)) {
+      bool success = mScheduledEvents[priority].push(
+          ScheduledEvent{event, mNextScheduledEventSequence++,
+                         event->receivedTimeMicros});
+      CHRE_ASSERT(success);
+      if (success) {
+        mNumScheduledEvents.fetch_increment();
+      }
+    }
+  }
+
+  // Freed once the lock is released, as free callbacks may post events
+  for (Event *eventToFree : eventsToFree) {
+    if (eventToFree != nullptr) {
+      freeEvent(eventToFree);
+    }
+  }
+}
+
+void EventLoop::setEventCoalescer(uint16_t firstEventType,
+                                  uint16_t lastEventType,
+                                  EventCoalesceFunction *coalesceFunction,
+                                  size_t queueDepthThreshold) {
+  mFirstCoalescedEventType = firstEventType;
+  mLastCoalescedEventType = lastEventType;
+  mCoalesceFunction = coalesceFunction;
+  mCoalescingQueueDepth = queueDepthThreshold;
+}
+
+void EventLoop::setEventDispatchHook(uint16_t firstEventType,
+                                     uint16_t lastEventType,
+                                     EventDispatchHookFunction *hook) {
+  mFirstHookedEventType = firstEventType;
+  mLastHookedEventType = lastEventType;
+  mEventDispatchHook = hook;
+}
+
+bool EventLoop::coalesceEvent(Event *event, ScheduledEventQueue &queue,
+                              Event *eventsToFree[2]) {
+  if (mCoalesceFunction == nullptr ||
+      event->targetInstanceId == kSystemInstanceId ||
+      event->eventType < mFirstCoalescedEventType ||
+      event->eventType > mLastCoalescedEventType ||
+      mNumScheduledEvents + mEvents.size() < mCoalescingQueueDepth) {
+    return false;
+  }
+
+  bool coalesced = false;
+  for (size_t i = queue.size(); i > 0; i--) {
+    Event *queued = queue[i - 1].event;
+    if (queued->eventType != event->eventType ||
+        queued->senderInstanceId != event->senderInstanceId ||
+        queued->targetInstanceId != event->targetInstanceId ||
+        queued->targetAppGroupMask != event->targetAppGroupMask) {
+      continue;
+    }
+
+    chreEventCompleteFunction *freeCallback = nullptr;
+    void *data = mCoalesceFunction(event->eventType, queued->eventData,
+                                   event->eventData, &freeCallback);
+    // The entry keeps its sequence and time, so the coalesced event is
+    // dispatched no later than the one it replaces would have been
+    if (data == event->eventData) {
+      queue[i - 1].event = event;
+      eventsToFree[0] = queued;
+      coalesced = true;
+    } else if (data != nullptr) {
+      Event *combined = mEventPool.allocate(
+          event->eventType, data, freeCallback, event->isLowPriority,
+          event->senderInstanceId, event->targetInstanceId,
+          event->targetAppGroupMask);
+      if (combined == nullptr) {
+        LOG_OOM();
+        if (freeCallback != nullptr) {
+          freeCallback(event->eventType, data);
+        }
+      } else {
+        queue[i - 1].event = combined;
+        eventsToFree[0] = queued;
+        eventsToFree[1] = event;
+        coalesced = true;
+      }
+    }
+    break;
+  }
+  return coalesced;
+}
+
+Event *EventLoop::popScheduledEvent() {
+  LockGuard<Mutex> lock(mScheduledEventsLock);
+  size_t nextPriority = kNumEventPriorities;
+  uint32_t nextDeadline = 0;
+  for (size_t i = 0; i < kNumEventPriorities; i++) {
+    if (!mScheduledEvents[i].empty() && !isBehindEventOfSameSender(i)) {
+      uint32_t deadline =
+          mScheduledEvents[i].front().receivedTimeMicros +
+          kEventPriorityMaxDelayMicros[i];
+      // Compared through the difference, as the timestamps wrap around
+      if (nextPriority == kNumEventPriorities ||
+          static_cast<int32_t>(deadline - nextDeadline) < 0) {
+        nextPriority = i;
+        nextDeadline = deadline;
+      }
+    }
+  }
+
+  // The event scheduled first is never behind another one, so this is only
+  // reached with an empty scheduler
+  if (nextPriority == kNumEventPriorities) {
+    return nullptr;
+  }
+
+  Event *event = mScheduledEvents[nextPriority].front().event;
+  mScheduledEvents[nextPriority].pop();
+  mNumScheduledEvents.fetch_decrement();
+
+  EventPriorityStats &stats = mEventPriorityStats[nextPriority];
+  stats.numDispatched++;
+  if (static_cast<int32_t>(mBatchStartTimeMicros - nextDeadline) > 0) {
+    stats.numLate++;
+  }
+  return event;
+}
+
+bool EventLoop::isBehindEventOfSameSender(size_t priority) const {
+  const ScheduledEvent &front = mScheduledEvents[priority].front();
+  // Deferred callbacks are independent of each other, so the scheduler is free
+  // to change their order.
+  if (front.event->targetInstanceId == kSystemInstanceId) {
+    return false;
+  }
+
+  for (size_t i = 0; i < kNumEventPriorities; i++) {
+    if (i == priority) {
+      continue;
+    }
+    for (const ScheduledEvent &entry : mScheduledEvents[i]) {
+      // Each queue is in the order the events were scheduled in
+      if (static_cast<int32_t>(entry.sequence - front.sequence) > 0) {
+        break;
+      }
+      if (entry.event->targetInstanceId != kSystemInstanceId &&
+          isFromSameSource(entry.event, front.event)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 void EventLoop::flushInboundEventQueue() {
+  // Events in the scheduler were posted before those still inbound
+  Event *event;
+  while ((event = popScheduledEvent()) != nullptr) {
+    distributeEvent(event);
+  }
+
+  // Followed by the rest of the batch being moved into the scheduler
+  while (mEventBatchHead < mEventBatchCount) {
+    event = mEventBatch[mEventBatchHead++];
+    if (event != nullptr) {
+      releaseDivertedEvent(event, false /* schedule */);
+      distributeEvent(event);
+    }
+  }
+  while (popEventSourceLanes(&event, 1) > 0) {
+    distributeEvent(event);
+  }
   while (!mEvents.empty()) {
-    distributeEvent(mEvents.pop());
+    event = mEvents.pop();
+    if (event != nullptr) {
+      releaseDivertedEvent(event, false /* schedule */);
+      distributeEvent(event);
+    }
   }
 }
 
@@ -597,6 +1465,7 @@ void EventLoop::unloadNanoappAtIndex(size_t index) {
   mCurrentApp = nullptr;
 
   // Destroy the Nanoapp instance
+  removeAllBroadcastSubscriptions(nanoapp.get());
   mNanoapps.erase(index);
 }
 
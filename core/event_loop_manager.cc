@@ -17,6 +17,7 @@
 #include "chre/core/event_loop_manager.h"
 
 #include "chre/platform/fatal_error.h"
+#include "chre/platform/log.h"
 #include "chre/platform/memory.h"
 #include "chre/util/lock_guard.h"
 
@@ -31,6 +32,9 @@ Nanoapp *EventLoopManager::validateChreApiCall(const char *functionName) {
 }
 
 uint16_t EventLoopManager::getNextInstanceId() {
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  LockGuard<Mutex> lock(mInstanceIdMutex);
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
   ++mLastInstanceId;
 
   // ~4 billion instance IDs should be enough for anyone... if we need to
@@ -45,6 +49,77 @@ uint16_t EventLoopManager::getNextInstanceId() {
   return mLastInstanceId;
 }
 
+bool EventLoopManager::findNanoappInstanceIdByAppId(uint64_t appId,
+                                                    uint16_t *instanceId) {
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  for (size_t i = 0; i < getEventLoopCount(); i++) {
+    if (getEventLoop(i).findNanoappInstanceIdByAppId(appId, instanceId)) {
+      return true;
+    }
+  }
+  return false;
+#else
+  return mEventLoop.findNanoappInstanceIdByAppId(appId, instanceId);
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+}
+
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+size_t EventLoopManager::addEventLoop() {
+  size_t index = 0;
+  uint32_t numWorkers = mNumWorkerEventLoops.load();
+  if (numWorkers >= kMaxWorkerEventLoops) {
+    LOGE("Can't add more than %zu event loops", kMaxWorkerEventLoops);
+  } else {
+    mWorkerEventLoops[numWorkers] = MakeUnique<EventLoop>();
+    if (mWorkerEventLoops[numWorkers].isNull()) {
+      LOG_OOM();
+    } else {
+      mNumWorkerEventLoops = numWorkers + 1;
+      index = numWorkers + 1;
+    }
+  }
+  return index;
+}
+
+bool EventLoopManager::setEventLoopAffinity(uint64_t appId, size_t index) {
+  bool success = false;
+  if (index >= getEventLoopCount()) {
+    LOGE("Invalid event loop index %zu", index);
+  } else {
+    for (EventLoopAffinity &affinity : mEventLoopAffinities) {
+      if (affinity.appId == appId) {
+        affinity.index = index;
+        return true;
+      }
+    }
+    success = mEventLoopAffinities.push_back({appId, index});
+    if (!success) {
+      LOG_OOM();
+    }
+  }
+  return success;
+}
+
+EventLoop &EventLoopManager::getEventLoopForAppId(uint64_t appId) {
+  for (const EventLoopAffinity &affinity : mEventLoopAffinities) {
+    if (affinity.appId == appId) {
+      return getEventLoop(affinity.index);
+    }
+  }
+  return mEventLoop;
+}
+
+EventLoop *EventLoopManager::findEventLoopByInstanceId(uint16_t instanceId) {
+  for (size_t i = 0; i < getEventLoopCount(); i++) {
+    EventLoop &eventLoop = getEventLoop(i);
+    if (eventLoop.findNanoappByInstanceId(instanceId) != nullptr) {
+      return &eventLoop;
+    }
+  }
+  return nullptr;
+}
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
 void EventLoopManager::lateInit() {
 #ifdef CHRE_SENSORS_SUPPORT_ENABLED
   mSensorRequestManager.init();
@@ -21,7 +21,9 @@
 #include "chre/core/host_comms_manager.h"
 #include "chre/platform/assert.h"
 #include "chre/platform/host_link.h"
+#include "chre/util/lock_guard.h"
 #include "chre/util/macros.h"
+#include "chre/util/nanoapp/host_message_queue.h"
 
 namespace chre {
 
@@ -30,6 +32,7 @@ bool HostCommsManager::sendMessageToHostFromNanoapp(
     uint32_t messageType, uint16_t hostEndpoint, uint32_t messagePermissions,
     chreMessageFreeFunction *freeCallback) {
   bool success = false;
+  bool notifyNearlyFull = false;
   if (messageSize > 0 && messageData == nullptr) {
     LOGW("Rejecting malformed message (null data but non-zero size)");
   } else if (messageSize > CHRE_MESSAGE_TO_HOST_MAX_SIZE) {
@@ -41,11 +44,16 @@ bool HostCommsManager::sendMessageToHostFromNanoapp(
                                 messagePermissions)) {
     LOGE("Message perms %" PRIx32 " not subset of napp perms %" PRIx32,
          messagePermissions, nanoapp->getAppPermissions());
+  } else if (!reserveNanoappQuota(*nanoapp, &notifyNearlyFull)) {
+    LOGW("Rejecting message from app ID 0x%016" PRIx64
+         ": over quota of %zu outstanding messages",
+         nanoapp->getAppId(), kNanoappMessageQuota);
   } else {
-    MessageToHost *msgToHost = mMessagePool.allocate();
+    MessageToHost *msgToHost = allocateMessage();
 
     if (msgToHost == nullptr) {
       LOG_OOM();
+      releaseNanoappQuota(nanoapp->getAppId());
     } else {
       msgToHost->appId = nanoapp->getAppId();
       msgToHost->message.wrap(static_cast<uint8_t *>(messageData), messageSize);
@@ -64,9 +72,16 @@ bool HostCommsManager::sendMessageToHostFromNanoapp(
       bool wokeHost = !hostWasAwake && !mIsNanoappBlamedForWakeup;
       msgToHost->toHostData.wokeHost = wokeHost;
 
+      // Posted ahead of sending, as the HostLink may complete the message (and
+      // so post CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED) before returning.
+      if (notifyNearlyFull) {
+        postQueueStateEvent(CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL,
+                            nanoapp->getInstanceId());
+      }
+
       success = HostLink::sendMessage(msgToHost);
       if (!success) {
-        mMessagePool.deallocate(msgToHost);
+        releaseMessageToHost(msgToHost);
       } else if (wokeHost) {
         // If message successfully sent and host was suspended before sending
         EventLoopManagerSingleton::get()
@@ -84,7 +99,7 @@ bool HostCommsManager::sendMessageToHostFromNanoapp(
 MessageFromHost *HostCommsManager::craftNanoappMessageFromHost(
     uint64_t appId, uint16_t hostEndpoint, uint32_t messageType,
     const void *messageData, uint32_t messageSize) {
-  MessageFromHost *msgFromHost = mMessagePool.allocate();
+  MessageFromHost *msgFromHost = allocateMessage();
   if (msgFromHost == nullptr) {
     LOG_OOM();
   } else if (!msgFromHost->message.copy_array(
@@ -93,7 +108,7 @@ MessageFromHost *HostCommsManager::craftNanoappMessageFromHost(
          " bytes for message data from host "
          "(endpoint 0x%" PRIx16 " type %" PRIu32 ")",
          messageSize, hostEndpoint, messageType);
-    mMessagePool.deallocate(msgFromHost);
+    deallocateMessage(msgFromHost);
     msgFromHost = nullptr;
   } else {
     msgFromHost->appId = appId;
@@ -108,15 +123,15 @@ MessageFromHost *HostCommsManager::craftNanoappMessageFromHost(
 
 bool HostCommsManager::deliverNanoappMessageFromHost(
     MessageFromHost *craftedMessage) {
-  const EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
   uint16_t targetInstanceId;
   bool nanoappFound = false;
 
   CHRE_ASSERT_LOG(craftedMessage != nullptr,
                   "Cannot deliver NULL pointer nanoapp message from host");
 
-  if (eventLoop.findNanoappInstanceIdByAppId(craftedMessage->appId,
-                                             &targetInstanceId)) {
+  // The nanoapp may run on another event loop, which the event is forwarded to
+  if (EventLoopManagerSingleton::get()->findNanoappInstanceIdByAppId(
+          craftedMessage->appId, &targetInstanceId)) {
     nanoappFound = true;
     EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
         CHRE_EVENT_MESSAGE_FROM_HOST, &craftedMessage->fromHostData,
@@ -160,7 +175,7 @@ void HostCommsManager::sendMessageToNanoappFromHost(uint64_t appId,
       if (!EventLoopManagerSingleton::get()->deferCallback(
               SystemCallbackType::DeferredMessageToNanoappFromHost,
               craftedMessage, callback)) {
-        mMessagePool.deallocate(craftedMessage);
+        deallocateMessage(craftedMessage);
       }
     }
   }
@@ -175,7 +190,7 @@ void HostCommsManager::sendDeferredMessageToNanoappFromHost(
     LOGE("Dropping deferred message; destination app ID 0x%016" PRIx64
          " still not found",
          craftedMessage->appId);
-    mMessagePool.deallocate(craftedMessage);
+    deallocateMessage(craftedMessage);
   } else {
     LOGD("Deferred message to app ID 0x%016" PRIx64 " delivered",
          craftedMessage->appId);
@@ -195,7 +210,7 @@ void HostCommsManager::onMessageToHostComplete(const MessageToHost *message) {
   // message pool is thread-safe; otherwise, we need to do it from within the
   // EventLoop context.
   if (msgToHost->toHostData.nanoappFreeFunction == nullptr) {
-    mMessagePool.deallocate(msgToHost);
+    releaseMessageToHost(msgToHost);
   } else {
     auto freeMsgCallback = [](uint16_t /*type*/, void *data,
                               void * /*extraData*/) {
@@ -218,7 +233,7 @@ void HostCommsManager::freeMessageToHost(MessageToHost *msgToHost) {
         msgToHost->appId, msgToHost->toHostData.nanoappFreeFunction,
         msgToHost->message.data(), msgToHost->message.size());
   }
-  mMessagePool.deallocate(msgToHost);
+  releaseMessageToHost(msgToHost);
 }
 
 void HostCommsManager::freeMessageFromHostCallback(uint16_t /*type*/,
@@ -237,7 +252,166 @@ void HostCommsManager::freeMessageFromHostCallback(uint16_t /*type*/,
   auto *eventData = static_cast<chreMessageFromHostData *>(data);
   auto *msgFromHost = reinterpret_cast<MessageFromHost *>(eventData);
   auto &hostCommsMgr = EventLoopManagerSingleton::get()->getHostCommsManager();
-  hostCommsMgr.mMessagePool.deallocate(msgFromHost);
+  hostCommsMgr.deallocateMessage(msgFromHost);
+}
+
+void HostCommsManager::logStateToBuffer(DebugDumpWrapper &debugDump) {
+  LockGuard<Mutex> lock(mUsageMutex);
+  debugDump.print("\nHost messages:\n");
+  debugDump.print("  Message pool usage: %zu/%zu, max %zu\n",
+                  mNumMessagesAllocated, kMaxOutstandingMessages,
+                  mMaxMessagesAllocated);
+  debugDump.print("  Allocation failures: %" PRIu32 "\n",
+                  mNumAllocationFailures);
+  debugDump.print("  Per-nanoapp quota: %zu\n", kNanoappMessageQuota);
+  for (const NanoappMessageUsage &usage : mNanoappUsage) {
+    debugDump.print("  appId=0x%016" PRIx64 " outstanding=%" PRIu16
+                    " max=%" PRIu16 " rejected=%" PRIu32 "\n",
+                    usage.appId, usage.numOutstanding, usage.maxOutstanding,
+                    usage.numRejected);
+  }
+}
+
+HostMessage *HostCommsManager::allocateMessage() {
+  HostMessage *message = mMessagePool.allocate();
+
+  LockGuard<Mutex> lock(mUsageMutex);
+  if (message == nullptr) {
+    mNumAllocationFailures++;
+  } else {
+    mNumMessagesAllocated++;
+    if (mNumMessagesAllocated > mMaxMessagesAllocated) {
+      mMaxMessagesAllocated = mNumMessagesAllocated;
+    }
+  }
+  return message;
+}
+
+void HostCommsManager::deallocateMessage(HostMessage *message) {
+  mMessagePool.deallocate(message);
+
+  LockGuard<Mutex> lock(mUsageMutex);
+  mNumMessagesAllocated--;
+}
+
+bool HostCommsManager::reserveNanoappQuota(const Nanoapp &nanoapp,
+                                           bool *notifyNearlyFull) {
+  bool success = false;
+  *notifyNearlyFull = false;
+
+  LockGuard<Mutex> lock(mUsageMutex);
+  NanoappMessageUsage *usage = findNanoappUsage(nanoapp.getAppId());
+  if (usage == nullptr) {
+    NanoappMessageUsage newUsage = {};
+    newUsage.appId = nanoapp.getAppId();
+    if (!mNanoappUsage.push_back(newUsage)) {
+      LOG_OOM();
+    } else {
+      usage = &mNanoappUsage.back();
+    }
+  }
+
+  if (usage != nullptr) {
+    if (usage->numOutstanding >= kNanoappMessageQuota) {
+      usage->numRejected++;
+    } else {
+      success = true;
+      usage->instanceId = nanoapp.getInstanceId();
+      usage->numOutstanding++;
+      if (usage->numOutstanding > usage->maxOutstanding) {
+        usage->maxOutstanding = usage->numOutstanding;
+      }
+
+      // The message for this reservation hasn't been allocated yet.
+      if (nanoapp.isHostMessageQueueEventsEnabled() &&
+          !usage->nearlyFullNotified &&
+          (usage->numOutstanding >= kNanoappNearlyFullThreshold ||
+           mNumMessagesAllocated + 1 >= kPoolNearlyFullThreshold)) {
+        usage->nearlyFullNotified = true;
+        *notifyNearlyFull = true;
+      }
+    }
+  }
+
+  return success;
+}
+
+void HostCommsManager::releaseNanoappQuota(uint64_t appId) {
+  bool notifyDrained = false;
+  uint16_t instanceId = kInvalidInstanceId;
+  {
+    LockGuard<Mutex> lock(mUsageMutex);
+    size_t index = findNanoappUsageIndex(appId);
+    CHRE_ASSERT(index < mNanoappUsage.size() &&
+                mNanoappUsage[index].numOutstanding > 0);
+    if (index < mNanoappUsage.size() &&
+        mNanoappUsage[index].numOutstanding > 0) {
+      NanoappMessageUsage &usage = mNanoappUsage[index];
+      usage.numOutstanding--;
+      if (usage.numOutstanding == 0) {
+        if (usage.instanceId == kInvalidInstanceId) {
+          mNanoappUsage.erase(index);
+        } else if (usage.nearlyFullNotified) {
+          usage.nearlyFullNotified = false;
+          notifyDrained = true;
+          instanceId = usage.instanceId;
+        }
+      }
+    }
+  }
+
+  if (notifyDrained) {
+    postQueueStateEvent(CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED, instanceId);
+  }
+}
+
+void HostCommsManager::postQueueStateEvent(uint16_t eventType,
+                                           uint16_t instanceId) {
+  // These events are advisory, so they're dropped rather than treated as fatal
+  // when the event queue is full.
+  if (!EventLoopManagerSingleton::get()
+           ->getEventLoop()
+           .postLowPriorityEventOrFree(
+               eventType, nullptr /* eventData */, nullptr /* freeCallback */,
+               kSystemInstanceId, instanceId)) {
+    LOGW("Dropped host message queue event 0x%" PRIx16 " for instance %" PRIu16,
+         eventType, instanceId);
+  }
+}
+
+void HostCommsManager::releaseMessageToHost(MessageToHost *msgToHost) {
+  uint64_t appId = msgToHost->appId;
+  deallocateMessage(msgToHost);
+  releaseNanoappQuota(appId);
+}
+
+void HostCommsManager::onNanoappUnloaded(uint64_t appId) {
+  LockGuard<Mutex> lock(mUsageMutex);
+  size_t index = findNanoappUsageIndex(appId);
+  if (index < mNanoappUsage.size()) {
+    if (mNanoappUsage[index].numOutstanding == 0) {
+      mNanoappUsage.erase(index);
+    } else {
+      // Released by releaseNanoappQuota() with the last outstanding message;
+      // the nanoapp is gone, so it is not sent the DRAINED event.
+      mNanoappUsage[index].instanceId = kInvalidInstanceId;
+      mNanoappUsage[index].nearlyFullNotified = false;
+    }
+  }
+}
+
+HostCommsManager::NanoappMessageUsage *HostCommsManager::findNanoappUsage(
+    uint64_t appId) {
+  size_t index = findNanoappUsageIndex(appId);
+  return (index < mNanoappUsage.size()) ? &mNanoappUsage[index] : nullptr;
+}
+
+size_t HostCommsManager::findNanoappUsageIndex(uint64_t appId) const {
+  size_t index = 0;
+  while (index < mNanoappUsage.size() && mNanoappUsage[index].appId != appId) {
+    index++;
+  }
+  return index;
 }
 
 }  // namespace chre
@@ -22,6 +22,7 @@
 #include "chre/util/non_copyable.h"
 #include "chre_api/chre/event.h"
 
+#include <cstddef>
 #include <cstdint>
 
 namespace chre {
@@ -41,6 +42,24 @@ constexpr uint16_t kInvalidInstanceId = kBroadcastInstanceId;
 //! registered for it.
 constexpr uint16_t kDefaultTargetGroupMask = UINT16_MAX;
 
+//! The classes that the event loop schedules events in, from highest to lowest
+//! priority. An event waits at most a class-specific delay behind events of
+//! lower classes before it is dispatched in arrival order with them.
+//! @see EventLoop::popScheduledEvent()
+enum class EventPriority : uint8_t {
+  //! Events handled by the system itself, e.g. deferred callbacks
+  System = 0,
+  //! Sensor and audio data, which is only useful when delivered promptly
+  Realtime,
+  //! All other events posted by the system
+  Normal,
+  //! Bulk data, e.g. WiFi scan results, and events sent between nanoapps
+  Background,
+};
+
+//! The number of EventPriority values.
+constexpr size_t kNumEventPriorities = 4;
+
 class Event : public NonCopyable {
  public:
   Event() = delete;
@@ -52,7 +71,7 @@ class Event : public NonCopyable {
         uint16_t targetInstanceId_ = kBroadcastInstanceId,
         uint16_t targetAppGroupMask_ = kDefaultTargetGroupMask)
       : eventType(eventType_),
-        receivedTimeMillis(getTimeMillis()),
+        receivedTimeMicros(getTimeMicros()),
         eventData(eventData_),
         freeCallback(freeCallback_),
         senderInstanceId(senderInstanceId_),
@@ -69,7 +88,7 @@ class Event : public NonCopyable {
   Event(uint16_t eventType_, void *eventData_,
         SystemEventCallbackFunction *systemEventCallback_, void *extraData_)
       : eventType(eventType_),
-        receivedTimeMillis(getTimeMillis()),
+        receivedTimeMicros(getTimeMicros()),
         eventData(eventData_),
         systemEventCallback(systemEventCallback_),
         extraData(extraData_),
@@ -118,8 +137,9 @@ class Event : public NonCopyable {
   const uint16_t eventType;
 
   //! This value can serve as a proxy for how fast CHRE is processing events
-  //! in its queue by substracting the newest event timestamp by the oldest one.
-  const uint16_t receivedTimeMillis;
+  //! in its queue by substracting the newest event timestamp by the oldest one,
+  //! and is used to measure the queueing delay of each event.
+  const uint32_t receivedTimeMicros;
   void *const eventData;
 
   //! If targetInstanceId is kSystemInstanceId, senderInstanceId is always
@@ -147,11 +167,16 @@ class Event : public NonCopyable {
 
   const bool isLowPriority;
 
+  //! The ID of the event source whose lane this event was diverted from into
+  //! the shared inbound event queue, or UINT8_MAX if it wasn't.
+  //! @see EventLoop::postEventFromSource()
+  uint8_t divertedFromSource = UINT8_MAX;
+
+  //! @return Monotonic time reference for initializing receivedTimeMicros
+  static uint32_t getTimeMicros();
+
  private:
   uint8_t mRefCount = 0;
-
-  //! @return Monotonic time reference for initializing receivedTimeMillis
-  static uint16_t getTimeMillis();
 };
 
 }  // namespace chre
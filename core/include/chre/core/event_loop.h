@@ -25,8 +25,10 @@
 #include "chre/platform/platform_nanoapp.h"
 #include "chre/platform/power_control_manager.h"
 #include "chre/platform/system_time.h"
+#include "chre/util/array_queue.h"
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/non_copyable.h"
+#include "chre/util/system/atomic_spsc_queue.h"
 #include "chre/util/system/debug_dump.h"
 #include "chre/util/system/stats_container.h"
 #include "chre/util/unique_ptr.h"
@@ -45,9 +47,20 @@
 #define CHRE_MAX_UNSCHEDULED_EVENT_COUNT 96
 #endif
 #else
-#include "chre/util/blocking_segmented_queue.h"
 #include "chre/util/synchronized_expandable_memory_pool.h"
 
+#ifdef CHRE_LOCK_FREE_EVENT_QUEUE
+#include "chre/util/system/atomic_mpsc_queue.h"
+
+// The number of slots in the lock-free event queue, which must be a power of
+// 2. Can be overridden in the variant-specific makefile.
+#ifndef CHRE_LOCK_FREE_EVENT_QUEUE_SIZE
+#define CHRE_LOCK_FREE_EVENT_QUEUE_SIZE 256
+#endif
+#else
+#include "chre/util/blocking_segmented_queue.h"
+#endif  // CHRE_LOCK_FREE_EVENT_QUEUE
+
 // These default values can be overridden in the variant-specific makefile.
 #ifndef CHRE_EVENT_PER_BLOCK
 #define CHRE_EVENT_PER_BLOCK 24
@@ -66,6 +79,31 @@
 #endif
 #endif
 
+// The maximum number of events that the event loop drains from the inbound
+// queue at once. Can be overridden in the variant-specific makefile; setting it
+// to 1 disables batching.
+#ifndef CHRE_EVENT_LOOP_MAX_BATCH_SIZE
+#define CHRE_EVENT_LOOP_MAX_BATCH_SIZE 32
+#endif
+
+// The maximum number of event sources that can be given a dedicated lane into
+// the event loop, and the number of events that each lane can hold. Can be
+// overridden in the variant-specific makefile.
+#ifndef CHRE_MAX_EVENT_SOURCES
+#define CHRE_MAX_EVENT_SOURCES 6
+#endif
+
+#ifndef CHRE_EVENT_SOURCE_LANE_SIZE
+#define CHRE_EVENT_SOURCE_LANE_SIZE 32
+#endif
+
+// The maximum number of events that the event loop holds in its scheduler,
+// which is how far ahead of the inbound queue it looks when picking the next
+// event by priority. Can be overridden in the variant-specific makefile.
+#ifndef CHRE_MAX_SCHEDULED_EVENT_COUNT
+#define CHRE_MAX_SCHEDULED_EVENT_COUNT 32
+#endif
+
 namespace chre {
 
 /**
@@ -77,13 +115,28 @@ class EventLoop : public NonCopyable {
  public:
   EventLoop()
       :
-#ifndef CHRE_STATIC_EVENT_LOOP
+#if !defined(CHRE_STATIC_EVENT_LOOP) && !defined(CHRE_LOCK_FREE_EVENT_QUEUE)
         mEvents(kMaxUnscheduleEventBlocks),
 #endif
         mTimeLastWakeupBucketCycled(SystemTime::getMonotonicTime()),
         mRunning(true) {
   }
 
+  //! Identifies an event source registered with registerEventSource().
+  typedef uint8_t EventSourceId;
+
+  //! Returned by registerEventSource() when no lane is available. Events
+  //! posted with this ID go through the shared inbound event queue.
+  static constexpr EventSourceId kInvalidEventSourceId = UINT8_MAX;
+
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  /**
+   * @return The event loop whose run() is executing on the calling thread, or
+   *         nullptr if the calling thread is not running an event loop.
+   */
+  static EventLoop *getCurrentThreadEventLoop();
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
   /**
    * Synchronous callback used with forEachNanoapp
    */
@@ -143,6 +196,11 @@ class EventLoop : public NonCopyable {
    * the same thread that will call run() or from a callback invoked within
    * run()).
    *
+   * If the EventLoopManager assigns the nanoapp to another event loop, it is
+   * handed over to that loop to be started from its thread, and this function
+   * returns true once the hand-over is queued. A failure to start is then only
+   * logged.
+   *
    * @param nanoapp The nanoapp that will be started. Upon success, this
    *        UniquePtr will become invalid, as the underlying Nanoapp instance
    *        will have been transferred to be managed by this EventLoop.
@@ -156,6 +214,10 @@ class EventLoop : public NonCopyable {
    * After this function returns, all references to the Nanoapp instance are
    * invalidated.
    *
+   * If the nanoapp runs on another event loop of the EventLoopManager, the
+   * unload is handed over to that loop and this function returns true once the
+   * hand-over is queued.
+   *
    * @param instanceId The nanoapp's unique instance identifier
    * @param allowSystemNanoappUnload If false, this function will reject
    *        attempts to unload a system nanoapp
@@ -177,6 +239,24 @@ class EventLoop : public NonCopyable {
    */
   void stop();
 
+  /**
+   * Sets the maximum number of events that run() drains from the inbound event
+   * queue under a single lock acquisition, and distributes between one pair of
+   * PowerControlManager pre/post processing calls. Takes effect from the next
+   * batch. Must only be called from the context of this EventLoop's thread.
+   *
+   * @param batchSize The new batch size, clamped to the range
+   *        [1, CHRE_EVENT_LOOP_MAX_BATCH_SIZE]
+   */
+  void setEventBatchSize(size_t batchSize);
+
+  /**
+   * @return The maximum number of events that run() processes per batch.
+   */
+  size_t getEventBatchSize() const {
+    return mEventBatchSize;
+  }
+
   /**
    * Posts an event to a nanoapp that is currently running (or all nanoapps if
    * the target instance ID is kBroadcastInstanceId). A senderInstanceId cannot
@@ -232,6 +312,119 @@ class EventLoop : public NonCopyable {
       uint16_t targetInstanceId = kBroadcastInstanceId,
       uint16_t targetGroupMask = kDefaultTargetGroupMask);
 
+  /**
+   * Registers a source of events, such as a PAL, and gives it a dedicated
+   * single-producer lane into the event loop. Events posted through
+   * postEventFromSource() are pushed to the lane without taking a lock, and
+   * run() drains the lanes round-robin ahead of the shared inbound event
+   * queue, so a busy source does not contend with, or wait behind, other
+   * threads posting events.
+   *
+   * Sources are expected to register while CHRE is initializing. Must not be
+   * called concurrently with itself.
+   *
+   * @param name A name for the source, used in debug dumps. Must remain valid
+   *        for the lifetime of the event loop.
+   * @return The ID to pass to postEventFromSource(), or kInvalidEventSourceId
+   *         if all CHRE_MAX_EVENT_SOURCES lanes are in use.
+   */
+  EventSourceId registerEventSource(const char *name);
+
+  /**
+   * Posts a system event through the lane of the given event source, with the
+   * same semantics as postEventOrDie(), or postLowPriorityEventOrFree() if
+   * isLowPriority is true.
+   *
+   * The lane is expected to be fed from one thread at a time. If another thread
+   * is already posting for the same source, or the lane is full, the event is
+   * posted to the shared inbound event queue instead and the overflow is
+   * counted. Later events of the source also go to the shared queue until the
+   * diverted events have been taken from it, so the events of a source are
+   * delivered in the order they were posted.
+   *
+   * Safe to call from any thread.
+   *
+   * @param sourceId The ID returned by registerEventSource()
+   * @param isLowPriority true if the event can be dropped when the event pool
+   *        is running low
+   *
+   * @see postEventOrDie
+   * @see postLowPriorityEventOrFree
+   */
+  void postEventFromSource(EventSourceId sourceId, bool isLowPriority,
+                           uint16_t eventType, void *eventData,
+                           chreEventCompleteFunction *freeCallback,
+                           uint16_t targetInstanceId = kBroadcastInstanceId,
+                           uint16_t targetGroupMask = kDefaultTargetGroupMask);
+
+  /**
+   * @return The largest number of events that run() found waiting in the lane
+   *         of the given event source, or 0 if the ID is not registered.
+   */
+  uint32_t getMaxEventSourceDepth(EventSourceId sourceId) const;
+
+  /**
+   * Combines a scheduled event with a newer event of the same type, sender and
+   * target. Invoked from the context of this EventLoop.
+   *
+   * @param eventType The type of both events.
+   * @param olderData The data of the scheduled event.
+   * @param newerData The data of the newer event.
+   * @param freeCallback Set to the callback that frees the returned data when
+   *        it is newly allocated.
+   * @return newerData if it supersedes olderData, newly allocated data that
+   *         holds the contents of both events, or nullptr if both events must
+   *         be delivered.
+   */
+  typedef void *(EventCoalesceFunction)(
+      uint16_t eventType, void *olderData, void *newerData,
+      chreEventCompleteFunction **freeCallback);
+
+  /**
+   * Lets events with a type in [firstEventType, lastEventType] be coalesced
+   * while the event loop is backed up. Once at least queueDepthThreshold events
+   * are pending distribution, an incoming event in the range is offered to
+   * coalesceFunction along with the latest scheduled event of the same type,
+   * sender and target, and the result takes the place and deadline of the
+   * scheduled event.
+   * Replaces any previously set coalescer. Must be called from the context of
+   * this EventLoop, or before it runs.
+   *
+   * @param firstEventType The first event type to coalesce.
+   * @param lastEventType The last event type to coalesce.
+   * @param coalesceFunction The function that combines two events, or nullptr
+   *        to disable coalescing.
+   * @param queueDepthThreshold The number of pending events from which events
+   *        are coalesced.
+   */
+  void setEventCoalescer(uint16_t firstEventType, uint16_t lastEventType,
+                         EventCoalesceFunction *coalesceFunction,
+                         size_t queueDepthThreshold);
+
+  /**
+   * Inspects an event just before it is distributed to nanoapps. Invoked from
+   * the context of this EventLoop.
+   *
+   * @param eventType The type of the event.
+   * @param eventData The data of the event, which remains owned by the event.
+   */
+  typedef void(EventDispatchHookFunction)(uint16_t eventType, void *eventData);
+
+  /**
+   * Lets the system observe events it posted with a type in
+   * [firstEventType, lastEventType] as they are distributed, so bookkeeping
+   * that must run in order with delivery doesn't need a deferred callback of
+   * its own. Replaces any previously set hook. Must be called from the context
+   * of this EventLoop, or before it runs.
+   *
+   * @param firstEventType The first event type to observe.
+   * @param lastEventType The last event type to observe.
+   * @param hook The function invoked before each event in the range is
+   *        distributed, or nullptr to remove the hook.
+   */
+  void setEventDispatchHook(uint16_t firstEventType, uint16_t lastEventType,
+                            EventDispatchHookFunction *hook);
+
   /**
    * Posts an event for processing by the system from within the context of the
    * CHRE thread. Uses the same underlying event queue as is used for nanoapp
@@ -351,6 +544,44 @@ class EventLoop : public NonCopyable {
     return mNumDroppedLowPriEvents;
   }
 
+  /**
+   * @return the number of events posted to this EventLoop since it started.
+   */
+  inline uint32_t getNumEventsPosted() const {
+    return mNumEventsPosted.load();
+  }
+
+  /**
+   * Adds a nanoapp to the index of subscribers for the given broadcast event
+   * type, so that distributeEvent() will consider it when an event of that
+   * type is broadcast. The nanoapp's own registration (e.g. group ID mask)
+   * still determines whether it ultimately receives the event. Adding a
+   * nanoapp that is already subscribed to the event type has no effect.
+   *
+   * Must only be called from the context of this EventLoop's thread.
+   *
+   * @param eventType The broadcast event type the nanoapp is subscribing to
+   * @param nanoapp The subscribing nanoapp, which must already have been
+   *        assigned an instance ID
+   *
+   * @see Nanoapp::registerForBroadcastEvent
+   */
+  void addBroadcastSubscriber(uint16_t eventType, Nanoapp *nanoapp);
+
+  /**
+   * Removes a nanoapp from the index of subscribers for the given broadcast
+   * event type. Removing a nanoapp that is not subscribed has no effect.
+   *
+   * Must only be called from the context of this EventLoop's thread.
+   *
+   * @param eventType The broadcast event type the nanoapp is unsubscribing
+   *        from
+   * @param nanoapp The unsubscribing nanoapp
+   *
+   * @see Nanoapp::unregisterForBroadcastEvent
+   */
+  void removeBroadcastSubscriber(uint16_t eventType, const Nanoapp *nanoapp);
+
  private:
 #ifdef CHRE_STATIC_EVENT_LOOP
   //! The maximum number of events that can be active in the system.
@@ -399,9 +630,21 @@ class EventLoop : public NonCopyable {
   SynchronizedExpandableMemoryPool<Event, kEventPerBlock, kMaxEventBlock>
       mEventPool;
 
+#ifdef CHRE_LOCK_FREE_EVENT_QUEUE
+  static_assert(CHRE_LOCK_FREE_EVENT_QUEUE_SIZE >= kMaxEventCount,
+                "The lock-free event queue must fit every event in the pool");
+
+  //! The queue of incoming events from the system that have not been
+  //! distributed out to apps yet, which can be posted to from any thread
+  //! without taking a lock. Low priority events removed to make room in the
+  //! event pool keep their slot until run() reaches them, so the default size
+  //! leaves headroom above kMaxEventCount.
+  AtomicMpscQueue<Event *, CHRE_LOCK_FREE_EVENT_QUEUE_SIZE> mEvents;
+#else
   //! The blocking queue of incoming events from the system that have not been
   //! distributed out to apps yet.
   BlockingSegmentedQueue<Event *, kMaxUnscheduledEventPerBlock> mEvents;
+#endif  // CHRE_LOCK_FREE_EVENT_QUEUE
 #endif
   //! The time interval of nanoapp wakeup buckets, adjust in conjuction with
   //! Nanoapp::kMaxSizeWakeupBuckets.
@@ -441,9 +684,271 @@ class EventLoop : public NonCopyable {
   //! The stats collection used to collect event pool usage
   StatsContainer<uint32_t> mEventPoolUsage;
 
+  //! The maximum number of events that can be processed as a batch in run().
+  static constexpr size_t kMaxEventBatchSize = CHRE_EVENT_LOOP_MAX_BATCH_SIZE;
+  static_assert(kMaxEventBatchSize > 0, "Event batch size must be non-zero");
+
+  //! The number of events run() currently drains from mEvents per batch.
+  size_t mEventBatchSize = kMaxEventBatchSize;
+
+  //! Storage for the batch of events being moved into the scheduler by run().
+  //! Kept as a member rather than on the stack to keep the event loop thread's
+  //! stack usage independent of the batch size.
+  Event *mEventBatch[kMaxEventBatchSize];
+
+  //! The number of events in mEventBatch, and the index of the first one that
+  //! is yet to be scheduled.
+  size_t mEventBatchCount = 0;
+  size_t mEventBatchHead = 0;
+
+  //! The maximum number of events held in mScheduledEvents.
+  static constexpr size_t kMaxScheduledEventCount =
+      CHRE_MAX_SCHEDULED_EVENT_COUNT;
+  static_assert(kMaxScheduledEventCount > 0,
+                "Event scheduler capacity must be non-zero");
+
+  //! An event in the scheduler, along with the order it was scheduled in and
+  //! the time its deadline is computed from.
+  struct ScheduledEvent {
+    Event *event;
+    uint32_t sequence;
+    //! The receivedTimeMicros of the oldest event coalesced into this entry,
+    //! from which its deadline is computed.
+    uint32_t receivedTimeMicros;
+  };
+
+  typedef ArrayQueue<ScheduledEvent, kMaxScheduledEventCount>
+      ScheduledEventQueue;
+
+  //! Events taken out of the inbound queues that are yet to be distributed,
+  //! in arrival order for each EventPriority. Changed from the context of this
+  //! EventLoop, and by removeLowPriorityEventsFromBack() from any thread.
+  ScheduledEventQueue mScheduledEvents[kNumEventPriorities];
+
+  //! Must be held to access mScheduledEvents, and must not be held while
+  //! calling out of the event loop, e.g. to free events.
+  Mutex mScheduledEventsLock;
+
+  //! The total number of events in mScheduledEvents, only changed with
+  //! mScheduledEventsLock held.
+  AtomicUint32 mNumScheduledEvents{0};
+
+  //! The sequence number of the next event added to mScheduledEvents.
+  uint32_t mNextScheduledEventSequence = 0;
+
+  //! The time, in the timebase of Event::receivedTimeMicros, at which run()
+  //! started distributing the current batch of events.
+  uint32_t mBatchStartTimeMicros = 0;
+
+  //! Dispatch statistics for one EventPriority.
+  struct EventPriorityStats {
+    //! The number of events distributed.
+    uint32_t numDispatched = 0;
+
+    //! The number of events distributed after their deadline had passed.
+    uint32_t numLate = 0;
+  };
+
+  EventPriorityStats mEventPriorityStats[kNumEventPriorities];
+
+  //! The range of event types given to setEventCoalescer().
+  uint16_t mFirstCoalescedEventType = 0;
+  uint16_t mLastCoalescedEventType = 0;
+
+  //! The function given to setEventCoalescer(), or nullptr if events are not
+  //! coalesced.
+  EventCoalesceFunction *mCoalesceFunction = nullptr;
+
+  //! The number of pending events from which events are coalesced.
+  size_t mCoalescingQueueDepth = 0;
+
+  //! The range of event types given to setEventDispatchHook().
+  uint16_t mFirstHookedEventType = 0;
+  uint16_t mLastHookedEventType = 0;
+
+  //! The function given to setEventDispatchHook(), or nullptr if not set.
+  EventDispatchHookFunction *mEventDispatchHook = nullptr;
+
+  //! The number of events posted, from any thread.
+  AtomicUint32 mNumEventsPosted{0};
+
   //! The number of events dropped due to capacity limits
   uint32_t mNumDroppedLowPriEvents = 0;
 
+  static constexpr size_t kMaxEventSources = CHRE_MAX_EVENT_SOURCES;
+  static_assert(kMaxEventSources < kInvalidEventSourceId,
+                "Too many event sources for EventSourceId");
+
+  //! A dedicated lane from an event source into the event loop.
+  struct EventSourceLane {
+    //! The name given to registerEventSource().
+    const char *name = nullptr;
+
+    //! Events posted by the source that run() has yet to distribute.
+    AtomicSpscQueue<Event *, CHRE_EVENT_SOURCE_LANE_SIZE> events;
+
+    //! Set while a thread is pushing to events, so that another thread posting
+    //! for the same source at the same time does not break the single
+    //! producer contract of the queue.
+    AtomicBool producerBusy{false};
+
+    //! The number of events posted to mEvents instead of this lane.
+    AtomicUint32 numOverflows{0};
+
+    //! The number of events of this source posted to mEvents that run() has
+    //! yet to schedule. The lane is bypassed while non-zero, and run() empties
+    //! the lane ahead of each of these events, so that no event overtakes one
+    //! posted before it.
+    AtomicUint32 numDiverted{0};
+
+    //! The number of events in the lane each time run() drains it.
+    StatsContainer<uint32_t> depth;
+  };
+
+  //! The lanes of the registered event sources.
+  EventSourceLane mEventSourceLanes[kMaxEventSources];
+
+  //! The number of entries in mEventSourceLanes that are registered.
+  AtomicUint32 mNumEventSources{0};
+
+  //! The lane that run() drains first on its next iteration.
+  size_t mNextEventSourceLane = 0;
+
+  //! Set while run() may block on mEvents. An event source that posts to its
+  //! lane while this is set clears it and pushes a null event into mEvents to
+  //! wake the event loop.
+  AtomicBool mWaitingForEvents{false};
+
+  //! An entry in the index of nanoapps subscribed to broadcast events.
+  struct BroadcastSubscriber {
+    BroadcastSubscriber(uint16_t eventType_, Nanoapp *nanoapp_)
+        : eventType(eventType_),
+          instanceId(nanoapp_->getInstanceId()),
+          nanoapp(nanoapp_) {}
+
+    uint16_t eventType;
+    uint16_t instanceId;
+    Nanoapp *nanoapp;
+  };
+
+  //! Index of broadcast event type to the nanoapps subscribed to it, sorted by
+  //! event type and then instance ID. Since instance IDs are assigned in
+  //! increasing order, this preserves the delivery order of mNanoapps while
+  //! letting distributeEvent() skip over nanoapps that are not subscribed to a
+  //! broadcast event. Only accessed from the context of this EventLoop.
+  DynamicVector<BroadcastSubscriber> mBroadcastSubscribers;
+
+  /**
+   * Delivers an event to the nanoapps of this event loop that it targets.
+   *
+   * @return true if the event was delivered to at least one nanoapp.
+   */
+  bool deliverEvent(Event *event);
+
+  /**
+   * @return true if called from the thread that runs this event loop.
+   */
+  bool inThisEventLoopThread() const;
+
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  /**
+   * Forwards an event being distributed by this event loop to the other event
+   * loops of the EventLoopManager: all of them if it is broadcast, or the one
+   * running its target nanoapp otherwise. Each forwarded delivery holds a
+   * reference to the event until the other loop hands it back through
+   * releaseForwardedEvent(), so that the event is still freed, and its free
+   * callback invoked, from this loop.
+   *
+   * @return true if the event was forwarded to at least one event loop.
+   */
+  bool forwardEvent(Event *event);
+
+  /**
+   * Delivers an event forwarded by another event loop to the nanoapps of this
+   * event loop, then hands it back to its origin. Must only be called from the
+   * context of this EventLoop's thread.
+   *
+   * @param event The event, owned by the origin event loop
+   * @param origin The event loop that forwarded the event
+   */
+  void distributeForwardedEvent(Event *event, EventLoop *origin);
+
+  /**
+   * Releases the reference to an event taken by forwardEvent(), freeing the
+   * event once every event loop it was forwarded to is done with it. Must only
+   * be called from the context of this EventLoop's thread.
+   */
+  void releaseForwardedEvent(Event *event);
+
+  //! The arguments of invokeMessageFreeFunction(), for it to be invoked on
+  //! another event loop.
+  struct MessageFreeData {
+    uint64_t appId;
+    chreMessageFreeFunction *freeFunction;
+    void *message;
+    size_t messageSize;
+  };
+
+  /**
+   * Hands a message free callback over to the event loop running the nanoapp
+   * that sent the message, which invokes it from its own thread.
+   *
+   * @return true if the hand-over was queued.
+   */
+  bool forwardMessageFreeFunction(EventLoop &eventLoop, uint64_t appId,
+                                  chreMessageFreeFunction *freeFunction,
+                                  void *message, size_t messageSize);
+
+  /**
+   * Hands a nanoapp over to another event loop, which starts it from its own
+   * thread.
+   *
+   * @return true if the hand-over was queued, in which case nanoapp becomes
+   *         invalid.
+   */
+  bool startNanoappOnEventLoop(EventLoop &eventLoop,
+                               UniquePtr<Nanoapp> &nanoapp);
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
+  /**
+   * Moves up to maxCount events out of the event source lanes, starting from a
+   * different lane on each call so that every source gets a fair share of the
+   * batch. Must only be called from the context of this EventLoop's thread.
+   *
+   * @return The number of events moved into events.
+   */
+  size_t popEventSourceLanes(Event **events, size_t maxCount);
+
+  /**
+   * Pushes an event into the lane of an event source if the lane has room and
+   * the event pool can spare an event of the given priority.
+   *
+   * @return true if the event was pushed to the lane.
+   */
+  /**
+   * Must be called for each event taken out of mEvents before it is scheduled
+   * or distributed. If the event was diverted from the lane of an event
+   * source, the events still in the lane are taken out ahead of it, and the
+   * source can use its lane again.
+   *
+   * @param event An event taken out of mEvents.
+   * @param schedule true to schedule the events taken out of the lane, false
+   *        to distribute them right away.
+   */
+  void releaseDivertedEvent(const Event *event, bool schedule);
+
+  bool pushToEventSourceLane(EventSourceLane &lane, bool isLowPriority,
+                             uint16_t eventType, void *eventData,
+                             chreEventCompleteFunction *freeCallback,
+                             uint16_t targetInstanceId,
+                             uint16_t targetGroupMask);
+
+  /**
+   * @return true if the event pool has more free events than are reserved for
+   *         high priority events.
+   */
+  bool hasSpaceForLowPriorityEvent();
+
   /**
    * Modifies the run loop state so it no longer iterates on new events. This
    * should only be invoked by the event loop when it is ready to stop
@@ -458,11 +963,12 @@ class EventLoop : public NonCopyable {
    *
    * @see postEventOrDie and postLowPriorityEventOrFree
    */
-  bool allocateAndPostEvent(uint16_t eventType, void *eventData,
-                            chreEventCompleteFunction *freeCallback,
-                            bool isLowPriority, uint16_t senderInstanceId,
-                            uint16_t targetInstanceId,
-                            uint16_t targetGroupMask);
+  bool allocateAndPostEvent(
+      uint16_t eventType, void *eventData,
+      chreEventCompleteFunction *freeCallback, bool isLowPriority,
+      uint16_t senderInstanceId, uint16_t targetInstanceId,
+      uint16_t targetGroupMask,
+      EventSourceId divertedFromSource = kInvalidEventSourceId);
   /**
    * Remove some low priority events from back of the queue.
    *
@@ -471,6 +977,16 @@ class EventLoop : public NonCopyable {
    */
   bool removeLowPriorityEventsFromBack(size_t removeNum);
 
+#ifndef CHRE_STATIC_EVENT_LOOP
+  /**
+   * Removes up to removeNum low priority events from the scheduler, most
+   * recently scheduled first.
+   *
+   * @return The number of events removed.
+   */
+  size_t removeLowPriorityScheduledEvents(size_t removeNum);
+#endif  // CHRE_STATIC_EVENT_LOOP
+
   /**
    * Determine if there are space for high priority event.
    * During the processing of determining the vacant space, it might
@@ -483,7 +999,33 @@ class EventLoop : public NonCopyable {
   /**
    * Delivers the next event pending to the Nanoapp.
    */
-  void deliverNextEvent(const UniquePtr<Nanoapp> &app, Event *event);
+  void deliverNextEvent(Nanoapp *app, Event *event);
+
+  /**
+   * Delivers a broadcast event to all subscribed nanoapps that are registered
+   * for it. Tolerates nanoapps subscribing or unsubscribing while the event is
+   * being delivered.
+   *
+   * @param event The broadcast Event to deliver
+   * @return true if the event was delivered to at least one nanoapp
+   */
+  bool distributeBroadcastEvent(Event *event);
+
+  /**
+   * @return The index of the first entry in mBroadcastSubscribers that is not
+   *         ordered before the given event type and instance ID, or
+   *         mBroadcastSubscribers.size() if there is none
+   */
+  size_t broadcastSubscriberLowerBound(uint16_t eventType,
+                                       uint16_t instanceId) const;
+
+  /**
+   * Removes all entries for the given nanoapp from the broadcast subscriber
+   * index. Must be called before the nanoapp is removed from mNanoapps.
+   *
+   * @param nanoapp The nanoapp to remove
+   */
+  void removeAllBroadcastSubscriptions(const Nanoapp *nanoapp);
 
   /**
    * Given an event pulled from the main incoming event queue (mEvents), deliver
@@ -494,6 +1036,62 @@ class EventLoop : public NonCopyable {
    */
   void distributeEvent(Event *event);
 
+  /**
+   * Moves as many events from the event source lanes and mEvents into the
+   * scheduler as it has room for, in batches of up to kMaxEventBatchSize.
+   * Blocks until an event is posted if there are no events to distribute.
+   */
+  void pullInboundEvents();
+
+  /**
+   * Moves the events left in mEventBatch into the scheduler, one at a time so
+   * that the remaining ones stay visible to flushInboundEventQueue().
+   */
+  void scheduleEventBatch();
+
+  /**
+   * Adds an event to the scheduler queue of its priority class. If the
+   * scheduler is full, the next event is distributed first to make room.
+   */
+  void scheduleEvent(Event *event);
+
+  /**
+   * Coalesces an incoming event with the latest scheduled event of the same
+   * type, sender and target if setEventCoalescer() allows it, in which case
+   * the incoming event is consumed.
+   *
+   * Must be called with mScheduledEventsLock held.
+   *
+   * @param event The incoming event.
+   * @param queue The scheduler queue of the event's priority class.
+   * @param eventsToFree Set to the events replaced by coalescing, which the
+   *        caller must free once mScheduledEventsLock is released.
+   * @return true if the event was coalesced, and must not be scheduled.
+   */
+  bool coalesceEvent(Event *event, ScheduledEventQueue &queue,
+                     Event *eventsToFree[2]);
+
+  /**
+   * Removes the next event to distribute from the scheduler. Events are picked
+   * by earliest deadline, where the deadline of an event is the time it was
+   * posted plus the maximum delay of its priority class, so higher classes are
+   * dispatched first but a lower class event that has waited past its deadline
+   * can't be starved by a stream of newer higher class events. An event is
+   * never picked ahead of an earlier one from the same source: the same
+   * nanoapp, or for system events the same subsystem, so that e.g. a WiFi
+   * async result doesn't overtake the scan results posted before it.
+   *
+   * @return The next event, or nullptr if the scheduler is empty.
+   */
+  Event *popScheduledEvent();
+
+  /**
+   * @return true if the event at the front of the scheduler queue of the given
+   *         class comes from a nanoapp or subsystem that has an earlier event
+   *         in another class. Must be called with mScheduledEventsLock held.
+   */
+  bool isBehindEventOfSameSender(size_t priority) const;
+
   /**
    * Distribute all events pending in the inbound event queue. Note that this
    * function only guarantees that any events in the inbound queue at the time
@@ -70,6 +70,11 @@ enum class SystemCallbackType : uint16_t {
   BleRequestResyncEvent,
   RequestTimeoutEvent,
   BleReadRssiEvent,
+  ForwardEvent,
+  ForwardedEventComplete,
+  ForwardMessageFreeFunction,
+  StartNanoappOnEventLoop,
+  UnloadNanoappOnEventLoop,
 };
 
 //! Deferred/delayed callbacks use the event subsystem but are invariably sent
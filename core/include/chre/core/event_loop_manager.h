@@ -63,6 +63,17 @@
 
 #include <cstddef>
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+#include "chre/platform/atomic.h"
+#include "chre/util/dynamic_vector.h"
+
+// The maximum number of event loops that can be added alongside the main one.
+// Can be overridden in the variant-specific makefile.
+#ifndef CHRE_MAX_WORKER_EVENT_LOOPS
+#define CHRE_MAX_WORKER_EVENT_LOOPS 4
+#endif
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
 namespace chre {
 
 template <typename T>
@@ -243,12 +254,93 @@ class EventLoopManager : public NonCopyable {
 #endif  // CHRE_BLE_SUPPORT_ENABLED
 
   /**
-   * @return The event loop managed by this event loop manager.
+   * @return The event loop running on the calling thread, or the main event
+   *         loop if the calling thread is not running an event loop.
    */
   EventLoop &getEventLoop() {
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+    EventLoop *eventLoop = EventLoop::getCurrentThreadEventLoop();
+    return (eventLoop != nullptr) ? *eventLoop : mEventLoop;
+#else
     return mEventLoop;
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
   }
 
+  /**
+   * Searches the nanoapps of every event loop for one with the given app ID.
+   * Safe to call from any thread.
+   *
+   * @see EventLoop::findNanoappInstanceIdByAppId
+   */
+  bool findNanoappInstanceIdByAppId(uint64_t appId, uint16_t *instanceId);
+
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  /**
+   * Adds an event loop alongside the main one, so that nanoapps assigned to it
+   * with setEventLoopAffinity() run on a separate thread. The caller is
+   * responsible for calling run() on the new event loop from a dedicated
+   * thread, and stop() once CHRE is shutting down.
+   *
+   * Nanoapps still run on exactly one thread each. Events are forwarded between
+   * event loops as needed: broadcast events are delivered on every event loop,
+   * and events unicast to a nanoapp are delivered on the loop it runs on. Free
+   * callbacks are always invoked from the event loop the event was posted to.
+   * As the core system components are only safe to use from the main event
+   * loop, nanoapps assigned to another event loop must restrict themselves to
+   * the event, timer, messaging and logging APIs.
+   *
+   * Must be called before any nanoapp is assigned to the new event loop, and
+   * not concurrently with itself.
+   *
+   * @return The index of the new event loop, to be used with
+   *         setEventLoopAffinity() and getEventLoop(size_t), or 0 if no more
+   *         event loops can be added.
+   */
+  size_t addEventLoop();
+
+  /**
+   * @return The number of event loops, including the main one.
+   */
+  size_t getEventLoopCount() const {
+    return 1 + mNumWorkerEventLoops.load();
+  }
+
+  /**
+   * @param index The index of the event loop, where 0 is the main event loop.
+   *        Must be less than getEventLoopCount().
+   * @return The event loop at the given index.
+   */
+  EventLoop &getEventLoop(size_t index) {
+    return (index == 0) ? mEventLoop : *mWorkerEventLoops[index - 1];
+  }
+
+  /**
+   * Assigns the nanoapp with the given app ID to an event loop, so that it is
+   * started on that loop the next time it is loaded. Nanoapps that are not
+   * assigned run on the main event loop. Must not be called concurrently with
+   * the loading of a nanoapp.
+   *
+   * @param appId The app ID of the nanoapp
+   * @param index The index of the event loop, as returned by addEventLoop()
+   * @return true if the assignment was recorded.
+   */
+  bool setEventLoopAffinity(uint64_t appId, size_t index);
+
+  /**
+   * @return The event loop that the nanoapp with the given app ID is assigned
+   *         to by setEventLoopAffinity(), or the main event loop.
+   */
+  EventLoop &getEventLoopForAppId(uint64_t appId);
+
+  /**
+   * Searches every event loop for the one running the nanoapp with the given
+   * instance ID. Safe to call from any thread.
+   *
+   * @return The event loop running the nanoapp, or nullptr if not found.
+   */
+  EventLoop *findEventLoopByInstanceId(uint16_t instanceId);
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
   /**
    * @return A reference to the GNSS request manager. This allows interacting
@@ -367,6 +459,28 @@ class EventLoopManager : public NonCopyable {
   //! The event loop managed by this event loop manager.
   EventLoop mEventLoop;
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+  static constexpr size_t kMaxWorkerEventLoops = CHRE_MAX_WORKER_EVENT_LOOPS;
+
+  //! Event loops added by addEventLoop(), which only become visible to other
+  //! threads once mNumWorkerEventLoops is incremented.
+  UniquePtr<EventLoop> mWorkerEventLoops[kMaxWorkerEventLoops];
+  AtomicUint32 mNumWorkerEventLoops{0};
+
+  //! An event loop assignment made by setEventLoopAffinity().
+  struct EventLoopAffinity {
+    uint64_t appId;
+    size_t index;
+  };
+
+  //! The event loop assignments of nanoapps that do not run on the main event
+  //! loop.
+  DynamicVector<EventLoopAffinity> mEventLoopAffinities;
+
+  //! Serializes getNextInstanceId(), which is called from every event loop.
+  Mutex mInstanceIdMutex;
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
 #ifdef CHRE_GNSS_SUPPORT_ENABLED
   //! The GnssManager that handles requests for all nanoapps. This manages the
   //! state of the GNSS subsystem that the runtime subscribes to.
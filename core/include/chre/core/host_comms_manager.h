@@ -22,11 +22,35 @@
 #include "chre/core/event_loop.h"
 #include "chre/platform/atomic.h"
 #include "chre/platform/host_link.h"
+#include "chre/platform/mutex.h"
 #include "chre/util/buffer.h"
+#include "chre/util/dynamic_vector.h"
 #include "chre/util/non_copyable.h"
-#include "chre/util/synchronized_memory_pool.h"
+#include "chre/util/system/debug_dump.h"
 #include "chre_api/chre/event.h"
 
+#ifdef CHRE_STATIC_EVENT_LOOP
+#include "chre/util/synchronized_memory_pool.h"
+
+// This default value can be overridden in the variant-specific makefile.
+#ifndef CHRE_MAX_OUTSTANDING_HOST_MESSAGES
+#define CHRE_MAX_OUTSTANDING_HOST_MESSAGES 32
+#endif
+
+#else
+#include "chre/util/synchronized_expandable_memory_pool.h"
+
+// These default values can be overridden in the variant-specific makefile.
+#ifndef CHRE_HOST_MESSAGE_PER_BLOCK
+#define CHRE_HOST_MESSAGE_PER_BLOCK 32
+#endif
+
+#ifndef CHRE_MAX_HOST_MESSAGE_BLOCKS
+#define CHRE_MAX_HOST_MESSAGE_BLOCKS 4
+#endif
+
+#endif  // CHRE_STATIC_EVENT_LOOP
+
 namespace chre {
 
 //! Only valid for messages from host to CHRE - indicates that the sender of the
@@ -178,9 +202,91 @@ class HostCommsManager : public HostLink {
    */
   void onMessageToHostComplete(const MessageToHost *msgToHost);
 
+  /**
+   * Stops tracking the share of the message pool used by a nanoapp that is
+   * being unloaded. If some of its messages are still outstanding, the usage
+   * entry is removed once the last of them is released.
+   *
+   * @param appId The app ID of the nanoapp being unloaded.
+   */
+  void onNanoappUnloaded(uint64_t appId);
+
+  /**
+   * Prints state in a string buffer. Must only be called from the context of
+   * the main CHRE thread.
+   *
+   * @param debugDump The debug dump wrapper where a string can be printed
+   *     into one of the buffers.
+   */
+  void logStateToBuffer(DebugDumpWrapper &debugDump);
+
  private:
+  /**
+   * Usage of the message pool by a single nanoapp's messages to the host.
+   */
+  struct NanoappMessageUsage {
+    //! App ID of the nanoapp.
+    uint64_t appId;
+
+    //! Instance ID the nanoapp had when it last sent a message, used to
+    //! deliver queue state notifications. kInvalidInstanceId once the nanoapp
+    //! has been unloaded, in which case the entry is removed when
+    //! numOutstanding drops to 0.
+    uint16_t instanceId;
+
+    //! The number of messages currently outstanding.
+    uint16_t numOutstanding;
+
+    //! The largest value numOutstanding has reached.
+    uint16_t maxOutstanding;
+
+    //! true if the nanoapp was sent CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL
+    //! and has not yet been sent CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED.
+    bool nearlyFullNotified;
+
+    //! The number of messages rejected as the nanoapp was over its quota.
+    uint32_t numRejected;
+  };
+
+#ifdef CHRE_STATIC_EVENT_LOOP
+  //! The maximum number of messages we can have outstanding at any given time
+  static constexpr size_t kMaxOutstandingMessages =
+      CHRE_MAX_OUTSTANDING_HOST_MESSAGES;
+#else
+  //! The number of messages allocated at a time when the pool grows.
+  static constexpr size_t kMessagesPerBlock = CHRE_HOST_MESSAGE_PER_BLOCK;
+
+  //! The maximum number of blocks the message pool can grow to.
+  static constexpr size_t kMaxMessageBlocks = CHRE_MAX_HOST_MESSAGE_BLOCKS;
+
   //! The maximum number of messages we can have outstanding at any given time
-  static constexpr size_t kMaxOutstandingMessages = 32;
+  static constexpr size_t kMaxOutstandingMessages =
+      kMessagesPerBlock * kMaxMessageBlocks;
+#endif  // CHRE_STATIC_EVENT_LOOP
+
+  //! The maximum number of messages to the host a single nanoapp can have
+  //! outstanding, so that one nanoapp can't starve the others of the pool.
+#if defined(CHRE_HOST_MESSAGE_NANOAPP_QUOTA)
+  static constexpr size_t kNanoappMessageQuota =
+      CHRE_HOST_MESSAGE_NANOAPP_QUOTA;
+#elif defined(CHRE_STATIC_EVENT_LOOP)
+  //! The static pool only holds the burst that a single nanoapp could always
+  //! send, so a nanoapp may use all of it.
+  static constexpr size_t kNanoappMessageQuota = kMaxOutstandingMessages;
+#else
+  static constexpr size_t kNanoappMessageQuota = kMaxOutstandingMessages / 2;
+#endif  // defined(CHRE_HOST_MESSAGE_NANOAPP_QUOTA)
+
+  static_assert(kNanoappMessageQuota > 0 &&
+                    kNanoappMessageQuota <= kMaxOutstandingMessages,
+                "Nanoapp message quota must fit in the message pool");
+
+  //! A nanoapp is notified that the queue is nearly full once its own usage or
+  //! the pool usage reaches three quarters of the respective limit.
+  static constexpr size_t kNanoappNearlyFullThreshold =
+      kNanoappMessageQuota - kNanoappMessageQuota / 4;
+  static constexpr size_t kPoolNearlyFullThreshold =
+      kMaxOutstandingMessages - kMaxOutstandingMessages / 4;
 
   //! Ensures that we do not blame more than once per host wakeup. This is
   //! checked before calling host blame to make sure it is set once. The power
@@ -191,7 +297,90 @@ class HostCommsManager : public HostLink {
   //! messages themselves). Must be synchronized as the same HostCommsManager
   //! handles communications for all EventLoops, and also to support freeing
   //! messages directly in onMessageToHostComplete.
+#ifdef CHRE_STATIC_EVENT_LOOP
   SynchronizedMemoryPool<HostMessage, kMaxOutstandingMessages> mMessagePool;
+#else
+  SynchronizedExpandableMemoryPool<HostMessage, kMessagesPerBlock,
+                                   kMaxMessageBlocks>
+      mMessagePool;
+#endif  // CHRE_STATIC_EVENT_LOOP
+
+  //! Protects the message usage accounting below, which is updated from both
+  //! the EventLoop and the HostLink contexts.
+  Mutex mUsageMutex;
+
+  //! The number of messages in either direction currently allocated from
+  //! mMessagePool, and the largest value it has reached.
+  size_t mNumMessagesAllocated = 0;
+  size_t mMaxMessagesAllocated = 0;
+
+  //! The number of messages in either direction that could not be allocated.
+  uint32_t mNumAllocationFailures = 0;
+
+  //! Usage of the pool by each nanoapp that has sent messages to the host.
+  DynamicVector<NanoappMessageUsage> mNanoappUsage;
+
+  /**
+   * Allocates a message from mMessagePool and updates the usage accounting.
+   *
+   * @return The message, or nullptr if the pool is exhausted.
+   */
+  HostMessage *allocateMessage();
+
+  /**
+   * Returns a message previously obtained from allocateMessage() to the pool.
+   * For messages to the host, releaseNanoappQuota() must also be called.
+   */
+  void deallocateMessage(HostMessage *message);
+
+  /**
+   * Reserves room for one more outstanding message to the host from the given
+   * nanoapp, if it is below its quota.
+   *
+   * @param nanoapp The nanoapp sending the message.
+   * @param notifyNearlyFull Set to true if the nanoapp should be sent
+   *     CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL.
+   *
+   * @return true if the nanoapp may send the message.
+   */
+  bool reserveNanoappQuota(const Nanoapp &nanoapp, bool *notifyNearlyFull);
+
+  /**
+   * Releases a reservation made by reserveNanoappQuota(), and sends
+   * CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED to the nanoapp if this was the last
+   * of its messages and it was told the queue was nearly full.
+   *
+   * @param appId The app ID of the nanoapp that sent the message.
+   */
+  void releaseNanoappQuota(uint64_t appId);
+
+  /**
+   * Releases a message to the host along with its quota reservation.
+   */
+  void releaseMessageToHost(MessageToHost *msgToHost);
+
+  /**
+   * @return The usage entry for the given app ID, or nullptr if there is none.
+   *     mUsageMutex must be held.
+   */
+  NanoappMessageUsage *findNanoappUsage(uint64_t appId);
+
+  /**
+   * @return The index of the usage entry for the given app ID in
+   *     mNanoappUsage, or mNanoappUsage.size() if there is none. mUsageMutex
+   *     must be held.
+   */
+  size_t findNanoappUsageIndex(uint64_t appId) const;
+
+  /**
+   * Posts CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL or
+   * CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED to a nanoapp, dropping it if the
+   * event queue has no room.
+   *
+   * @param eventType The event to post.
+   * @param instanceId The instance ID of the nanoapp to post it to.
+   */
+  void postQueueStateEvent(uint16_t eventType, uint16_t instanceId);
 
   /**
    * Allocates and populates the event structure used to notify a nanoapp of an
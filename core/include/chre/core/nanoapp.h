@@ -27,11 +27,30 @@
 #include "chre/platform/platform_nanoapp.h"
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/fixed_size_vector.h"
+#include "chre/util/sorted_vector_set.h"
 #include "chre/util/system/debug_dump.h"
+#include "chre/util/system/log_histogram.h"
 #include "chre/util/system/napp_permissions.h"
 #include "chre/util/system/stats_container.h"
+#include "chre/util/time.h"
 #include "chre_api/chre/event.h"
 
+// The number of event types, starting from 0, for which each nanoapp tracks
+// its registrations in a bitmap for fast lookup. The default covers the
+// CHRE_EVENT_* system events defined in the CHRE API, and can be overridden
+// in the variant-specific makefile (e.g. set to 0 to save memory).
+#ifndef CHRE_NANOAPP_DENSE_EVENT_TYPE_COUNT
+#define CHRE_NANOAPP_DENSE_EVENT_TYPE_COUNT 0x400
+#endif
+
+// The number of distinct event types for which each nanoapp keeps its own
+// latency histograms, in the order they are first delivered. Events of any
+// other type share one more set of histograms. Can be overridden in the
+// variant-specific makefile.
+#ifndef CHRE_NANOAPP_LATENCY_EVENT_TYPE_COUNT
+#define CHRE_NANOAPP_LATENCY_EVENT_TYPE_COUNT 4
+#endif
+
 namespace chre {
 
 /**
@@ -110,6 +129,43 @@ class Nanoapp : public PlatformNanoapp {
     }
   }
 
+  /**
+   * Sets the slack of timers subsequently set by this nanoapp: the time after
+   * their expiration within which they may fire, allowing the TimerPool to
+   * handle them in the same wakeup as other timers.
+   *
+   * @param slack The timer slack, where 0 fires timers as close to their
+   *        expiration as possible.
+   */
+  void setTimerSlack(Nanoseconds slack) {
+    mTimerSlack = slack;
+  }
+
+  /**
+   * @return The slack applied to timers set by this nanoapp.
+   */
+  Nanoseconds getTimerSlack() const {
+    return mTimerSlack;
+  }
+
+  /**
+   * Configures whether the nanoapp is sent the host message queue state
+   * events. Nanoapps are not sent these events by default.
+   *
+   * @param enable true if events are to be sent, false otherwise.
+   */
+  void configureHostMessageQueueEvents(bool enable) {
+    mHostMessageQueueEventsEnabled = enable;
+  }
+
+  /**
+   * @return true if the nanoapp opted in to the host message queue state
+   *     events.
+   */
+  bool isHostMessageQueueEventsEnabled() const {
+    return mHostMessageQueueEventsEnabled;
+  }
+
   /**
    * @return true if the nanoapp should receive broadcast event
    */
@@ -117,7 +173,8 @@ class Nanoapp : public PlatformNanoapp {
 
   /**
    * Updates the Nanoapp's registration so that it will receive broadcast events
-   * with the given event type.
+   * with the given event type. Must only be called from the context of the
+   * EventLoop this Nanoapp is running in, after an instance ID was assigned.
    *
    * @param eventType The event type that the nanoapp will now be registered to
    *     receive
@@ -182,6 +239,18 @@ class Nanoapp : public PlatformNanoapp {
    */
   void processEvent(Event *event);
 
+  /**
+   * Records the latency of an event delivered to this nanoapp in the event
+   * process time stats and latency histograms.
+   *
+   * @param eventType The type of the event.
+   * @param queueDelayMicros The time from the event being posted until it was
+   *     delivered to this nanoapp, in microseconds.
+   * @param processTime The time this nanoapp took to process the event.
+   */
+  void recordEventLatency(uint16_t eventType, uint32_t queueDelayMicros,
+                          Nanoseconds processTime);
+
   /**
    * Log info about a single host wakeup that this nanoapp triggered by storing
    * the count of wakeups in mWakeupBuckets.
@@ -249,7 +318,9 @@ class Nanoapp : public PlatformNanoapp {
   void linkHeapBlock(HeapBlockHeader *header);
 
   /**
-   * Removes a block of memory from the linked list of headers.
+   * Removes a block of memory from the linked list of headers, in constant
+   * time. If the block was allocated by a different nanoapp, it is removed from
+   * that nanoapp's list.
    *
    * @see getFirstHeapBlock
    * @see chreHeapFree
@@ -270,9 +341,11 @@ class Nanoapp : public PlatformNanoapp {
   uint32_t mNumWakeupsSinceBoot = 0;
 
   /**
-   * Head of the singly linked list of heap block headers.
+   * Head of the doubly linked list of heap block headers.
    *
-   * The list is used to free all the memory allocated by the nanoapp.
+   * The list is used to free all the memory allocated by the nanoapp. The
+   * first header refers back to this member, so a Nanoapp must not be moved
+   * while it has heap blocks allocated.
    *
    * @see MemoryManager
    */
@@ -284,6 +357,12 @@ class Nanoapp : public PlatformNanoapp {
   //! The peak total number of bytes allocated by the nanoapp.
   size_t mPeakAllocatedBytes = 0;
 
+  //! The slack applied to timers set by this nanoapp.
+  Nanoseconds mTimerSlack = Nanoseconds(0);
+
+  //! Whether the nanoapp is sent the host message queue state events.
+  bool mHostMessageQueueEventsEnabled = false;
+
   //! The number of buckets for wakeup logging, adjust along with
   //! EventLoop::kIntervalWakupBucketInMins.
   static constexpr size_t kMaxSizeWakeupBuckets = 4;
@@ -295,24 +374,61 @@ class Nanoapp : public PlatformNanoapp {
   //! Collects process time in nanoseconds of each event
   StatsContainer<uint64_t> mEventProcessTime;
 
+  //! Latency histograms are in microseconds, the last bucket counting
+  //! latencies of 2^18 us (~262 ms) and above.
+  typedef LogHistogram<20> LatencyHistogram;
+
+  //! Latency histograms of the events of one type delivered to this nanoapp.
+  struct EventLatency {
+    uint16_t eventType;
+
+    //! Time from the event being posted until it was delivered.
+    LatencyHistogram queueDelay;
+
+    //! Time taken by the nanoapp to process the event.
+    LatencyHistogram processTime;
+  };
+
+  //! Latencies of the first event types delivered to this nanoapp.
+  FixedSizeVector<EventLatency, CHRE_NANOAPP_LATENCY_EVENT_TYPE_COUNT>
+      mEventLatencies;
+
+  //! Latencies of event types that didn't fit in mEventLatencies.
+  EventLatency mOtherEventLatency = {};
+
+  //! The maximum number of distinct event types tracked in mOtherEventTypes.
+  static constexpr size_t kMaxOtherEventTypes = 8;
+
+  //! The distinct event types recorded in mOtherEventLatency, so the debug dump
+  //! shows how many were merged there. Once full, further types only set
+  //! mOtherEventTypesOverflowed.
+  FixedSizeVector<uint16_t, kMaxOtherEventTypes> mOtherEventTypes;
+  bool mOtherEventTypesOverflowed = false;
+
   //! Metadata needed for keeping track of the registered events for this
   //! nanoapp.
   struct EventRegistration {
     EventRegistration(uint16_t eventType_, uint16_t groupIdMask_)
         : eventType(eventType_), groupIdMask(groupIdMask_) {}
 
+    //! @return The key identifying this registration in mRegisteredEvents.
+    uint16_t getKey() const {
+      return eventType;
+    }
+
     uint16_t eventType;
     uint16_t groupIdMask;
   };
 
-  //! The set of broadcast events that this app is registered for.
-  // TODO: Implement a set container and replace DynamicVector here. There may
-  // also be a better way of handling this (perhaps we map event type to apps
-  // who care about them).
-  DynamicVector<EventRegistration> mRegisteredEvents;
+  //! The set of broadcast events that this app is registered for. The
+  //! EventLoop keeps an index of event type to the apps registered for it,
+  //! which is updated whenever an event type is added to or removed from this
+  //! set.
+  SortedVectorSet<EventRegistration, CHRE_NANOAPP_DENSE_EVENT_TYPE_COUNT>
+      mRegisteredEvents;
 
   //! The registered host endpoints to receive notifications for.
-  DynamicVector<uint16_t> mRegisteredHostEndpoints;
+  SortedVectorSet<uint16_t> mRegisteredHostEndpoints;
 
   //! The list of RPC services for this nanoapp.
   DynamicVector<struct chreNanoappRpcService> mRpcServices;
@@ -320,10 +436,6 @@ class Nanoapp : public PlatformNanoapp {
   //! Whether nanoappStart is being executed.
   bool mIsInNanoappStart = false;
 
-  //! @return index of event registration if found. mRegisteredEvents.size() if
-  //!     not.
-  size_t registrationIndex(uint16_t eventType) const;
-
   /**
    * A special function to deliver GNSS measurement events to nanoapps and
    * handles version compatibility.
@@ -332,9 +444,15 @@ class Nanoapp : public PlatformNanoapp {
    */
   void handleGnssMeasurementDataEvent(const Event *event);
 
+  /**
+   * Prints a summary of the latency histograms of one event type.
+   */
+  void logEventLatencyToBuffer(DebugDumpWrapper &debugDump,
+                               const EventLatency &latency,
+                               bool isOtherEventTypes) const;
+
   bool isRegisteredForHostEndpointNotifications(uint16_t hostEndpointId) const {
-    return mRegisteredHostEndpoints.find(hostEndpointId) !=
-           mRegisteredHostEndpoints.size();
+    return mRegisteredHostEndpoints.contains(hostEndpointId);
   }
 };
 
@@ -220,6 +220,22 @@ class Sensor : public PlatformSensor {
    */
   void setSamplingStatus(const struct chreSensorSamplingStatus &status);
 
+  /**
+   * @return The number of this sensor's events that were merged into another
+   *     event, or dropped as superseded, while the event loop was backed up.
+   */
+  uint32_t getNumCoalescedEvents() const {
+    return mNumCoalescedEvents;
+  }
+
+  /**
+   * Counts an event of this sensor that was coalesced. Must be called from the
+   * CHRE thread.
+   */
+  void incrementNumCoalescedEvents() {
+    mNumCoalescedEvents++;
+  }
+
   const char *getSensorTypeName() const {
     return SensorTypeHelpers::getSensorTypeName(getSensorType());
   }
@@ -254,6 +270,9 @@ class Sensor : public PlatformSensor {
 
   //! True if a flush request is pending for this sensor.
   AtomicBool mFlushRequestPending;
+
+  //! @see getNumCoalescedEvents()
+  uint32_t mNumCoalescedEvents = 0;
 };
 
 }  // namespace chre
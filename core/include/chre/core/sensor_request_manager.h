@@ -17,6 +17,7 @@
 #ifndef CHRE_CORE_SENSOR_REQUEST_MANAGER_H_
 #define CHRE_CORE_SENSOR_REQUEST_MANAGER_H_
 
+#include "chre/core/event_loop.h"
 #include "chre/core/sensor.h"
 #include "chre/core/sensor_request.h"
 #include "chre/core/sensor_request_multiplexer.h"
@@ -28,6 +29,14 @@
 #include "chre/util/optional.h"
 #include "chre/util/system/debug_dump.h"
 
+// The number of events pending in the event loop from which consecutive
+// sensor data batches are merged and superseded sampling status and bias
+// updates are dropped, when CHRE_SENSOR_EVENT_COALESCING_ENABLED is defined.
+// Can be overridden in the variant-specific makefile.
+#ifndef CHRE_SENSOR_EVENT_COALESCING_QUEUE_DEPTH
+#define CHRE_SENSOR_EVENT_COALESCING_QUEUE_DEPTH 16
+#endif
+
 namespace chre {
 
 /**
@@ -345,6 +354,9 @@ class SensorRequestManager : public NonCopyable {
 
   PlatformSensorManager mPlatformSensorManager;
 
+  //! The event loop lane that sensor data events are posted through.
+  EventLoop::EventSourceId mEventSourceId = EventLoop::kInvalidEventSourceId;
+
   /**
    * Makes a specified flush request, and sets the timeout timer appropriately.
    * If there already is a pending flush request for the sensor specified in
@@ -92,6 +92,16 @@ class SensorTypeHelpers : public PlatformSensorTypeHelpers {
    */
   static size_t getLastEventSize(uint8_t sensorType);
 
+  /**
+   * Determines the size of a single reading in the data events of a continuous
+   * sensor, which is needed to combine the readings of several data events.
+   *
+   * @param sensorType The sensorType of this sensor.
+   * @return the size of one entry of the readings array of the sensor's data
+   *     events, or 0 if the sensor isn't continuous or the size isn't known.
+   */
+  static size_t getReadingSize(uint8_t sensorType);
+
   /**
    * @param sensorType The sensor type to obtain a string for.
    * @return A string representation of the sensor type.
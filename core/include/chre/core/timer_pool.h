@@ -25,7 +25,22 @@
 #include "chre/platform/mutex.h"
 #include "chre/platform/system_timer.h"
 #include "chre/util/non_copyable.h"
+#include "chre/util/system/debug_dump.h"
+
+#ifdef CHRE_INDEXED_TIMER_POOL_ENABLED
+#include "chre/util/indexed_priority_queue.h"
+#else
 #include "chre/util/priority_queue.h"
+#endif
+
+// The minimum window after a timer's expiration time within which it may fire,
+// so timers expiring close to each other are handled by a single SystemTimer
+// wakeup. A value of 0 fires each timer as close to its expiration as
+// possible, unless the nanoapp that set it requested a larger slack. This
+// default value can be overridden in the variant-specific makefile.
+#ifndef CHRE_TIMER_POOL_COALESCING_SLACK_NS
+#define CHRE_TIMER_POOL_COALESCING_SLACK_NS 0
+#endif
 
 namespace chre {
 
@@ -52,7 +67,8 @@ class TimerPool : public NonCopyable {
 
   /**
    * Requests a timer for a nanoapp given a cookie to pass to the nanoapp when
-   * the timer event is published.
+   * the timer event is published. The timer may fire up to the nanoapp's timer
+   * slack after it expires.
    *
    * @param nanoapp The nanoapp for which this timer is being requested.
    * @param duration The duration of the timer.
@@ -64,8 +80,8 @@ class TimerPool : public NonCopyable {
   TimerHandle setNanoappTimer(const Nanoapp *nanoapp, Nanoseconds duration,
                               const void *cookie, bool isOneShot) {
     CHRE_ASSERT(nanoapp != nullptr);
-    return setTimer(nanoapp->getInstanceId(), duration, cookie,
-                    nullptr /* systemCallback */,
+    return setTimer(nanoapp->getInstanceId(), duration, nanoapp->getTimerSlack(),
+                    cookie, nullptr /* systemCallback */,
                     SystemCallbackType::FirstCallbackType, isOneShot);
   }
 
@@ -119,6 +135,31 @@ class TimerPool : public NonCopyable {
     return cancelTimer(kSystemInstanceId, timerHandle);
   }
 
+  /**
+   * @return The number of SystemTimer wakeups that fired at least one timer.
+   *         The first timer fired by each wakeup counts as uncoalesced.
+   */
+  uint32_t getNumUncoalescedTimerFires() const {
+    return mNumUncoalescedTimerFires;
+  }
+
+  /**
+   * @return The number of timers that fired in the same wakeup as an earlier
+   *         timer, i.e. the number of wakeups saved by coalescing.
+   */
+  uint32_t getNumCoalescedTimerFires() const {
+    return mNumCoalescedTimerFires;
+  }
+
+  /**
+   * Prints state in a string buffer. Must only be called from the context of
+   * the main CHRE thread.
+   *
+   * @param debugDump The debug dump wrapper where a string can be printed
+   *     into one of the buffers.
+   */
+  void logStateToBuffer(DebugDumpWrapper &debugDump) const;
+
  private:
   // Allows TestTimer to access hasNanoappTimers.
   friend class TestTimer;
@@ -131,6 +172,9 @@ class TimerPool : public NonCopyable {
     Nanoseconds expirationTime;
     Nanoseconds duration;
 
+    //! The time after expirationTime within which the timer may fire.
+    Nanoseconds slack;
+
     //! The cookie pointer to be passed as an event to the requesting nanoapp,
     //! or data pointer for system callbacks.
     const void *cookie;
@@ -156,19 +200,56 @@ class TimerPool : public NonCopyable {
      *         request.
      */
     bool operator>(const TimerRequest &request) const;
+
+    /**
+     * @return The latest time at which the timer should fire.
+     */
+    Nanoseconds getDeadline() const;
   };
 
+  //! Max number of timers that can be requested.
+  static constexpr size_t kMaxTimerRequests = 64;
+
+  //! The time after its expiration within which a timer may fire.
+  static constexpr Nanoseconds kCoalescingSlack =
+      Nanoseconds(CHRE_TIMER_POOL_COALESCING_SLACK_NS);
+
+#ifdef CHRE_INDEXED_TIMER_POOL_ENABLED
+  //! The queue of outstanding timer requests. Each request stays at a fixed
+  //! slot which is encoded in its timer handle, so requests can be looked up
+  //! from their handle in constant time.
+  IndexedPriorityQueue<TimerRequest, kMaxTimerRequests,
+                       std::greater<TimerRequest>>
+      mTimerRequests;
+
+  //! Incremented for each timer handle generated, forming the upper bits of the
+  //! handle to keep handles of successive requests using a slot distinct.
+  TimerHandle mTimerHandleGeneration = 0;
+#else
   //! The queue of outstanding timer requests.
   PriorityQueue<TimerRequest, std::greater<TimerRequest>> mTimerRequests;
+#endif
 
   //! The underlying system timer used to schedule delayed callbacks.
   SystemTimer mSystemTimer;
 
+  //! The value of mNextWakeupTime when the system timer isn't set.
+  static constexpr Nanoseconds kNoWakeupScheduled = Nanoseconds(UINT64_MAX);
+
+  //! The time mSystemTimer is set to fire at, i.e. the earliest deadline of
+  //! all timer requests, or kNoWakeupScheduled.
+  Nanoseconds mNextWakeupTime = kNoWakeupScheduled;
+
+  //! @see getNumUncoalescedTimerFires
+  uint32_t mNumUncoalescedTimerFires = 0;
+
+  //! @see getNumCoalescedTimerFires
+  uint32_t mNumCoalescedTimerFires = 0;
+
+#ifndef CHRE_INDEXED_TIMER_POOL_ENABLED
   //! The next timer handle for generateTimerHandleLocked() to return.
   TimerHandle mLastTimerHandle = CHRE_TIMER_INVALID;
-
-  //! Max number of timers that can be requested.
-  static constexpr size_t kMaxTimerRequests = 64;
+#endif
 
   //! The number of timers that must be available for all nanoapps
   //! (per CHRE API).
@@ -181,9 +262,11 @@ class TimerPool : public NonCopyable {
   static_assert(kMaxNanoappTimers >= kNumReservedNanoappTimers,
                 "Max number of nanoapp timers is too small");
 
+#ifndef CHRE_INDEXED_TIMER_POOL_ENABLED
   //! Whether or not the timer handle generation logic needs to perform a
   //! search for a vacant timer handle.
   bool mGenerateTimerHandleMustCheckUniqueness = false;
+#endif
 
   //! The mutex to lock when using this class.
   Mutex mMutex;
@@ -197,6 +280,8 @@ class TimerPool : public NonCopyable {
    *
    * @param instanceId The instance ID of the caller.
    * @param duration The duration of the timer.
+   * @param slack The time after expiration within which the timer may fire.
+   *        At least kCoalescingSlack is used.
    * @param cookie A cookie to pass to the app when the timer elapses.
    * @param systemCallback Callback to invoke (only for system-started timers).
    * @param callbackType Identifier to pass to the callback.
@@ -205,7 +290,7 @@ class TimerPool : public NonCopyable {
    *         not successful.
    */
   TimerHandle setTimer(uint16_t instanceId, Nanoseconds duration,
-                       const void *cookie,
+                       Nanoseconds slack, const void *cookie,
                        SystemEventCallbackFunction *systemCallback,
                        SystemCallbackType callbackType, bool isOneShot);
 
@@ -234,12 +319,15 @@ class TimerPool : public NonCopyable {
 
   /**
    * Obtains a unique timer handle to return to an app requesting a timer.
-   * mMutex must be acquired prior to calling this function.
+   * With CHRE_INDEXED_TIMER_POOL_ENABLED, the handle refers to the slot that
+   * the next request inserted into mTimerRequests will occupy. mMutex must be
+   * acquired prior to calling this function.
    *
    * @return The guaranteed unique timer handle.
    */
   TimerHandle generateTimerHandleLocked();
 
+#ifndef CHRE_INDEXED_TIMER_POOL_ENABLED
   /**
    * Obtains a unique timer handle by searching through the list of timer
    * requests. This is a fallback for once the timer handles have been
@@ -248,6 +336,7 @@ class TimerPool : public NonCopyable {
    * @return A guaranteed unique timer handle.
    */
   TimerHandle generateUniqueTimerHandleLocked();
+#endif
 
   /**
    * Helper function to determine whether a new timer of the specified type
@@ -299,6 +388,27 @@ class TimerPool : public NonCopyable {
    */
   bool handleExpiredTimersAndScheduleNextLocked();
 
+  /**
+   * Computes the next expiration time of a periodic timer that has just fired,
+   * one period after its previous expiration. Periods that have already passed
+   * are skipped.
+   *
+   * @param timerRequest The periodic timer request that fired.
+   * @param currentTime The current monotonic time.
+   * @return The next expiration time of the timer.
+   */
+  static Nanoseconds getNextPeriodicExpirationTime(
+      const TimerRequest &timerRequest, Nanoseconds currentTime);
+
+  /**
+   * Sets the underlying system timer to the earliest deadline of the timer
+   * requests, or leaves it unset if there are none. mMutex must be acquired
+   * prior to calling this function.
+   *
+   * @param currentTime The current monotonic time.
+   */
+  void scheduleNextWakeupLocked(Nanoseconds currentTime);
+
   /**
    * Returns whether the nanoapp holds timers.
    *
@@ -61,7 +61,7 @@ bool Nanoapp::isRegisteredForBroadcastEvent(const Event *event) const {
         static_cast<const chreHostEndpointNotification *>(event->eventData);
     registered = isRegisteredForHostEndpointNotifications(data->hostEndpointId);
   } else {
-    size_t foundIndex = registrationIndex(eventType);
+    size_t foundIndex = mRegisteredEvents.find(eventType);
     if (foundIndex < mRegisteredEvents.size()) {
       const EventRegistration &reg = mRegisteredEvents[foundIndex];
       if (targetGroupIdMask & reg.groupIdMask) {
@@ -74,23 +74,29 @@ bool Nanoapp::isRegisteredForBroadcastEvent(const Event *event) const {
 
 void Nanoapp::registerForBroadcastEvent(uint16_t eventType,
                                         uint16_t groupIdMask) {
-  size_t foundIndex = registrationIndex(eventType);
+  size_t foundIndex = mRegisteredEvents.find(eventType);
   if (foundIndex < mRegisteredEvents.size()) {
     mRegisteredEvents[foundIndex].groupIdMask |= groupIdMask;
-  } else if (!mRegisteredEvents.push_back(
+  } else if (!mRegisteredEvents.insert(
                  EventRegistration(eventType, groupIdMask))) {
     FATAL_ERROR_OOM();
+  } else {
+    EventLoopManagerSingleton::get()->getEventLoop().addBroadcastSubscriber(
+        eventType, this);
   }
 }
 
 void Nanoapp::unregisterForBroadcastEvent(uint16_t eventType,
                                           uint16_t groupIdMask) {
-  size_t foundIndex = registrationIndex(eventType);
+  size_t foundIndex = mRegisteredEvents.find(eventType);
   if (foundIndex < mRegisteredEvents.size()) {
     EventRegistration &reg = mRegisteredEvents[foundIndex];
     reg.groupIdMask &= ~groupIdMask;
     if (reg.groupIdMask == 0) {
       mRegisteredEvents.erase(foundIndex);
+      EventLoopManagerSingleton::get()
+          ->getEventLoop()
+          .removeBroadcastSubscriber(eventType, this);
     }
   }
 }
@@ -133,7 +139,6 @@ void Nanoapp::configureUserSettingEvent(uint8_t setting, bool enable) {
 }
 
 void Nanoapp::processEvent(Event *event) {
-  Nanoseconds eventStartTime = SystemTime::getMonotonicTime();
   traceNanoappHandleEventStart(getInstanceId(), event->eventType);
   if (event->eventType == CHRE_EVENT_GNSS_DATA) {
     handleGnssMeasurementDataEvent(event);
@@ -141,15 +146,43 @@ void Nanoapp::processEvent(Event *event) {
     handleEvent(event->senderInstanceId, event->eventType, event->eventData);
   }
   traceNanoappHandleEventEnd(getInstanceId());
-  Nanoseconds eventProcessTime =
-      SystemTime::getMonotonicTime() - eventStartTime;
-  if (Milliseconds(eventProcessTime) >= Milliseconds(100)) {
+}
+
+void Nanoapp::recordEventLatency(uint16_t eventType, uint32_t queueDelayMicros,
+                                 Nanoseconds processTime) {
+  if (Milliseconds(processTime) >= Milliseconds(100)) {
     LOGE("Nanoapp 0x%" PRIx64 " took %" PRIu64
          " ms to process event type %" PRIu16,
-         getAppId(), Milliseconds(eventProcessTime).getMilliseconds(),
-         event->eventType);
+         getAppId(), Milliseconds(processTime).getMilliseconds(), eventType);
   }
-  mEventProcessTime.addValue(Milliseconds(eventProcessTime).getMilliseconds());
+  mEventProcessTime.addValue(Milliseconds(processTime).getMilliseconds());
+
+  EventLatency *latency = &mOtherEventLatency;
+  for (EventLatency &trackedLatency : mEventLatencies) {
+    if (trackedLatency.eventType == eventType) {
+      latency = &trackedLatency;
+      break;
+    }
+  }
+  if (latency == &mOtherEventLatency) {
+    if (!mEventLatencies.full()) {
+      mEventLatencies.push_back(EventLatency{});
+      latency = &mEventLatencies.back();
+      latency->eventType = eventType;
+    } else if (std::find(mOtherEventTypes.begin(), mOtherEventTypes.end(),
+                         eventType) == mOtherEventTypes.end()) {
+      if (mOtherEventTypes.full()) {
+        mOtherEventTypesOverflowed = true;
+      } else {
+        mOtherEventTypes.push_back(eventType);
+      }
+    }
+  }
+
+  uint64_t processTimeMicros = Microseconds(processTime).getMicroseconds();
+  latency->queueDelay.addValue(queueDelayMicros);
+  latency->processTime.addValue(static_cast<uint32_t>(
+      std::min<uint64_t>(processTimeMicros, UINT32_MAX)));
 }
 
 void Nanoapp::blameHostWakeup() {
@@ -193,22 +226,54 @@ void Nanoapp::logStateToBuffer(DebugDumpWrapper &debugDump) const {
   // Print mean and max event process time
   debugDump.print("eventProcessTimeMs: mean=%" PRIu64 ", max=%" PRIu64 "\n",
                   mEventProcessTime.getMean(), mEventProcessTime.getMax());
-}
 
-bool Nanoapp::permitPermissionUse(uint32_t permission) const {
-  return !supportsAppPermissions() ||
-         ((getAppPermissions() & permission) == permission);
+  for (const EventLatency &latency : mEventLatencies) {
+    logEventLatencyToBuffer(debugDump, latency, false /* isOtherEventTypes */);
+  }
+  if (mOtherEventLatency.queueDelay.getTotalCount() > 0) {
+    logEventLatencyToBuffer(debugDump, mOtherEventLatency,
+                            true /* isOtherEventTypes */);
+  }
 }
 
-size_t Nanoapp::registrationIndex(uint16_t eventType) const {
-  size_t foundIndex = 0;
-  for (; foundIndex < mRegisteredEvents.size(); ++foundIndex) {
-    const EventRegistration &reg = mRegisteredEvents[foundIndex];
-    if (reg.eventType == eventType) {
-      break;
+void Nanoapp::logEventLatencyToBuffer(DebugDumpWrapper &debugDump,
+                                      const EventLatency &latency,
+                                      bool isOtherEventTypes) const {
+  if (isOtherEventTypes) {
+    debugDump.print("  latencyUs evt=other types=%zu%s",
+                    mOtherEventTypes.size(),
+                    mOtherEventTypesOverflowed ? "+" : "");
+  } else {
+    debugDump.print("  latencyUs evt=0x%" PRIx16, latency.eventType);
+  }
+  debugDump.print(" n=%" PRIu32, latency.queueDelay.getTotalCount());
+
+  // Each percentile is printed as the upper bound of the bucket it falls in,
+  // e.g. p50<16 means half of the latencies were below 16 us.
+  const struct {
+    const char *name;
+    const LatencyHistogram &histogram;
+  } kHistograms[] = {{"queue", latency.queueDelay},
+                     {"process", latency.processTime}};
+  for (const auto &entry : kHistograms) {
+    debugDump.print(" %s:", entry.name);
+    for (uint8_t percentile : {50, 99, 100}) {
+      size_t bucket = entry.histogram.getPercentileBucket(percentile);
+      if (bucket + 1 < LatencyHistogram::getNumBuckets()) {
+        debugDump.print(" p%" PRIu8 "<%" PRIu32, percentile,
+                        LatencyHistogram::getBucketLowerBound(bucket + 1));
+      } else {
+        debugDump.print(" p%" PRIu8 ">=%" PRIu32, percentile,
+                        LatencyHistogram::getBucketLowerBound(bucket));
+      }
     }
   }
-  return foundIndex;
+  debugDump.print("\n");
+}
+
+bool Nanoapp::permitPermissionUse(uint32_t permission) const {
+  return !supportsAppPermissions() ||
+         ((getAppPermissions() & permission) == permission);
 }
 
 void Nanoapp::handleGnssMeasurementDataEvent(const Event *event) {
@@ -232,14 +297,21 @@ bool Nanoapp::configureHostEndpointNotifications(uint16_t hostEndpointId,
                                                  bool enable) {
   bool success = true;
   bool registered = isRegisteredForHostEndpointNotifications(hostEndpointId);
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
   if (enable && !registered) {
-    success = mRegisteredHostEndpoints.push_back(hostEndpointId);
+    success = mRegisteredHostEndpoints.insert(hostEndpointId);
     if (!success) {
       LOG_OOM();
+    } else if (mRegisteredHostEndpoints.size() == 1) {
+      eventLoop.addBroadcastSubscriber(CHRE_EVENT_HOST_ENDPOINT_NOTIFICATION,
+                                       this);
     }
   } else if (!enable && registered) {
-    size_t index = mRegisteredHostEndpoints.find(hostEndpointId);
-    mRegisteredHostEndpoints.erase(index);
+    mRegisteredHostEndpoints.remove(hostEndpointId);
+    if (mRegisteredHostEndpoints.empty()) {
+      eventLoop.removeBroadcastSubscriber(CHRE_EVENT_HOST_ENDPOINT_NOTIFICATION,
+                                          this);
+    }
   }
 
   return success;
@@ -291,31 +363,27 @@ bool Nanoapp::publishRpcServices(struct chreNanoappRpcService *services,
 
 void Nanoapp::linkHeapBlock(HeapBlockHeader *header) {
   header->data.next = mFirstHeader;
+  header->data.prevNext = &mFirstHeader;
+  if (mFirstHeader != nullptr) {
+    mFirstHeader->data.prevNext = &header->data.next;
+  }
   mFirstHeader = header;
 }
 
 void Nanoapp::unlinkHeapBlock(HeapBlockHeader *header) {
-  if (mFirstHeader == nullptr) {
-    // The list is empty.
-    return;
-  }
-
-  if (header == mFirstHeader) {
-    mFirstHeader = header->data.next;
+  if (header->data.prevNext == nullptr) {
+    // The block is not in a list.
     return;
   }
 
-  HeapBlockHeader *previous = mFirstHeader;
-  HeapBlockHeader *current = mFirstHeader->data.next;
-
-  while (current != nullptr) {
-    if (current == header) {
-      previous->data.next = current->data.next;
-      break;
-    }
-    previous = current;
-    current = current->data.next;
+  // Note that this also unlinks the block correctly if it belongs to another
+  // nanoapp, as prevNext points into the owner's list.
+  *header->data.prevNext = header->data.next;
+  if (header->data.next != nullptr) {
+    header->data.next->data.prevNext = header->data.prevNext;
   }
+  header->data.next = nullptr;
+  header->data.prevNext = nullptr;
 }
 
 }  // namespace chre
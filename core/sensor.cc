@@ -44,6 +44,9 @@ Sensor &Sensor::operator=(Sensor &&other) {
   mLastEventValid = other.mLastEventValid;
   other.mLastEventValid = false;
 
+  mNumCoalescedEvents = other.mNumCoalescedEvents;
+  other.mNumCoalescedEvents = 0;
+
   return *this;
 }
 
@@ -16,7 +16,11 @@
 
 #include "chre/core/sensor_request_manager.h"
 
+#include <cstddef>
+#include <cstring>
+
 #include "chre/core/event_loop_manager.h"
+#include "chre/core/sensor_type_helpers.h"
 #include "chre/util/macros.h"
 #include "chre/util/nested_data_ptr.h"
 #include "chre/util/system/debug_dump.h"
@@ -52,30 +56,27 @@ bool isSensorRequestValid(const Sensor &sensor,
 }
 
 /**
- * A helper function that updates the last event of a sensor in the main thread.
+ * Updates the last event of an on-change sensor as its data event is
+ * distributed, so that it is recorded in order with delivery without posting
+ * an event of its own.
  *
- * @param eventData A non-null pointer to the sensor's CHRE event data.
+ * @see EventLoop::EventDispatchHookFunction
  */
-void updateLastEvent(void *eventData) {
-  CHRE_ASSERT(eventData);
-
-  auto callback = [](uint16_t /*type*/, void *data, void * /*extraData*/) {
-    auto *sensorData = static_cast<ChreSensorData *>(data);
-    Sensor *sensor =
-        EventLoopManagerSingleton::get()->getSensorRequestManager().getSensor(
-            sensorData->header.sensorHandle);
-
-    // Mark last event as valid only if the sensor is enabled. Event data may
-    // arrive after sensor is disabled.
-    if (sensor != nullptr &&
-        sensor->getMaximalRequest().getMode() != SensorMode::Off) {
-      sensor->setLastEvent(sensorData);
-    }
-  };
-
-  // Schedule a deferred callback.
-  EventLoopManagerSingleton::get()->deferCallback(
-      SystemCallbackType::SensorLastEventUpdate, eventData, callback);
+void updateLastEvent(uint16_t /*eventType*/, void *eventData) {
+  auto *sensorData = static_cast<ChreSensorData *>(eventData);
+  Sensor *sensor =
+      (sensorData == nullptr)
+          ? nullptr
+          : EventLoopManagerSingleton::get()
+                ->getSensorRequestManager()
+                .getSensor(sensorData->header.sensorHandle);
+
+  // Mark last event as valid only if the sensor is enabled. Event data may
+  // arrive after sensor is disabled.
+  if (sensor != nullptr && sensor->isOnChange() &&
+      sensor->getMaximalRequest().getMode() != SensorMode::Off) {
+    sensor->setLastEvent(sensorData);
+  }
 }
 
 void sensorDataEventFree(uint16_t eventType, void *eventData) {
@@ -123,6 +124,149 @@ void postSamplingStatus(uint32_t sensorHandle,
   }
 }
 
+#ifdef CHRE_SENSOR_EVENT_COALESCING_ENABLED
+// Readings are combined as raw bytes, relying on each data event laying its
+// readings out right after the header, starting with the timestamp delta.
+static_assert(offsetof(chreSensorThreeAxisData, readings) ==
+                  sizeof(chreSensorDataHeader),
+              "Three axis readings don't follow the header");
+static_assert(offsetof(chreSensorFloatData, readings) ==
+                  sizeof(chreSensorDataHeader),
+              "Float readings don't follow the header");
+static_assert(offsetof(chreSensorOccurrenceData, readings) ==
+                  sizeof(chreSensorDataHeader),
+              "Occurrence readings don't follow the header");
+
+void freeCombinedSensorData(uint16_t /*eventType*/, void *eventData) {
+  memoryFree(eventData);
+}
+
+uint32_t getReadingTimestampDelta(const uint8_t *reading) {
+  uint32_t timestampDelta;
+  memcpy(&timestampDelta, reading, sizeof(timestampDelta));
+  return timestampDelta;
+}
+
+/**
+ * Combines the readings of two consecutive data events of a continuous sensor
+ * into a newly allocated data event.
+ *
+ * @return The combined data event, or nullptr if the events can't be combined.
+ */
+void *combineSensorData(const Sensor &sensor, const ChreSensorData *older,
+                        const ChreSensorData *newer) {
+  const chreSensorDataHeader &olderHeader = older->header;
+  const chreSensorDataHeader &newerHeader = newer->header;
+  size_t readingSize =
+      SensorTypeHelpers::getReadingSize(sensor.getSensorType());
+  if (readingSize == 0 || olderHeader.readingCount == 0 ||
+      newerHeader.readingCount == 0 ||
+      olderHeader.accuracy != newerHeader.accuracy ||
+      olderHeader.readingCount + newerHeader.readingCount > UINT16_MAX) {
+    return nullptr;
+  }
+
+  // The first reading's timestamp delta is relative to the base timestamp, and
+  // each other one to the previous reading, so only the delta of the newer
+  // event's first reading needs to change.
+  auto *olderReadings =
+      reinterpret_cast<const uint8_t *>(older) + sizeof(chreSensorDataHeader);
+  auto *newerReadings =
+      reinterpret_cast<const uint8_t *>(newer) + sizeof(chreSensorDataHeader);
+  uint64_t lastOlderTimestamp = olderHeader.baseTimestamp;
+  for (size_t i = 0; i < olderHeader.readingCount; i++) {
+    lastOlderTimestamp +=
+        getReadingTimestampDelta(&olderReadings[i * readingSize]);
+  }
+  uint64_t firstNewerTimestamp =
+      newerHeader.baseTimestamp + getReadingTimestampDelta(newerReadings);
+  if (firstNewerTimestamp < lastOlderTimestamp ||
+      firstNewerTimestamp - lastOlderTimestamp > UINT32_MAX) {
+    return nullptr;
+  }
+
+  size_t olderSize = olderHeader.readingCount * readingSize;
+  size_t newerSize = newerHeader.readingCount * readingSize;
+  auto *combined = static_cast<uint8_t *>(
+      memoryAlloc(sizeof(chreSensorDataHeader) + olderSize + newerSize));
+  if (combined == nullptr) {
+    LOG_OOM();
+  } else {
+    memcpy(combined, older, sizeof(chreSensorDataHeader) + olderSize);
+    uint8_t *firstNewerReading =
+        &combined[sizeof(chreSensorDataHeader) + olderSize];
+    memcpy(firstNewerReading, newerReadings, newerSize);
+
+    reinterpret_cast<chreSensorDataHeader *>(combined)->readingCount =
+        static_cast<uint16_t>(olderHeader.readingCount +
+                              newerHeader.readingCount);
+    uint32_t timestampDelta =
+        static_cast<uint32_t>(firstNewerTimestamp - lastOlderTimestamp);
+    memcpy(firstNewerReading, &timestampDelta, sizeof(timestampDelta));
+  }
+  return combined;
+}
+
+bool isBiasEventType(uint16_t eventType) {
+  switch (eventType) {
+    case CHRE_EVENT_SENSOR_ACCELEROMETER_BIAS_INFO:
+    case CHRE_EVENT_SENSOR_GYROSCOPE_BIAS_INFO:
+    case CHRE_EVENT_SENSOR_GEOMAGNETIC_FIELD_BIAS_INFO:
+    case CHRE_EVENT_SENSOR_UNCALIBRATED_ACCELEROMETER_BIAS_INFO:
+    case CHRE_EVENT_SENSOR_UNCALIBRATED_GYROSCOPE_BIAS_INFO:
+    case CHRE_EVENT_SENSOR_UNCALIBRATED_GEOMAGNETIC_FIELD_BIAS_INFO:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/**
+ * Coalesces sensor events while the event loop is backed up: consecutive data
+ * batches of a continuous sensor are merged into one event, and sampling
+ * status and bias updates are superseded by newer ones for the same sensor.
+ *
+ * @see EventLoop::EventCoalesceFunction
+ */
+void *coalesceSensorEvents(uint16_t eventType, void *olderData,
+                           void *newerData,
+                           chreEventCompleteFunction **freeCallback) {
+  SensorRequestManager &sensorRequestManager =
+      EventLoopManagerSingleton::get()->getSensorRequestManager();
+  Sensor *sensor = nullptr;
+  void *data = nullptr;
+  if (eventType == CHRE_EVENT_SENSOR_SAMPLING_CHANGE) {
+    auto *older = static_cast<chreSensorSamplingStatusEvent *>(olderData);
+    auto *newer = static_cast<chreSensorSamplingStatusEvent *>(newerData);
+    if (older->sensorHandle == newer->sensorHandle) {
+      sensor = sensorRequestManager.getSensor(newer->sensorHandle);
+      data = newerData;
+    }
+  } else if ((eventType >= CHRE_EVENT_SENSOR_DATA_EVENT_BASE &&
+              eventType < CHRE_EVENT_SENSOR_OTHER_EVENTS_BASE) ||
+             isBiasEventType(eventType)) {
+    auto *older = static_cast<ChreSensorData *>(olderData);
+    auto *newer = static_cast<ChreSensorData *>(newerData);
+    if (older->header.sensorHandle == newer->header.sensorHandle) {
+      sensor = sensorRequestManager.getSensor(newer->header.sensorHandle);
+    }
+    if (sensor == nullptr) {
+      // Not coalesced
+    } else if (isBiasEventType(eventType)) {
+      data = newerData;
+    } else if (sensor->isContinuous()) {
+      data = combineSensorData(*sensor, older, newer);
+      *freeCallback = freeCombinedSensorData;
+    }
+  }
+
+  if (sensor != nullptr && data != nullptr) {
+    sensor->incrementNumCoalescedEvents();
+  }
+  return data;
+}
+#endif  // CHRE_SENSOR_EVENT_COALESCING_ENABLED
+
 }  // namespace
 
 SensorRequestManager::~SensorRequestManager() {
@@ -138,6 +282,19 @@ void SensorRequestManager::init() {
   mPlatformSensorManager.init();
 
   mSensors = mPlatformSensorManager.getSensors();
+
+  mEventSourceId =
+      EventLoopManagerSingleton::get()->getEventLoop().registerEventSource(
+          "sensors");
+  EventLoopManagerSingleton::get()->getEventLoop().setEventDispatchHook(
+      CHRE_EVENT_SENSOR_DATA_EVENT_BASE,
+      CHRE_EVENT_SENSOR_OTHER_EVENTS_BASE - 1, updateLastEvent);
+
+#ifdef CHRE_SENSOR_EVENT_COALESCING_ENABLED
+  EventLoopManagerSingleton::get()->getEventLoop().setEventCoalescer(
+      CHRE_EVENT_SENSOR_FIRST_EVENT, CHRE_EVENT_SENSOR_LAST_EVENT,
+      coalesceSensorEvents, CHRE_SENSOR_EVENT_COALESCING_QUEUE_DEPTH);
+#endif  // CHRE_SENSOR_EVENT_COALESCING_ENABLED
 }
 
 bool SensorRequestManager::getSensorHandle(uint8_t sensorType,
@@ -483,26 +640,15 @@ void SensorRequestManager::handleSensorDataEvent(uint32_t sensorHandle,
     mPlatformSensorManager.releaseSensorDataEvent(event);
   } else {
     Sensor &sensor = mSensors[sensorHandle];
-    if (sensor.isOnChange()) {
-      updateLastEvent(event);
-    }
-
     uint16_t eventType =
         getSampleEventTypeForSensorType(sensor.getSensorType());
 
     // Only allow dropping continuous sensor events since losing one-shot or
     // on-change events could result in nanoapps stuck in a bad state.
-    if (sensor.isContinuous()) {
-      EventLoopManagerSingleton::get()
-          ->getEventLoop()
-          .postLowPriorityEventOrFree(eventType, event, sensorDataEventFree,
-                                      kSystemInstanceId, kBroadcastInstanceId,
-                                      sensor.getTargetGroupMask());
-    } else {
-      EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
-          eventType, event, sensorDataEventFree, kBroadcastInstanceId,
-          sensor.getTargetGroupMask());
-    }
+    EventLoopManagerSingleton::get()->getEventLoop().postEventFromSource(
+        mEventSourceId, sensor.isContinuous() /* isLowPriority */, eventType,
+        event, sensorDataEventFree, kBroadcastInstanceId,
+        sensor.getTargetGroupMask());
   }
 }
 
@@ -575,6 +721,13 @@ void SensorRequestManager::logStateToBuffer(DebugDumpWrapper &debugDump) const {
           request.getLatency().toRawNanoseconds(), request.getInstanceId());
     }
   }
+  for (uint8_t i = 0; i < mSensors.size(); i++) {
+    if (mSensors[i].getNumCoalescedEvents() > 0) {
+      debugDump.print(" %s: coalesced=%" PRIu32 "\n",
+                      mSensors[i].getSensorTypeName(),
+                      mSensors[i].getNumCoalescedEvents());
+    }
+  }
   debugDump.print("\n Last %zu Sensor Requests:\n", mSensorRequestLogs.size());
   static_assert(kMaxSensorRequestLogs <= INT8_MAX,
                 "kMaxSensorRequestLogs must be <= INT8_MAX");
@@ -129,6 +129,31 @@ size_t SensorTypeHelpers::getLastEventSize(uint8_t sensorType) {
   return 0;
 }
 
+size_t SensorTypeHelpers::getReadingSize(uint8_t sensorType) {
+  if (!isContinuous(sensorType) || isVendorSensorType(sensorType)) {
+    return 0;
+  }
+
+  switch (sensorType) {
+    case CHRE_SENSOR_TYPE_ACCELEROMETER:
+    case CHRE_SENSOR_TYPE_GYROSCOPE:
+    case CHRE_SENSOR_TYPE_GEOMAGNETIC_FIELD:
+    case CHRE_SENSOR_TYPE_UNCALIBRATED_ACCELEROMETER:
+    case CHRE_SENSOR_TYPE_UNCALIBRATED_GYROSCOPE:
+    case CHRE_SENSOR_TYPE_UNCALIBRATED_GEOMAGNETIC_FIELD:
+      return sizeof(chreSensorThreeAxisData::readings[0]);
+    case CHRE_SENSOR_TYPE_PRESSURE:
+    case CHRE_SENSOR_TYPE_ACCELEROMETER_TEMPERATURE:
+    case CHRE_SENSOR_TYPE_GYROSCOPE_TEMPERATURE:
+    case CHRE_SENSOR_TYPE_GEOMAGNETIC_FIELD_TEMPERATURE:
+      return sizeof(chreSensorFloatData::readings[0]);
+    case CHRE_SENSOR_TYPE_STEP_DETECT:
+      return sizeof(chreSensorOccurrenceData::readings[0]);
+    default:
+      return 0;
+  }
+}
+
 const char *SensorTypeHelpers::getSensorTypeName(uint8_t sensorType) {
   if (isVendorSensorType(sensorType)) {
     return getVendorSensorTypeName(sensorType);
@@ -105,3 +105,41 @@ TEST(MemoryManager, NegativeAllocationFails) {
   EXPECT_EQ(manager.getTotalAllocatedBytes(), 0u);
   EXPECT_EQ(manager.getAllocationCount(), 0u);
 }
+
+TEST(MemoryManager, FreeInAnyOrderKeepsListConsistent) {
+  MemoryManager manager;
+  Nanoapp app;
+  void *ptrs[4];
+  for (void *&ptr : ptrs) {
+    ptr = manager.nanoappAlloc(&app, 8u);
+    ASSERT_NE(ptr, nullptr);
+  }
+
+  // Free a block in the middle, the oldest and the newest block.
+  manager.nanoappFree(&app, ptrs[1]);
+  manager.nanoappFree(&app, ptrs[0]);
+  manager.nanoappFree(&app, ptrs[3]);
+  EXPECT_EQ(manager.getAllocationCount(), 1u);
+
+  EXPECT_EQ(manager.nanoappFreeAll(&app), 1u);
+  EXPECT_EQ(manager.getAllocationCount(), 0u);
+  EXPECT_EQ(app.getFirstHeapBlock(), nullptr);
+}
+
+TEST(MemoryManager, FreeFromOtherNanoappUnlinksFromOwner) {
+  MemoryManager manager;
+  Nanoapp owner;
+  Nanoapp other;
+  void *first = manager.nanoappAlloc(&owner, 8u);
+  void *second = manager.nanoappAlloc(&owner, 8u);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+
+  // The most recently allocated block is at the head of the owner's list.
+  manager.nanoappFree(&other, second);
+  EXPECT_EQ(manager.getAllocationCount(), 1u);
+
+  EXPECT_EQ(manager.nanoappFreeAll(&owner), 1u);
+  EXPECT_EQ(manager.getAllocationCount(), 0u);
+  EXPECT_EQ(owner.getFirstHeapBlock(), nullptr);
+}
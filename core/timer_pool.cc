@@ -35,8 +35,8 @@ TimerHandle TimerPool::setSystemTimer(Nanoseconds duration,
                                       void *data) {
   CHRE_ASSERT(callback != nullptr);
   TimerHandle timerHandle =
-      setTimer(kSystemInstanceId, duration, data, callback, callbackType,
-               true /* isOneShot */);
+      setTimer(kSystemInstanceId, duration, Nanoseconds(0) /* slack */, data,
+               callback, callbackType, true /* isOneShot */);
 
   if (timerHandle == CHRE_TIMER_INVALID) {
     FATAL_ERROR("Failed to set system timer");
@@ -65,7 +65,7 @@ uint32_t TimerPool::cancelAllNanoappTimers(const Nanoapp *nanoapp) {
 }
 
 TimerHandle TimerPool::setTimer(uint16_t instanceId, Nanoseconds duration,
-                                const void *cookie,
+                                Nanoseconds slack, const void *cookie,
                                 SystemEventCallbackFunction *systemCallback,
                                 SystemCallbackType callbackType,
                                 bool isOneShot) {
@@ -76,21 +76,22 @@ TimerHandle TimerPool::setTimer(uint16_t instanceId, Nanoseconds duration,
   timerRequest.timerHandle = generateTimerHandleLocked();
   timerRequest.expirationTime = SystemTime::getMonotonicTime() + duration;
   timerRequest.duration = duration;
+  timerRequest.slack = (slack > kCoalescingSlack) ? slack : kCoalescingSlack;
   timerRequest.cookie = cookie;
   timerRequest.systemCallback = systemCallback;
   timerRequest.callbackType = callbackType;
   timerRequest.isOneShot = isOneShot;
 
-  bool newTimerExpiresEarliest =
-      (!mTimerRequests.empty() && mTimerRequests.top() > timerRequest);
   bool success = insertTimerRequestLocked(timerRequest);
 
   if (success) {
-    if (newTimerExpiresEarliest) {
-      mSystemTimer.set(handleSystemTimerCallback, this, duration);
-    } else if (mTimerRequests.size() == 1) {
+    if (mTimerRequests.size() == 1) {
       // If this timer request was the first, schedule it.
       handleExpiredTimersAndScheduleNextLocked();
+    } else if (timerRequest.getDeadline() < mNextWakeupTime) {
+      mNextWakeupTime = timerRequest.getDeadline();
+      mSystemTimer.set(handleSystemTimerCallback, this,
+                       duration + timerRequest.slack);
     }
   }
 
@@ -119,6 +120,16 @@ bool TimerPool::cancelTimer(uint16_t instanceId, TimerHandle timerHandle) {
 
 TimerPool::TimerRequest *TimerPool::getTimerRequestByTimerHandleLocked(
     TimerHandle timerHandle, size_t *index) {
+#ifdef CHRE_INDEXED_TIMER_POOL_ENABLED
+  size_t i = mTimerRequests.getIndexOfSlot(timerHandle % kMaxTimerRequests);
+  if (i < mTimerRequests.size() &&
+      mTimerRequests[i].timerHandle == timerHandle) {
+    if (index != nullptr) {
+      *index = i;
+    }
+    return &mTimerRequests[i];
+  }
+#else
   for (size_t i = 0; i < mTimerRequests.size(); i++) {
     if (mTimerRequests[i].timerHandle == timerHandle) {
       if (index != nullptr) {
@@ -127,6 +138,7 @@ TimerPool::TimerRequest *TimerPool::getTimerRequestByTimerHandleLocked(
       return &mTimerRequests[i];
     }
   }
+#endif
 
   return nullptr;
 }
@@ -135,6 +147,32 @@ bool TimerPool::TimerRequest::operator>(const TimerRequest &request) const {
   return (expirationTime > request.expirationTime);
 }
 
+Nanoseconds TimerPool::TimerRequest::getDeadline() const {
+  uint64_t expirationNs = expirationTime.toRawNanoseconds();
+  uint64_t slackNs = slack.toRawNanoseconds();
+  return (slackNs > UINT64_MAX - expirationNs) ? Nanoseconds(UINT64_MAX)
+                                               : expirationTime + slack;
+}
+
+#ifdef CHRE_INDEXED_TIMER_POOL_ENABLED
+TimerHandle TimerPool::generateTimerHandleLocked() {
+  // Handle arithmetic wraps around, which preserves the slot in the lower bits
+  // as long as the number of slots is a power of two.
+  static_assert((kMaxTimerRequests & (kMaxTimerRequests - 1)) == 0,
+                "Max number of timer requests must be a power of two");
+
+  // The handle is unique among outstanding requests as no other request can
+  // occupy the same slot. If the queue is full, the handle is never returned
+  // as the insertion will fail.
+  TimerHandle slot = static_cast<TimerHandle>(mTimerRequests.getNextFreeSlot());
+  TimerHandle timerHandle;
+  do {
+    timerHandle = mTimerHandleGeneration++ * kMaxTimerRequests + slot;
+  } while (timerHandle == CHRE_TIMER_INVALID);
+
+  return timerHandle;
+}
+#else
 TimerHandle TimerPool::generateTimerHandleLocked() {
   TimerHandle timerHandle;
   if (mGenerateTimerHandleMustCheckUniqueness) {
@@ -166,6 +204,7 @@ TimerHandle TimerPool::generateUniqueTimerHandleLocked() {
     }
   }
 }
+#endif
 
 bool TimerPool::isNewTimerAllowedLocked(bool isNanoappTimer) const {
   static_assert(kMaxNanoappTimers <= kMaxTimerRequests,
@@ -219,12 +258,14 @@ void TimerPool::removeTimerRequestLocked(size_t index) {
   if (index < mTimerRequests.size()) {
     bool isNanoappTimer =
         (mTimerRequests[index].instanceId != kSystemInstanceId);
+    bool setsNextWakeup =
+        (mTimerRequests[index].getDeadline() == mNextWakeupTime);
     mTimerRequests.remove(index);
     if (isNanoappTimer) {
       mNumNanoappTimers--;
     }
 
-    if (index == 0) {
+    if (setsNextWakeup) {
       mSystemTimer.cancel();
       handleExpiredTimersAndScheduleNextLocked();
     }
@@ -237,10 +278,11 @@ bool TimerPool::handleExpiredTimersAndScheduleNext() {
 }
 
 bool TimerPool::handleExpiredTimersAndScheduleNextLocked() {
-  bool handledExpiredTimer = false;
+  uint32_t numTimersFired = 0;
+  Nanoseconds currentTime = SystemTime::getMonotonicTime();
 
   while (!mTimerRequests.empty()) {
-    Nanoseconds currentTime = SystemTime::getMonotonicTime();
+    currentTime = SystemTime::getMonotonicTime();
     TimerRequest &currentTimerRequest = mTimerRequests.top();
     if (currentTime >= currentTimerRequest.expirationTime) {
       // This timer has expired, so post an event if it is a nanoapp timer, or
@@ -255,7 +297,7 @@ bool TimerPool::handleExpiredTimersAndScheduleNextLocked() {
             CHRE_EVENT_TIMER, const_cast<void *>(currentTimerRequest.cookie),
             nullptr /*freeCallback*/, currentTimerRequest.instanceId);
       }
-      handledExpiredTimer = true;
+      numTimersFired++;
 
       // Reschedule the timer if needed, and release the current request.
       if (!currentTimerRequest.isOneShot) {
@@ -264,23 +306,68 @@ bool TimerPool::handleExpiredTimersAndScheduleNextLocked() {
         // insert operation (thereby invalidating it).
         TimerRequest cyclicTimerRequest = currentTimerRequest;
         cyclicTimerRequest.expirationTime =
-            currentTime + currentTimerRequest.duration;
+            getNextPeriodicExpirationTime(currentTimerRequest, currentTime);
         popTimerRequestLocked();
         CHRE_ASSERT(insertTimerRequestLocked(cyclicTimerRequest));
       } else {
         popTimerRequestLocked();
       }
     } else {
-      // Update the system timer to reflect the duration until the closest
-      // expiry (mTimerRequests is sorted by expiry, so we just do this for
-      // the first timer found which has not expired yet)
-      Nanoseconds duration = currentTimerRequest.expirationTime - currentTime;
-      mSystemTimer.set(handleSystemTimerCallback, this, duration);
       break;
     }
   }
 
-  return handledExpiredTimer;
+  if (numTimersFired > 0) {
+    mNumUncoalescedTimerFires++;
+    mNumCoalescedTimerFires += numTimersFired - 1;
+  }
+  scheduleNextWakeupLocked(currentTime);
+
+  return numTimersFired > 0;
+}
+
+Nanoseconds TimerPool::getNextPeriodicExpirationTime(
+    const TimerRequest &timerRequest, Nanoseconds currentTime) {
+  // Advance from the previous expiration rather than the current time, so the
+  // timer doesn't drift by the dispatch latency and slack every period.
+  uint64_t expirationNs = timerRequest.expirationTime.toRawNanoseconds() +
+                          timerRequest.duration.toRawNanoseconds();
+  uint64_t periodNs = timerRequest.duration.toRawNanoseconds();
+  uint64_t currentNs = currentTime.toRawNanoseconds();
+  if (expirationNs <= currentNs && periodNs > 0) {
+    // Skip the periods that were missed entirely instead of firing them in a
+    // burst.
+    expirationNs += ((currentNs - expirationNs) / periodNs + 1) * periodNs;
+  }
+  return Nanoseconds(expirationNs);
+}
+
+void TimerPool::scheduleNextWakeupLocked(Nanoseconds currentTime) {
+  if (mTimerRequests.empty()) {
+    mNextWakeupTime = kNoWakeupScheduled;
+    return;
+  }
+
+  // mTimerRequests is sorted by expiry, so the first timer has the earliest
+  // deadline unless its slack is larger than the minimum. Deferring the wakeup
+  // to the deadline lets any timers expiring in the meantime fire along with
+  // this one.
+  const TimerRequest &firstTimerRequest = mTimerRequests.top();
+  Nanoseconds nextWakeupTime = firstTimerRequest.getDeadline();
+  if (firstTimerRequest.slack > kCoalescingSlack) {
+    for (size_t i = 1; i < mTimerRequests.size(); i++) {
+      Nanoseconds deadline = mTimerRequests[i].getDeadline();
+      if (deadline < nextWakeupTime) {
+        nextWakeupTime = deadline;
+      }
+    }
+  }
+
+  mNextWakeupTime = nextWakeupTime;
+  Nanoseconds duration = (nextWakeupTime > currentTime)
+                             ? nextWakeupTime - currentTime
+                             : Nanoseconds(0);
+  mSystemTimer.set(handleSystemTimerCallback, this, duration);
 }
 
 bool TimerPool::hasNanoappTimers(uint16_t instanceId) {
@@ -295,6 +382,13 @@ bool TimerPool::hasNanoappTimers(uint16_t instanceId) {
   return false;
 }
 
+void TimerPool::logStateToBuffer(DebugDumpWrapper &debugDump) const {
+  debugDump.print("\nTimer Pool:\n");
+  debugDump.print("  Timer fires: uncoalesced=%" PRIu32 " coalesced=%" PRIu32
+                  "\n",
+                  mNumUncoalescedTimerFires, mNumCoalescedTimerFires);
+}
+
 void TimerPool::handleSystemTimerCallback(void *timerPoolPtr) {
   auto callback = [](uint16_t /*type*/, void *data, void * /*extraData*/) {
     auto *timerPool = static_cast<TimerPool *>(data);
@@ -15,6 +15,7 @@
  */
 
 #include <signal.h>
+#include <chrono>
 #include <cstdlib>
 #include <fstream>
 
@@ -86,9 +87,14 @@ void ChreDaemonBase::loadPreloadedNanoapps() {
     return;
   }
 
+  auto startTime = std::chrono::steady_clock::now();
   for (uint32_t i = 0; i < nanoapps.size(); ++i) {
     loadPreloadedNanoapp(directory, nanoapps[i], i);
   }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - startTime);
+  LOGI("Preloaded %zu nanoapps in %lld ms", nanoapps.size(),
+       static_cast<long long>(elapsed.count()));
 }
 
 void ChreDaemonBase::loadPreloadedNanoapp(const std::string &directory,
@@ -128,6 +128,12 @@ void FbsDaemonBase::onMessageReceived(const unsigned char *messageBuffer,
     uint32_t numLogsDropped = logMessage->num_logs_dropped;
 
     getLogger().logV2(logData, logDataBuffer.size(), numLogsDropped);
+  } else if (messageType == fbs::ChreMessage::BatchedMessages) {
+    HostProtocolHost::unbatchMessages(
+        messageBuffer, messageLen,
+        [this](const uint8_t *message, size_t length) {
+          onMessageReceived(message, length);
+        });
   } else if (messageType == fbs::ChreMessage::TimeSyncRequest) {
     sendTimeSync(true /* logOnError */);
   } else if (messageType == fbs::ChreMessage::LowPowerMicAccessRequest) {
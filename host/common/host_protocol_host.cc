@@ -59,6 +59,13 @@ bool HostProtocolHost::decodeMessageFromChre(const void *message,
         handlers.handleNanoappMessage(*msg.AsNanoappMessage());
         break;
 
+      case fbs::ChreMessage::BatchedMessages:
+        for (const std::unique_ptr<fbs::NanoappMessageT> &nanoappMessage :
+             msg.AsBatchedMessages()->nanoapp_messages) {
+          handlers.handleNanoappMessage(*nanoappMessage);
+        }
+        break;
+
       case fbs::ChreMessage::HubInfoResponse:
         handlers.handleHubInfoResponse(*msg.AsHubInfoResponse());
         break;
@@ -181,6 +188,45 @@ bool HostProtocolHost::mutateHostClientId(void *message, size_t messageLen,
   return success;
 }
 
+bool HostProtocolHost::unbatchMessages(
+    const void *message, size_t messageLen,
+    const std::function<void(const uint8_t *message, size_t messageLen)>
+        &callback) {
+  if (!verifyMessage(message, messageLen)) {
+    LOGE("Message verification failed - can't unbatch messages");
+    return false;
+  }
+
+  const fbs::MessageContainer *container = fbs::GetMessageContainer(message);
+  const fbs::BatchedMessages *batch = container->message_as_BatchedMessages();
+  if (batch == nullptr) {
+    LOGE("Can't unbatch message of type %" PRIu8,
+         static_cast<uint8_t>(container->message_type()));
+    return false;
+  }
+
+  if (batch->nanoapp_messages() != nullptr) {
+    uint16_t hostClientId = container->host_addr()->client_id();
+    for (const fbs::NanoappMessage *nanoappMessage :
+         *batch->nanoapp_messages()) {
+      const flatbuffers::Vector<uint8_t> *payload = nanoappMessage->message();
+      constexpr size_t kFixedSizePortion = 80;
+      FlatBufferBuilder builder(payload->size() + kFixedSizePortion);
+      auto messageData = builder.CreateVector(payload->data(), payload->size());
+      auto unbatched = fbs::CreateNanoappMessage(
+          builder, nanoappMessage->app_id(), nanoappMessage->message_type(),
+          nanoappMessage->host_endpoint(), messageData,
+          nanoappMessage->message_permissions(), nanoappMessage->permissions(),
+          nanoappMessage->woke_host());
+      finalize(builder, fbs::ChreMessage::NanoappMessage, unbatched.Union(),
+               hostClientId);
+      callback(builder.GetBufferPointer(), builder.GetSize());
+    }
+  }
+
+  return true;
+}
+
 void HostProtocolHost::encodeLoadNanoappRequestForBinary(
     FlatBufferBuilder &builder, uint32_t transactionId, uint64_t appId,
     uint32_t appVersion, uint32_t appFlags, uint32_t targetApiVersion,
@@ -26,6 +26,21 @@
 #define CHRE_HOST_DEFAULT_FRAGMENT_SIZE (30 * 1024)
 #endif
 
+#ifndef CHRE_HOST_DEFAULT_FRAGMENT_WINDOW_SIZE
+// Send each fragment only once the previous one is acknowledged by default.
+// CHRE acknowledges fragments cumulatively, so a larger window lets the host
+// stream fragments without waiting for each response. It must not exceed
+// CHRE_NANOAPP_LOAD_FRAGMENT_WINDOW_SIZE if the link may reorder messages.
+#define CHRE_HOST_DEFAULT_FRAGMENT_WINDOW_SIZE 1
+#endif
+
+#ifndef CHRE_HOST_DEFAULT_CONCURRENT_LOAD_TRANSACTIONS
+// Load one nanoapp at a time by default. Up to
+// CHRE_MAX_CONCURRENT_NANOAPP_LOADS transactions may be in progress in CHRE,
+// beyond which the oldest one is abandoned.
+#define CHRE_HOST_DEFAULT_CONCURRENT_LOAD_TRANSACTIONS 1
+#endif
+
 namespace android {
 namespace chre {
 
@@ -129,6 +129,10 @@ struct DebugConfiguration;
 struct DebugConfigurationBuilder;
 struct DebugConfigurationT;
 
+struct BatchedMessages;
+struct BatchedMessagesBuilder;
+struct BatchedMessagesT;
+
 struct HostAddress;
 
 struct MessageContainer;
@@ -249,31 +253,34 @@ enum class LogType : int8_t {
   STRING = 0,
   TOKENIZED = 1,
   BLUETOOTH = 2,
+  STRUCTURED = 3,
   MIN = STRING,
-  MAX = BLUETOOTH
+  MAX = STRUCTURED
 };
 
-inline const LogType (&EnumValuesLogType())[3] {
+inline const LogType (&EnumValuesLogType())[4] {
   static const LogType values[] = {
     LogType::STRING,
     LogType::TOKENIZED,
-    LogType::BLUETOOTH
+    LogType::BLUETOOTH,
+    LogType::STRUCTURED
   };
   return values;
 }
 
 inline const char * const *EnumNamesLogType() {
-  static const char * const names[4] = {
+  static const char * const names[5] = {
     "STRING",
     "TOKENIZED",
     "BLUETOOTH",
+    "STRUCTURED",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameLogType(LogType e) {
-  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::BLUETOOTH)) return "";
+  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::STRUCTURED)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesLogType()[index];
 }
@@ -340,11 +347,12 @@ enum class ChreMessage : uint8_t {
   NanConfigurationRequest = 26,
   NanConfigurationUpdate = 27,
   DebugConfiguration = 28,
+  BatchedMessages = 29,
   MIN = NONE,
-  MAX = DebugConfiguration
+  MAX = BatchedMessages
 };
 
-inline const ChreMessage (&EnumValuesChreMessage())[29] {
+inline const ChreMessage (&EnumValuesChreMessage())[30] {
   static const ChreMessage values[] = {
     ChreMessage::NONE,
     ChreMessage::NanoappMessage,
@@ -374,13 +382,14 @@ inline const ChreMessage (&EnumValuesChreMessage())[29] {
     ChreMessage::BatchedMetricLog,
     ChreMessage::NanConfigurationRequest,
     ChreMessage::NanConfigurationUpdate,
-    ChreMessage::DebugConfiguration
+    ChreMessage::DebugConfiguration,
+    ChreMessage::BatchedMessages
   };
   return values;
 }
 
 inline const char * const *EnumNamesChreMessage() {
-  static const char * const names[30] = {
+  static const char * const names[31] = {
     "NONE",
     "NanoappMessage",
     "HubInfoRequest",
@@ -410,13 +419,14 @@ inline const char * const *EnumNamesChreMessage() {
     "NanConfigurationRequest",
     "NanConfigurationUpdate",
     "DebugConfiguration",
+    "BatchedMessages",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameChreMessage(ChreMessage e) {
-  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::DebugConfiguration)) return "";
+  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::BatchedMessages)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesChreMessage()[index];
 }
@@ -537,6 +547,10 @@ template<> struct ChreMessageTraits<chre::fbs::DebugConfiguration> {
   static const ChreMessage enum_value = ChreMessage::DebugConfiguration;
 };
 
+template<> struct ChreMessageTraits<chre::fbs::BatchedMessages> {
+  static const ChreMessage enum_value = ChreMessage::BatchedMessages;
+};
+
 struct ChreMessageUnion {
   ChreMessage type;
   void *value;
@@ -793,6 +807,14 @@ struct ChreMessageUnion {
     return type == ChreMessage::DebugConfiguration ?
       reinterpret_cast<const chre::fbs::DebugConfigurationT *>(value) : nullptr;
   }
+  chre::fbs::BatchedMessagesT *AsBatchedMessages() {
+    return type == ChreMessage::BatchedMessages ?
+      reinterpret_cast<chre::fbs::BatchedMessagesT *>(value) : nullptr;
+  }
+  const chre::fbs::BatchedMessagesT *AsBatchedMessages() const {
+    return type == ChreMessage::BatchedMessages ?
+      reinterpret_cast<const chre::fbs::BatchedMessagesT *>(value) : nullptr;
+  }
 };
 
 bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj, ChreMessage type);
@@ -2760,7 +2782,8 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   /// uint8_t                 - Log metadata, encoded as follows:
   ///                           [EI(Upper nibble) | Level(Lower nibble)]
   ///                            * Log Type
-  ///                              (0 = No encoding, 1 = Tokenized log, 2 = BT snoop log)
+  ///                              (0 = No encoding, 1 = Tokenized log, 2 = BT snoop log,
+  ///                               3 = Structured log)
   ///                            * LogBuffer log level (1 = error, 2 = warn,
   ///                                                   3 = info,  4 = debug,
   ///                                                   5 = verbose)
@@ -2786,6 +2809,14 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   ///   size 24 bytes were to be represented, a buffer of size 26 bytes would
   ///   be needed to encode this as: [Direction(1B) | Size(1B) | Data(24B)].
   ///
+  /// * Structured logs: The log buffer is laid out like an encoded log,
+  ///   [Size(1B) | Data], where the data is the NULL terminated printf format
+  ///   string followed by the arguments to format it with on the host. Each
+  ///   argument is encoded according to its conversion: signed integers as
+  ///   zigzag varints, unsigned integers, characters and pointers as varints,
+  ///   floating point values as little-endian doubles, and strings as
+  ///   [Length(1B) | Characters].
+  ///
   /// This pattern repeats until the end of the buffer for multiple log
   /// messages. The last byte will always be a null-terminator. There are no
   /// padding bytes between these fields. Treat this like a packed struct and be
@@ -3479,6 +3510,75 @@ inline flatbuffers::Offset<DebugConfiguration> CreateDebugConfiguration(
 
 flatbuffers::Offset<DebugConfiguration> CreateDebugConfiguration(flatbuffers::FlatBufferBuilder &_fbb, const DebugConfigurationT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
 
+struct BatchedMessagesT : public flatbuffers::NativeTable {
+  typedef BatchedMessages TableType;
+  std::vector<std::unique_ptr<chre::fbs::NanoappMessageT>> nanoapp_messages;
+  BatchedMessagesT() {
+  }
+};
+
+struct BatchedMessages FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef BatchedMessagesT NativeTableType;
+  typedef BatchedMessagesBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_NANOAPP_MESSAGES = 4
+  };
+  const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *nanoapp_messages() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *>(VT_NANOAPP_MESSAGES);
+  }
+  flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *mutable_nanoapp_messages() {
+    return GetPointer<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *>(VT_NANOAPP_MESSAGES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_NANOAPP_MESSAGES) &&
+           verifier.VerifyVector(nanoapp_messages()) &&
+           verifier.VerifyVectorOfTables(nanoapp_messages()) &&
+           verifier.EndTable();
+  }
+  BatchedMessagesT *UnPack(const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  void UnPackTo(BatchedMessagesT *_o, const flatbuffers::resolver_function_t *_resolver = nullptr) const;
+  static flatbuffers::Offset<BatchedMessages> Pack(flatbuffers::FlatBufferBuilder &_fbb, const BatchedMessagesT* _o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+};
+
+struct BatchedMessagesBuilder {
+  typedef BatchedMessages Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_nanoapp_messages(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> nanoapp_messages) {
+    fbb_.AddOffset(BatchedMessages::VT_NANOAPP_MESSAGES, nanoapp_messages);
+  }
+  explicit BatchedMessagesBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  BatchedMessagesBuilder &operator=(const BatchedMessagesBuilder &);
+  flatbuffers::Offset<BatchedMessages> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<BatchedMessages>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<BatchedMessages> CreateBatchedMessages(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> nanoapp_messages = 0) {
+  BatchedMessagesBuilder builder_(_fbb);
+  builder_.add_nanoapp_messages(nanoapp_messages);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<BatchedMessages> CreateBatchedMessagesDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *nanoapp_messages = nullptr) {
+  auto nanoapp_messages__ = nanoapp_messages ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::NanoappMessage>>(*nanoapp_messages) : 0;
+  return chre::fbs::CreateBatchedMessages(
+      _fbb,
+      nanoapp_messages__);
+}
+
+flatbuffers::Offset<BatchedMessages> CreateBatchedMessages(flatbuffers::FlatBufferBuilder &_fbb, const BatchedMessagesT *_o, const flatbuffers::rehasher_function_t *_rehasher = nullptr);
+
 struct MessageContainerT : public flatbuffers::NativeTable {
   typedef MessageContainer TableType;
   chre::fbs::ChreMessageUnion message;
@@ -3589,6 +3689,9 @@ struct MessageContainer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const chre::fbs::DebugConfiguration *message_as_DebugConfiguration() const {
     return message_type() == chre::fbs::ChreMessage::DebugConfiguration ? static_cast<const chre::fbs::DebugConfiguration *>(message()) : nullptr;
   }
+  const chre::fbs::BatchedMessages *message_as_BatchedMessages() const {
+    return message_type() == chre::fbs::ChreMessage::BatchedMessages ? static_cast<const chre::fbs::BatchedMessages *>(message()) : nullptr;
+  }
   void *mutable_message() {
     return GetPointer<void *>(VT_MESSAGE);
   }
@@ -3729,6 +3832,10 @@ template<> inline const chre::fbs::DebugConfiguration *MessageContainer::message
   return message_as_DebugConfiguration();
 }
 
+template<> inline const chre::fbs::BatchedMessages *MessageContainer::message_as<chre::fbs::BatchedMessages>() const {
+  return message_as_BatchedMessages();
+}
+
 struct MessageContainerBuilder {
   typedef MessageContainer Table;
   flatbuffers::FlatBufferBuilder &fbb_;
@@ -4661,6 +4768,32 @@ inline flatbuffers::Offset<DebugConfiguration> CreateDebugConfiguration(flatbuff
       _health_monitor_failure_crash);
 }
 
+inline BatchedMessagesT *BatchedMessages::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
+  std::unique_ptr<chre::fbs::BatchedMessagesT> _o = std::unique_ptr<chre::fbs::BatchedMessagesT>(new BatchedMessagesT());
+  UnPackTo(_o.get(), _resolver);
+  return _o.release();
+}
+
+inline void BatchedMessages::UnPackTo(BatchedMessagesT *_o, const flatbuffers::resolver_function_t *_resolver) const {
+  (void)_o;
+  (void)_resolver;
+  { auto _e = nanoapp_messages(); if (_e) { _o->nanoapp_messages.resize(_e->size()); for (flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->nanoapp_messages[_i] = std::unique_ptr<chre::fbs::NanoappMessageT>(_e->Get(_i)->UnPack(_resolver)); } } }
+}
+
+inline flatbuffers::Offset<BatchedMessages> BatchedMessages::Pack(flatbuffers::FlatBufferBuilder &_fbb, const BatchedMessagesT* _o, const flatbuffers::rehasher_function_t *_rehasher) {
+  return CreateBatchedMessages(_fbb, _o, _rehasher);
+}
+
+inline flatbuffers::Offset<BatchedMessages> CreateBatchedMessages(flatbuffers::FlatBufferBuilder &_fbb, const BatchedMessagesT *_o, const flatbuffers::rehasher_function_t *_rehasher) {
+  (void)_rehasher;
+  (void)_o;
+  struct _VectorArgs { flatbuffers::FlatBufferBuilder *__fbb; const BatchedMessagesT* __o; const flatbuffers::rehasher_function_t *__rehasher; } _va = { &_fbb, _o, _rehasher}; (void)_va;
+  auto _nanoapp_messages = _o->nanoapp_messages.size() ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::NanoappMessage>> (_o->nanoapp_messages.size(), [](size_t i, _VectorArgs *__va) { return CreateNanoappMessage(*__va->__fbb, __va->__o->nanoapp_messages[i].get(), __va->__rehasher); }, &_va ) : 0;
+  return chre::fbs::CreateBatchedMessages(
+      _fbb,
+      _nanoapp_messages);
+}
+
 inline MessageContainerT *MessageContainer::UnPack(const flatbuffers::resolver_function_t *_resolver) const {
   std::unique_ptr<chre::fbs::MessageContainerT> _o = std::unique_ptr<chre::fbs::MessageContainerT>(new MessageContainerT());
   UnPackTo(_o.get(), _resolver);
@@ -4810,6 +4943,10 @@ inline bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj,
       auto ptr = reinterpret_cast<const chre::fbs::DebugConfiguration *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case ChreMessage::BatchedMessages: {
+      auto ptr = reinterpret_cast<const chre::fbs::BatchedMessages *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return true;
   }
 }
@@ -4940,6 +5077,10 @@ inline void *ChreMessageUnion::UnPack(const void *obj, ChreMessage type, const f
       auto ptr = reinterpret_cast<const chre::fbs::DebugConfiguration *>(obj);
       return ptr->UnPack(resolver);
     }
+    case ChreMessage::BatchedMessages: {
+      auto ptr = reinterpret_cast<const chre::fbs::BatchedMessages *>(obj);
+      return ptr->UnPack(resolver);
+    }
     default: return nullptr;
   }
 }
@@ -5058,6 +5199,10 @@ inline flatbuffers::Offset<void> ChreMessageUnion::Pack(flatbuffers::FlatBufferB
       auto ptr = reinterpret_cast<const chre::fbs::DebugConfigurationT *>(value);
       return CreateDebugConfiguration(_fbb, ptr, _rehasher).Union();
     }
+    case ChreMessage::BatchedMessages: {
+      auto ptr = reinterpret_cast<const chre::fbs::BatchedMessagesT *>(value);
+      return CreateBatchedMessages(_fbb, ptr, _rehasher).Union();
+    }
     default: return 0;
   }
 }
@@ -5176,6 +5321,10 @@ inline ChreMessageUnion::ChreMessageUnion(const ChreMessageUnion &u) : type(u.ty
       value = new chre::fbs::DebugConfigurationT(*reinterpret_cast<chre::fbs::DebugConfigurationT *>(u.value));
       break;
     }
+    case ChreMessage::BatchedMessages: {
+      FLATBUFFERS_ASSERT(false);  // chre::fbs::BatchedMessagesT not copyable.
+      break;
+    }
     default:
       break;
   }
@@ -5323,6 +5472,11 @@ inline void ChreMessageUnion::Reset() {
       delete ptr;
       break;
     }
+    case ChreMessage::BatchedMessages: {
+      auto ptr = reinterpret_cast<chre::fbs::BatchedMessagesT *>(value);
+      delete ptr;
+      break;
+    }
     default: break;
   }
   value = nullptr;
@@ -25,6 +25,7 @@
 #include "chre_host/generated/host_messages_generated.h"
 #include "flatbuffers/flatbuffers.h"
 
+#include <functional>
 #include <vector>
 
 namespace android {
@@ -200,6 +201,23 @@ class HostProtocolHost : public ::chre::HostProtocolCommon {
   static bool mutateHostClientId(void *message, size_t messageLen,
                                  uint16_t hostClientId);
 
+  /**
+   * Splits a BatchedMessages container received from CHRE into a standalone
+   * MessageContainer for each message it carries, addressed to the same host
+   * client ID as the batch, so each can be handled as if it had been sent on
+   * its own.
+   *
+   * @param message Buffer containing a complete FlatBuffers CHRE message
+   * @param messageLen Size of the message, in bytes
+   * @param callback Invoked with each of the unbatched messages, in order
+   *
+   * @return true if the message was a valid BatchedMessages container
+   */
+  static bool unbatchMessages(
+      const void *message, size_t messageLen,
+      const std::function<void(const uint8_t *message, size_t messageLen)>
+          &callback);
+
   /**
    * Encodes a message requesting to load a nanoapp specified by the included
    * binary payload and metadata.
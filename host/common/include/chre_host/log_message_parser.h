@@ -20,6 +20,7 @@
 #include <endian.h>
 #include <cinttypes>
 #include <memory>
+#include <string>
 #include "chre/util/time.h"
 #include "chre_host/bt_snoop_log_parser.h"
 
@@ -66,6 +67,19 @@ class LogMessageParser {
    */
   void dump(const uint8_t *logBuffer, size_t logBufferSize);
 
+  /**
+   * Formats the data of a structured log, i.e. a printf format string followed
+   * by the encoded values of its arguments (see LogMessageData in
+   * host_messages.fbs).
+   *
+   * @param data The data of the structured log, after its size byte.
+   * @param size The size of the data.
+   * @param formattedLog Set to the formatted log message.
+   * @return false if the data could not be decoded.
+   */
+  static bool formatStructuredLog(const uint8_t *data, size_t size,
+                                  std::string &formattedLog);
+
  private:
   static constexpr char kHubLogFormatStr[] = "@ %3" PRIu32 ".%03" PRIu32 ": %s";
 
@@ -127,6 +141,19 @@ class LogMessageParser {
    */
   size_t parseAndEmitTokenizedLogMessageAndGetSize(const LogMessageV2 *message);
 
+  /**
+   * Parses and emits a structured log message, formatting it on the host,
+   * while also returning the size of the parsed message for buffer index
+   * bookkeeping.
+   *
+   * @param maxLogMessageSize The number of bytes left in the log buffer for
+   *        the message payload.
+   * @return Size of the structured log message payload, including its 1 byte
+   *         size header, or 0 if the payload overruns the log buffer.
+   */
+  size_t parseAndEmitStructuredLogMessageAndGetSize(const LogMessageV2 *message,
+                                                    size_t maxLogMessageSize);
+
   void emitLogMessage(uint8_t level, uint32_t timestampMillis,
                       const char *logMessage);
 
@@ -171,6 +198,17 @@ class LogMessageParser {
    * @return true if the log message type is BT Snoop log.
    */
   bool isBtSnoopLogMessage(uint8_t metadata);
+
+  /**
+   * Helper function to check the metadata whether the log message is a
+   * structured log, formatted on the host.
+   *
+   * @param metadata A byte from the log message payload containing the
+   *        log level and log type information.
+   *
+   * @return true if the log message type is structured log.
+   */
+  bool isStructuredLogMessage(uint8_t metadata);
 };
 
 }  // namespace chre
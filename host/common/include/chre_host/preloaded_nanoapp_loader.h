@@ -18,11 +18,14 @@
 #define CHRE_HOST_PRELOADED_NANOAPP_LOADER_H_
 
 #include <android/binder_to_string.h>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <map>
 #include <mutex>
-#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "chre_connection.h"
 #include "chre_host/generated/host_messages_generated.h"
@@ -59,7 +62,9 @@ class PreloadedNanoappLoader {
    *     "/path/to/nanoapp_2"
    * ]}
    *
-   * The napp_header and so files will both be used.
+   * The napp_header and so files will both be used. Up to
+   * ChreConnection::getMaxConcurrentLoadTransactions() nanoapps are loaded at
+   * once, and the files of the next nanoapp are read while one is being sent.
    */
   void loadPreloadedNanoapps();
 
@@ -78,18 +83,37 @@ class PreloadedNanoappLoader {
   /** Timeout value of waiting for the response of a fragmented load */
   static constexpr auto kTimeoutInMs = std::chrono::milliseconds(2000);
 
+  /** The files of a preloaded nanoapp. */
+  struct PreloadedNanoappFiles {
+    bool success = false;
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> binary;
+  };
+
   /**
-   * Loads a preloaded nanoapp given a filename.
-   *
-   * This function allows the transaction to complete before the nanoapp starts
-   * so the server can start serving requests as soon as possible.
+   * Reads the files of a preloaded nanoapp.
    *
    * @param directory The directory to load the nanoapp from.
    * @param name The filename of the nanoapp to load.
-   * @param transactionId The transaction ID to use when loading the app.
    */
-  void loadPreloadedNanoapp(const std::string &directory,
-                            const std::string &name, uint32_t transactionId);
+  static PreloadedNanoappFiles readPreloadedNanoappFiles(
+      const std::string &directory, const std::string &name);
+
+  /**
+   * Loads preloaded nanoapps one at a time until all of them are taken,
+   * reading the files of the next one while the current one is being sent.
+   *
+   * This function allows each transaction to complete before the nanoapp
+   * starts so the server can start serving requests as soon as possible.
+   *
+   * @param directory The directory to load the nanoapps from.
+   * @param names The filenames of the nanoapps to load.
+   * @param nextIndex The index of the next nanoapp to load, shared by all
+   *        callers loading from the same list and used as transaction ID.
+   */
+  void loadPreloadedNanoappsInOrder(const std::string &directory,
+                                    const std::vector<std::string> &names,
+                                    std::atomic<uint32_t> &nextIndex);
 
   /**
    * Loads a preloaded nanoapp.
@@ -103,40 +127,51 @@ class PreloadedNanoappLoader {
                    const std::vector<uint8_t> &nanoapp, uint32_t transactionId);
 
   /**
-   * Chunks the nanoapp binary into fragments and load each fragment
-   * sequentially.
+   * Chunks the nanoapp binary into fragments and loads them in order, keeping
+   * up to ChreConnection::getLoadFragmentWindowSize() fragments awaiting a
+   * response from CHRE.
    */
   bool sendFragmentedLoadAndWaitForEachResponse(
       uint64_t appId, uint32_t appVersion, uint32_t appFlags,
-      uint32_t appTargetApiVersion, const uint8_t *appBinary, size_t appSize,
+      uint32_t appTargetApiVersion, const std::vector<uint8_t> &appBinary,
       uint32_t transactionId);
 
-  /** Sends the FragmentedLoadRequest to CHRE. */
-  std::future<bool> sendFragmentedLoadRequest(
-      ::android::chre::FragmentedLoadRequest &request);
-
-  /** Verifies the future returned by sendFragmentedLoadRequest(). */
-  [[nodiscard]] static bool waitAndVerifyFuture(
-      std::future<bool> &future, const FragmentedLoadRequest &request);
-
-  /** Verifies the response of a loading request. */
-  [[nodiscard]] bool verifyFragmentLoadResponse(
-      const ::chre::fbs::LoadNanoappResponseT &response) const;
+  /**
+   * Sends the FragmentedLoadRequest to CHRE. Must be called with
+   * mPreloadedNanoappsMutex held.
+   */
+  bool sendFragmentedLoadRequest(
+      const ::android::chre::FragmentedLoadRequest &request);
 
-  /** Tracks the transaction state of the ongoing nanoapp loading */
+  /** Tracks the transaction state of an ongoing nanoapp loading */
   struct Transaction {
     uint32_t transactionId;
-    size_t fragmentId;
+    /** The ID of the last fragment sent to CHRE. */
+    size_t lastSentFragmentId;
+    /**
+     * The ID of the last fragment acknowledged by CHRE. Acknowledgements are
+     * cumulative, so all the fragments before it were accepted too.
+     */
+    size_t lastAckedFragmentId;
+    /** True if CHRE rejected a fragment of this transaction. */
+    bool failed;
   };
-  Transaction mPreloadedNanoappPendingTransaction{0, 0};
 
-  /** The value of this promise carries the result in the load response. */
-  std::optional<std::promise<bool>> mFragmentedLoadPromise = std::nullopt;
+  /** Verifies the response of a loading request for a pending transaction. */
+  [[nodiscard]] static bool verifyFragmentLoadResponse(
+      const ::chre::fbs::LoadNanoappResponseT &response,
+      const Transaction &pending);
+
+  /** The transactions in progress, by transaction ID. */
+  std::map<uint32_t, Transaction> mPreloadedNanoappPendingTransactions;
+
+  /** Notified when a pending transaction receives a response. */
+  std::condition_variable mFragmentResponseCondition;
 
   /** The mutex used to guard states change for preloading. */
   std::mutex mPreloadedNanoappsMutex;
 
-  bool mIsPreloadingOngoing = false;
+  std::atomic<bool> mIsPreloadingOngoing = false;
 
   ChreConnection *mConnection;
   std::string mConfigPath;
@@ -37,6 +37,32 @@ constexpr bool kVerboseLoggingEnabled = true;
 #else
 constexpr bool kVerboseLoggingEnabled = false;
 #endif
+
+//! Reads a little-endian base 128 varint argument of a structured log.
+bool readVarint(const uint8_t *&pos, const uint8_t *end, uint64_t &value) {
+  value = 0;
+  for (unsigned shift = 0; pos < end && shift < 64; shift += 7) {
+    uint8_t byte = *pos++;
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//! Appends a single conversion of a structured log, formatted with spec.
+template <typename T>
+void appendFormatted(std::string &formattedLog, const std::string &spec,
+                     T value) {
+  int length = snprintf(nullptr, 0, spec.c_str(), value);
+  if (length > 0) {
+    size_t offset = formattedLog.size();
+    formattedLog.resize(offset + length + 1);
+    snprintf(&formattedLog[offset], length + 1, spec.c_str(), value);
+    formattedLog.resize(offset + length);
+  }
+}
 }  // anonymous namespace
 
 LogMessageParser::LogMessageParser()
@@ -134,13 +160,19 @@ uint8_t LogMessageParser::getLogLevelFromMetadata(uint8_t metadata) {
 bool LogMessageParser::isLogMessageEncoded(uint8_t metadata) {
   // The upper nibble of the metadata denotes the encoding, as indicated
   // by the schema in host_messages.fbs.
-  return (metadata & 0x10) != 0;
+  return (metadata & 0xf0) == 0x10;
 }
 
 bool LogMessageParser::isBtSnoopLogMessage(uint8_t metadata) {
   // The upper nibble of the metadata denotes the encoding, as indicated
   // by the schema in host_messages.fbs.
-  return (metadata & 0x20) != 0;
+  return (metadata & 0xf0) == 0x20;
+}
+
+bool LogMessageParser::isStructuredLogMessage(uint8_t metadata) {
+  // The upper nibble of the metadata denotes the encoding, as indicated
+  // by the schema in host_messages.fbs.
+  return (metadata & 0xf0) == 0x30;
 }
 
 void LogMessageParser::log(const uint8_t *logBuffer, size_t logBufferSize) {
@@ -176,6 +208,158 @@ size_t LogMessageParser::parseAndEmitTokenizedLogMessageAndGetSize(
   return logMessageSize;
 }
 
+size_t LogMessageParser::parseAndEmitStructuredLogMessageAndGetSize(
+    const LogMessageV2 *message, size_t maxLogMessageSize) {
+  auto *encodedLog = reinterpret_cast<const EncodedLog *>(message->logMessage);
+  size_t logMessageSize = encodedLog->size + sizeof(struct EncodedLog);
+  if (maxLogMessageSize == 0 || logMessageSize > maxLogMessageSize) {
+    return 0;
+  }
+
+  auto *data = reinterpret_cast<const uint8_t *>(encodedLog->data);
+  std::string formattedLog;
+  if (!formatStructuredLog(data, encodedLog->size, formattedLog)) {
+    LOGE("Failed to decode structured log message");
+    formattedLog = "(undecodable structured log)";
+  }
+  emitLogMessage(getLogLevelFromMetadata(message->metadata),
+                 le32toh(message->timestampMillis), formattedLog.c_str());
+  return logMessageSize;
+}
+
+bool LogMessageParser::formatStructuredLog(const uint8_t *data, size_t size,
+                                           std::string &formattedLog) {
+  const char *format = reinterpret_cast<const char *>(data);
+  size_t formatLength = strnlen(format, size);
+  if (formatLength == size) {
+    return false;
+  }
+  const uint8_t *arg = data + formatLength + 1;
+  const uint8_t *end = data + size;
+
+  formattedLog.clear();
+  for (const char *pos = format; *pos != '\0'; ++pos) {
+    if (*pos != '%') {
+      formattedLog.push_back(*pos);
+      continue;
+    }
+    const char *specStart = pos++;
+    if (*pos == '%') {
+      formattedLog.push_back('%');
+      continue;
+    }
+
+    pos += strspn(pos, "-+ #0");
+    pos += strspn(pos, "0123456789");
+    if (*pos == '.') {
+      ++pos;
+      pos += strspn(pos, "0123456789");
+    }
+    // The flags, width and precision, which apply as is on the host.
+    std::string spec(specStart, pos);
+
+    // The length modifier, with 'H' and 'L' standing for "hh" and "ll". Values
+    // are encoded independently of their size on CHRE, so only "hh" and "h"
+    // need to be applied by truncating them.
+    char length = '\0';
+    if (*pos == 'h' || *pos == 'l') {
+      length = *pos++;
+      if (*pos == length) {
+        length = (length == 'h') ? 'H' : 'L';
+        ++pos;
+      }
+    } else if (*pos == 'j' || *pos == 'z' || *pos == 't') {
+      length = *pos++;
+    }
+
+    uint64_t value;
+    switch (*pos) {
+      case 'd':
+      case 'i': {
+        if (!readVarint(arg, end, value)) {
+          return false;
+        }
+        auto signedValue = static_cast<long long>((value >> 1) ^ -(value & 1));
+        if (length == 'H') {
+          signedValue = static_cast<signed char>(signedValue);
+        } else if (length == 'h') {
+          signedValue = static_cast<short>(signedValue);
+        }
+        appendFormatted(formattedLog, spec + "ll" + *pos, signedValue);
+        break;
+      }
+
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X': {
+        if (!readVarint(arg, end, value)) {
+          return false;
+        }
+        if (length == 'H') {
+          value = static_cast<unsigned char>(value);
+        } else if (length == 'h') {
+          value = static_cast<unsigned short>(value);
+        }
+        appendFormatted(formattedLog, spec + "ll" + *pos,
+                        static_cast<unsigned long long>(value));
+        break;
+      }
+
+      case 'c':
+        if (!readVarint(arg, end, value)) {
+          return false;
+        }
+        appendFormatted(formattedLog, spec + 'c', static_cast<int>(value));
+        break;
+
+      case 'p':
+        if (!readVarint(arg, end, value)) {
+          return false;
+        }
+        appendFormatted(
+            formattedLog, spec + 'p',
+            reinterpret_cast<void *>(static_cast<uintptr_t>(value)));
+        break;
+
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        double doubleValue;
+        if (end - arg < static_cast<ptrdiff_t>(sizeof(doubleValue))) {
+          return false;
+        }
+        memcpy(&value, arg, sizeof(value));
+        value = le64toh(value);
+        memcpy(&doubleValue, &value, sizeof(doubleValue));
+        arg += sizeof(doubleValue);
+        appendFormatted(formattedLog, spec + *pos, doubleValue);
+        break;
+      }
+
+      case 's': {
+        if (arg >= end || end - arg - 1 < *arg) {
+          return false;
+        }
+        std::string stringValue(reinterpret_cast<const char *>(arg + 1), *arg);
+        arg += 1 + *arg;
+        appendFormatted(formattedLog, spec + 's', stringValue.c_str());
+        break;
+      }
+
+      default:
+        return false;
+    }
+  }
+
+  return true;
+}
+
 void LogMessageParser::parseAndEmitLogMessage(const LogMessageV2 *message) {
   emitLogMessage(getLogLevelFromMetadata(message->metadata),
                  le32toh(message->timestampMillis), message->logMessage);
@@ -219,7 +403,16 @@ void LogMessageParser::logV2(const uint8_t *logBuffer, size_t logBufferSize,
         reinterpret_cast<const LogMessageV2 *>(&logBuffer[bufferIndex]);
 
     size_t logMessageSize = 0;
-    if (isBtSnoopLogMessage(message->metadata)) {
+    if (isStructuredLogMessage(message->metadata)) {
+      size_t maxLogMessageSize =
+          (logBufferSize - bufferIndex) - sizeof(LogMessageV2);
+      logMessageSize = parseAndEmitStructuredLogMessageAndGetSize(
+          message, maxLogMessageSize);
+      if (logMessageSize == 0) {
+        LOGE("Dropping log due to invalid buffer structure");
+        break;
+      }
+    } else if (isBtSnoopLogMessage(message->metadata)) {
       logMessageSize = mBtLogParser.log(message->logMessage);
     } else if (isLogMessageEncoded(message->metadata)) {
       logMessageSize = parseAndEmitTokenizedLogMessageAndGetSize(message);
@@ -16,7 +16,11 @@
 
 #include "chre_host/preloaded_nanoapp_loader.h"
 #include <chre_host/host_protocol_host.h>
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <future>
+#include <thread>
 #include "chre_host/config_util.h"
 #include "chre_host/file_stream.h"
 #include "chre_host/fragmented_load_transaction.h"
@@ -65,26 +69,74 @@ void PreloadedNanoappLoader::loadPreloadedNanoapps() {
     LOGE("Failed to load any preloaded nanoapp");
   } else {
     mIsPreloadingOngoing = true;
-    for (uint32_t i = 0; i < nanoapps.size(); ++i) {
-      loadPreloadedNanoapp(directory, nanoapps[i], i);
+    auto startTime = std::chrono::steady_clock::now();
+
+    const size_t numLoaders =
+        std::clamp<size_t>(mConnection->getMaxConcurrentLoadTransactions(), 1,
+                           std::max<size_t>(nanoapps.size(), 1));
+    std::atomic<uint32_t> nextIndex = 0;
+    std::vector<std::thread> loaders;
+    for (size_t i = 1; i < numLoaders; ++i) {
+      loaders.emplace_back([&]() {
+        loadPreloadedNanoappsInOrder(directory, nanoapps, nextIndex);
+      });
+    }
+    loadPreloadedNanoappsInOrder(directory, nanoapps, nextIndex);
+    for (std::thread &loader : loaders) {
+      loader.join();
     }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    LOGI("Preloaded %zu nanoapps in %lld ms with %zu concurrent loads",
+         nanoapps.size(), static_cast<long long>(elapsed.count()),
+         numLoaders);
     mIsPreloadingOngoing = false;
   }
 }
 
-void PreloadedNanoappLoader::loadPreloadedNanoapp(const std::string &directory,
-                                                  const std::string &name,
-                                                  uint32_t transactionId) {
-  std::vector<uint8_t> headerBuffer;
-  std::vector<uint8_t> nanoappBuffer;
-
+PreloadedNanoappLoader::PreloadedNanoappFiles
+PreloadedNanoappLoader::readPreloadedNanoappFiles(const std::string &directory,
+                                                  const std::string &name) {
+  PreloadedNanoappFiles files;
   std::string headerFilename = directory + "/" + name + ".napp_header";
   std::string nanoappFilename = directory + "/" + name + ".so";
+  files.success = readFileContents(headerFilename.c_str(), files.header) &&
+                  readFileContents(nanoappFilename.c_str(), files.binary);
+  return files;
+}
+
+void PreloadedNanoappLoader::loadPreloadedNanoappsInOrder(
+    const std::string &directory, const std::vector<std::string> &names,
+    std::atomic<uint32_t> &nextIndex) {
+  uint32_t index = nextIndex++;
+  if (index >= names.size()) {
+    return;
+  }
+  std::future<PreloadedNanoappFiles> nextFiles =
+      std::async(std::launch::async, readPreloadedNanoappFiles, directory,
+                 names[index]);
+
+  while (index < names.size()) {
+    PreloadedNanoappFiles files = nextFiles.get();
+
+    // Read the next nanoapp while this one is in flight
+    uint32_t followingIndex = nextIndex++;
+    if (followingIndex < names.size()) {
+      nextFiles = std::async(std::launch::async, readPreloadedNanoappFiles,
+                             directory, names[followingIndex]);
+    }
 
-  if (!readFileContents(headerFilename.c_str(), headerBuffer) ||
-      !readFileContents(nanoappFilename.c_str(), nanoappBuffer) ||
-      !loadNanoapp(headerBuffer, nanoappBuffer, transactionId)) {
-    LOGE("Failed to load nanoapp: '%s'", name.c_str());
+    auto startTime = std::chrono::steady_clock::now();
+    if (!files.success || !loadNanoapp(files.header, files.binary, index)) {
+      LOGE("Failed to load nanoapp: '%s'", names[index].c_str());
+    } else {
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::steady_clock::now() - startTime);
+      LOGI("Loaded nanoapp '%s' (%zu bytes) in %lld ms", names[index].c_str(),
+           files.binary.size(), static_cast<long long>(elapsed.count()));
+    }
+    index = followingIndex;
   }
 }
 
@@ -103,73 +155,90 @@ bool PreloadedNanoappLoader::loadNanoapp(const std::vector<uint8_t> &header,
                               (appHeader->targetChreApiMinorVersion << 16);
   return sendFragmentedLoadAndWaitForEachResponse(
       appHeader->appId, appHeader->appVersion, appHeader->flags,
-      targetApiVersion, nanoapp.data(), nanoapp.size(), transactionId);
+      targetApiVersion, nanoapp, transactionId);
 }
 
 bool PreloadedNanoappLoader::sendFragmentedLoadAndWaitForEachResponse(
     uint64_t appId, uint32_t appVersion, uint32_t appFlags,
-    uint32_t appTargetApiVersion, const uint8_t *appBinary, size_t appSize,
+    uint32_t appTargetApiVersion, const std::vector<uint8_t> &appBinary,
     uint32_t transactionId) {
-  std::vector<uint8_t> binary(appSize);
-  std::copy(appBinary, appBinary + appSize, binary.begin());
-
   FragmentedLoadTransaction transaction(transactionId, appId, appVersion,
-                                        appFlags, appTargetApiVersion, binary);
-  while (!transaction.isComplete()) {
-    auto nextRequest = transaction.getNextRequest();
-    auto future = sendFragmentedLoadRequest(nextRequest);
-    if (!waitAndVerifyFuture(future, nextRequest)) {
-      return false;
+                                        appFlags, appTargetApiVersion,
+                                        appBinary);
+  const size_t windowSize =
+      std::max<size_t>(mConnection->getLoadFragmentWindowSize(), 1);
+
+  std::unique_lock<std::mutex> lock(mPreloadedNanoappsMutex);
+  Transaction &pending = mPreloadedNanoappPendingTransactions[transactionId];
+  pending = {
+      .transactionId = transactionId,
+      .lastSentFragmentId = kNoFragmentId,
+      .lastAckedFragmentId = kNoFragmentId,
+      .failed = false,
+  };
+
+  bool success = true;
+  while (success) {
+    // Keep the window full, then wait for CHRE to acknowledge some of it
+    while (!transaction.isComplete() &&
+           pending.lastSentFragmentId - pending.lastAckedFragmentId <
+               windowSize) {
+      const FragmentedLoadRequest &request = transaction.getNextRequest();
+      if (!sendFragmentedLoadRequest(request)) {
+        LOGE("Failed to send out the fragmented load fragment");
+        success = false;
+        break;
+      }
+      pending.lastSentFragmentId = request.fragmentId;
+    }
+    if (!success ||
+        (transaction.isComplete() &&
+         pending.lastAckedFragmentId == pending.lastSentFragmentId)) {
+      break;
     }
-  }
-  return true;
-}
 
-bool PreloadedNanoappLoader::waitAndVerifyFuture(
-    std::future<bool> &future, const FragmentedLoadRequest &request) {
-  if (!future.valid()) {
-    LOGE("Failed to send out the fragmented load fragment");
-    return false;
-  }
-  if (future.wait_for(kTimeoutInMs) != std::future_status::ready) {
-    LOGE(
-        "Waiting for response of fragment %zu transaction %d times out "
-        "after %lld ms",
-        request.fragmentId, request.transactionId, kTimeoutInMs.count());
-    return false;
-  }
-  if (!future.get()) {
-    LOGE(
-        "Received a failure result for loading fragment %zu of "
-        "transaction %d",
-        request.fragmentId, request.transactionId);
-    return false;
+    size_t lastAckedFragmentId = pending.lastAckedFragmentId;
+    if (!mFragmentResponseCondition.wait_for(lock, kTimeoutInMs, [&]() {
+          return pending.failed ||
+                 pending.lastAckedFragmentId != lastAckedFragmentId;
+        })) {
+      LOGE(
+          "Waiting for response of fragment %zu transaction %d times out "
+          "after %lld ms",
+          lastAckedFragmentId + 1, transactionId, kTimeoutInMs.count());
+      success = false;
+    } else if (pending.failed) {
+      success = false;
+    }
   }
-  return true;
+
+  mPreloadedNanoappPendingTransactions.erase(transactionId);
+  return success;
 }
 
 bool PreloadedNanoappLoader::verifyFragmentLoadResponse(
-    const ::chre::fbs::LoadNanoappResponseT &response) const {
+    const ::chre::fbs::LoadNanoappResponseT &response,
+    const Transaction &pending) {
   if (!response.success) {
     LOGE("Loading nanoapp binary fragment %d of transaction %u failed.",
          response.fragment_id, response.transaction_id);
     // TODO(b/247124878): Report metrics.
     return false;
   }
-  if (mPreloadedNanoappPendingTransaction.transactionId !=
-      response.transaction_id) {
+  if (pending.transactionId != response.transaction_id) {
     LOGE(
         "Fragmented load response with transactionId %u but transactionId "
         "%u is expected",
-        response.transaction_id,
-        mPreloadedNanoappPendingTransaction.transactionId);
+        response.transaction_id, pending.transactionId);
     return false;
   }
-  if (mPreloadedNanoappPendingTransaction.fragmentId != response.fragment_id) {
+  if (response.fragment_id < pending.lastAckedFragmentId ||
+      response.fragment_id > pending.lastSentFragmentId) {
     LOGE(
         "Fragmented load response with unexpected fragment id %u while "
-        "%zu is expected",
-        response.fragment_id, mPreloadedNanoappPendingTransaction.fragmentId);
+        "%zu to %zu is expected",
+        response.fragment_id, pending.lastAckedFragmentId,
+        pending.lastSentFragmentId);
     return false;
   }
   return true;
@@ -178,7 +247,8 @@ bool PreloadedNanoappLoader::verifyFragmentLoadResponse(
 bool PreloadedNanoappLoader::onLoadNanoappResponse(
     const ::chre::fbs::LoadNanoappResponseT &response, HalClientId clientId) {
   std::unique_lock<std::mutex> lock(mPreloadedNanoappsMutex);
-  if (clientId != kHalId || !mFragmentedLoadPromise.has_value()) {
+  auto it = mPreloadedNanoappPendingTransactions.find(response.transaction_id);
+  if (clientId != kHalId || it == mPreloadedNanoappPendingTransactions.end()) {
     LOGE(
         "Received an unexpected preload nanoapp %s response for client %d "
         "transaction %u fragment %u",
@@ -186,15 +256,19 @@ bool PreloadedNanoappLoader::onLoadNanoappResponse(
         response.transaction_id, response.fragment_id);
     return false;
   }
-  // set value for the future instance
-  mFragmentedLoadPromise->set_value(verifyFragmentLoadResponse(response));
-  // reset the promise as the value can only be retrieved once from it
-  mFragmentedLoadPromise = std::nullopt;
+  Transaction &pending = it->second;
+  if (verifyFragmentLoadResponse(response, pending)) {
+    // A response acknowledges all the fragments up to the one it carries
+    pending.lastAckedFragmentId = response.fragment_id;
+  } else {
+    pending.failed = true;
+  }
+  mFragmentResponseCondition.notify_all();
   return true;
 }
 
-std::future<bool> PreloadedNanoappLoader::sendFragmentedLoadRequest(
-    ::android::chre::FragmentedLoadRequest &request) {
+bool PreloadedNanoappLoader::sendFragmentedLoadRequest(
+    const ::android::chre::FragmentedLoadRequest &request) {
   flatbuffers::FlatBufferBuilder builder(request.binary.size() + 128);
   // TODO(b/247124878): Confirm if respondBeforeStart can be set to true on all
   //  the devices.
@@ -202,17 +276,7 @@ std::future<bool> PreloadedNanoappLoader::sendFragmentedLoadRequest(
       builder, request, /* respondBeforeStart= */ true);
   HostProtocolHost::mutateHostClientId(builder.GetBufferPointer(),
                                        builder.GetSize(), kHalId);
-  std::unique_lock<std::mutex> lock(mPreloadedNanoappsMutex);
-  if (!mConnection->sendMessage(builder.GetBufferPointer(),
-                                builder.GetSize())) {
-    // Returns an invalid future to indicate the failure
-    return std::future<bool>{};
-  }
-  mPreloadedNanoappPendingTransaction = {
-      .transactionId = request.transactionId,
-      .fragmentId = request.fragmentId,
-  };
-  mFragmentedLoadPromise = std::make_optional<std::promise<bool>>();
-  return mFragmentedLoadPromise->get_future();
+  return mConnection->sendMessage(builder.GetBufferPointer(),
+                                  builder.GetSize());
 }
-}  // namespace android::chre
\ No newline at end of file
+}  // namespace android::chre
@@ -54,6 +54,24 @@ class ChreConnection {
     return CHRE_HOST_DEFAULT_FRAGMENT_SIZE;
   }
 
+  /**
+   * @return The number of nanoapp loading fragments that may await a response
+   * from CHRE at once.
+   */
+  virtual size_t getLoadFragmentWindowSize() const {
+    static_assert(CHRE_HOST_DEFAULT_FRAGMENT_WINDOW_SIZE > 0);
+    return CHRE_HOST_DEFAULT_FRAGMENT_WINDOW_SIZE;
+  }
+
+  /**
+   * @return The number of nanoapp load transactions that may be in progress at
+   * once.
+   */
+  virtual size_t getMaxConcurrentLoadTransactions() const {
+    static_assert(CHRE_HOST_DEFAULT_CONCURRENT_LOAD_TRANSACTIONS > 0);
+    return CHRE_HOST_DEFAULT_CONCURRENT_LOAD_TRANSACTIONS;
+  }
+
   /**
    * Sends a message encapsulated in a FlatBufferBuilder to CHRE.
    *
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/host_protocol_host.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace android::chre {
+namespace {
+
+using ::chre::fbs::ChreMessage;
+using ::flatbuffers::FlatBufferBuilder;
+using ::flatbuffers::Offset;
+
+constexpr uint16_t kHostClientId = 7;
+
+struct TestMessage {
+  uint64_t appId;
+  uint32_t messageType;
+  uint16_t hostEndpoint;
+  std::vector<uint8_t> payload;
+};
+
+const std::vector<TestMessage> kTestMessages = {
+    {0x0123456789abcdef, 1, 0x10, {1, 2, 3}},
+    {0x0123456789abcdef, 2, 0x10, {}},
+    {0x4c, 3, 0x20, {4, 5, 6, 7, 8}},
+};
+
+//! Encodes the test messages into a BatchedMessages container, the way CHRE
+//! sends them.
+void encodeBatch(FlatBufferBuilder &builder) {
+  std::vector<Offset<::chre::fbs::NanoappMessage>> messages;
+  for (const TestMessage &message : kTestMessages) {
+    messages.push_back(::chre::fbs::CreateNanoappMessageDirect(
+        builder, message.appId, message.messageType, message.hostEndpoint,
+        &message.payload));
+  }
+  auto batch = ::chre::fbs::CreateBatchedMessagesDirect(builder, &messages);
+  ::chre::fbs::HostAddress hostAddress(kHostClientId);
+  builder.Finish(::chre::fbs::CreateMessageContainer(
+      builder, ChreMessage::BatchedMessages, batch.Union(), &hostAddress));
+}
+
+void expectMessage(const ::chre::fbs::NanoappMessageT &message,
+                   const TestMessage &expected) {
+  EXPECT_EQ(message.app_id, expected.appId);
+  EXPECT_EQ(message.message_type, expected.messageType);
+  EXPECT_EQ(message.host_endpoint, expected.hostEndpoint);
+  EXPECT_EQ(message.message, expected.payload);
+}
+
+class NanoappMessageCollector : public IChreMessageHandlers {
+ public:
+  void handleNanoappMessage(
+      const ::chre::fbs::NanoappMessageT &message) override {
+    messages.push_back(message);
+  }
+
+  std::vector<::chre::fbs::NanoappMessageT> messages;
+};
+
+TEST(HostProtocolHostTest, UnbatchesMessagesInOrder) {
+  FlatBufferBuilder builder;
+  encodeBatch(builder);
+
+  size_t numMessages = 0;
+  EXPECT_TRUE(HostProtocolHost::unbatchMessages(
+      builder.GetBufferPointer(), builder.GetSize(),
+      [&numMessages](const uint8_t *message, size_t messageLen) {
+        ASSERT_LT(numMessages, kTestMessages.size());
+
+        // Each message is addressed to the client of the batch
+        uint16_t hostClientId;
+        ChreMessage messageType;
+        ASSERT_TRUE(HostProtocolHost::extractHostClientIdAndType(
+            message, messageLen, &hostClientId, &messageType));
+        EXPECT_EQ(hostClientId, kHostClientId);
+        EXPECT_EQ(messageType, ChreMessage::NanoappMessage);
+
+        NanoappMessageCollector collector;
+        ASSERT_TRUE(HostProtocolHost::decodeMessageFromChre(
+            message, messageLen, collector));
+        ASSERT_EQ(collector.messages.size(), 1u);
+        expectMessage(collector.messages[0], kTestMessages[numMessages]);
+        numMessages++;
+      }));
+  EXPECT_EQ(numMessages, kTestMessages.size());
+}
+
+TEST(HostProtocolHostTest, DecodesBatchedMessagesAsNanoappMessages) {
+  FlatBufferBuilder builder;
+  encodeBatch(builder);
+
+  NanoappMessageCollector collector;
+  ASSERT_TRUE(HostProtocolHost::decodeMessageFromChre(
+      builder.GetBufferPointer(), builder.GetSize(), collector));
+  ASSERT_EQ(collector.messages.size(), kTestMessages.size());
+  for (size_t i = 0; i < kTestMessages.size(); i++) {
+    expectMessage(collector.messages[i], kTestMessages[i]);
+  }
+}
+
+TEST(HostProtocolHostTest, UnbatchesEmptyBatch) {
+  FlatBufferBuilder builder;
+  auto batch = ::chre::fbs::CreateBatchedMessages(builder);
+  ::chre::fbs::HostAddress hostAddress(kHostClientId);
+  builder.Finish(::chre::fbs::CreateMessageContainer(
+      builder, ChreMessage::BatchedMessages, batch.Union(), &hostAddress));
+
+  bool called = false;
+  EXPECT_TRUE(HostProtocolHost::unbatchMessages(
+      builder.GetBufferPointer(), builder.GetSize(),
+      [&called](const uint8_t *, size_t) { called = true; }));
+  EXPECT_FALSE(called);
+}
+
+TEST(HostProtocolHostTest, DoesNotUnbatchOtherMessages) {
+  FlatBufferBuilder builder;
+  std::vector<uint8_t> payload = {1, 2, 3};
+  auto message = ::chre::fbs::CreateNanoappMessageDirect(
+      builder, 0x4c /* appId */, 1 /* messageType */, 0x10 /* hostEndpoint */,
+      &payload);
+  ::chre::fbs::HostAddress hostAddress(kHostClientId);
+  builder.Finish(::chre::fbs::CreateMessageContainer(
+      builder, ChreMessage::NanoappMessage, message.Union(), &hostAddress));
+
+  bool called = false;
+  EXPECT_FALSE(HostProtocolHost::unbatchMessages(
+      builder.GetBufferPointer(), builder.GetSize(),
+      [&called](const uint8_t *, size_t) { called = true; }));
+  EXPECT_FALSE(called);
+}
+
+TEST(HostProtocolHostTest, RejectsTruncatedBatch) {
+  FlatBufferBuilder builder;
+  encodeBatch(builder);
+
+  bool called = false;
+  EXPECT_FALSE(HostProtocolHost::unbatchMessages(
+      builder.GetBufferPointer(), builder.GetSize() / 2,
+      [&called](const uint8_t *, size_t) { called = true; }));
+  EXPECT_FALSE(called);
+}
+
+}  // namespace
+}  // namespace android::chre
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/log_message_parser.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace android::chre {
+namespace {
+
+/**
+ * Encodes the data of a structured log the way LogBuffer does on CHRE: the
+ * format string, followed by each argument encoded according to its
+ * conversion.
+ */
+class StructuredLogBuilder {
+ public:
+  explicit StructuredLogBuilder(const char *format)
+      : mData(format, format + strlen(format) + 1) {}
+
+  StructuredLogBuilder &addSigned(int64_t value) {
+    return addVarint((static_cast<uint64_t>(value) << 1) ^
+                     static_cast<uint64_t>(value >> 63));
+  }
+
+  StructuredLogBuilder &addUnsigned(uint64_t value) {
+    return addVarint(value);
+  }
+
+  StructuredLogBuilder &addDouble(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (size_t i = 0; i < sizeof(bits); i++) {
+      mData.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    }
+    return *this;
+  }
+
+  StructuredLogBuilder &addString(const char *value) {
+    mData.push_back(static_cast<uint8_t>(strlen(value)));
+    mData.insert(mData.end(), value, value + strlen(value));
+    return *this;
+  }
+
+  const std::vector<uint8_t> &data() const {
+    return mData;
+  }
+
+ private:
+  StructuredLogBuilder &addVarint(uint64_t value) {
+    while (value >= 0x80) {
+      mData.push_back(static_cast<uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    mData.push_back(static_cast<uint8_t>(value));
+    return *this;
+  }
+
+  std::vector<uint8_t> mData;
+};
+
+bool format(const StructuredLogBuilder &builder, std::string &formattedLog) {
+  return LogMessageParser::formatStructuredLog(
+      builder.data().data(), builder.data().size(), formattedLog);
+}
+
+TEST(LogMessageParserTest, FormatsStructuredLogIntegers) {
+  StructuredLogBuilder builder("%d %i %u %x %04X %" PRId64 " %" PRIu64);
+  builder.addSigned(-42)
+      .addSigned(7)
+      .addUnsigned(300)
+      .addUnsigned(0xbeef)
+      .addUnsigned(0xa)
+      .addSigned(INT64_MIN)
+      .addUnsigned(UINT64_MAX);
+
+  std::string formattedLog;
+  ASSERT_TRUE(format(builder, formattedLog));
+  EXPECT_EQ(formattedLog,
+            "-42 7 300 beef 000A -9223372036854775808 18446744073709551615");
+}
+
+TEST(LogMessageParserTest, TruncatesStructuredLogShortIntegers) {
+  StructuredLogBuilder builder("%hhd %hu");
+  builder.addSigned(0x1ff).addUnsigned(0x12345);
+
+  std::string formattedLog;
+  ASSERT_TRUE(format(builder, formattedLog));
+  EXPECT_EQ(formattedLog, "-1 9029");
+}
+
+TEST(LogMessageParserTest, FormatsStructuredLogStringsAndFloats) {
+  StructuredLogBuilder builder("%s: %.2f%% %c [%5s] %e");
+  builder.addString("temp")
+      .addDouble(36.55)
+      .addUnsigned('C')
+      .addString("ok")
+      .addDouble(-1.5e-3);
+
+  std::string formattedLog;
+  ASSERT_TRUE(format(builder, formattedLog));
+  EXPECT_EQ(formattedLog, "temp: 36.55% C [   ok] -1.500000e-03");
+}
+
+TEST(LogMessageParserTest, FormatsStructuredLogWithoutArguments) {
+  StructuredLogBuilder builder("Nanoapp loaded");
+
+  std::string formattedLog = "stale";
+  ASSERT_TRUE(format(builder, formattedLog));
+  EXPECT_EQ(formattedLog, "Nanoapp loaded");
+}
+
+TEST(LogMessageParserTest, RejectsStructuredLogWithMissingArguments) {
+  std::string formattedLog;
+  EXPECT_FALSE(format(StructuredLogBuilder("%d"), formattedLog));
+  EXPECT_FALSE(format(StructuredLogBuilder("%f"), formattedLog));
+  EXPECT_FALSE(format(StructuredLogBuilder("%s"), formattedLog));
+}
+
+TEST(LogMessageParserTest, RejectsStructuredLogWithTruncatedArguments) {
+  std::string formattedLog;
+
+  // A varint whose last byte is missing
+  StructuredLogBuilder varint("%u");
+  varint.addUnsigned(1000);
+  std::vector<uint8_t> data = varint.data();
+  data.pop_back();
+  EXPECT_FALSE(LogMessageParser::formatStructuredLog(data.data(), data.size(),
+                                                     formattedLog));
+
+  // A string whose length runs past the end of the log
+  StructuredLogBuilder string("%s");
+  string.addString("truncated");
+  data = string.data();
+  data.pop_back();
+  EXPECT_FALSE(LogMessageParser::formatStructuredLog(data.data(), data.size(),
+                                                     formattedLog));
+}
+
+TEST(LogMessageParserTest, RejectsStructuredLogWithoutTerminatedFormat) {
+  const char kFormat[] = {'a', 'b', 'c'};
+  std::string formattedLog;
+  EXPECT_FALSE(LogMessageParser::formatStructuredLog(
+      reinterpret_cast<const uint8_t *>(kFormat), sizeof(kFormat),
+      formattedLog));
+}
+
+TEST(LogMessageParserTest, RejectsStructuredLogWithUnsupportedConversion) {
+  StructuredLogBuilder builder("%n");
+  builder.addUnsigned(0);
+
+  std::string formattedLog;
+  EXPECT_FALSE(format(builder, formattedLog));
+}
+
+}  // namespace
+}  // namespace android::chre
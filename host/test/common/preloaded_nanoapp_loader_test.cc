@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre_host/preloaded_nanoapp_loader.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "chre_connection.h"
+#include "chre_host/generated/host_messages_generated.h"
+#include "chre_host/napp_header.h"
+#include "gtest/gtest.h"
+#include "hal_client_id.h"
+
+namespace android::chre {
+namespace {
+
+using ::android::hardware::contexthub::common::implementation::ChreConnection;
+
+constexpr size_t kNumNanoapps = 20;
+constexpr size_t kNanoappSize = 8 * CHRE_HOST_DEFAULT_FRAGMENT_SIZE;
+constexpr auto kOneWayLatency = std::chrono::milliseconds(1);
+
+/**
+ * Stands in for the link to CHRE: fragments are accepted in order and
+ * acknowledged cumulatively per transaction, with each response delivered one
+ * round trip after its fragment was sent.
+ */
+class FakeChreConnection : public ChreConnection {
+ public:
+  FakeChreConnection(size_t windowSize, size_t maxConcurrentLoads = 1)
+      : mWindowSize(windowSize), mMaxConcurrentLoads(maxConcurrentLoads) {
+    mResponder = std::thread([this]() { respond(); });
+  }
+
+  ~FakeChreConnection() override {
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mStopped = true;
+    }
+    mCondition.notify_all();
+    mResponder.join();
+  }
+
+  void setLoader(PreloadedNanoappLoader *loader) {
+    mLoader = loader;
+  }
+
+  bool init() override {
+    return true;
+  }
+
+  size_t getLoadFragmentWindowSize() const override {
+    return mWindowSize;
+  }
+
+  size_t getMaxConcurrentLoadTransactions() const override {
+    return mMaxConcurrentLoads;
+  }
+
+  bool sendMessage(void *data, size_t /*length*/) override {
+    const auto *request = ::chre::fbs::GetMessageContainer(data)
+                              ->message_as_LoadNanoappRequest();
+    if (request == nullptr) {
+      return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    Load &load = mLoads[request->transaction_id()];
+    Response response;
+    response.deliveryTime = std::chrono::steady_clock::now() +
+                            2 * kOneWayLatency;
+    response.message.transaction_id = request->transaction_id();
+    if (request->fragment_id() == load.nextFragmentId) {
+      // Only the first fragment carries the size of the whole binary
+      if (load.nextFragmentId == 1) {
+        load.totalAppSize = request->total_app_size();
+      }
+      load.nextFragmentId++;
+      load.numBytes += request->app_binary()->size();
+      response.message.success = true;
+      response.message.fragment_id = load.nextFragmentId - 1;
+      if (load.numBytes == load.totalAppSize) {
+        mNumLoadedNanoapps++;
+      }
+    } else {
+      response.message.success = false;
+      response.message.fragment_id = request->fragment_id();
+    }
+    mResponses.push(response);
+    mCondition.notify_all();
+    return true;
+  }
+
+  size_t getNumLoadedNanoapps() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumLoadedNanoapps;
+  }
+
+ private:
+  struct Load {
+    uint32_t nextFragmentId = 1;
+    size_t numBytes = 0;
+    size_t totalAppSize = 0;
+  };
+
+  struct Response {
+    std::chrono::steady_clock::time_point deliveryTime;
+    ::chre::fbs::LoadNanoappResponseT message;
+  };
+
+  void respond() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true) {
+      mCondition.wait(lock, [this]() { return mStopped || !mResponses.empty(); });
+      if (mStopped) {
+        break;
+      }
+      Response response = mResponses.front();
+      mResponses.pop();
+      lock.unlock();
+      std::this_thread::sleep_until(response.deliveryTime);
+      mLoader->onLoadNanoappResponse(response.message, kHalId);
+      lock.lock();
+    }
+  }
+
+  const size_t mWindowSize;
+  const size_t mMaxConcurrentLoads;
+  PreloadedNanoappLoader *mLoader = nullptr;
+  std::mutex mMutex;
+  std::condition_variable mCondition;
+  std::queue<Response> mResponses;
+  std::map<uint32_t, Load> mLoads;
+  size_t mNumLoadedNanoapps = 0;
+  bool mStopped = false;
+  std::thread mResponder;
+};
+
+/** Writes a config listing kNumNanoapps nanoapps and returns its path. */
+std::string writePreloadedNanoapps() {
+  const std::string directory = ::testing::TempDir();
+  std::ofstream config(directory + "/preloaded_nanoapps.json");
+  config << "{\"source_dir\": \"" << directory << "\", \"nanoapps\": [";
+  for (size_t i = 0; i < kNumNanoapps; i++) {
+    const std::string name = "nanoapp_" + std::to_string(i);
+    config << (i == 0 ? "" : ", ") << "\"" << name << "\"";
+
+    NanoAppBinaryHeader header{};
+    header.appId = 0x0123456789000000 + i;
+    header.targetChreApiMajorVersion = 1;
+    std::ofstream(directory + "/" + name + ".napp_header", std::ios::binary)
+        .write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    std::vector<char> binary(kNanoappSize, static_cast<char>(i));
+    std::ofstream(directory + "/" + name + ".so", std::ios::binary)
+        .write(binary.data(), binary.size());
+  }
+  config << "]}";
+  return directory + "/preloaded_nanoapps.json";
+}
+
+TEST(PreloadedNanoappLoaderTest,
+     DISABLED_PreloadTimeVersusFragmentWindowSize) {
+  const std::string configPath = writePreloadedNanoapps();
+  std::chrono::steady_clock::duration windowOfOneTime{};
+  for (size_t windowSize : {1, 2, 4, 8}) {
+    FakeChreConnection connection(windowSize);
+    PreloadedNanoappLoader loader(&connection, configPath);
+    connection.setLoader(&loader);
+
+    auto start = std::chrono::steady_clock::now();
+    loader.loadPreloadedNanoapps();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(connection.getNumLoadedNanoapps(), kNumNanoapps);
+    printf("Window of %zu fragments: preloaded %zu nanoapps in %lld ms\n",
+           windowSize, kNumNanoapps,
+           static_cast<long long>(
+               std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                   .count()));
+    if (windowSize == 1) {
+      windowOfOneTime = elapsed;
+    } else {
+      EXPECT_LT(elapsed, windowOfOneTime);
+    }
+  }
+}
+
+TEST(PreloadedNanoappLoaderTest, DISABLED_PreloadTimeVersusConcurrentLoads) {
+  const std::string configPath = writePreloadedNanoapps();
+  std::chrono::steady_clock::duration oneLoadTime{};
+  for (size_t maxConcurrentLoads : {1, 2, 4}) {
+    FakeChreConnection connection(CHRE_HOST_DEFAULT_FRAGMENT_WINDOW_SIZE,
+                                  maxConcurrentLoads);
+    PreloadedNanoappLoader loader(&connection, configPath);
+    connection.setLoader(&loader);
+
+    auto start = std::chrono::steady_clock::now();
+    loader.loadPreloadedNanoapps();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(connection.getNumLoadedNanoapps(), kNumNanoapps);
+    printf("%zu concurrent loads: preloaded %zu nanoapps in %lld ms\n",
+           maxConcurrentLoads, kNumNanoapps,
+           static_cast<long long>(
+               std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+                   .count()));
+    if (maxConcurrentLoads == 1) {
+      oneLoadTime = elapsed;
+    } else {
+      EXPECT_LT(elapsed, oneLoadTime);
+    }
+  }
+}
+
+}  // namespace
+}  // namespace android::chre
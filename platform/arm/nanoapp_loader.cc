@@ -67,6 +67,10 @@ bool NanoappLoader::relocateTable(DynamicHeader *dyn, int tag) {
           }
 
           case R_ARM_GLOB_DAT: {
+            if (mSymbolRelocationsApplied) {
+              // Already patched from the relocation manifest.
+              break;
+            }
             LOGV("Resolving type ARM_GLOB_DAT at offset %lx",
                  static_cast<long unsigned int>(curr->r_offset));
             size_t posInSymbolTable = ELFW_R_SYM(curr->r_info);
@@ -115,6 +119,11 @@ bool NanoappLoader::relocateTable(DynamicHeader *dyn, int tag) {
 }
 
 bool NanoappLoader::resolveGot() {
+  if (mSymbolRelocationsApplied) {
+    LOGV("GOT already resolved from the relocation manifest");
+    return true;
+  }
+
   ElfAddr *addr;
   ElfRel *reloc = reinterpret_cast<ElfRel *>(
       mMapping + getDynEntry(getDynamicHeader(), DT_JMPREL));
@@ -22,6 +22,9 @@
 
 namespace chre {
 
+class NanoappLoader;
+struct StreamingAuthentication;
+
 /**
  * FREERTOS-specific nanoapp functionality.
  */
@@ -78,7 +81,10 @@ class PlatformNanoappBase {
    * Copies the (possibly fragmented) application binary data into the allocated
    * buffer, and updates the pointer to the next address to write into. The
    * application may be invalid - full checking and initialization happens just
-   * before invoking start() nanoapp entry point.
+   * before invoking start() nanoapp entry point. With
+   * CHRE_NANOAPP_STREAMING_LOAD_ENABLED, the binary is authenticated and mapped
+   * as fragments are copied, leaving only relocation and static initialization
+   * to start().
    *
    * @param buffer The pointer to the buffer
    * @param bufferSize The size of the buffer in bytes
@@ -133,6 +139,32 @@ class PlatformNanoappBase {
   //! The number of bytes of the binary that has been loaded so far.
   size_t mBytesLoaded = 0;
 
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+  //! Authenticates the binary as it is copied by copyNanoappFragment().
+  StreamingAuthentication *mStreamingAuth = nullptr;
+
+  //! Maps the binary as it is copied by copyNanoappFragment(). Created once the
+  //! headers used by the authentication code are verified.
+  NanoappLoader *mStreamingLoader = nullptr;
+
+  //! The offset of the raw binary within mAppBinary, after any headers used by
+  //! the authentication code.
+  size_t mRawBinaryOffset = 0;
+
+  /**
+   * Authenticates and maps the part of the binary copied since the previous
+   * call.
+   *
+   * @return false if the binary failed authentication or verification.
+   */
+  bool processReceivedBinary();
+
+  /**
+   * Frees the state of a streaming load that has not completed.
+   */
+  void abortStreamingLoad();
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+
   /**
    * Loads the nanoapp symbols from the currently loaded binary and verifies
    * they match the expected information the nanoapp should have.
@@ -43,6 +43,9 @@ size_t kDefaultAppVersionStringSize = ARRAY_SIZE(kDefaultAppVersionString);
 
 PlatformNanoapp::~PlatformNanoapp() {
   closeNanoapp();
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+  abortStreamingLoad();
+#endif
 
   if (mAppBinary != nullptr) {
     forceDramAccess();
@@ -197,6 +200,10 @@ bool PlatformNanoappBase::reserveBuffer(uint64_t appId, uint32_t appVersion,
     mExpectedTcmCapable = tcmCapable;
     mAppBinaryLen = appBinaryLen;
     success = true;
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+    mStreamingAuth = startStreamingAuthentication(appBinaryLen);
+    success = (mStreamingAuth != nullptr);
+#endif
   }
 
   return success;
@@ -218,11 +225,56 @@ bool PlatformNanoappBase::copyNanoappFragment(const void *buffer,
     uint8_t *binaryBuffer = static_cast<uint8_t *>(mAppBinary) + mBytesLoaded;
     memcpy(binaryBuffer, buffer, bufferLen);
     mBytesLoaded += bufferLen;
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+    success = processReceivedBinary();
+#endif
   }
 
   return success;
 }
 
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+bool PlatformNanoappBase::processReceivedBinary() {
+  if (mStreamingAuth == nullptr) {
+    LOGE("No streaming load in progress");
+    return false;
+  }
+
+  void *binaryStart = nullptr;
+  if (!updateStreamingAuthentication(mStreamingAuth, mAppBinary, mBytesLoaded,
+                                     &binaryStart)) {
+    LOGE("Unable to authenticate 0x%" PRIx64 " not loading", mExpectedAppId);
+    return false;
+  }
+
+  if (mStreamingLoader == nullptr && binaryStart != nullptr) {
+    mRawBinaryOffset = static_cast<uint8_t *>(binaryStart) -
+                       static_cast<uint8_t *>(mAppBinary);
+    mStreamingLoader = NanoappLoader::createStreaming(
+        binaryStart, mAppBinaryLen - mRawBinaryOffset, mExpectedTcmCapable);
+    if (mStreamingLoader == nullptr) {
+      return false;
+    }
+  }
+
+  return mStreamingLoader == nullptr ||
+         mStreamingLoader->onBinaryReceived(mBytesLoaded - mRawBinaryOffset);
+}
+
+void PlatformNanoappBase::abortStreamingLoad() {
+  if (mStreamingAuth != nullptr) {
+    forceDramAccess();
+    abortStreamingAuthentication(mStreamingAuth);
+    mStreamingAuth = nullptr;
+  }
+  if (mStreamingLoader != nullptr) {
+    forceDramAccess();
+    NanoappLoader::abortStreaming(mStreamingLoader);
+    mStreamingLoader = nullptr;
+  }
+}
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+
 bool PlatformNanoappBase::verifyNanoappInfo() {
   bool success = false;
 
@@ -270,6 +322,25 @@ bool PlatformNanoappBase::openNanoapp() {
   if (mIsStatic) {
     success = true;
   } else if (mAppBinary != nullptr) {
+#ifdef CHRE_NANOAPP_STREAMING_LOAD_ENABLED
+    //! The binary was authenticated and mapped as it was received, only the
+    //! hash check and relocations are left.
+    bool authenticated = (mStreamingAuth != nullptr) &&
+                         finishStreamingAuthentication(mStreamingAuth);
+    mStreamingAuth = nullptr;
+    if (!authenticated) {
+      LOGE("Unable to authenticate 0x%" PRIx64 " not loading", mExpectedAppId);
+    } else if (mDsoHandle != nullptr) {
+      LOGE("Trying to reopen an existing buffer");
+    } else if (mStreamingLoader == nullptr) {
+      LOGE("Binary of 0x%" PRIx64 " was not mapped", mExpectedAppId);
+    } else {
+      mDsoHandle = NanoappLoader::finishStreaming(mStreamingLoader);
+      mStreamingLoader = nullptr;
+      success = verifyNanoappInfo();
+    }
+    abortStreamingLoad();
+#else
     //! The true start of the binary will be after the authentication header.
     //! Use the returned value from authenticateBinary to ensure dlopenbuf has
     //! the starting address to a valid ELF.
@@ -282,6 +353,7 @@ bool PlatformNanoappBase::openNanoapp() {
       mDsoHandle = dlopenbuf(binaryStart, mExpectedTcmCapable);
       success = verifyNanoappInfo();
     }
+#endif  // CHRE_NANOAPP_STREAMING_LOAD_ENABLED
   }
 
   if (!success) {
@@ -34,6 +34,14 @@ union HeapBlockHeader {
      */
     HeapBlockHeader *next = nullptr;
 
+    /**
+     * Pointer to the link that points to this header, i.e. the next field of
+     * the previous header or the owning nanoapp's mFirstHeader. Makes the list
+     * doubly linked so a header can be unlinked in constant time, without
+     * needing to know which nanoapp owns it.
+     */
+    HeapBlockHeader **prevNext = nullptr;
+
     //! The amount of memory in bytes allocated (not including header).
     uint32_t bytes;
 
@@ -15,16 +15,325 @@
  */
 
 #include "chre/platform/host_link.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+
 #include "chre/core/event_loop_manager.h"
+#include "chre/core/host_comms_manager.h"
+#include "chre/platform/log.h"
+#include "chre/platform/memory.h"
+#include "chre/platform/shared/host_protocol_chre.h"
+#include "chre/util/flatbuffers/helpers.h"
+#include "chre/util/macros.h"
+#include "chre/util/nested_data_ptr.h"
 
 namespace chre {
+namespace {
+
+struct UnloadNanoappCallbackData {
+  uint64_t appId;
+  uint32_t transactionId;
+  uint16_t hostClientId;
+  bool allowSystemNanoappUnload;
+};
+
+struct NanoappListData {
+  ChreFlatBufferBuilder *builder;
+  DynamicVector<NanoappListEntryOffset> nanoappEntries;
+  uint16_t hostClientId;
+};
+
+inline HostCommsManager &getHostCommsManager() {
+  return EventLoopManagerSingleton::get()->getHostCommsManager();
+}
+
+bool sendFromBuilder(const ChreFlatBufferBuilder &builder) {
+  return getHostCommsManager().send(builder.GetBufferPointer(),
+                                    builder.GetSize());
+}
+
+/**
+ * Sets the host client ID of an incoming message, like the CHRE daemon does so
+ * that responses can be routed back to the client. The copy of the generated
+ * FlatBuffers header used by CHRE doesn't include mutable accessors, so the
+ * HostAddress struct is written to directly.
+ */
+void setHostClientId(uint8_t *message, uint16_t hostClientId) {
+  const fbs::MessageContainer *container = fbs::GetMessageContainer(message);
+  auto *hostAddr = reinterpret_cast<uint8_t *>(
+      const_cast<fbs::HostAddress *>(container->host_addr()));
+  flatbuffers::WriteScalar(hostAddr, hostClientId);
+}
+
+void buildAndSendNanoappList(uint16_t /* type */, void *data,
+                             void * /* extraData */) {
+  uint16_t hostClientId = NestedDataPtr<uint16_t>(data);
+  NanoappListData cbData = {};
+  cbData.hostClientId = hostClientId;
+
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  size_t expectedNanoappCount = eventLoop.getNanoappCount();
+  if (!cbData.nanoappEntries.reserve(expectedNanoappCount)) {
+    LOG_OOM();
+    return;
+  }
+
+  constexpr size_t kFixedOverhead = 48;
+  constexpr size_t kPerNanoappSize = 32;
+  ChreFlatBufferBuilder builder(kFixedOverhead +
+                                expectedNanoappCount * kPerNanoappSize);
+  cbData.builder = &builder;
+
+  auto nanoappAdderCallback = [](const Nanoapp *nanoapp, void *data) {
+    auto *cbData = static_cast<NanoappListData *>(data);
+    HostProtocolChre::addNanoappListEntry(
+        *(cbData->builder), cbData->nanoappEntries, nanoapp->getAppId(),
+        nanoapp->getAppVersion(), true /*enabled*/, nanoapp->isSystemNanoapp(),
+        nanoapp->getAppPermissions(), nanoapp->getRpcServices());
+  };
+  eventLoop.forEachNanoapp(nanoappAdderCallback, &cbData);
+  HostProtocolChre::finishNanoappListResponse(builder, cbData.nanoappEntries,
+                                              hostClientId);
+  sendFromBuilder(builder);
+}
+
+void handleUnloadNanoappCallback(uint16_t /* type */, void *data,
+                                 void * /* extraData */) {
+  auto *cbData = static_cast<UnloadNanoappCallbackData *>(data);
+  bool success = false;
+  uint16_t instanceId;
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  if (!eventLoop.findNanoappInstanceIdByAppId(cbData->appId, &instanceId)) {
+    LOGE("Couldn't unload app ID 0x%016" PRIx64 ": not found", cbData->appId);
+  } else {
+    success =
+        eventLoop.unloadNanoapp(instanceId, cbData->allowSystemNanoappUnload);
+  }
+
+  constexpr size_t kInitialBufferSize = 52;
+  ChreFlatBufferBuilder builder(kInitialBufferSize);
+  HostProtocolChre::encodeUnloadNanoappResponse(builder, cbData->hostClientId,
+                                                cbData->transactionId, success);
+  sendFromBuilder(builder);
+
+  memoryFree(data);
+}
+
+}  // anonymous namespace
+
+HostLinkBase::~HostLinkBase() {
+  stopSocketServer();
+}
+
+bool HostLinkBase::startSocketServer(const char *socketPath) {
+  if (isSocketServerRunning()) {
+    LOGE("Host socket server already running");
+    return false;
+  }
+
+  struct sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+    LOGE("Host socket path too long: %s", socketPath);
+    return false;
+  }
+  strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+
+  int serverFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+  if (serverFd < 0) {
+    LOGE("Couldn't create host socket: %s", strerror(errno));
+    return false;
+  }
+
+  unlink(socketPath);
+  if (bind(serverFd, reinterpret_cast<struct sockaddr *>(&addr),
+           sizeof(addr)) != 0 ||
+      listen(serverFd, static_cast<int>(kMaxClients)) != 0 ||
+      pipe2(mWakePipe, O_CLOEXEC) != 0) {
+    LOGE("Couldn't listen on host socket %s: %s", socketPath, strerror(errno));
+    close(serverFd);
+    return false;
+  }
+
+  mRecvBuffer.resize(kMaxPacketSize);
+  mPollFds[kListenIndex].fd = serverFd;
+  mPollFds[kListenIndex].events = POLLIN;
+  mPollFds[kWakeIndex].fd = mWakePipe[0];
+  mPollFds[kWakeIndex].events = POLLIN;
+  for (size_t i = kFirstClientIndex; i < ARRAY_SIZE(mPollFds); i++) {
+    mPollFds[i].fd = -1;
+    mPollFds[i].events = POLLIN;
+  }
+
+  mServerFd = serverFd;
+  mServerThread = std::thread(&HostLinkBase::serviceSocket, this);
+  LOGI("Host socket server listening on %s", socketPath);
+  return true;
+}
+
+void HostLinkBase::stopSocketServer() {
+  if (!isSocketServerRunning()) {
+    return;
+  }
+
+  char wake = 0;
+  if (write(mWakePipe[1], &wake, sizeof(wake)) != sizeof(wake)) {
+    LOGE("Couldn't wake host socket thread: %s", strerror(errno));
+  }
+  mServerThread.join();
+
+  {
+    std::lock_guard<std::mutex> lock(mClientsMutex);
+    for (size_t i = 0; i < kMaxClients; i++) {
+      disconnectClientLocked(i);
+    }
+    close(mServerFd);
+    mServerFd = -1;
+  }
+
+  close(mWakePipe[0]);
+  close(mWakePipe[1]);
+  mWakePipe[0] = mWakePipe[1] = -1;
+}
+
+bool HostLinkBase::send(const uint8_t *data, size_t dataLen) {
+  uint16_t hostClientId =
+      fbs::GetMessageContainer(data)->host_addr()->client_id();
+
+  std::lock_guard<std::mutex> lock(mClientsMutex);
+  bool delivered = false;
+  for (size_t i = 0; i < kMaxClients; i++) {
+    int clientFd = mPollFds[kFirstClientIndex + i].fd;
+    if (clientFd < 0 || (hostClientId != kHostClientIdUnspecified &&
+                         hostClientId != mClientIds[i])) {
+      continue;
+    }
+
+    if (::send(clientFd, data, dataLen, MSG_NOSIGNAL) !=
+        static_cast<ssize_t>(dataLen)) {
+      LOGW("Couldn't send %zu bytes to host client %" PRIu16 ": %s", dataLen,
+           mClientIds[i], strerror(errno));
+    } else {
+      delivered = true;
+    }
+  }
+
+  if (!delivered) {
+    LOGW("Message to host client %" PRIu16 " not delivered", hostClientId);
+  }
+  return delivered;
+}
+
+void HostLinkBase::serviceSocket() {
+  while (true) {
+    int ret = poll(mPollFds, ARRAY_SIZE(mPollFds), -1 /* timeout */);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOGE("Host socket poll failed: %s", strerror(errno));
+      break;
+    }
+
+    if (mPollFds[kWakeIndex].revents != 0) {
+      break;
+    }
+
+    if (mPollFds[kListenIndex].revents & POLLIN) {
+      acceptClientConnection();
+    }
+
+    for (size_t i = 0; i < kMaxClients; i++) {
+      if (mPollFds[kFirstClientIndex + i].fd >= 0 &&
+          mPollFds[kFirstClientIndex + i].revents != 0) {
+        handleClientData(i);
+      }
+    }
+  }
+}
+
+void HostLinkBase::acceptClientConnection() {
+  int clientFd = accept4(mServerFd, nullptr, nullptr, SOCK_CLOEXEC);
+  if (clientFd < 0) {
+    LOGE("Couldn't accept host client: %s", strerror(errno));
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mClientsMutex);
+  for (size_t i = 0; i < kMaxClients; i++) {
+    if (mPollFds[kFirstClientIndex + i].fd < 0) {
+      if (mNextClientId == kHostClientIdUnspecified) {
+        mNextClientId++;
+      }
+      mClientIds[i] = mNextClientId++;
+      mPollFds[kFirstClientIndex + i].fd = clientFd;
+      LOGI("Host client %" PRIu16 " connected", mClientIds[i]);
+      return;
+    }
+  }
+
+  LOGW("Rejecting host client: too many clients");
+  close(clientFd);
+}
+
+void HostLinkBase::handleClientData(size_t clientIndex) {
+  int clientFd = mPollFds[kFirstClientIndex + clientIndex].fd;
+  ssize_t len = recv(clientFd, mRecvBuffer.data(), mRecvBuffer.size(), 0);
+  if (len <= 0) {
+    if (len < 0) {
+      LOGE("Couldn't receive from host client %" PRIu16 ": %s",
+           mClientIds[clientIndex], strerror(errno));
+    }
+    std::lock_guard<std::mutex> lock(mClientsMutex);
+    LOGI("Host client %" PRIu16 " disconnected", mClientIds[clientIndex]);
+    disconnectClientLocked(clientIndex);
+    return;
+  }
+
+  size_t messageLen = static_cast<size_t>(len);
+  if (!HostProtocolChre::verifyMessage(mRecvBuffer.data(), messageLen)) {
+    LOGE("Dropping invalid message from host client %" PRIu16,
+         mClientIds[clientIndex]);
+  } else {
+    setHostClientId(mRecvBuffer.data(), mClientIds[clientIndex]);
+    HostProtocolChre::decodeMessageFromHost(mRecvBuffer.data(), messageLen);
+  }
+}
+
+void HostLinkBase::disconnectClientLocked(size_t clientIndex) {
+  int &clientFd = mPollFds[kFirstClientIndex + clientIndex].fd;
+  if (clientFd >= 0) {
+    close(clientFd);
+    clientFd = -1;
+  }
+}
 
 void HostLink::flushMessagesSentByNanoapp(uint64_t /* appId */) {
   // (empty)
 }
 
 bool HostLink::sendMessage(const MessageToHost *message) {
-  // Just drop the message since we don't have a real host to send to
+  if (isSocketServerRunning()) {
+    // Same reserve size as other platforms for the fixed message fields
+    constexpr size_t kFixedReserveSize = 80;
+    ChreFlatBufferBuilder builder(message->message.size() + kFixedReserveSize);
+    HostProtocolChre::encodeNanoappMessage(
+        builder, message->appId, message->toHostData.messageType,
+        message->toHostData.hostEndpoint, message->message.data(),
+        message->message.size(), message->toHostData.appPermissions,
+        message->toHostData.messagePermissions, message->toHostData.wokeHost);
+    send(builder.GetBufferPointer(), builder.GetSize());
+  }
+
+  // The message is either copied into the socket or dropped, since we may not
+  // have a real host to send to
   EventLoopManagerSingleton::get()
       ->getHostCommsManager()
       .onMessageToHostComplete(message);
@@ -41,4 +350,135 @@ void HostLinkBase::sendNanConfiguration(bool enable) {
 #endif
 }
 
+void HostMessageHandlers::handleNanoappMessage(uint64_t appId,
+                                               uint32_t messageType,
+                                               uint16_t hostEndpoint,
+                                               const void *messageData,
+                                               size_t messageDataLen) {
+  LOGV("Parsed nanoapp message from host: app ID 0x%016" PRIx64
+       ", endpoint 0x%" PRIx16 ", msgType %" PRIu32 ", payload size %zu",
+       appId, hostEndpoint, messageType, messageDataLen);
+
+  getHostCommsManager().sendMessageToNanoappFromHost(
+      appId, messageType, hostEndpoint, messageData, messageDataLen);
+}
+
+void HostMessageHandlers::handleHubInfoRequest(uint16_t hostClientId) {
+  constexpr size_t kInitialBufferSize = 192;
+
+  constexpr char kHubName[] = "CHRE on Linux";
+  constexpr char kVendor[] = "Google";
+  constexpr char kToolchain[] = "Linux";
+  constexpr uint32_t kLegacyPlatformVersion = 0;
+  constexpr uint32_t kLegacyToolchainVersion = 0;
+  constexpr float kPeakMips = 0;
+  constexpr float kStoppedPower = 0;
+  constexpr float kSleepPower = 0;
+  constexpr float kPeakPower = 0;
+  // The Linux build doesn't link chre_api_version.cc, so report the values
+  // from build/variant/google_x86_linux.mk directly
+  constexpr uint64_t kPlatformId = UINT64_C(0x476f6f676c000001);
+  constexpr uint32_t kChreVersion = CHRE_API_VERSION;
+
+  ChreFlatBufferBuilder builder(kInitialBufferSize);
+  HostProtocolChre::encodeHubInfoResponse(
+      builder, kHubName, kVendor, kToolchain, kLegacyPlatformVersion,
+      kLegacyToolchainVersion, kPeakMips, kStoppedPower, kSleepPower,
+      kPeakPower, CHRE_MESSAGE_TO_HOST_MAX_SIZE, kPlatformId, kChreVersion,
+      hostClientId);
+  sendFromBuilder(builder);
+}
+
+void HostMessageHandlers::handleNanoappListRequest(uint16_t hostClientId) {
+  LOGD("Nanoapp list request from client ID %" PRIu16, hostClientId);
+  EventLoopManagerSingleton::get()->deferCallback(
+      SystemCallbackType::NanoappListResponse,
+      NestedDataPtr<uint16_t>(hostClientId), buildAndSendNanoappList);
+}
+
+void HostMessageHandlers::handleDebugConfiguration(
+    const fbs::DebugConfiguration * /* debugConfiguration */) {
+  // Not supported on Linux
+}
+
+void HostMessageHandlers::handleLoadNanoappRequest(
+    uint16_t hostClientId, uint32_t transactionId, uint64_t appId,
+    uint32_t /* appVersion */, uint32_t /* appFlags */,
+    uint32_t /* targetApiVersion */, const void * /* buffer */,
+    size_t /* bufferLen */, const char * /* appFileName */, uint32_t fragmentId,
+    size_t /* appBinaryLen */, bool /* respondBeforeStart */) {
+  // Dynamic nanoapps are given on the command line on Linux
+  LOGE("Loading app ID 0x%016" PRIx64 " from the host is unsupported", appId);
+  constexpr size_t kInitialBufferSize = 52;
+  ChreFlatBufferBuilder builder(kInitialBufferSize);
+  HostProtocolChre::encodeLoadNanoappResponse(
+      builder, hostClientId, transactionId, false /* success */, fragmentId);
+  sendFromBuilder(builder);
+}
+
+void HostMessageHandlers::handleUnloadNanoappRequest(
+    uint16_t hostClientId, uint32_t transactionId, uint64_t appId,
+    bool allowSystemNanoappUnload) {
+  LOGD("Unload nanoapp request from client %" PRIu16 " (txnID %" PRIu32
+       ") for appId 0x%016" PRIx64 " system %d",
+       hostClientId, transactionId, appId, allowSystemNanoappUnload);
+  auto *cbData = memoryAlloc<UnloadNanoappCallbackData>();
+  if (cbData == nullptr) {
+    LOG_OOM();
+  } else {
+    cbData->appId = appId;
+    cbData->transactionId = transactionId;
+    cbData->hostClientId = hostClientId;
+    cbData->allowSystemNanoappUnload = allowSystemNanoappUnload;
+
+    EventLoopManagerSingleton::get()->deferCallback(
+        SystemCallbackType::HandleUnloadNanoapp, cbData,
+        handleUnloadNanoappCallback);
+  }
+}
+
+void HostMessageHandlers::handleTimeSyncMessage(int64_t /* offset */) {
+  // The host and CHRE share a clock on Linux
+}
+
+void HostMessageHandlers::handleDebugDumpRequest(uint16_t hostClientId) {
+  LOGW("Debug dump request from client %" PRIu16 " unsupported",
+       hostClientId);
+  constexpr size_t kInitialBufferSize = 52;
+  ChreFlatBufferBuilder builder(kInitialBufferSize);
+  HostProtocolChre::encodeDebugDumpResponse(
+      builder, hostClientId, false /* success */, 0 /* dataCount */);
+  sendFromBuilder(builder);
+}
+
+void HostMessageHandlers::handleSettingChangeMessage(fbs::Setting setting,
+                                                     fbs::SettingState state) {
+  Setting chreSetting;
+  bool chreSettingEnabled;
+  if (HostProtocolChre::getSettingFromFbs(setting, &chreSetting) &&
+      HostProtocolChre::getSettingEnabledFromFbs(state, &chreSettingEnabled)) {
+    EventLoopManagerSingleton::get()->getSettingManager().postSettingChange(
+        chreSetting, chreSettingEnabled);
+  }
+}
+
+void HostMessageHandlers::handleSelfTestRequest(uint16_t hostClientId) {
+  LOGW("Self test request from client %" PRIu16 " unsupported", hostClientId);
+  constexpr size_t kInitialBufferSize = 52;
+  ChreFlatBufferBuilder builder(kInitialBufferSize);
+  HostProtocolChre::encodeSelfTestResponse(builder, hostClientId,
+                                           false /* success */);
+  sendFromBuilder(builder);
+}
+
+void HostMessageHandlers::handleNanConfigurationUpdate(bool enabled) {
+#if defined(CHRE_WIFI_SUPPORT_ENABLED) && defined(CHRE_WIFI_NAN_SUPPORT_ENABLED)
+  EventLoopManagerSingleton::get()
+      ->getWifiRequestManager()
+      .updateNanAvailability(enabled);
+#else
+  UNUSED_VAR(enabled);
+#endif
+}
+
 }  // namespace chre
@@ -22,4 +22,16 @@
  */
 bool chrePalSensorIsSensor0Enabled();
 
+/**
+ * @return whether sensor 1 is active.
+ */
+bool chrePalSensorIsSensor1Enabled();
+
+/**
+ * Delivers a proximity sample from sensor 1 (an on-change sensor) to CHRE.
+ *
+ * @param isNear The value of the sample.
+ */
+void chrePalSensorSendSensor1Event(bool isNear);
+
 #endif  // CHRE_PLATFORM_LINUX_PAL_SENSOR_H_
\ No newline at end of file
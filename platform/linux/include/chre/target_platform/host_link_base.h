@@ -17,10 +17,26 @@
 #ifndef CHRE_PLATFORM_LINUX_HOST_LINK_BASE_H_
 #define CHRE_PLATFORM_LINUX_HOST_LINK_BASE_H_
 
+#include <poll.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 namespace chre {
 
+/**
+ * On Linux, messages to the host are dropped unless a socket server is started,
+ * in which case CHRE serves the same Unix domain socket protocol as the CHRE
+ * daemon: one FlatBuffers-encoded MessageContainer per SOCK_SEQPACKET packet.
+ * This allows host clients to exchange messages with nanoapps off-target.
+ */
 class HostLinkBase {
  public:
+  ~HostLinkBase();
+
   /**
    * Enqueues a NAN configuration request to be sent to the host.
    * For Linux, the request is simply echoed back via a NAN configuration
@@ -30,6 +46,88 @@ class HostLinkBase {
    *        boolean's value.
    */
   void sendNanConfiguration(bool enable);
+
+  /**
+   * Creates a socket at the given path and starts accepting host client
+   * connections on a dedicated thread. Messages received from clients are
+   * decoded via HostProtocolChre, after setting their host client ID like the
+   * CHRE daemon does.
+   *
+   * @param socketPath Filesystem path of the socket. Any existing file at this
+   *        path is removed.
+   *
+   * @return true if the server was started.
+   */
+  bool startSocketServer(const char *socketPath);
+
+  /**
+   * Stops the socket server started by startSocketServer(), if any, and
+   * disconnects all clients.
+   */
+  void stopSocketServer();
+
+  /**
+   * @return true if the socket server is running.
+   */
+  bool isSocketServerRunning() const {
+    return mServerFd >= 0;
+  }
+
+  /**
+   * Sends an encoded message to the host client given by its host address, or
+   * to all clients if the host client ID is unspecified. This method is
+   * thread-safe.
+   *
+   * @param data FlatBuffers-encoded MessageContainer.
+   * @param dataLen Size of the message in bytes.
+   *
+   * @return true if the message was delivered to at least one client.
+   */
+  bool send(const uint8_t *data, size_t dataLen);
+
+ private:
+  static constexpr size_t kMaxClients = 8;
+  static constexpr size_t kMaxPacketSize = 1024 * 1024;
+
+  //! Index of the listening socket in mPollFds, followed by the read end of
+  //! mWakePipe and kMaxClients client sockets.
+  static constexpr size_t kListenIndex = 0;
+  static constexpr size_t kWakeIndex = 1;
+  static constexpr size_t kFirstClientIndex = 2;
+
+  //! The listening socket, or -1 if the server is not running.
+  int mServerFd = -1;
+
+  //! Written to by stopSocketServer() to wake the server thread.
+  int mWakePipe[2] = {-1, -1};
+
+  std::thread mServerThread;
+
+  //! Guards mClientIds and the client fds in mPollFds.
+  std::mutex mClientsMutex;
+
+  struct pollfd mPollFds[kFirstClientIndex + kMaxClients] = {};
+
+  //! Host client ID of each client slot, assigned on connection.
+  uint16_t mClientIds[kMaxClients] = {};
+
+  //! Host client ID of the next accepted client, starting at 1 as 0 is
+  //! kHostClientIdUnspecified.
+  uint16_t mNextClientId = 1;
+
+  std::vector<uint8_t> mRecvBuffer;
+
+  //! Runs the server thread until stopSocketServer() is called.
+  void serviceSocket();
+
+  void acceptClientConnection();
+
+  //! Receives and decodes a message from the client in the given slot, or
+  //! disconnects it on error.
+  void handleClientData(size_t clientIndex);
+
+  //! Closes the client socket in the given slot. mClientsMutex must be held.
+  void disconnectClientLocked(size_t clientIndex);
 };
 
 }  // namespace chre
@@ -32,8 +32,11 @@
 #include "chre/util/time.h"
 
 #include <tclap/CmdLine.h>
+#include <cinttypes>
 #include <csignal>
+#include <cstdio>
 #include <thread>
+#include <vector>
 
 using chre::EventLoopManagerSingleton;
 using chre::Milliseconds;
@@ -66,6 +69,19 @@ int main(int argc, char **argv) {
     TCLAP::MultiArg<std::string> nanoappsArg(
         "", "nanoapp", "nanoapp shared object to load and execute", false,
         "path", cmd);
+    TCLAP::ValueArg<std::string> hostSocketArg(
+        "", "host_socket",
+        "Unix socket to serve the CHRE daemon host protocol on", false, "",
+        "path", cmd);
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+    TCLAP::ValueArg<uint32_t> eventLoopsArg(
+        "", "event_loops", "number of event loop threads to run nanoapps on",
+        false, 1, "count", cmd);
+    TCLAP::MultiArg<std::string> eventLoopAffinityArg(
+        "", "event_loop_affinity",
+        "runs a nanoapp on the given event loop, e.g. 0x476f6f676c000001:1",
+        false, "app_id:index", cmd);
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
 #ifdef CHRE_AUDIO_SUPPORT_ENABLED
     TCLAP::ValueArg<std::string> audioFileArg(
         "", "audio_file", "WAV file to open for audio simulation", false, "",
@@ -101,6 +117,38 @@ int main(int argc, char **argv) {
     // Initialize the system.
     chre::init();
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+    // Start the event loops that run alongside the main one, and assign
+    // nanoapps to them.
+    std::vector<std::thread> eventLoopThreads;
+    for (uint32_t i = 1; i < eventLoopsArg.getValue(); i++) {
+      size_t index = EventLoopManagerSingleton::get()->addEventLoop();
+      if (index == 0) {
+        FATAL_ERROR("Failed to add event loop %" PRIu32, i);
+      }
+      eventLoopThreads.emplace_back([index]() {
+        EventLoopManagerSingleton::get()->getEventLoop(index).run();
+      });
+    }
+    for (const std::string &affinity : eventLoopAffinityArg.getValue()) {
+      uint64_t appId;
+      size_t index;
+      if (sscanf(affinity.c_str(), "%" SCNx64 ":%zu", &appId, &index) != 2 ||
+          !EventLoopManagerSingleton::get()->setEventLoopAffinity(appId,
+                                                                  index)) {
+        FATAL_ERROR("Invalid event loop affinity %s", affinity.c_str());
+      }
+    }
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
+    // Accept host connections if requested.
+    if (!hostSocketArg.getValue().empty() &&
+        !EventLoopManagerSingleton::get()
+             ->getHostCommsManager()
+             .startSocketServer(hostSocketArg.getValue().c_str())) {
+      FATAL_ERROR("Failed to start the host socket server");
+    }
+
     // Register a signal handler.
     std::signal(SIGINT, signalHandler);
 
@@ -126,6 +174,14 @@ int main(int argc, char **argv) {
     });
     chreThread.join();
 
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+    for (size_t i = 0; i < eventLoopThreads.size(); i++) {
+      EventLoopManagerSingleton::get()->getEventLoop(i + 1).stop();
+      eventLoopThreads[i].join();
+    }
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
+    EventLoopManagerSingleton::get()->getHostCommsManager().stopSocketServer();
     chre::TaskManagerSingleton::deinit();
     chre::deinit();
     chre::PlatformLogSingleton::deinit();
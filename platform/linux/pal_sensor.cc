@@ -48,11 +48,23 @@ struct chreSensorInfo gSensors[] = {
         .minInterval = 0,
         .sensorIndex = CHRE_SENSOR_INDEX_DEFAULT,
     },
+    // Sensor 1 - Proximity, only reports data when the test asks for it.
+    {
+        .sensorName = "Test Proximity",
+        .sensorType = CHRE_SENSOR_TYPE_PROXIMITY,
+        .isOnChange = 1,
+        .isOneShot = 0,
+        .reportsBiasEvents = 0,
+        .supportsPassiveMode = 0,
+        .minInterval = 0,
+        .sensorIndex = CHRE_SENSOR_INDEX_DEFAULT,
+    },
 };
 
 //! Task to deliver asynchronous sensor data after a CHRE request.
 std::optional<uint32_t> gSensor0TaskId;
 bool gIsSensor0Enabled = false;
+bool gIsSensor1Enabled = false;
 
 void stopSensor0Task() {
   if (gSensor0TaskId.has_value()) {
@@ -62,6 +74,7 @@ void stopSensor0Task() {
 
 void chrePalSensorApiClose() {
   stopSensor0Task();
+  gIsSensor1Enabled = false;
 }
 
 bool chrePalSensorApiOpen(const struct chrePalSystemApi *systemApi,
@@ -89,12 +102,13 @@ bool chrePalSensorApiGetSensors(const struct chreSensorInfo **sensors,
   return true;
 }
 
-void sendSensor0StatusUpdate(uint64_t intervalNs, bool enabled) {
+void sendSensorStatusUpdate(uint32_t sensorInfoIndex, uint64_t intervalNs,
+                            bool enabled) {
   auto status = chre::MakeUniqueZeroFill<struct chreSensorSamplingStatus>();
   status->interval = intervalNs;
   status->latency = 0;
   status->enabled = enabled;
-  gCallbacks->samplingStatusUpdateCallback(0, status.release());
+  gCallbacks->samplingStatusUpdateCallback(sensorInfoIndex, status.release());
 }
 
 void sendSensor0Events() {
@@ -117,15 +131,20 @@ bool chrePalSensorApiConfigureSensor(uint32_t sensorInfoIndex,
     return false;
   }
 
-  if (sensorInfoIndex != 0) {
-    // Only sensor 0 is supported for now.
-    return false;
+  if (sensorInfoIndex == 1) {
+    if (mode != CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS &&
+        mode != CHRE_SENSOR_CONFIGURE_MODE_DONE) {
+      return false;
+    }
+    gIsSensor1Enabled = (mode == CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS);
+    sendSensorStatusUpdate(1, intervalNs, gIsSensor1Enabled);
+    return true;
   }
 
   if (mode == CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS) {
     stopSensor0Task();
     gIsSensor0Enabled = true;
-    sendSensor0StatusUpdate(intervalNs, true /*enabled*/);
+    sendSensorStatusUpdate(0, intervalNs, true /*enabled*/);
     gSensor0TaskId = TaskManagerSingleton::get()->addTask(
         sendSensor0Events,
         std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -136,7 +155,7 @@ bool chrePalSensorApiConfigureSensor(uint32_t sensorInfoIndex,
   if (mode == CHRE_SENSOR_CONFIGURE_MODE_DONE) {
     stopSensor0Task();
     gIsSensor0Enabled = false;
-    sendSensor0StatusUpdate(intervalNs, false /*enabled*/);
+    sendSensorStatusUpdate(0, intervalNs, false /*enabled*/);
     return true;
   }
 
@@ -183,6 +202,23 @@ bool chrePalSensorIsSensor0Enabled() {
   return gIsSensor0Enabled;
 }
 
+bool chrePalSensorIsSensor1Enabled() {
+  return gIsSensor1Enabled;
+}
+
+void chrePalSensorSendSensor1Event(bool isNear) {
+  auto data = chre::MakeUniqueZeroFill<struct chreSensorByteData>();
+
+  data->header.baseTimestamp = gSystemApi->getCurrentTime();
+  data->header.sensorHandle = 1;
+  data->header.readingCount = 1;
+  data->header.accuracy = CHRE_SENSOR_ACCURACY_HIGH;
+  data->header.reserved = 0;
+  data->readings[0].isNear = isNear ? 1 : 0;
+
+  gCallbacks->dataEventCallback(1, data.release());
+}
+
 const chrePalSensorApi *chrePalSensorGetApi(uint32_t requestedApiVersion) {
   static const struct chrePalSensorApi kApi = {
       .moduleVersion = CHRE_PAL_SENSOR_API_CURRENT_VERSION,
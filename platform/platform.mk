@@ -37,6 +37,12 @@ SLPI_CFLAGS += $(FLATBUFFERS_CFLAGS)
 # SLPI still uses static event loop as oppose to heap based dynamic event loop
 SLPI_CFLAGS += -DCHRE_STATIC_EVENT_LOOP
 
+# Optional packing of queued nanoapp messages into BatchedMessages frames. Only
+# enable it with a host daemon that unbatches them.
+ifeq ($(CHRE_SLPI_BATCH_MESSAGES_TO_HOST), true)
+SLPI_CFLAGS += -DCHRE_SLPI_BATCH_MESSAGES_TO_HOST
+endif
+
 # SLPI/SEE-specific Compiler Flags #############################################
 
 # Include paths.
@@ -223,6 +229,8 @@ SIM_SRCS += platform/shared/chre_api_user_settings.cc
 SIM_SRCS += platform/shared/chre_api_version.cc
 SIM_SRCS += platform/shared/chre_api_wifi.cc
 SIM_SRCS += platform/shared/chre_api_wwan.cc
+SIM_SRCS += platform/shared/host_protocol_chre.cc
+SIM_SRCS += platform/shared/host_protocol_common.cc
 SIM_SRCS += platform/shared/memory_manager.cc
 SIM_SRCS += platform/shared/nanoapp/nanoapp_dso_util.cc
 SIM_SRCS += platform/shared/pal_system_api.cc
@@ -520,3 +528,9 @@ TINYSYS_CFLAGS += $(MBEDTLS_CFLAGS)
 TINYSYS_CFLAGS += -DCFG_DRAM_HEAP_SUPPORT
 TINYSYS_CFLAGS += -DCHRE_LOADER_ARCH=EM_RISCV
 TINYSYS_CFLAGS += -DCHRE_NANOAPP_LOAD_ALIGNMENT=4096
+
+# Optional authentication and mapping of nanoapp binaries as their fragments
+# arrive, rather than once the whole binary is buffered.
+ifeq ($(CHRE_NANOAPP_STREAMING_LOAD_ENABLED), true)
+TINYSYS_CFLAGS += -DCHRE_NANOAPP_STREAMING_LOAD_ENABLED
+endif
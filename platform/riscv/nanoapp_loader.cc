@@ -89,6 +89,11 @@ bool NanoappLoader::relocateTable(DynamicHeader *dyn, int tag) {
 }
 
 bool NanoappLoader::resolveGot() {
+  if (mSymbolRelocationsApplied) {
+    LOGV("GOT already resolved from the relocation manifest");
+    return true;
+  }
+
   ElfAddr *addr;
   ElfRela *reloc = reinterpret_cast<ElfRela *>(
       mMapping + getDynEntry(getDynamicHeader(), DT_JMPREL));
@@ -24,6 +24,7 @@
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/log.h"
 #include "chre/util/macros.h"
+#include "chre/util/nanoapp/host_message_queue.h"
 #include "chre/util/system/napp_permissions.h"
 #include "chre_api/chre/event.h"
 #include "chre_api/chre/re.h"
@@ -159,6 +160,11 @@ DLL_EXPORT bool chreConfigureHostEndpointNotifications(uint16_t hostEndpointId,
   return nanoapp->configureHostEndpointNotifications(hostEndpointId, enable);
 }
 
+DLL_EXPORT void platform_chreConfigureHostMessageQueueEvents(bool enable) {
+  chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
+  nanoapp->configureHostMessageQueueEvents(enable);
+}
+
 DLL_EXPORT bool chrePublishRpcServices(struct chreNanoappRpcService *services,
                                        size_t numServices) {
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
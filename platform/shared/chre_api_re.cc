@@ -19,6 +19,7 @@
 #include "chre/platform/assert.h"
 #include "chre/platform/memory.h"
 #include "chre/platform/shared/debug_dump.h"
+#include "chre/platform/shared/timer_slack.h"
 #include "chre/platform/system_time.h"
 #include "chre/util/macros.h"
 #include "chre_api/chre/re.h"
@@ -53,6 +54,11 @@ DLL_EXPORT uint32_t chreTimerSet(uint64_t duration, const void *cookie,
       .setNanoappTimer(nanoapp, chre::Nanoseconds(duration), cookie, oneShot);
 }
 
+DLL_EXPORT void platform_chreTimerSetSlack(uint64_t slackNs) {
+  chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
+  nanoapp->setTimerSlack(chre::Nanoseconds(slackNs));
+}
+
 DLL_EXPORT bool chreTimerCancel(uint32_t timerId) {
   chre::Nanoapp *nanoapp = EventLoopManager::validateChreApiCall(__func__);
   return EventLoopManagerSingleton::get()
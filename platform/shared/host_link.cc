@@ -71,11 +71,12 @@ void HostMessageHandlers::loadNanoappData(
          appId, appVersion, appFlags, targetApiVersion, totalAppBinaryLen,
          transactionId, hostClientId);
 
-    if (getLoadManager().hasPendingLoadTransaction()) {
-      FragmentedLoadInfo info = getLoadManager().getTransactionInfo();
+    FragmentedLoadInfo info;
+    if (getLoadManager().getTransactionToReplace(hostClientId, transactionId,
+                                                 &info)) {
       sendFragmentResponse(info.hostClientId, info.transactionId,
                            0 /* fragmentId */, false /* success */);
-      getLoadManager().markFailure();
+      getLoadManager().markFailure(info.hostClientId, info.transactionId);
     }
 
     success = getLoadManager().prepareForLoad(
@@ -83,15 +84,22 @@ void HostMessageHandlers::loadNanoappData(
         totalAppBinaryLen, targetApiVersion);
   }
 
+  // Fragments are acknowledged cumulatively, so the host may have several in
+  // flight: a response for a fragment covers all the fragments before it
+  uint32_t responseFragmentId = fragmentId;
   if (success) {
     success = getLoadManager().copyNanoappFragment(
         hostClientId, transactionId, (fragmentId == 0) ? 1 : fragmentId, buffer,
         bufferLen);
+    if (success && fragmentId != 0) {
+      responseFragmentId = getLoadManager().getLastContiguousFragmentId(
+          hostClientId, transactionId);
+    }
   } else {
     LOGE("Failed to prepare for load");
   }
 
-  if (getLoadManager().isLoadComplete()) {
+  if (getLoadManager().isLoadComplete(hostClientId, transactionId)) {
     LOGD("Load manager load complete...");
     auto cbData = MakeUnique<LoadNanoappCallbackData>();
     if (cbData.isNull()) {
@@ -100,8 +108,9 @@ void HostMessageHandlers::loadNanoappData(
       cbData->transactionId = transactionId;
       cbData->hostClientId = hostClientId;
       cbData->appId = appId;
-      cbData->fragmentId = fragmentId;
-      cbData->nanoapp = getLoadManager().releaseNanoapp();
+      cbData->fragmentId = responseFragmentId;
+      cbData->nanoapp =
+          getLoadManager().releaseNanoapp(hostClientId, transactionId);
       cbData->sendFragmentResponse = !respondBeforeStart;
 
       // Note that if this fails, we'll generate the error response in
@@ -110,12 +119,14 @@ void HostMessageHandlers::loadNanoappData(
           SystemCallbackType::FinishLoadingNanoapp, std::move(cbData),
           finishLoadingNanoappCallback);
       if (respondBeforeStart) {
-        sendFragmentResponse(hostClientId, transactionId, fragmentId, success);
+        sendFragmentResponse(hostClientId, transactionId, responseFragmentId,
+                             success);
       }  // else the response will be sent in finishLoadingNanoappCallback
     }
   } else {
     // send a response for this fragment
-    sendFragmentResponse(hostClientId, transactionId, fragmentId, success);
+    sendFragmentResponse(hostClientId, transactionId, responseFragmentId,
+                         success);
   }
 }
 
@@ -251,6 +251,33 @@ void HostProtocolChre::finishNanoappListResponse(
            hostClientId);
 }
 
+void HostProtocolChre::addBatchedNanoappMessage(
+    ChreFlatBufferBuilder &builder,
+    DynamicVector<NanoappMessageOffset> &offsetVector, uint64_t appId,
+    uint32_t messageType, uint16_t hostEndpoint, const void *messageData,
+    size_t messageDataLen, uint32_t permissions, uint32_t messagePermissions,
+    bool wokeHost) {
+  auto messageDataOffset = builder.CreateVector(
+      static_cast<const uint8_t *>(messageData), messageDataLen);
+  auto offset = fbs::CreateNanoappMessage(builder, appId, messageType,
+                                          hostEndpoint, messageDataOffset,
+                                          messagePermissions, permissions,
+                                          wokeHost);
+
+  if (!offsetVector.push_back(offset)) {
+    LOGE("Couldn't push batched nanoapp message offset!");
+  }
+}
+
+void HostProtocolChre::finishBatchedMessages(
+    ChreFlatBufferBuilder &builder,
+    DynamicVector<NanoappMessageOffset> &offsetVector) {
+  auto vectorOffset =
+      builder.CreateVector<NanoappMessageOffset>(offsetVector);
+  auto batch = fbs::CreateBatchedMessages(builder, vectorOffset);
+  finalize(builder, fbs::ChreMessage::BatchedMessages, batch.Union());
+}
+
 void HostProtocolChre::encodeLoadNanoappResponse(ChreFlatBufferBuilder &builder,
                                                  uint16_t hostClientId,
                                                  uint32_t transactionId,
@@ -39,6 +39,51 @@ namespace chre {
 bool authenticateBinary(const void *binary, size_t appBinaryLen,
                         void **realBinaryStart);
 
+//! The state of a binary being authenticated while it is received, defined by
+//! the platform.
+struct StreamingAuthentication;
+
+/**
+ * Starts authenticating a binary that is received in fragments, so that most
+ * of the work of authenticateBinary() is done by the time the last fragment
+ * arrives. Only required on platforms that define
+ * CHRE_NANOAPP_STREAMING_LOAD_ENABLED.
+ *
+ * @param appBinaryLen The length of the binary once fully received.
+ * @return The state of the authentication, or nullptr if out of memory.
+ */
+StreamingAuthentication *startStreamingAuthentication(size_t appBinaryLen);
+
+/**
+ * Authenticates the part of the binary received since the previous call.
+ *
+ * @param auth The state returned by startStreamingAuthentication().
+ * @param binary Pointer to the binary being received.
+ * @param bytesReceived The number of bytes of the binary received so far.
+ * @param realBinaryStart A non-null pointer that is filled with the starting
+ *     address of the raw binary once the headers used by the authentication
+ *     code have been received and verified, and left unchanged before that.
+ * @return false if the binary failed authentication.
+ */
+bool updateStreamingAuthentication(StreamingAuthentication *auth,
+                                   const void *binary, size_t bytesReceived,
+                                   void **realBinaryStart);
+
+/**
+ * Completes the authentication of a fully received binary and frees its state.
+ *
+ * @param auth The state returned by startStreamingAuthentication().
+ * @return True if the binary passed authentication.
+ */
+bool finishStreamingAuthentication(StreamingAuthentication *auth);
+
+/**
+ * Frees the state of an authentication that will not be completed.
+ *
+ * @param auth The state returned by startStreamingAuthentication().
+ */
+void abortStreamingAuthentication(StreamingAuthentication *auth);
+
 }  // namespace chre
 
 #endif  // CHRE_PLATFORM_SHARED_AUTHENTICATION_H_
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_SHARED_EXPORTED_SYMBOL_TABLE_H_
+#define CHRE_PLATFORM_SHARED_EXPORTED_SYMBOL_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+/**
+ * Looks up symbols exported to nanoapps by name in O(log n) string
+ * comparisons, rather than comparing the name against every exported symbol.
+ *
+ * The table refers to the names of the exported symbols, in the order they are
+ * declared in, and holds an index of them sorted by name. The index is built by
+ * the constexpr constructor, so a table declared constexpr is sorted at compile
+ * time, needs no static constructor and is only ever read.
+ *
+ * @tparam kNumSymbols The number of exported symbols.
+ */
+template <size_t kNumSymbols>
+class ExportedSymbolTable : public NonCopyable {
+ public:
+  static_assert(kNumSymbols < UINT16_MAX,
+                "Symbol indices must fit in 16 bits");
+
+  constexpr explicit ExportedSymbolTable(
+      const char *const (&names)[kNumSymbols])
+      : mNames(names) {
+    // An insertion sort is stable, so symbols with the same name stay in
+    // declaration order, and cheap enough to evaluate at compile time for the
+    // hundred or so exported symbols.
+    for (size_t i = 0; i < kNumSymbols; i++) {
+      uint16_t index = static_cast<uint16_t>(i);
+      size_t j = i;
+      while (j > 0 && compareNames(mNames[mSortedIndices[j - 1]],
+                                   mNames[index]) > 0) {
+        mSortedIndices[j] = mSortedIndices[j - 1];
+        j--;
+      }
+      mSortedIndices[j] = index;
+    }
+  }
+
+  /**
+   * @param name A null-terminated symbol name.
+   * @return The position in declaration order of the exported symbol with the
+   *     given name, or kNumSymbols if there is none. If several symbols share
+   *     the name, the one declared first is returned.
+   */
+  size_t find(const char *name) const {
+    size_t low = 0;
+    size_t high = kNumSymbols;
+    while (low < high) {
+      size_t mid = low + (high - low) / 2;
+      if (strcmp(getName(mid), name) < 0) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+
+    return (low < kNumSymbols && strcmp(getName(low), name) == 0)
+               ? mSortedIndices[low]
+               : kNumSymbols;
+  }
+
+ private:
+  //! The names of the exported symbols, in declaration order.
+  const char *const *mNames;
+
+  //! Indices into mNames, sorted by name.
+  uint16_t mSortedIndices[kNumSymbols] = {};
+
+  //! @return The name of the symbol at the given position of the sorted index.
+  const char *getName(size_t sortedIndex) const {
+    return mNames[mSortedIndices[sortedIndex]];
+  }
+
+  //! strcmp(), usable in a constant expression.
+  static constexpr int compareNames(const char *a, const char *b) {
+    while (*a != '\0' && *a == *b) {
+      a++;
+      b++;
+    }
+    return static_cast<int>(static_cast<unsigned char>(*a)) -
+           static_cast<int>(static_cast<unsigned char>(*b));
+  }
+};
+
+}  // namespace chre
+
+#endif  // CHRE_PLATFORM_SHARED_EXPORTED_SYMBOL_TABLE_H_
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_SHARED_EXPORTED_SYMBOLS_H_
+#define CHRE_PLATFORM_SHARED_EXPORTED_SYMBOLS_H_
+
+#include "chre/util/macros.h"
+
+// TODO(karthikmb/stange): While this array was hand-coded for simple
+// "hello-world" prototyping, the list of exported symbols must be
+// generated to minimize runtime errors and build breaks.
+
+/**
+ * The symbols exported to nanoapps by the nanoapp loader, as a list of
+ * initializers. SYMBOL(function_name, function_string) and
+ * C_SYMBOL(function_name) are the macros to expand each entry with, e.g.
+ * ADD_EXPORTED_SYMBOL() and ADD_EXPORTED_C_SYMBOL() for the symbols, or
+ * EXPORTED_SYMBOL_NAME() and EXPORTED_C_SYMBOL_NAME() for their names only.
+ */
+// clang-format off
+#define CHRE_LOADER_EXPORTED_SYMBOLS(SYMBOL, C_SYMBOL)  \
+    /* libmath overrides and symbols */                 \
+    SYMBOL(asinOverride, "asin"),                       \
+    SYMBOL(atan2Override, "atan2"),                     \
+    SYMBOL(cosOverride, "cos"),                         \
+    SYMBOL(floorOverride, "floor"),                     \
+    SYMBOL(fmaxOverride, "fmax"),                       \
+    SYMBOL(fminOverride, "fmin"),                       \
+    SYMBOL(frexpOverride, "frexp"),                     \
+    SYMBOL(roundOverride, "round"),                     \
+    SYMBOL(sinOverride, "sin"),                         \
+    SYMBOL(sqrtOverride, "sqrt"),                       \
+    C_SYMBOL(acosf),                                    \
+    C_SYMBOL(asinf),                                    \
+    C_SYMBOL(atan2f),                                   \
+    C_SYMBOL(ceilf),                                    \
+    C_SYMBOL(cosf),                                     \
+    C_SYMBOL(expf),                                     \
+    C_SYMBOL(fabsf),                                    \
+    C_SYMBOL(floorf),                                   \
+    C_SYMBOL(fmaxf),                                    \
+    C_SYMBOL(fminf),                                    \
+    C_SYMBOL(fmodf),                                    \
+    C_SYMBOL(log10f),                                   \
+    C_SYMBOL(log1pf),                                   \
+    C_SYMBOL(log2f),                                    \
+    C_SYMBOL(logf),                                     \
+    C_SYMBOL(lrintf),                                   \
+    C_SYMBOL(lroundf),                                  \
+    C_SYMBOL(powf),                                     \
+    C_SYMBOL(remainderf),                               \
+    C_SYMBOL(roundf),                                   \
+    C_SYMBOL(sinf),                                     \
+    C_SYMBOL(sqrtf),                                    \
+    C_SYMBOL(tanf),                                     \
+    C_SYMBOL(tanhf),                                    \
+    /* libc overrides and symbols */                    \
+    C_SYMBOL(__cxa_pure_virtual),                       \
+    SYMBOL(cxaAtexitOverride, "__cxa_atexit"),          \
+    SYMBOL(atexitOverride, "atexit"),                   \
+    C_SYMBOL(dlsym),                                    \
+    C_SYMBOL(isgraph),                                  \
+    C_SYMBOL(memcmp),                                   \
+    C_SYMBOL(memcpy),                                   \
+    C_SYMBOL(memmove),                                  \
+    C_SYMBOL(memset),                                   \
+    C_SYMBOL(snprintf),                                 \
+    C_SYMBOL(strcmp),                                   \
+    C_SYMBOL(strlen),                                   \
+    C_SYMBOL(strncmp),                                  \
+    C_SYMBOL(tolower),                                  \
+    /* CHRE symbols */                                  \
+    C_SYMBOL(chreAbort),                                \
+    C_SYMBOL(chreAudioConfigureSource),                 \
+    C_SYMBOL(chreAudioGetSource),                       \
+    C_SYMBOL(chreBleGetCapabilities),                   \
+    C_SYMBOL(chreBleGetFilterCapabilities),             \
+    C_SYMBOL(chreBleFlushAsync),                        \
+    C_SYMBOL(chreBleStartScanAsync),                    \
+    C_SYMBOL(chreBleStopScanAsync),                     \
+    C_SYMBOL(chreBleReadRssiAsync),                     \
+    C_SYMBOL(chreBleGetScanStatus),                     \
+    C_SYMBOL(chreConfigureDebugDumpEvent),              \
+    C_SYMBOL(chreConfigureHostSleepStateEvents),        \
+    C_SYMBOL(chreConfigureNanoappInfoEvents),           \
+    C_SYMBOL(chreDebugDumpLog),                         \
+    C_SYMBOL(chreGetApiVersion),                        \
+    C_SYMBOL(chreGetAppId),                             \
+    C_SYMBOL(chreGetInstanceId),                        \
+    C_SYMBOL(chreGetEstimatedHostTimeOffset),           \
+    C_SYMBOL(chreGetNanoappInfoByAppId),                \
+    C_SYMBOL(chreGetNanoappInfoByInstanceId),           \
+    C_SYMBOL(chreGetPlatformId),                        \
+    C_SYMBOL(chreGetSensorInfo),                        \
+    C_SYMBOL(chreGetSensorSamplingStatus),              \
+    C_SYMBOL(chreGetTime),                              \
+    C_SYMBOL(chreGetVersion),                           \
+    C_SYMBOL(chreGnssConfigurePassiveLocationListener), \
+    C_SYMBOL(chreGnssGetCapabilities),                  \
+    C_SYMBOL(chreGnssLocationSessionStartAsync),        \
+    C_SYMBOL(chreGnssLocationSessionStopAsync),         \
+    C_SYMBOL(chreGnssMeasurementSessionStartAsync),     \
+    C_SYMBOL(chreGnssMeasurementSessionStopAsync),      \
+    C_SYMBOL(chreHeapAlloc),                            \
+    C_SYMBOL(chreHeapFree),                             \
+    C_SYMBOL(chreIsHostAwake),                          \
+    C_SYMBOL(chreLog),                                  \
+    C_SYMBOL(chreSendEvent),                            \
+    C_SYMBOL(chreSendMessageToHost),                    \
+    C_SYMBOL(chreSendMessageToHostEndpoint),            \
+    C_SYMBOL(chreSendMessageWithPermissions),           \
+    C_SYMBOL(chreSensorConfigure),                      \
+    C_SYMBOL(chreSensorConfigureBiasEvents),            \
+    C_SYMBOL(chreSensorFind),                           \
+    C_SYMBOL(chreSensorFindDefault),                    \
+    C_SYMBOL(chreSensorFlushAsync),                     \
+    C_SYMBOL(chreSensorGetThreeAxisBias),               \
+    C_SYMBOL(chreTimerCancel),                          \
+    C_SYMBOL(chreTimerSet),                             \
+    C_SYMBOL(chreUserSettingConfigureEvents),           \
+    C_SYMBOL(chreUserSettingGetState),                  \
+    C_SYMBOL(chreWifiConfigureScanMonitorAsync),        \
+    C_SYMBOL(chreWifiGetCapabilities),                  \
+    C_SYMBOL(chreWifiRequestScanAsync),                 \
+    C_SYMBOL(chreWifiRequestRangingAsync),              \
+    C_SYMBOL(chreWifiNanRequestRangingAsync),           \
+    C_SYMBOL(chreWifiNanSubscribe),                     \
+    C_SYMBOL(chreWifiNanSubscribeCancel),               \
+    C_SYMBOL(chreWwanGetCapabilities),                  \
+    C_SYMBOL(chreWwanGetCellInfoAsync),                 \
+    C_SYMBOL(platform_chreDebugDumpVaLog),              \
+    C_SYMBOL(platform_chreTimerSetSlack),               \
+    C_SYMBOL(platform_chreConfigureHostMessageQueueEvents), \
+    C_SYMBOL(chreConfigureHostEndpointNotifications),   \
+    C_SYMBOL(chrePublishRpcServices),                   \
+    C_SYMBOL(chreGetHostEndpointInfo),
+// clang-format on
+
+// Macros used to list the name of a symbol exported by the nanoapp loader,
+// without referencing the symbol
+#define EXPORTED_SYMBOL_NAME(function_name, function_string) function_string
+#define EXPORTED_C_SYMBOL_NAME(function_name) STRINGIFY(function_name)
+
+#endif  // CHRE_PLATFORM_SHARED_EXPORTED_SYMBOLS_H_
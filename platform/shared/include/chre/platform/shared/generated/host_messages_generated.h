@@ -99,6 +99,9 @@ struct NanConfigurationUpdateBuilder;
 struct DebugConfiguration;
 struct DebugConfigurationBuilder;
 
+struct BatchedMessages;
+struct BatchedMessagesBuilder;
+
 struct HostAddress;
 
 struct MessageContainer;
@@ -218,31 +221,34 @@ enum class LogType : int8_t {
   STRING = 0,
   TOKENIZED = 1,
   BLUETOOTH = 2,
+  STRUCTURED = 3,
   MIN = STRING,
-  MAX = BLUETOOTH
+  MAX = STRUCTURED
 };
 
-inline const LogType (&EnumValuesLogType())[3] {
+inline const LogType (&EnumValuesLogType())[4] {
   static const LogType values[] = {
     LogType::STRING,
     LogType::TOKENIZED,
-    LogType::BLUETOOTH
+    LogType::BLUETOOTH,
+    LogType::STRUCTURED
   };
   return values;
 }
 
 inline const char * const *EnumNamesLogType() {
-  static const char * const names[4] = {
+  static const char * const names[5] = {
     "STRING",
     "TOKENIZED",
     "BLUETOOTH",
+    "STRUCTURED",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameLogType(LogType e) {
-  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::BLUETOOTH)) return "";
+  if (flatbuffers::IsOutRange(e, LogType::STRING, LogType::STRUCTURED)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesLogType()[index];
 }
@@ -309,11 +315,12 @@ enum class ChreMessage : uint8_t {
   NanConfigurationRequest = 26,
   NanConfigurationUpdate = 27,
   DebugConfiguration = 28,
+  BatchedMessages = 29,
   MIN = NONE,
-  MAX = DebugConfiguration
+  MAX = BatchedMessages
 };
 
-inline const ChreMessage (&EnumValuesChreMessage())[29] {
+inline const ChreMessage (&EnumValuesChreMessage())[30] {
   static const ChreMessage values[] = {
     ChreMessage::NONE,
     ChreMessage::NanoappMessage,
@@ -343,13 +350,14 @@ inline const ChreMessage (&EnumValuesChreMessage())[29] {
     ChreMessage::BatchedMetricLog,
     ChreMessage::NanConfigurationRequest,
     ChreMessage::NanConfigurationUpdate,
-    ChreMessage::DebugConfiguration
+    ChreMessage::DebugConfiguration,
+    ChreMessage::BatchedMessages
   };
   return values;
 }
 
 inline const char * const *EnumNamesChreMessage() {
-  static const char * const names[30] = {
+  static const char * const names[31] = {
     "NONE",
     "NanoappMessage",
     "HubInfoRequest",
@@ -379,13 +387,14 @@ inline const char * const *EnumNamesChreMessage() {
     "NanConfigurationRequest",
     "NanConfigurationUpdate",
     "DebugConfiguration",
+    "BatchedMessages",
     nullptr
   };
   return names;
 }
 
 inline const char *EnumNameChreMessage(ChreMessage e) {
-  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::DebugConfiguration)) return "";
+  if (flatbuffers::IsOutRange(e, ChreMessage::NONE, ChreMessage::BatchedMessages)) return "";
   const size_t index = static_cast<size_t>(e);
   return EnumNamesChreMessage()[index];
 }
@@ -506,6 +515,10 @@ template<> struct ChreMessageTraits<chre::fbs::DebugConfiguration> {
   static const ChreMessage enum_value = ChreMessage::DebugConfiguration;
 };
 
+template<> struct ChreMessageTraits<chre::fbs::BatchedMessages> {
+  static const ChreMessage enum_value = ChreMessage::BatchedMessages;
+};
+
 bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj, ChreMessage type);
 bool VerifyChreMessageVector(flatbuffers::Verifier &verifier, const flatbuffers::Vector<flatbuffers::Offset<void>> *values, const flatbuffers::Vector<uint8_t> *types);
 
@@ -1963,7 +1976,8 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   /// uint8_t                 - Log metadata, encoded as follows:
   ///                           [EI(Upper nibble) | Level(Lower nibble)]
   ///                            * Log Type
-  ///                              (0 = No encoding, 1 = Tokenized log, 2 = BT snoop log)
+  ///                              (0 = No encoding, 1 = Tokenized log, 2 = BT snoop log,
+  ///                               3 = Structured log)
   ///                            * LogBuffer log level (1 = error, 2 = warn,
   ///                                                   3 = info,  4 = debug,
   ///                                                   5 = verbose)
@@ -1989,6 +2003,14 @@ struct LogMessageV2 FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   ///   size 24 bytes were to be represented, a buffer of size 26 bytes would
   ///   be needed to encode this as: [Direction(1B) | Size(1B) | Data(24B)].
   ///
+  /// * Structured logs: The log buffer is laid out like an encoded log,
+  ///   [Size(1B) | Data], where the data is the NULL terminated printf format
+  ///   string followed by the arguments to format it with on the host. Each
+  ///   argument is encoded according to its conversion: signed integers as
+  ///   zigzag varints, unsigned integers, characters and pointers as varints,
+  ///   floating point values as little-endian doubles, and strings as
+  ///   [Length(1B) | Characters].
+  ///
   /// This pattern repeats until the end of the buffer for multiple log
   /// messages. The last byte will always be a null-terminator. There are no
   /// padding bytes between these fields. Treat this like a packed struct and be
@@ -2507,6 +2529,59 @@ inline flatbuffers::Offset<DebugConfiguration> CreateDebugConfiguration(
   return builder_.Finish();
 }
 
+struct BatchedMessages FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
+  typedef BatchedMessagesBuilder Builder;
+  enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
+    VT_NANOAPP_MESSAGES = 4
+  };
+  const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *nanoapp_messages() const {
+    return GetPointer<const flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *>(VT_NANOAPP_MESSAGES);
+  }
+  bool Verify(flatbuffers::Verifier &verifier) const {
+    return VerifyTableStart(verifier) &&
+           VerifyOffset(verifier, VT_NANOAPP_MESSAGES) &&
+           verifier.VerifyVector(nanoapp_messages()) &&
+           verifier.VerifyVectorOfTables(nanoapp_messages()) &&
+           verifier.EndTable();
+  }
+};
+
+struct BatchedMessagesBuilder {
+  typedef BatchedMessages Table;
+  flatbuffers::FlatBufferBuilder &fbb_;
+  flatbuffers::uoffset_t start_;
+  void add_nanoapp_messages(flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> nanoapp_messages) {
+    fbb_.AddOffset(BatchedMessages::VT_NANOAPP_MESSAGES, nanoapp_messages);
+  }
+  explicit BatchedMessagesBuilder(flatbuffers::FlatBufferBuilder &_fbb)
+        : fbb_(_fbb) {
+    start_ = fbb_.StartTable();
+  }
+  BatchedMessagesBuilder &operator=(const BatchedMessagesBuilder &);
+  flatbuffers::Offset<BatchedMessages> Finish() {
+    const auto end = fbb_.EndTable(start_);
+    auto o = flatbuffers::Offset<BatchedMessages>(end);
+    return o;
+  }
+};
+
+inline flatbuffers::Offset<BatchedMessages> CreateBatchedMessages(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<chre::fbs::NanoappMessage>>> nanoapp_messages = 0) {
+  BatchedMessagesBuilder builder_(_fbb);
+  builder_.add_nanoapp_messages(nanoapp_messages);
+  return builder_.Finish();
+}
+
+inline flatbuffers::Offset<BatchedMessages> CreateBatchedMessagesDirect(
+    flatbuffers::FlatBufferBuilder &_fbb,
+    const std::vector<flatbuffers::Offset<chre::fbs::NanoappMessage>> *nanoapp_messages = nullptr) {
+  auto nanoapp_messages__ = nanoapp_messages ? _fbb.CreateVector<flatbuffers::Offset<chre::fbs::NanoappMessage>>(*nanoapp_messages) : 0;
+  return chre::fbs::CreateBatchedMessages(
+      _fbb,
+      nanoapp_messages__);
+}
+
 /// The top-level container that encapsulates all possible messages. Note that
 /// per FlatBuffers requirements, we can't use a union as the top-level
 /// structure (root type), so we must wrap it in a table.
@@ -2608,6 +2683,9 @@ struct MessageContainer FLATBUFFERS_FINAL_CLASS : private flatbuffers::Table {
   const chre::fbs::DebugConfiguration *message_as_DebugConfiguration() const {
     return message_type() == chre::fbs::ChreMessage::DebugConfiguration ? static_cast<const chre::fbs::DebugConfiguration *>(message()) : nullptr;
   }
+  const chre::fbs::BatchedMessages *message_as_BatchedMessages() const {
+    return message_type() == chre::fbs::ChreMessage::BatchedMessages ? static_cast<const chre::fbs::BatchedMessages *>(message()) : nullptr;
+  }
   /// The originating or destination client ID on the host side, used to direct
   /// responses only to the client that sent the request. Although initially
   /// populated by the requesting client, this is enforced to be the correct
@@ -2739,6 +2817,10 @@ template<> inline const chre::fbs::DebugConfiguration *MessageContainer::message
   return message_as_DebugConfiguration();
 }
 
+template<> inline const chre::fbs::BatchedMessages *MessageContainer::message_as<chre::fbs::BatchedMessages>() const {
+  return message_as_BatchedMessages();
+}
+
 struct MessageContainerBuilder {
   typedef MessageContainer Table;
   flatbuffers::FlatBufferBuilder &fbb_;
@@ -2895,6 +2977,10 @@ inline bool VerifyChreMessage(flatbuffers::Verifier &verifier, const void *obj,
       auto ptr = reinterpret_cast<const chre::fbs::DebugConfiguration *>(obj);
       return verifier.VerifyTable(ptr);
     }
+    case ChreMessage::BatchedMessages: {
+      auto ptr = reinterpret_cast<const chre::fbs::BatchedMessages *>(obj);
+      return verifier.VerifyTable(ptr);
+    }
     default: return true;
   }
 }
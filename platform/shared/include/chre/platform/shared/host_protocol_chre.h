@@ -32,6 +32,7 @@
 namespace chre {
 
 typedef flatbuffers::Offset<fbs::NanoappListEntry> NanoappListEntryOffset;
+typedef flatbuffers::Offset<fbs::NanoappMessage> NanoappMessageOffset;
 
 /**
  * Checks that a string encapsulated as a byte vector is null-terminated, and
@@ -199,6 +200,46 @@ class HostProtocolChre : public HostProtocolCommon {
       DynamicVector<NanoappListEntryOffset> &offsetVector,
       uint16_t hostClientId);
 
+  /**
+   * Supports construction of a BatchedMessages frame by adding a single
+   * NanoappMessage to it, following the same pattern as addNanoappListEntry().
+   * Example usage:
+   *
+   *   ChreFlatBufferBuilder builder;
+   *   DynamicVector<NanoappMessageOffset> vector;
+   *   for (auto message : pendingMessages) {
+   *     HostProtocolChre::addBatchedNanoappMessage(builder, vector, ...);
+   *   }
+   *   HostProtocolChre::finishBatchedMessages(builder, vector);
+   *
+   * @param builder A ChreFlatBufferBuilder to use for encoding the message
+   * @param offsetVector A vector to track the offset to the newly added
+   *        NanoappMessage, which be passed to finishBatchedMessages() once all
+   *        messages are added
+   *
+   * @see HostProtocolCommon::encodeNanoappMessage() for the other parameters
+   */
+  static void addBatchedNanoappMessage(
+      ChreFlatBufferBuilder &builder,
+      DynamicVector<NanoappMessageOffset> &offsetVector, uint64_t appId,
+      uint32_t messageType, uint16_t hostEndpoint, const void *messageData,
+      size_t messageDataLen, uint32_t permissions, uint32_t messagePermissions,
+      bool wokeHost);
+
+  /**
+   * Finishes encoding a BatchedMessages frame after all NanoappMessage
+   * elements have already been added to the builder.
+   *
+   * @param builder The ChreFlatBufferBuilder used with
+   *        addBatchedNanoappMessage()
+   * @param offsetVector The vector used with addBatchedNanoappMessage()
+   *
+   * @see addBatchedNanoappMessage()
+   */
+  static void finishBatchedMessages(
+      ChreFlatBufferBuilder &builder,
+      DynamicVector<NanoappMessageOffset> &offsetVector);
+
   /**
    * Encodes a response to the host communicating the result of dynamically
    * loading a nanoapp.
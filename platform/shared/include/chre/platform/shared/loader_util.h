@@ -237,6 +237,8 @@ typedef struct elf32_sym {
 #define R_RISCV_JUMP_SLOT 5
 // Undefined symbol.
 #define SHN_UNDEF 0
+// Section occupying no space in the file.
+#define SHT_NOBITS 8
 
 // The following (legal values for segment flags) are copied from
 // bionic's elf.h
@@ -26,6 +26,10 @@
 
 namespace chre {
 
+namespace fbs {
+enum class LogType : int8_t;
+}  // namespace fbs
+
 /**
  * Values that represent a preferred setting for when the LogBuffer should
  * notify the platform that logs are ready to be copied.
@@ -86,6 +90,10 @@ class LogBuffer {
   //! message.
   static constexpr size_t kLogDataOffset = 5;
 
+  //! The max size of the data of an encoded log, which is preceded by its
+  //! size in the log entry.
+  static constexpr size_t kEncodedLogMaxSize = kLogMaxSize - 1;
+
   /**
    * @param callback The callback object that will receive notifications about
    *                 the state of the log buffer or nullptr if it is not needed.
@@ -132,6 +140,30 @@ class LogBuffer {
   void handleEncodedLog(LogBufferLogLevel logLevel, uint32_t timestampMs,
                         const uint8_t *log, size_t logSize);
 
+  /**
+   * Same as handleEncodedLog but for a log encoded by encodeStructuredLogVa.
+   */
+  void handleStructuredLog(LogBufferLogLevel logLevel, uint32_t timestampMs,
+                           const uint8_t *log, size_t logSize);
+
+  /**
+   * Encodes a log as a structured log, deferring its formatting to the host:
+   * the format string is copied along with the raw values of its arguments
+   * instead of being printed with vsnprintf. See LogMessageData in
+   * host_messages.fbs for the encoding.
+   *
+   * @param buffer The buffer the log is encoded into.
+   * @param bufferSize The size of the buffer, at most kEncodedLogMaxSize.
+   * @param logFormat The ASCII log format.
+   * @param args The arguments of the log format, consumed by this call.
+   * @return The size of the encoded log, or 0 if it did not fit into the
+   *     buffer or the log format uses a conversion structured logs don't
+   *     support ('*' width or precision, %n or long double), in which case it
+   *     should be logged as text.
+   */
+  static size_t encodeStructuredLogVa(uint8_t *buffer, size_t bufferSize,
+                                      const char *logFormat, va_list args);
+
 #ifdef CHRE_BLE_SUPPORT_ENABLED
   /**
    * Similar to handleLog but buffer a BT snoop log.
@@ -283,6 +315,13 @@ class LogBuffer {
    */
   size_t getNextLogIndex(size_t startingIndex, size_t *logSize);
 
+  /**
+   * @param startingIndex The index of the data portion of an encoded log.
+   * @return The length of the data portion of the log along with the byte
+   *         holding its size.
+   */
+  size_t getEncodedLogDataLength(size_t startingIndex);
+
   /**
    * @param startingIndex The index to start from.
    * @return The length of the data portion of a log along with the null
@@ -297,21 +336,25 @@ class LogBuffer {
    * is used) and dispatch it.
    */
   void processLog(LogBufferLogLevel logLevel, uint32_t timestampMs,
-                  const void *log, size_t logSize, bool encoded = true);
+                  const void *log, size_t logSize, fbs::LogType logType);
 
   /**
    * First ensure that there's enough space for the log by discarding older
    * logs, then encode and copy this log into the internal log buffer.
    */
   void copyLogToBuffer(LogBufferLogLevel level, uint32_t timestampMs,
-                       const void *logBuffer, uint8_t logLen, bool encoded);
+                       const void *logBuffer, uint8_t logLen,
+                       fbs::LogType logType);
 
   /**
    * Invalidate memory allocated for log at head while the buffer is greater
    * than max size. This function must only be called with the log buffer mutex
    * locked.
+   *
+   * @param logDataSize The size of the data portion of the log about to be
+   *        copied into the buffer.
    */
-  void discardExcessOldLogsLocked(bool encoded, uint8_t currentLogLen);
+  void discardExcessOldLogsLocked(size_t logDataSize);
 
   /**
    * Add an encoding header to the log message if the encoding param is true.
@@ -319,7 +362,7 @@ class LogBuffer {
    */
   void encodeAndCopyLogLocked(LogBufferLogLevel level, uint32_t timestampMs,
                               const void *logBuffer, uint8_t logLen,
-                              bool encoded);
+                              fbs::LogType logType);
 
   /**
    * Send ready to dispatch logs over, based on the current log notification
@@ -343,6 +386,8 @@ class LogBuffer {
    *  - When logs are unencoded, the data buffer can be interpreted as a
    *    NULL terminated C-style string (pass to string manipulation functions,
    *    get size from strlen(), etc.).
+   *  - Structured logs are laid out like encoded logs, their data holding the
+   *    format string and raw arguments of the log.
    *
    * This pattern is repeated as many times as there is log entries in the
    * buffer.
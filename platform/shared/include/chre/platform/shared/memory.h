@@ -18,6 +18,7 @@
 #define CHRE_PLATFORM_SHARED_MEMORY_H_
 
 #include <cstddef>
+#include <new>
 #include <type_traits>
 #include <utility>
 
@@ -24,6 +24,19 @@
 #include "chre/util/non_copyable.h"
 #include "chre/util/unique_ptr.h"
 
+#ifndef CHRE_NANOAPP_LOAD_FRAGMENT_WINDOW_SIZE
+//! The number of fragments of a load transaction accepted at once, starting
+//! from the next expected one. Fragments that arrive ahead of it are held until
+//! the fragments before them are received.
+#define CHRE_NANOAPP_LOAD_FRAGMENT_WINDOW_SIZE 4
+#endif
+
+#ifndef CHRE_MAX_CONCURRENT_NANOAPP_LOADS
+//! The number of load transactions that can be in progress at once. Each one
+//! holds the binary of the nanoapp it loads until the nanoapp is started.
+#define CHRE_MAX_CONCURRENT_NANOAPP_LOADS 2
+#endif
+
 namespace chre {
 
 /**
@@ -39,14 +52,15 @@ struct FragmentedLoadInfo {
 };
 
 /**
- * A class which handles loading a (possibly fragmented) nanoapp binary.
+ * A class which handles loading (possibly fragmented) nanoapp binaries. Up to
+ * CHRE_MAX_CONCURRENT_NANOAPP_LOADS transactions, identified by their host
+ * client and transaction IDs, can be in progress at once.
  */
 class NanoappLoadManager : public NonCopyable {
  public:
   /**
-   * Prepares for a (possibly fragmented) load transaction. If an ongoing
-   * transaction exists, the transaction will be overwritten by the new
-   * incoming transaction.
+   * Prepares for a (possibly fragmented) load transaction. The caller must
+   * first make room for it with getTransactionToReplace() and markFailure().
    *
    * @param hostClientId the ID of client that originated this transaction
    * @param transactionId the ID of the transaction
@@ -63,8 +77,12 @@ class NanoappLoadManager : public NonCopyable {
                       size_t totalBinaryLen, uint32_t targetApiVersion);
 
   /**
-   * Copies a fragment of a nanoapp binary. If the parameters do not match the
-   * expected load transaction, the transaction is marked as a failure.
+   * Copies a fragment of a nanoapp binary. Fragments are copied in order: a
+   * fragment within the window ahead of the next expected one is held until
+   * the fragments before it are received, a fragment that was already copied
+   * is ignored, and any other fragment is rejected without affecting the
+   * transaction. If copying a fragment fails, the transaction is marked as a
+   * failure.
    *
    * @param hostClientId the ID of client that originated this transaction
    * @param transactionId the ID of the transaction
@@ -72,72 +90,151 @@ class NanoappLoadManager : public NonCopyable {
    * @param buffer the pointer to the buffer binary
    * @param bufferLen the size of the buffer in bytes
    *
-   * @return true if the copy was successful, false otherwise
+   * @return true if the fragment was copied, held or already copied, false
+   *         otherwise
    */
   bool copyNanoappFragment(uint16_t hostClientId, uint32_t transactionId,
                            uint32_t fragmentId, const void *buffer,
                            size_t bufferLen);
 
+  /**
+   * Finds the pending transaction a new transaction must replace: a pending
+   * transaction with the same IDs, or the oldest one if no more transactions
+   * can be in progress.
+   *
+   * @param hostClientId the ID of client that originated the new transaction
+   * @param transactionId the ID of the new transaction
+   * @param info populated with the transaction to replace, if any
+   *
+   * @return true if a transaction must be replaced, false otherwise
+   */
+  bool getTransactionToReplace(uint16_t hostClientId, uint32_t transactionId,
+                               FragmentedLoadInfo *info) const;
+
   /**
    * Invalidates an ongoing load transaction. After this method is invoked,
-   * hasPendingLoadTransaction() will return false, and a new transaction must
-   * be started by invoking prepareForLoad.
+   * hasPendingLoadTransaction() will return false for it, and a new
+   * transaction must be started by invoking prepareForLoad.
    */
-  void markFailure() {
-    mNanoapp.reset(nullptr);
-  }
+  void markFailure(uint16_t hostClientId, uint32_t transactionId);
 
   /**
-   * @return true if a pending transaction exists, false otherwise
+   * @return true if the given transaction is pending, false otherwise
    */
-  bool hasPendingLoadTransaction() const {
-    return !mNanoapp.isNull();
+  bool hasPendingLoadTransaction(uint16_t hostClientId,
+                                 uint32_t transactionId) const {
+    return findTransaction(hostClientId, transactionId) != nullptr;
   }
 
   /**
-   * @return true if a pending transaction exists and the nanoapp is fully
+   * @return true if the given transaction is pending and its nanoapp is fully
    *         loaded, false otherwise
    */
-  bool isLoadComplete() const {
-    return hasPendingLoadTransaction() && mNanoapp->isLoaded();
+  bool isLoadComplete(uint16_t hostClientId, uint32_t transactionId) const {
+    const LoadTransaction *transaction =
+        findTransaction(hostClientId, transactionId);
+    return transaction != nullptr && transaction->nanoapp->isLoaded();
   }
 
   /**
-   * @return the currently ongoing load transaction, invalid if
-   *         hasPendingLoadTransaction() returns false
+   * @return the ID of the last fragment of the given transaction copied such
+   *         that all fragments before it were copied too, which acknowledges
+   *         all of them to the host, or 0 if the transaction is not pending
    */
-  FragmentedLoadInfo getTransactionInfo() const {
-    return mCurrentLoadInfo;
+  uint32_t getLastContiguousFragmentId(uint16_t hostClientId,
+                                       uint32_t transactionId) const {
+    const LoadTransaction *transaction =
+        findTransaction(hostClientId, transactionId);
+    return (transaction == nullptr) ? 0 : transaction->info.nextFragmentId - 1;
   }
 
   /**
-   * Releases the underlying nanoapp of a currently ongoing load transaction,
-   * regardless of completion status. After this method is called, the ownership
-   * of the nanoapp is transferred to the caller. This method should only be
-   * called if hasPendingLoadTransaction() is true.
+   * Releases the underlying nanoapp of a pending load transaction, regardless
+   * of completion status, which ends the transaction. After this method is
+   * called, the ownership of the nanoapp is transferred to the caller.
    *
-   * @return the UniquePtr<Nanoapp> of the ongoing transaction, or null if no
-   *             transaction exists
+   * @return the UniquePtr<Nanoapp> of the transaction, or null if the
+   *         transaction is not pending
    */
-  UniquePtr<Nanoapp> releaseNanoapp() {
-    return mNanoapp.release();
+  UniquePtr<Nanoapp> releaseNanoapp(uint16_t hostClientId,
+                                    uint32_t transactionId);
+
+  ~NanoappLoadManager() {
+    for (LoadTransaction &transaction : mTransactions) {
+      releaseHeldFragments(transaction);
+    }
   }
 
  private:
-  //! The currently managed fragmented load.
-  FragmentedLoadInfo mCurrentLoadInfo;
+  static constexpr uint32_t kFragmentWindowSize =
+      CHRE_NANOAPP_LOAD_FRAGMENT_WINDOW_SIZE;
+  static_assert(kFragmentWindowSize > 0,
+                "The fragment window must include the next fragment");
+
+  static constexpr size_t kMaxConcurrentLoads =
+      CHRE_MAX_CONCURRENT_NANOAPP_LOADS;
+  static_assert(kMaxConcurrentLoads > 0,
+                "At least one load transaction must be supported");
+
+  //! A copy of a fragment received ahead of the next expected one.
+  struct HeldFragment {
+    //! The ID of the fragment, or 0 if this slot is unused.
+    uint32_t fragmentId = 0;
+    void *buffer = nullptr;
+    size_t bufferLen = 0;
+  };
+
+  //! A load transaction, which is pending while it holds a nanoapp.
+  struct LoadTransaction {
+    FragmentedLoadInfo info;
+
+    //! Orders transactions by the time they were prepared.
+    uint32_t sequenceNumber;
+
+    //! The underlying nanoapp that is being loaded.
+    UniquePtr<Nanoapp> nanoapp;
 
-  //! The underlying nanoapp that is being loaded.
-  UniquePtr<Nanoapp> mNanoapp;
+    //! The fragments held until the fragments before them are received,
+    //! indexed by fragment ID modulo the window size. The slot of the next
+    //! expected fragment is always unused.
+    HeldFragment heldFragments[kFragmentWindowSize];
+  };
+
+  LoadTransaction mTransactions[kMaxConcurrentLoads];
+
+  //! The sequence number of the next prepared transaction.
+  uint32_t mNextSequenceNumber = 0;
+
+  /**
+   * @return the pending transaction with the given IDs, or nullptr if none
+   */
+  LoadTransaction *findTransaction(uint16_t hostClientId,
+                                   uint32_t transactionId);
+  const LoadTransaction *findTransaction(uint16_t hostClientId,
+                                         uint32_t transactionId) const;
+
+  /**
+   * Keeps a copy of a fragment received ahead of the next expected one, which
+   * must be within the window.
+   *
+   * @return true if the fragment is held, false otherwise
+   */
+  bool holdFragment(LoadTransaction &transaction, uint32_t fragmentId,
+                    const void *buffer, size_t bufferLen);
 
   /**
-   * Validates an incoming fragment against the next expected one. An error is
-   * logged if invalid arguments are passed.
+   * Copies the next expected fragment, then the held fragments that follow
+   * it.
    *
-   * @return true if the arguments represent the next fragment, false otherwise
+   * @return true if all copies were successful, false otherwise
+   */
+  bool copyFragmentsInOrder(LoadTransaction &transaction, const void *buffer,
+                            size_t bufferLen);
+
+  /**
+   * Frees all fragments held by a transaction.
    */
-  bool validateFragment(uint16_t hostClientId, uint32_t transactionId,
-                        uint32_t fragmentId) const;
+  void releaseHeldFragments(LoadTransaction &transaction);
 };
 
 }  // namespace chre
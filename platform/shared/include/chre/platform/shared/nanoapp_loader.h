@@ -76,6 +76,11 @@ class NanoappLoader {
     mIsTcmBinary = mapIntoTcm;
   }
 
+  NanoappLoader(void *elfInput, size_t elfSize, bool mapIntoTcm)
+      : NanoappLoader(elfInput, mapIntoTcm) {
+    mBinarySize = elfSize;
+  }
+
   /**
    * Factory method to create a NanoappLoader Instance after loading
    * the buffer containing the ELF binary.
@@ -95,6 +100,56 @@ class NanoappLoader {
    */
   static void destroy(NanoappLoader *loader);
 
+  /**
+   * Factory method to create a NanoappLoader instance that verifies and maps
+   * the ELF binary while it is still being received, see onBinaryReceived().
+   * The load is then completed with finishStreaming(), or abandoned with
+   * abortStreaming().
+   *
+   * @param elfInput Buffer the elf file is being received into.
+   * @param elfSize The size of the elf file once fully received.
+   * @param mapIntoTcm Indicates whether the elfBinary should be mapped into
+   *     tightly coupled memory.
+   * @return Class instance, nullptr if out of memory.
+   */
+  static NanoappLoader *createStreaming(void *elfInput, size_t elfSize,
+                                        bool mapIntoTcm);
+
+  /**
+   * Completes a load started with createStreaming() once the binary is fully
+   * received and authenticated, by resolving symbols and invoking static
+   * initializers. The loader is freed if this fails.
+   *
+   * @param loader A non-null pointer returned by createStreaming().
+   * @return The loader, to be used as the result of create(), on success.
+   *     nullptr otherwise.
+   */
+  static void *finishStreaming(NanoappLoader *loader);
+
+  /**
+   * Frees a loader created by createStreaming() whose load is abandoned before
+   * finishStreaming() is called.
+   *
+   * @param loader A non-null pointer returned by createStreaming().
+   */
+  static void abortStreaming(NanoappLoader *loader);
+
+  /**
+   * Verifies and maps the part of the ELF binary received since the previous
+   * call: the ELF and program headers, the load segments, and the section
+   * headers along with the tables they refer to, each as soon as it is
+   * received.
+   *
+   * The binary is not authenticated at this point, so only data within the
+   * bounds of the binary and of the mapping is read and copied. Relocations
+   * and static initializers are left to finishStreaming().
+   *
+   * @param bytesReceived The number of bytes of the ELF binary received so
+   *     far.
+   * @return false if the received part of the binary is invalid.
+   */
+  bool onBinaryReceived(size_t bytesReceived);
+
   /**
    * Attempts to locate the exported symbol specified by the given function
    * name.
@@ -172,6 +227,31 @@ class NanoappLoader {
   static constexpr const char *kStrTableName = ".strtab";
   static constexpr const char *kInitArrayName = ".init_array";
   static constexpr const char *kFiniArrayName = ".fini_array";
+  static constexpr const char *kRelocationManifestName =
+      ".chre_reloc_manifest";
+
+  //! Magic number ("CRLM") and version of the relocation manifest, a section
+  //! added by build/nanoapp/relocation_manifest.py that groups the relocations
+  //! against imported symbols by symbol. The section is a
+  //! RelocationManifestHeader, followed by numSymbols RelocationManifestSymbol
+  //! entries, followed by numSites uint32_t offsets of the relocation sites
+  //! grouped by symbol. All values are little-endian and may be unaligned.
+  static constexpr uint32_t kRelocationManifestMagic = 0x4d4c5243;
+  static constexpr uint32_t kRelocationManifestVersion = 1;
+
+  struct RelocationManifestHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numSymbols;
+    uint32_t numSites;
+  };
+
+  struct RelocationManifestSymbol {
+    //! Index of the symbol in the dynamic symbol table.
+    uint32_t symbolIndex;
+    //! Number of relocation sites patched with the address of the symbol.
+    uint32_t numSites;
+  };
 
   //! Pointer to the table of all the section names.
   char *mSectionNamesPtr = nullptr;
@@ -202,6 +282,18 @@ class NanoappLoader {
   DynamicVector<struct AtExitCallback> mAtexitFunctions;
   //! Whether this loader instance is managing a TCM nanoapp binary.
   bool mIsTcmBinary = false;
+  //! The size of the ELF binary. Only known when created by createStreaming().
+  size_t mBinarySize = 0;
+  //! The number of bytes of the ELF binary whose load segments have been
+  //! copied by onBinaryReceived().
+  size_t mBytesMapped = 0;
+  //! The first and last load segments, found by allocateMappings().
+  const ProgramHeader *mFirstLoadSegment = nullptr;
+  const ProgramHeader *mLastLoadSegment = nullptr;
+  //! Whether the relocations against imported symbols were patched from the
+  //! relocation manifest, in which case relocateTable() and resolveGot() skip
+  //! them.
+  bool mSymbolRelocationsApplied = false;
 
   /**
    * Invokes all functions registered via atexit during static initialization.
@@ -229,6 +321,24 @@ class NanoappLoader {
    */
   bool createMappings();
 
+  /**
+   * Allocates memory for all load segments that need to be mapped into virtual
+   * memory, without copying them.
+   *
+   * @return true if the memory for mapping was allocated and the load segments
+   *     were formatted correctly.
+   */
+  bool allocateMappings();
+
+  /**
+   * Copies the part of the load segments found within the given range of the
+   * binary into the memory allocated by allocateMappings().
+   *
+   * @param binaryStart The offset of the start of the range in the binary.
+   * @param binaryEnd The offset of the end of the range in the binary.
+   */
+  void mapSegments(size_t binaryStart, size_t binaryEnd);
+
   /**
    * Copies various sections and headers from the ELF while verifying that they
    * match the ELF format specification.
@@ -237,6 +347,21 @@ class NanoappLoader {
    */
   bool copyAndVerifyHeaders();
 
+  /**
+   * Copies the section headers and the section names, symbol and string tables
+   * while verifying that they match the ELF format specification.
+   *
+   * @return true if all data was copied and verified.
+   */
+  bool copyAndVerifySectionHeaders();
+
+  /**
+   * Resolves relocations and the GOT, then invokes static initializers.
+   *
+   * @return true if the mapped binary is ready to be used.
+   */
+  bool relocateAndInitialize();
+
   /**
    * Resolves all relocated symbols located in the DT_REL table.
    *
@@ -244,6 +369,28 @@ class NanoappLoader {
    */
   bool fixRelocations();
 
+  /**
+   * Patches the relocations against imported symbols from the relocation
+   * manifest, resolving each symbol once rather than once per relocation. Does
+   * nothing if the binary has no valid manifest, leaving the relocations to
+   * relocateTable() and resolveGot().
+   *
+   * @return false if a symbol listed in the manifest could not be resolved.
+   */
+  bool applyRelocationManifest();
+
+  /**
+   * Verifies that the relocation manifest matches its header, and that every
+   * symbol index and relocation site it lists is within bounds.
+   *
+   * @param manifest The relocation manifest section.
+   * @param manifestSize The size of the relocation manifest section.
+   * @param header The header of the relocation manifest.
+   * @return true if the manifest passed verification.
+   */
+  bool verifyRelocationManifest(const uint8_t *manifest, size_t manifestSize,
+                                const RelocationManifestHeader &header);
+
   /**
    * Resolves entries in the Global Offset Table (GOT) to facility the ELF's
    * compiled using position independent code (PIC).
@@ -273,6 +420,40 @@ class NanoappLoader {
    */
   bool verifySectionHeaders();
 
+  /**
+   * @return true if the given range lies within the binary of a streaming
+   *     load.
+   */
+  bool isWithinBinary(size_t offset, size_t size) const;
+
+  /**
+   * Verifies that every load segment lies within the binary of a streaming
+   * load, and within the memory allocated by allocateMappings().
+   *
+   * @return true if the load segments passed verification.
+   */
+  bool verifyLoadSegmentBounds();
+
+  /**
+   * Verifies that every section with data lies within the binary of a
+   * streaming load, and that every section name lies within the table of
+   * section names.
+   *
+   * @param sectionsEnd Filled with the offset in the binary after all the
+   *     sections with data.
+   * @return true if the sections passed verification.
+   */
+  bool verifySectionBounds(size_t *sectionsEnd);
+
+  /**
+   * Verifies that the received table of section names ends with a null
+   * terminator, since section names are looked up before the binary of a
+   * streaming load is authenticated.
+   *
+   * @return true if the section names are terminated.
+   */
+  bool verifySectionNamesTerminated();
+
   /**
    * Retrieves the symbol at the given position in the symbol table.
    *
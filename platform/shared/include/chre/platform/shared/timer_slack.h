@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_PLATFORM_SHARED_TIMER_SLACK_H_
+#define CHRE_PLATFORM_SHARED_TIMER_SLACK_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Platform extension allowing a nanoapp to opt in to timer coalescing.
+ *
+ * Sets the slack of timers subsequently set by the calling nanoapp through
+ * chreTimerSet(): the time after its expiration within which a timer may fire.
+ * This allows the timers of several nanoapps expiring close to each other to
+ * be handled by a single wakeup. Timers never fire before they expire.
+ *
+ * @param slackNs The timer slack in nanoseconds, where 0 (the default) fires
+ *        timers as close to their expiration as the platform allows.
+ *
+ * @see chreTimerSet
+ */
+void platform_chreTimerSetSlack(uint64_t slackNs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CHRE_PLATFORM_SHARED_TIMER_SLACK_H_
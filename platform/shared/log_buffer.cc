@@ -18,14 +18,47 @@
 #include "chre/platform/assert.h"
 #include "chre/platform/shared/generated/host_messages_generated.h"
 #include "chre/util/lock_guard.h"
+#include "chre/util/macros.h"
 
 #include <cstdarg>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 
 namespace chre {
 
 using LogType = fbs::LogType;
 
+namespace {
+
+/**
+ * Appends a value to a structured log as a little-endian base 128 varint.
+ *
+ * @return false if the value did not fit into the buffer.
+ */
+bool appendVarint(uint64_t value, uint8_t *buffer, size_t bufferSize,
+                  size_t *offset) {
+  do {
+    if (*offset >= bufferSize) {
+      return false;
+    }
+    uint8_t byte = value & 0x7f;
+    value >>= 7;
+    buffer[(*offset)++] = (value != 0) ? (byte | 0x80) : byte;
+  } while (value != 0);
+  return true;
+}
+
+//! Appends a signed value to a structured log as a zigzag encoded varint.
+bool appendSignedVarint(int64_t value, uint8_t *buffer, size_t bufferSize,
+                        size_t *offset) {
+  uint64_t zigzag = (static_cast<uint64_t>(value) << 1) ^
+                    static_cast<uint64_t>(value >> 63);
+  return appendVarint(zigzag, buffer, bufferSize, offset);
+}
+
+}  // anonymous namespace
+
 LogBuffer::LogBuffer(LogBufferCallbackInterface *callback, void *buffer,
                      size_t bufferSize)
     : mBufferData(static_cast<uint8_t *>(buffer)),
@@ -47,8 +80,157 @@ void LogBuffer::handleLogVa(LogBufferLogLevel logLevel, uint32_t timestampMs,
   constexpr size_t maxLogLen = kLogMaxSize - kLogDataOffset;
   char tempBuffer[maxLogLen];
   int logLenSigned = vsnprintf(tempBuffer, maxLogLen, logFormat, args);
-  processLog(logLevel, timestampMs, tempBuffer, logLenSigned,
-             false /* encoded */);
+  processLog(logLevel, timestampMs, tempBuffer, logLenSigned, LogType::STRING);
+}
+
+size_t LogBuffer::encodeStructuredLogVa(uint8_t *buffer, size_t bufferSize,
+                                        const char *logFormat, va_list args) {
+  size_t formatSize = strlen(logFormat) + 1;
+  if (formatSize > bufferSize) {
+    return 0;
+  }
+  memcpy(buffer, logFormat, formatSize);
+  size_t offset = formatSize;
+
+  for (const char *pos = logFormat; *pos != '\0'; ++pos) {
+    if (*pos != '%') {
+      continue;
+    }
+    ++pos;
+    if (*pos == '%') {
+      continue;
+    }
+
+    pos += strspn(pos, "-+ #0");
+    pos += strspn(pos, "0123456789");
+    if (*pos == '.') {
+      ++pos;
+      pos += strspn(pos, "0123456789");
+    }
+    if (*pos == '*') {
+      return 0;
+    }
+
+    // The length modifier, with 'H' and 'L' standing for "hh" and "ll".
+    char length = '\0';
+    if (*pos == 'h' || *pos == 'l') {
+      length = *pos++;
+      if (*pos == length) {
+        length = (length == 'h') ? 'H' : 'L';
+        ++pos;
+      }
+    } else if (*pos == 'j' || *pos == 'z' || *pos == 't') {
+      length = *pos++;
+    }
+
+    bool appended;
+    switch (*pos) {
+      case 'd':
+      case 'i': {
+        int64_t value;
+        switch (length) {
+          case 'l':
+            value = va_arg(args, long);
+            break;
+          case 'L':
+            value = va_arg(args, long long);
+            break;
+          case 'j':
+            value = va_arg(args, intmax_t);
+            break;
+          case 'z':
+          case 't':
+            value = va_arg(args, ptrdiff_t);
+            break;
+          default:
+            value = va_arg(args, int);
+        }
+        appended = appendSignedVarint(value, buffer, bufferSize, &offset);
+        break;
+      }
+
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X': {
+        uint64_t value;
+        switch (length) {
+          case 'l':
+            value = va_arg(args, unsigned long);
+            break;
+          case 'L':
+            value = va_arg(args, unsigned long long);
+            break;
+          case 'j':
+            value = va_arg(args, uintmax_t);
+            break;
+          case 'z':
+          case 't':
+            value = va_arg(args, size_t);
+            break;
+          default:
+            value = va_arg(args, unsigned int);
+        }
+        appended = appendVarint(value, buffer, bufferSize, &offset);
+        break;
+      }
+
+      case 'c':
+        appended = appendVarint(static_cast<unsigned char>(va_arg(args, int)),
+                                buffer, bufferSize, &offset);
+        break;
+
+      case 'p':
+        appended =
+            appendVarint(reinterpret_cast<uintptr_t>(va_arg(args, void *)),
+                         buffer, bufferSize, &offset);
+        break;
+
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A': {
+        double value = va_arg(args, double);
+        appended = (bufferSize - offset >= sizeof(value));
+        if (appended) {
+          memcpy(&buffer[offset], &value, sizeof(value));
+          offset += sizeof(value);
+        }
+        break;
+      }
+
+      case 's': {
+        const char *value = va_arg(args, const char *);
+        if (value == nullptr) {
+          value = "(null)";
+        }
+        // Strings are truncated to the space left, like text logs are.
+        appended = (offset < bufferSize);
+        if (appended) {
+          size_t maxLength = MIN(bufferSize - offset - 1, size_t{UINT8_MAX});
+          auto valueLength = static_cast<uint8_t>(strnlen(value, maxLength));
+          buffer[offset++] = valueLength;
+          memcpy(&buffer[offset], value, valueLength);
+          offset += valueLength;
+        }
+        break;
+      }
+
+      default:
+        // Includes %n and long double, and the end of a truncated format.
+        appended = false;
+    }
+
+    if (!appended) {
+      return 0;
+    }
+  }
+
+  return offset;
 }
 
 #ifdef CHRE_BLE_SUPPORT_ENABLED
@@ -60,8 +242,8 @@ void LogBuffer::handleBtLog(BtSnoopDirection direction, uint32_t timestampMs,
     if (size < kLogMaxSize) {
       LockGuard<Mutex> lockGuard(mLock);
 
-      // No additional terminator towards the end.
-      discardExcessOldLogsLocked(false, logLen);
+      // The log is preceded by its direction and size, with no terminator.
+      discardExcessOldLogsLocked(logLen + 2);
 
       uint8_t logType = static_cast<uint8_t>(LogType::BLUETOOTH);
       uint8_t snoopLogDirection = static_cast<uint8_t>(direction);
@@ -85,7 +267,7 @@ void LogBuffer::handleBtLog(BtSnoopDirection direction, uint32_t timestampMs,
           "Error meessage size needs to be smaller than max log length");
       logLen = static_cast<uint8_t>(sizeof(kBtSnoopLogGenericErrorMsg));
       copyLogToBuffer(LogBufferLogLevel::INFO, timestampMs,
-                      kBtSnoopLogGenericErrorMsg, logLen, false /* encoded */);
+                      kBtSnoopLogGenericErrorMsg, logLen, LogType::STRING);
     }
     dispatch();
   }
@@ -95,7 +277,13 @@ void LogBuffer::handleBtLog(BtSnoopDirection direction, uint32_t timestampMs,
 void LogBuffer::handleEncodedLog(LogBufferLogLevel logLevel,
                                  uint32_t timestampMs, const uint8_t *log,
                                  size_t logSize) {
-  processLog(logLevel, timestampMs, log, logSize);
+  processLog(logLevel, timestampMs, log, logSize, LogType::TOKENIZED);
+}
+
+void LogBuffer::handleStructuredLog(LogBufferLogLevel logLevel,
+                                    uint32_t timestampMs, const uint8_t *log,
+                                    size_t logSize) {
+  processLog(logLevel, timestampMs, log, logSize, LogType::STRUCTURED);
 }
 
 size_t LogBuffer::copyLogs(void *destination, size_t size,
@@ -230,11 +418,29 @@ size_t LogBuffer::getNextLogIndex(size_t startingIndex, size_t *logSize) {
   size_t logDataStartIndex =
       incrementAndModByBufferMaxSize(startingIndex, kLogDataOffset);
 
-  size_t logDataSize = getLogDataLength(logDataStartIndex);
+  size_t logDataSize;
+  switch (static_cast<LogType>(mBufferData[startingIndex] >> 4)) {
+    case LogType::TOKENIZED:
+    case LogType::STRUCTURED:
+      logDataSize = getEncodedLogDataLength(logDataStartIndex);
+      break;
+    case LogType::BLUETOOTH:
+      // Skip the direction, the rest of the log is laid out as encoded.
+      logDataSize = sizeof(uint8_t) +
+                    getEncodedLogDataLength(incrementAndModByBufferMaxSize(
+                        logDataStartIndex, sizeof(uint8_t)));
+      break;
+    default:
+      logDataSize = getLogDataLength(logDataStartIndex);
+  }
   *logSize = kLogDataOffset + logDataSize;
   return incrementAndModByBufferMaxSize(startingIndex, *logSize);
 }
 
+size_t LogBuffer::getEncodedLogDataLength(size_t startingIndex) {
+  return sizeof(uint8_t) + mBufferData[startingIndex];
+}
+
 size_t LogBuffer::getLogDataLength(size_t startingIndex) {
   size_t currentIndex = startingIndex;
   constexpr size_t maxBytes = kLogMaxSize - kLogDataOffset;
@@ -252,11 +458,12 @@ size_t LogBuffer::getLogDataLength(size_t startingIndex) {
 }
 
 void LogBuffer::processLog(LogBufferLogLevel logLevel, uint32_t timestampMs,
-                           const void *logBuffer, size_t size, bool encoded) {
+                           const void *logBuffer, size_t size,
+                           LogType logType) {
   if (size > 0) {
     auto logLen = static_cast<uint8_t>(size);
     if (size >= kLogMaxSize) {
-      if (!encoded) {
+      if (logType == LogType::STRING) {
         // Leave space for null terminator to be copied on end
         logLen = static_cast<uint8_t>(kLogMaxSize - 1);
       } else {
@@ -272,26 +479,26 @@ void LogBuffer::processLog(LogBufferLogLevel logLevel, uint32_t timestampMs,
             "Error meessage size needs to be smaller than max log length");
         logBuffer = kTokenizedLogGenericErrorMsg;
         logLen = static_cast<uint8_t>(sizeof(kTokenizedLogGenericErrorMsg));
-        encoded = false;
+        logType = LogType::STRING;
       }
     }
-    copyLogToBuffer(logLevel, timestampMs, logBuffer, logLen, encoded);
+    copyLogToBuffer(logLevel, timestampMs, logBuffer, logLen, logType);
     dispatch();
   }
 }
 
 void LogBuffer::copyLogToBuffer(LogBufferLogLevel level, uint32_t timestampMs,
                                 const void *logBuffer, uint8_t logLen,
-                                bool encoded) {
+                                LogType logType) {
   LockGuard<Mutex> lockGuard(mLock);
-  discardExcessOldLogsLocked(encoded, logLen);
-  encodeAndCopyLogLocked(level, timestampMs, logBuffer, logLen, encoded);
+  // Encoded logs are preceded by their size, string logs followed by a null
+  // terminator.
+  discardExcessOldLogsLocked(logLen + 1);
+  encodeAndCopyLogLocked(level, timestampMs, logBuffer, logLen, logType);
 }
 
-void LogBuffer::discardExcessOldLogsLocked(bool encoded,
-                                           uint8_t currentLogLen) {
-  size_t totalLogSize =
-      kLogDataOffset + (encoded ? currentLogLen : currentLogLen + 1);
+void LogBuffer::discardExcessOldLogsLocked(size_t logDataSize) {
+  size_t totalLogSize = kLogDataOffset + logDataSize;
   while (mBufferDataSize + totalLogSize > mBufferMaxSize) {
     mNumLogsDropped++;
     size_t logSize;
@@ -303,9 +510,10 @@ void LogBuffer::discardExcessOldLogsLocked(bool encoded,
 void LogBuffer::encodeAndCopyLogLocked(LogBufferLogLevel level,
                                        uint32_t timestampMs,
                                        const void *logBuffer, uint8_t logLen,
-                                       bool encoded) {
+                                       LogType logType) {
+  bool encoded = logType != LogType::STRING;
   uint8_t metadata =
-      (static_cast<uint8_t>(encoded) << 4) | static_cast<uint8_t>(level);
+      (static_cast<uint8_t>(logType) << 4) | static_cast<uint8_t>(level);
 
   copyToBuffer(sizeof(uint8_t), &metadata);
   copyToBuffer(sizeof(timestampMs), &timestampMs);
@@ -136,6 +136,24 @@ void LogBufferManager::bufferOverflowGuard(size_t logSize) {
 
 void LogBufferManager::logVa(chreLogLevel logLevel, const char *formatStr,
                              va_list args) {
+#ifdef CHRE_STRUCTURED_LOGGING_ENABLED
+  // Defer formatting to the host when the log can be encoded as a structured
+  // log, and fall back to formatting it here otherwise.
+  uint8_t structuredLog[LogBuffer::kEncodedLogMaxSize];
+  va_list structuredLogArgs;
+  va_copy(structuredLogArgs, args);
+  size_t structuredLogSize = LogBuffer::encodeStructuredLogVa(
+      structuredLog, sizeof(structuredLog), formatStr, structuredLogArgs);
+  va_end(structuredLogArgs);
+  if (structuredLogSize > 0) {
+    bufferOverflowGuard(structuredLogSize);
+    mPrimaryLogBuffer.handleStructuredLog(chreToLogBufferLogLevel(logLevel),
+                                          getTimestampMs(), structuredLog,
+                                          structuredLogSize);
+    return;
+  }
+#endif  // CHRE_STRUCTURED_LOGGING_ENABLED
+
   // Copy the va_list before getting size from vsnprintf so that the next
   // argument that will be accessed in buffer.handleLogVa is the starting one.
   va_list getSizeArgs;
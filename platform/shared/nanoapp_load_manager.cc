@@ -16,6 +16,12 @@
 
 #include "chre/platform/shared/nanoapp_load_manager.h"
 
+#include <cstring>
+
+#include "chre/platform/assert.h"
+#include "chre/platform/log.h"
+#include "chre/platform/memory.h"
+
 namespace chre {
 
 bool NanoappLoadManager::prepareForLoad(uint16_t hostClientId,
@@ -23,27 +29,41 @@ bool NanoappLoadManager::prepareForLoad(uint16_t hostClientId,
                                         uint32_t appVersion, uint32_t appFlags,
                                         size_t totalBinaryLen,
                                         uint32_t targetApiVersion) {
-  if (hasPendingLoadTransaction()) {
+  LoadTransaction *transaction = findTransaction(hostClientId, transactionId);
+  if (transaction != nullptr) {
     LOGW(
         "Pending load transaction already exists. Overriding previous"
         " transaction.");
+    markFailure(hostClientId, transactionId);
   }
 
-  mCurrentLoadInfo.hostClientId = hostClientId;
-  mCurrentLoadInfo.transactionId = transactionId;
-  mCurrentLoadInfo.nextFragmentId = 1;
-  mNanoapp = MakeUnique<Nanoapp>();
+  transaction = nullptr;
+  for (LoadTransaction &candidate : mTransactions) {
+    if (candidate.nanoapp.isNull()) {
+      transaction = &candidate;
+      break;
+    }
+  }
 
   bool success = false;
-  if (mNanoapp.isNull()) {
-    LOG_OOM();
+  if (transaction == nullptr) {
+    LOGE("Too many load transactions in progress");
   } else {
-    success = mNanoapp->reserveBuffer(appId, appVersion, appFlags,
-                                      totalBinaryLen, targetApiVersion);
-  }
+    transaction->info.hostClientId = hostClientId;
+    transaction->info.transactionId = transactionId;
+    transaction->info.nextFragmentId = 1;
+    transaction->sequenceNumber = mNextSequenceNumber++;
+    transaction->nanoapp = MakeUnique<Nanoapp>();
 
-  if (!success) {
-    markFailure();
+    if (transaction->nanoapp.isNull()) {
+      LOG_OOM();
+    } else {
+      success = transaction->nanoapp->reserveBuffer(
+          appId, appVersion, appFlags, totalBinaryLen, targetApiVersion);
+      if (!success) {
+        markFailure(hostClientId, transactionId);
+      }
+    }
   }
 
   return success;
@@ -55,40 +75,150 @@ bool NanoappLoadManager::copyNanoappFragment(uint16_t hostClientId,
                                              const void *buffer,
                                              size_t bufferLen) {
   bool success = false;
-  if (validateFragment(hostClientId, transactionId, fragmentId)) {
-    success = mNanoapp->copyNanoappFragment(buffer, bufferLen);
-    if (success) {
-      mCurrentLoadInfo.nextFragmentId++;
+  LoadTransaction *transaction = findTransaction(hostClientId, transactionId);
+  if (transaction == nullptr) {
+    LOGE("No pending load transaction exists for host %" PRIu16
+         " transaction %" PRIu32 " fragment %" PRIu32,
+         hostClientId, transactionId, fragmentId);
+  } else {
+    const uint32_t nextFragmentId = transaction->info.nextFragmentId;
+    if (fragmentId == nextFragmentId) {
+      success = copyFragmentsInOrder(*transaction, buffer, bufferLen);
+      if (!success) {
+        markFailure(hostClientId, transactionId);
+      }
+    } else if (fragmentId < nextFragmentId) {
+      // Already acknowledged through a later fragment
+      LOGW("Ignoring duplicate load fragment %" PRIu32, fragmentId);
+      success = true;
+    } else if (fragmentId - nextFragmentId < kFragmentWindowSize) {
+      success = holdFragment(*transaction, fragmentId, buffer, bufferLen);
     } else {
-      markFailure();
+      LOGE("Load fragment %" PRIu32 " is outside of the window [%" PRIu32
+           ", %" PRIu32 "]",
+           fragmentId, nextFragmentId,
+           nextFragmentId + kFragmentWindowSize - 1);
     }
   }
 
   return success;
 }
 
-bool NanoappLoadManager::validateFragment(uint16_t hostClientId,
-                                          uint32_t transactionId,
-                                          uint32_t fragmentId) const {
-  bool valid = false;
-  if (!hasPendingLoadTransaction()) {
-    LOGE("No pending load transaction exists");
+bool NanoappLoadManager::getTransactionToReplace(
+    uint16_t hostClientId, uint32_t transactionId,
+    FragmentedLoadInfo *info) const {
+  const LoadTransaction *replaced = findTransaction(hostClientId, transactionId);
+  if (replaced == nullptr) {
+    for (const LoadTransaction &transaction : mTransactions) {
+      if (transaction.nanoapp.isNull()) {
+        // There is room for the new transaction
+        return false;
+      }
+      if (replaced == nullptr ||
+          static_cast<int32_t>(transaction.sequenceNumber -
+                               replaced->sequenceNumber) < 0) {
+        replaced = &transaction;
+      }
+    }
+  }
+
+  *info = replaced->info;
+  return true;
+}
+
+void NanoappLoadManager::markFailure(uint16_t hostClientId,
+                                     uint32_t transactionId) {
+  LoadTransaction *transaction = findTransaction(hostClientId, transactionId);
+  if (transaction != nullptr) {
+    releaseHeldFragments(*transaction);
+    transaction->nanoapp.reset(nullptr);
+  }
+}
+
+UniquePtr<Nanoapp> NanoappLoadManager::releaseNanoapp(uint16_t hostClientId,
+                                                      uint32_t transactionId) {
+  UniquePtr<Nanoapp> nanoapp;
+  LoadTransaction *transaction = findTransaction(hostClientId, transactionId);
+  if (transaction != nullptr) {
+    releaseHeldFragments(*transaction);
+    nanoapp = std::move(transaction->nanoapp);
+  }
+  return nanoapp;
+}
+
+NanoappLoadManager::LoadTransaction *NanoappLoadManager::findTransaction(
+    uint16_t hostClientId, uint32_t transactionId) {
+  return const_cast<LoadTransaction *>(
+      static_cast<const NanoappLoadManager *>(this)->findTransaction(
+          hostClientId, transactionId));
+}
+
+const NanoappLoadManager::LoadTransaction *NanoappLoadManager::findTransaction(
+    uint16_t hostClientId, uint32_t transactionId) const {
+  for (const LoadTransaction &transaction : mTransactions) {
+    if (!transaction.nanoapp.isNull() &&
+        transaction.info.hostClientId == hostClientId &&
+        transaction.info.transactionId == transactionId) {
+      return &transaction;
+    }
+  }
+  return nullptr;
+}
+
+bool NanoappLoadManager::holdFragment(LoadTransaction &transaction,
+                                      uint32_t fragmentId, const void *buffer,
+                                      size_t bufferLen) {
+  HeldFragment &held =
+      transaction.heldFragments[fragmentId % kFragmentWindowSize];
+  if (held.fragmentId == fragmentId) {
+    LOGW("Ignoring duplicate load fragment %" PRIu32, fragmentId);
+    return true;
+  }
+  CHRE_ASSERT(held.fragmentId == 0);
+
+  bool success = false;
+  void *copy = memoryAlloc(bufferLen);
+  if (copy == nullptr) {
+    LOG_OOM();
   } else {
-    const FragmentedLoadInfo &info = mCurrentLoadInfo;
-    valid = (info.hostClientId == hostClientId &&
-             info.transactionId == transactionId &&
-             info.nextFragmentId == fragmentId);
-    if (!valid) {
-      LOGE("Unexpected load fragment: expected host %" PRIu16
-           "transaction %" PRIu32 " fragment %" PRIu32
-           ", received host %" PRIu16 " transaction %" PRIu32
-           " fragment %" PRIu32,
-           info.hostClientId, info.transactionId, info.nextFragmentId,
-           hostClientId, transactionId, fragmentId);
+    memcpy(copy, buffer, bufferLen);
+    held.fragmentId = fragmentId;
+    held.buffer = copy;
+    held.bufferLen = bufferLen;
+    success = true;
+  }
+
+  return success;
+}
+
+bool NanoappLoadManager::copyFragmentsInOrder(LoadTransaction &transaction,
+                                              const void *buffer,
+                                              size_t bufferLen) {
+  bool success = transaction.nanoapp->copyNanoappFragment(buffer, bufferLen);
+  while (success) {
+    uint32_t nextFragmentId = ++transaction.info.nextFragmentId;
+    HeldFragment &held =
+        transaction.heldFragments[nextFragmentId % kFragmentWindowSize];
+    if (held.fragmentId != nextFragmentId) {
+      break;
     }
+
+    success =
+        transaction.nanoapp->copyNanoappFragment(held.buffer, held.bufferLen);
+    memoryFree(held.buffer);
+    held = HeldFragment();
   }
 
-  return valid;
+  return success;
+}
+
+void NanoappLoadManager::releaseHeldFragments(LoadTransaction &transaction) {
+  for (HeldFragment &held : transaction.heldFragments) {
+    if (held.fragmentId != 0) {
+      memoryFree(held.buffer);
+      held = HeldFragment();
+    }
+  }
 }
 
 }  // namespace chre
@@ -16,6 +16,7 @@
 
 #include <dlfcn.h>
 #include <cctype>
+#include <cinttypes>
 #include <cmath>
 #include <cstring>
 
@@ -25,7 +26,10 @@
 #include "chre/platform/assert.h"
 #include "chre/platform/fatal_error.h"
 #include "chre/platform/shared/debug_dump.h"
+#include "chre/platform/shared/exported_symbol_table.h"
+#include "chre/platform/shared/exported_symbols.h"
 #include "chre/platform/shared/memory.h"
+#include "chre/platform/shared/timer_slack.h"
 #include "chre/target_platform/platform_cache_management.h"
 #include "chre/util/dynamic_vector.h"
 #include "chre/util/macros.h"
@@ -132,130 +136,23 @@ void __cxa_pure_virtual(void) {
   chreAbort(CHRE_ERROR /* abortCode */);
 }
 
-// TODO(karthikmb/stange): While this array was hand-coded for simple
-// "hello-world" prototyping, the list of exported symbols must be
-// generated to minimize runtime errors and build breaks.
-// clang-format off
 // Disable deprecation warning so that deprecated symbols in the array
 // can be exported for older nanoapps and tests.
 CHRE_DEPRECATED_PREAMBLE
 const ExportedData kExportedData[] = {
-    /* libmath overrides and symbols */
-    ADD_EXPORTED_SYMBOL(asinOverride, "asin"),
-    ADD_EXPORTED_SYMBOL(atan2Override, "atan2"),
-    ADD_EXPORTED_SYMBOL(cosOverride, "cos"),
-    ADD_EXPORTED_SYMBOL(floorOverride, "floor"),
-    ADD_EXPORTED_SYMBOL(fmaxOverride, "fmax"),
-    ADD_EXPORTED_SYMBOL(fminOverride, "fmin"),
-    ADD_EXPORTED_SYMBOL(frexpOverride, "frexp"),
-    ADD_EXPORTED_SYMBOL(roundOverride, "round"),
-    ADD_EXPORTED_SYMBOL(sinOverride, "sin"),
-    ADD_EXPORTED_SYMBOL(sqrtOverride, "sqrt"),
-    ADD_EXPORTED_C_SYMBOL(acosf),
-    ADD_EXPORTED_C_SYMBOL(asinf),
-    ADD_EXPORTED_C_SYMBOL(atan2f),
-    ADD_EXPORTED_C_SYMBOL(ceilf),
-    ADD_EXPORTED_C_SYMBOL(cosf),
-    ADD_EXPORTED_C_SYMBOL(expf),
-    ADD_EXPORTED_C_SYMBOL(fabsf),
-    ADD_EXPORTED_C_SYMBOL(floorf),
-    ADD_EXPORTED_C_SYMBOL(fmaxf),
-    ADD_EXPORTED_C_SYMBOL(fminf),
-    ADD_EXPORTED_C_SYMBOL(fmodf),
-    ADD_EXPORTED_C_SYMBOL(log10f),
-    ADD_EXPORTED_C_SYMBOL(log1pf),
-    ADD_EXPORTED_C_SYMBOL(log2f),
-    ADD_EXPORTED_C_SYMBOL(logf),
-    ADD_EXPORTED_C_SYMBOL(lrintf),
-    ADD_EXPORTED_C_SYMBOL(lroundf),
-    ADD_EXPORTED_C_SYMBOL(powf),
-    ADD_EXPORTED_C_SYMBOL(remainderf),
-    ADD_EXPORTED_C_SYMBOL(roundf),
-    ADD_EXPORTED_C_SYMBOL(sinf),
-    ADD_EXPORTED_C_SYMBOL(sqrtf),
-    ADD_EXPORTED_C_SYMBOL(tanf),
-    ADD_EXPORTED_C_SYMBOL(tanhf),
-    /* libc overrides and symbols */
-    ADD_EXPORTED_C_SYMBOL(__cxa_pure_virtual),
-    ADD_EXPORTED_SYMBOL(cxaAtexitOverride, "__cxa_atexit"),
-    ADD_EXPORTED_SYMBOL(atexitOverride, "atexit"),
-    ADD_EXPORTED_C_SYMBOL(dlsym),
-    ADD_EXPORTED_C_SYMBOL(isgraph),
-    ADD_EXPORTED_C_SYMBOL(memcmp),
-    ADD_EXPORTED_C_SYMBOL(memcpy),
-    ADD_EXPORTED_C_SYMBOL(memmove),
-    ADD_EXPORTED_C_SYMBOL(memset),
-    ADD_EXPORTED_C_SYMBOL(snprintf),
-    ADD_EXPORTED_C_SYMBOL(strcmp),
-    ADD_EXPORTED_C_SYMBOL(strlen),
-    ADD_EXPORTED_C_SYMBOL(strncmp),
-    ADD_EXPORTED_C_SYMBOL(tolower),
-    /* CHRE symbols */
-    ADD_EXPORTED_C_SYMBOL(chreAbort),
-    ADD_EXPORTED_C_SYMBOL(chreAudioConfigureSource),
-    ADD_EXPORTED_C_SYMBOL(chreAudioGetSource),
-    ADD_EXPORTED_C_SYMBOL(chreBleGetCapabilities),
-    ADD_EXPORTED_C_SYMBOL(chreBleGetFilterCapabilities),
-    ADD_EXPORTED_C_SYMBOL(chreBleFlushAsync),
-    ADD_EXPORTED_C_SYMBOL(chreBleStartScanAsync),
-    ADD_EXPORTED_C_SYMBOL(chreBleStopScanAsync),
-    ADD_EXPORTED_C_SYMBOL(chreBleReadRssiAsync),
-    ADD_EXPORTED_C_SYMBOL(chreBleGetScanStatus),
-    ADD_EXPORTED_C_SYMBOL(chreConfigureDebugDumpEvent),
-    ADD_EXPORTED_C_SYMBOL(chreConfigureHostSleepStateEvents),
-    ADD_EXPORTED_C_SYMBOL(chreConfigureNanoappInfoEvents),
-    ADD_EXPORTED_C_SYMBOL(chreDebugDumpLog),
-    ADD_EXPORTED_C_SYMBOL(chreGetApiVersion),
-    ADD_EXPORTED_C_SYMBOL(chreGetAppId),
-    ADD_EXPORTED_C_SYMBOL(chreGetInstanceId),
-    ADD_EXPORTED_C_SYMBOL(chreGetEstimatedHostTimeOffset),
-    ADD_EXPORTED_C_SYMBOL(chreGetNanoappInfoByAppId),
-    ADD_EXPORTED_C_SYMBOL(chreGetNanoappInfoByInstanceId),
-    ADD_EXPORTED_C_SYMBOL(chreGetPlatformId),
-    ADD_EXPORTED_C_SYMBOL(chreGetSensorInfo),
-    ADD_EXPORTED_C_SYMBOL(chreGetSensorSamplingStatus),
-    ADD_EXPORTED_C_SYMBOL(chreGetTime),
-    ADD_EXPORTED_C_SYMBOL(chreGetVersion),
-    ADD_EXPORTED_C_SYMBOL(chreGnssConfigurePassiveLocationListener),
-    ADD_EXPORTED_C_SYMBOL(chreGnssGetCapabilities),
-    ADD_EXPORTED_C_SYMBOL(chreGnssLocationSessionStartAsync),
-    ADD_EXPORTED_C_SYMBOL(chreGnssLocationSessionStopAsync),
-    ADD_EXPORTED_C_SYMBOL(chreGnssMeasurementSessionStartAsync),
-    ADD_EXPORTED_C_SYMBOL(chreGnssMeasurementSessionStopAsync),
-    ADD_EXPORTED_C_SYMBOL(chreHeapAlloc),
-    ADD_EXPORTED_C_SYMBOL(chreHeapFree),
-    ADD_EXPORTED_C_SYMBOL(chreIsHostAwake),
-    ADD_EXPORTED_C_SYMBOL(chreLog),
-    ADD_EXPORTED_C_SYMBOL(chreSendEvent),
-    ADD_EXPORTED_C_SYMBOL(chreSendMessageToHost),
-    ADD_EXPORTED_C_SYMBOL(chreSendMessageToHostEndpoint),
-    ADD_EXPORTED_C_SYMBOL(chreSendMessageWithPermissions),
-    ADD_EXPORTED_C_SYMBOL(chreSensorConfigure),
-    ADD_EXPORTED_C_SYMBOL(chreSensorConfigureBiasEvents),
-    ADD_EXPORTED_C_SYMBOL(chreSensorFind),
-    ADD_EXPORTED_C_SYMBOL(chreSensorFindDefault),
-    ADD_EXPORTED_C_SYMBOL(chreSensorFlushAsync),
-    ADD_EXPORTED_C_SYMBOL(chreSensorGetThreeAxisBias),
-    ADD_EXPORTED_C_SYMBOL(chreTimerCancel),
-    ADD_EXPORTED_C_SYMBOL(chreTimerSet),
-    ADD_EXPORTED_C_SYMBOL(chreUserSettingConfigureEvents),
-    ADD_EXPORTED_C_SYMBOL(chreUserSettingGetState),
-    ADD_EXPORTED_C_SYMBOL(chreWifiConfigureScanMonitorAsync),
-    ADD_EXPORTED_C_SYMBOL(chreWifiGetCapabilities),
-    ADD_EXPORTED_C_SYMBOL(chreWifiRequestScanAsync),
-    ADD_EXPORTED_C_SYMBOL(chreWifiRequestRangingAsync),
-    ADD_EXPORTED_C_SYMBOL(chreWifiNanRequestRangingAsync),
-    ADD_EXPORTED_C_SYMBOL(chreWifiNanSubscribe),
-    ADD_EXPORTED_C_SYMBOL(chreWifiNanSubscribeCancel),
-    ADD_EXPORTED_C_SYMBOL(chreWwanGetCapabilities),
-    ADD_EXPORTED_C_SYMBOL(chreWwanGetCellInfoAsync),
-    ADD_EXPORTED_C_SYMBOL(platform_chreDebugDumpVaLog),
-    ADD_EXPORTED_C_SYMBOL(chreConfigureHostEndpointNotifications),
-    ADD_EXPORTED_C_SYMBOL(chrePublishRpcServices),
-    ADD_EXPORTED_C_SYMBOL(chreGetHostEndpointInfo),
-};
+    CHRE_LOADER_EXPORTED_SYMBOLS(ADD_EXPORTED_SYMBOL, ADD_EXPORTED_C_SYMBOL)};
 CHRE_DEPRECATED_EPILOGUE
-// clang-format on
+
+//! The names of kExportedData, in the same order.
+constexpr const char *kExportedNames[] = {CHRE_LOADER_EXPORTED_SYMBOLS(
+    EXPORTED_SYMBOL_NAME, EXPORTED_C_SYMBOL_NAME)};
+static_assert(ARRAY_SIZE(kExportedNames) == ARRAY_SIZE(kExportedData),
+              "Every exported symbol must have a name");
+
+//! Name lookup into kExportedData, used to resolve every undefined symbol of a
+//! nanoapp. Sorted at compile time, as the addresses in kExportedData aren't
+//! constant expressions.
+constexpr ExportedSymbolTable kExportedSymbols(kExportedNames);
 
 }  // namespace
 
@@ -283,16 +180,100 @@ void NanoappLoader::destroy(NanoappLoader *loader) {
   memoryFreeDram(loader);
 }
 
-void *NanoappLoader::findExportedSymbol(const char *name) {
-  size_t nameLen = strlen(name);
-  for (size_t i = 0; i < ARRAY_SIZE(kExportedData); i++) {
-    if (nameLen == strlen(kExportedData[i].dataName) &&
-        strncmp(name, kExportedData[i].dataName, nameLen) == 0) {
-      return kExportedData[i].data;
+NanoappLoader *NanoappLoader::createStreaming(void *elfInput, size_t elfSize,
+                                              bool mapIntoTcm) {
+  NanoappLoader *loader =
+      memoryAllocDram<NanoappLoader>(elfInput, elfSize, mapIntoTcm);
+  if (loader == nullptr) {
+    LOG_OOM();
+  }
+  return loader;
+}
+
+void *NanoappLoader::finishStreaming(NanoappLoader *loader) {
+  void *instance = nullptr;
+  if (loader->mSectionHeadersPtr == nullptr ||
+      loader->mBytesMapped != loader->mBinarySize) {
+    LOGE("Only %zu of %zu bytes of the binary were mapped",
+         loader->mBytesMapped, loader->mBinarySize);
+  } else if (loader->relocateAndInitialize()) {
+    instance = loader;
+  }
+
+  if (instance == nullptr) {
+    abortStreaming(loader);
+  }
+  return instance;
+}
+
+void NanoappLoader::abortStreaming(NanoappLoader *loader) {
+  loader->freeAllocatedData();
+  loader->~NanoappLoader();
+  memoryFreeDram(loader);
+}
+
+bool NanoappLoader::onBinaryReceived(size_t bytesReceived) {
+  if (bytesReceived > mBinarySize) {
+    LOGE("Received %zu bytes of a %zu byte binary", bytesReceived,
+         mBinarySize);
+    return false;
+  }
+
+  bool success = true;
+  ElfHeader *elfHeader = getElfHeader();
+  if (mMapping == nullptr && bytesReceived >= sizeof(ElfHeader)) {
+    size_t programHeadersSize = sizeof(ProgramHeader) * elfHeader->e_phnum;
+    if (!verifyElfHeader() ||
+        !isWithinBinary(elfHeader->e_phoff, programHeadersSize) ||
+        elfHeader->e_phoff % alignof(ProgramHeader) != 0) {
+      LOGE("Failed to verify ELF header");
+      success = false;
+    } else if (bytesReceived >= elfHeader->e_phoff + programHeadersSize) {
+      if (!verifyProgramHeaders() || !allocateMappings() ||
+          !verifyLoadSegmentBounds()) {
+        LOGE("Failed to create mappings");
+        success = false;
+      }
+    }
+  }
+
+  if (success && mMapping != nullptr) {
+    mapSegments(mBytesMapped, bytesReceived);
+    mBytesMapped = bytesReceived;
+
+    // Section headers usually follow all the sections, so they are copied once
+    // the end of the binary is received.
+    size_t sectionHeadersSize = sizeof(SectionHeader) * elfHeader->e_shnum;
+    size_t sectionsEnd = elfHeader->e_shoff + sectionHeadersSize;
+    if (mSectionHeadersPtr != nullptr || bytesReceived < sectionsEnd) {
+      // Nothing left to copy, or the section headers are yet to be received.
+    } else if (!isWithinBinary(elfHeader->e_shoff, sectionHeadersSize) ||
+               elfHeader->e_shoff % alignof(SectionHeader) != 0 ||
+               !verifySectionBounds(&sectionsEnd)) {
+      LOGE("Failed to verify section headers");
+      success = false;
+    } else if (bytesReceived < sectionsEnd) {
+      // Some sections are yet to be received.
+    } else if (!verifySectionNamesTerminated() ||
+               !copyAndVerifySectionHeaders()) {
+      LOGE("Failed to verify headers");
+      success = false;
     }
   }
 
+  return success;
+}
+
+void *NanoappLoader::findExportedSymbol(const char *name) {
+  size_t index = kExportedSymbols.find(name);
+  if (index < ARRAY_SIZE(kExportedData)) {
+    return kExportedData[index].data;
+  }
+
 #ifdef CHREX_SYMBOL_EXTENSIONS
+  // The few vendor symbols are only listed as data, so they are searched
+  // linearly.
+  size_t nameLen = strlen(name);
   for (size_t i = 0; i < ARRAY_SIZE(kVendorExportedData); i++) {
     if (nameLen == strlen(kVendorExportedData[i].dataName) &&
         strncmp(name, kVendorExportedData[i].dataName, nameLen) == 0) {
@@ -311,19 +292,8 @@ bool NanoappLoader::open() {
       LOGE("Failed to verify headers");
     } else if (!createMappings()) {
       LOGE("Failed to create mappings");
-    } else if (!fixRelocations()) {
-      LOGE("Failed to fix relocations");
-    } else if (!resolveGot()) {
-      LOGE("Failed to resolve GOT");
     } else {
-      // Wipe caches before calling init array to ensure initializers are not in
-      // the data cache.
-      wipeSystemCaches(reinterpret_cast<uintptr_t>(mMapping), mMemorySpan);
-      if (!callInitArray()) {
-        LOGE("Failed to perform static init");
-      } else {
-        success = true;
-      }
+      success = relocateAndInitialize();
     }
   }
 
@@ -334,6 +304,25 @@ bool NanoappLoader::open() {
   return success;
 }
 
+bool NanoappLoader::relocateAndInitialize() {
+  bool success = false;
+  if (!fixRelocations()) {
+    LOGE("Failed to fix relocations");
+  } else if (!resolveGot()) {
+    LOGE("Failed to resolve GOT");
+  } else {
+    // Wipe caches before calling init array to ensure initializers are not in
+    // the data cache.
+    wipeSystemCaches(reinterpret_cast<uintptr_t>(mMapping), mMemorySpan);
+    if (!callInitArray()) {
+      LOGE("Failed to perform static init");
+    } else {
+      success = true;
+    }
+  }
+  return success;
+}
+
 void NanoappLoader::close() {
   callAtexitFunctions();
   callTerminatorArray();
@@ -559,14 +548,64 @@ bool NanoappLoader::verifySectionHeaders() {
   return foundSymbolTableHeader && foundStringTableHeader;
 }
 
-bool NanoappLoader::copyAndVerifyHeaders() {
-  size_t offset = 0;
-  bool success = false;
-  uint8_t *pDataBytes = mBinary;
+bool NanoappLoader::isWithinBinary(size_t offset, size_t size) const {
+  return offset <= mBinarySize && size <= mBinarySize - offset;
+}
 
-  // Verify the ELF Header
+bool NanoappLoader::verifyLoadSegmentBounds() {
+  uintptr_t mappingStart = reinterpret_cast<uintptr_t>(mMapping);
+  uintptr_t mappingEnd = mappingStart + mMemorySpan;
+  for (const ProgramHeader *ph = mFirstLoadSegment; ph <= mLastLoadSegment;
+       ++ph) {
+    uintptr_t segStart = ph->p_vaddr + mLoadBias;
+    if (!isWithinBinary(ph->p_offset, ph->p_filesz) ||
+        ph->p_filesz > ph->p_memsz || segStart < mappingStart ||
+        segStart > mappingEnd || ph->p_memsz > mappingEnd - segStart) {
+      LOGE("Load segment at offset %zu lies outside the binary or mapping",
+           static_cast<size_t>(ph->p_offset));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool NanoappLoader::verifySectionBounds(size_t *sectionsEnd) {
   ElfHeader *elfHeader = getElfHeader();
-  success = verifyElfHeader();
+  auto *sectionHeaders =
+      reinterpret_cast<const SectionHeader *>(mBinary + elfHeader->e_shoff);
+  const SectionHeader &names = sectionHeaders[elfHeader->e_shstrndx];
+  if (names.sh_type == SHT_NOBITS) {
+    LOGE("Section names have no data");
+    return false;
+  }
+  for (size_t i = 0; i < elfHeader->e_shnum; ++i) {
+    const SectionHeader &section = sectionHeaders[i];
+    if (section.sh_name >= names.sh_size ||
+        (section.sh_type != SHT_NOBITS &&
+         !isWithinBinary(section.sh_offset, section.sh_size))) {
+      LOGE("Section %zu lies outside the binary", i);
+      return false;
+    }
+    if (section.sh_type != SHT_NOBITS) {
+      *sectionsEnd =
+          MAX(*sectionsEnd, static_cast<size_t>(section.sh_offset +
+                                                section.sh_size));
+    }
+  }
+  return true;
+}
+
+bool NanoappLoader::verifySectionNamesTerminated() {
+  ElfHeader *elfHeader = getElfHeader();
+  auto *sectionHeaders =
+      reinterpret_cast<const SectionHeader *>(mBinary + elfHeader->e_shoff);
+  const SectionHeader &names = sectionHeaders[elfHeader->e_shstrndx];
+  return mBinary[names.sh_offset + names.sh_size - 1] == '\0';
+}
+
+bool NanoappLoader::copyAndVerifyHeaders() {
+  // Verify the ELF Header
+  bool success = verifyElfHeader();
 
   LOGV("Verified ELF header %d", success);
 
@@ -577,19 +616,24 @@ bool NanoappLoader::copyAndVerifyHeaders() {
 
   LOGV("Verified Program headers %d", success);
 
+  return success && copyAndVerifySectionHeaders();
+}
+
+bool NanoappLoader::copyAndVerifySectionHeaders() {
+  bool success = true;
+  ElfHeader *elfHeader = getElfHeader();
+
   // Load Section Headers
-  if (success) {
-    offset = elfHeader->e_shoff;
-    size_t sectionHeaderSizeBytes = sizeof(SectionHeader) * elfHeader->e_shnum;
-    mSectionHeadersPtr =
-        static_cast<SectionHeader *>(memoryAllocDram(sectionHeaderSizeBytes));
-    if (mSectionHeadersPtr == nullptr) {
-      success = false;
-      LOG_OOM();
-    } else {
-      memcpy(mSectionHeadersPtr, (pDataBytes + offset), sectionHeaderSizeBytes);
-      mNumSectionHeaders = elfHeader->e_shnum;
-    }
+  size_t sectionHeaderSizeBytes = sizeof(SectionHeader) * elfHeader->e_shnum;
+  mSectionHeadersPtr =
+      static_cast<SectionHeader *>(memoryAllocDram(sectionHeaderSizeBytes));
+  if (mSectionHeadersPtr == nullptr) {
+    success = false;
+    LOG_OOM();
+  } else {
+    memcpy(mSectionHeadersPtr, mBinary + elfHeader->e_shoff,
+           sectionHeaderSizeBytes);
+    mNumSectionHeaders = elfHeader->e_shnum;
   }
 
   LOGV("Loaded section headers %d", success);
@@ -659,6 +703,14 @@ bool NanoappLoader::copyAndVerifyHeaders() {
 }
 
 bool NanoappLoader::createMappings() {
+  bool success = allocateMappings();
+  if (success) {
+    mapSegments(0, SIZE_MAX);
+  }
+  return success;
+}
+
+bool NanoappLoader::allocateMappings() {
   // ELF needs pt_load segments to be in contiguous ascending order of
   // virtual addresses. So the first and last segs can be used to
   // calculate the entire address span of the image.
@@ -721,29 +773,42 @@ bool NanoappLoader::createMappings() {
   }
 
   if (success) {
-    // Map the remaining segments
     for (const ProgramHeader *ph = first; ph <= last; ++ph) {
-      if (ph->p_type == PT_LOAD) {
-        ElfAddr segStart = ph->p_vaddr + mLoadBias;
-        void *startPage = reinterpret_cast<void *>(segStart);
-        void *binaryStartPage = mBinary + ph->p_offset;
-        size_t segmentLen = ph->p_filesz;
-
-        LOGV("Mapping start page %p from %p with length %zu", startPage,
-             binaryStartPage, segmentLen);
-        memcpy(startPage, binaryStartPage, segmentLen);
-        mapBss(ph);
-      } else {
+      if (ph->p_type != PT_LOAD) {
         LOGE("Non-load segment found between load segments");
         success = false;
         break;
       }
     }
+    mFirstLoadSegment = first;
+    mLastLoadSegment = last;
   }
 
   return success;
 }
 
+void NanoappLoader::mapSegments(size_t binaryStart, size_t binaryEnd) {
+  for (const ProgramHeader *ph = mFirstLoadSegment; ph <= mLastLoadSegment;
+       ++ph) {
+    size_t segmentEnd = ph->p_offset + ph->p_filesz;
+    size_t copyStart = MAX(binaryStart, static_cast<size_t>(ph->p_offset));
+    size_t copyEnd = MIN(binaryEnd, segmentEnd);
+    if (copyStart < copyEnd) {
+      ElfAddr segStart = ph->p_vaddr + mLoadBias + (copyStart - ph->p_offset);
+      void *startPage = reinterpret_cast<void *>(segStart);
+      void *binaryStartPage = mBinary + copyStart;
+      size_t segmentLen = copyEnd - copyStart;
+
+      LOGV("Mapping start page %p from %p with length %zu", startPage,
+           binaryStartPage, segmentLen);
+      memcpy(startPage, binaryStartPage, segmentLen);
+    }
+    if (segmentEnd >= binaryStart && segmentEnd <= binaryEnd) {
+      mapBss(ph);
+    }
+  }
+}
+
 NanoappLoader::ElfSym *NanoappLoader::getDynamicSymbol(
     size_t posInSymbolTable) {
   size_t sectionSize = getDynamicSymbolTableSize();
@@ -839,9 +904,15 @@ bool NanoappLoader::fixRelocations() {
     LOGE("Mandatory headers missing from shared object, aborting load");
   }
 
+  // Relocations against imported symbols are patched from the manifest first,
+  // when the binary has one, and skipped by relocateTable() and resolveGot().
+  success = applyRelocationManifest();
+
   // Must return true if it table is not required or is empty. If
   // the entry is present when not expected, this must return false.
-  success = relocateTable(dyn, DT_RELA);
+  if (success) {
+    success = relocateTable(dyn, DT_RELA);
+  }
   if (success) {
     success = relocateTable(dyn, DT_REL);
   }
@@ -853,6 +924,100 @@ bool NanoappLoader::fixRelocations() {
   return success;
 }
 
+bool NanoappLoader::applyRelocationManifest() {
+  SectionHeader *manifestHeader = getSectionHeader(kRelocationManifestName);
+  if (manifestHeader == nullptr) {
+    return true;
+  }
+
+  const uint8_t *manifest = mBinary + manifestHeader->sh_offset;
+  size_t manifestSize = manifestHeader->sh_size;
+  RelocationManifestHeader header;
+  if (manifestSize < sizeof(header)) {
+    LOGW("Ignoring truncated relocation manifest");
+    return true;
+  }
+  memcpy(&header, manifest, sizeof(header));
+  if (!verifyRelocationManifest(manifest, manifestSize, header)) {
+    LOGW("Ignoring invalid relocation manifest");
+    return true;
+  }
+
+  const uint8_t *symbolEntry = manifest + sizeof(header);
+  const uint8_t *site =
+      symbolEntry + header.numSymbols * sizeof(RelocationManifestSymbol);
+  for (uint32_t i = 0; i < header.numSymbols; ++i) {
+    RelocationManifestSymbol symbol;
+    memcpy(&symbol, symbolEntry, sizeof(symbol));
+    symbolEntry += sizeof(symbol);
+
+    void *resolved = resolveData(symbol.symbolIndex);
+    if (resolved == nullptr) {
+      return false;
+    }
+    // TODO(b/155512914): When we move to DRAM allocations, we need to
+    // check if the above address is in a Read-Only section of memory,
+    // and give it temporary write permission if that is the case.
+    ElfAddr value = reinterpret_cast<ElfAddr>(resolved);
+    for (uint32_t j = 0; j < symbol.numSites; ++j) {
+      uint32_t offset;
+      memcpy(&offset, site, sizeof(offset));
+      site += sizeof(offset);
+      *reinterpret_cast<ElfAddr *>(mMapping + offset) = value;
+    }
+  }
+
+  LOGV("Resolved %" PRIu32 " symbol relocations through %" PRIu32
+       " symbols from the relocation manifest",
+       header.numSites, header.numSymbols);
+  mSymbolRelocationsApplied = true;
+  return true;
+}
+
+bool NanoappLoader::verifyRelocationManifest(
+    const uint8_t *manifest, size_t manifestSize,
+    const RelocationManifestHeader &header) {
+  uint64_t expectedSize =
+      sizeof(header) +
+      static_cast<uint64_t>(header.numSymbols) *
+          sizeof(RelocationManifestSymbol) +
+      static_cast<uint64_t>(header.numSites) * sizeof(uint32_t);
+  if (header.magic != kRelocationManifestMagic ||
+      header.version != kRelocationManifestVersion ||
+      expectedSize != manifestSize) {
+    return false;
+  }
+
+  size_t numDynamicSymbols = getDynamicSymbolTableSize() / sizeof(ElfSym);
+  const uint8_t *symbolEntry = manifest + sizeof(header);
+  uint64_t numSites = 0;
+  for (uint32_t i = 0; i < header.numSymbols; ++i) {
+    RelocationManifestSymbol symbol;
+    memcpy(&symbol, symbolEntry, sizeof(symbol));
+    symbolEntry += sizeof(symbol);
+    if (symbol.symbolIndex >= numDynamicSymbols) {
+      return false;
+    }
+    numSites += symbol.numSites;
+  }
+  if (numSites != header.numSites) {
+    return false;
+  }
+
+  const uint8_t *site = symbolEntry;
+  for (uint32_t i = 0; i < header.numSites; ++i) {
+    uint32_t offset;
+    memcpy(&offset, site, sizeof(offset));
+    site += sizeof(offset);
+    if (mMemorySpan < sizeof(ElfAddr) ||
+        offset > mMemorySpan - sizeof(ElfAddr)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void NanoappLoader::callAtexitFunctions() {
   while (!mAtexitFunctions.empty()) {
     struct AtExitCallback cb = mAtexitFunctions.back();
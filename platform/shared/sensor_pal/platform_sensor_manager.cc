@@ -68,6 +68,7 @@ DynamicVector<Sensor> PlatformSensorManager::getSensors() {
         const struct chreSensorInfo *sensor = &palSensors[i];
         sensors.push_back(Sensor());
         sensors[i].initBase(sensor, i /* sensorHandle */);
+        sensors[i].init();
         if (sensor->sensorName != nullptr) {
           LOGD("Found sensor: %s", sensor->sensorName);
         } else {
@@ -52,6 +52,16 @@ namespace {
 
 constexpr size_t kOutboundQueueSize = 32;
 
+#ifdef CHRE_SLPI_BATCH_MESSAGES_TO_HOST
+//! The maximum number of nanoapp messages packed into one BatchedMessages frame
+constexpr size_t kMaxBatchedMessages = 16;
+
+//! Upper bounds on the encoded size of a BatchedMessages frame excluding the
+//! nanoapp messages, and of each nanoapp message excluding its payload
+constexpr size_t kBatchedFrameOverhead = 64;
+constexpr size_t kBatchedMessageOverhead = 64;
+#endif  // CHRE_SLPI_BATCH_MESSAGES_TO_HOST
+
 //! The last time a time sync request message has been sent.
 //! TODO: Make this a member of HostLinkBase
 Nanoseconds gLastTimeSyncRequestNanos(0);
@@ -268,6 +278,72 @@ int generateMessageToHost(const MessageToHost *msgToHost, unsigned char *buffer,
   return result;
 }
 
+#ifdef CHRE_SLPI_BATCH_MESSAGES_TO_HOST
+/**
+ * Encodes msgToHost together with the nanoapp messages queued right behind it
+ * into a single BatchedMessages frame, so that a burst of messages costs one
+ * host transaction rather than one each. Messages are only taken from the front
+ * of the queue, preserving the order of all outbound messages, and only while
+ * the frame is guaranteed to fit in the host buffer.
+ */
+int generateMessagesToHost(const MessageToHost *msgToHost,
+                           unsigned char *buffer, size_t bufferSize,
+                           unsigned int *messageLen) {
+  // This thread is the only consumer of the queue, so the front element seen
+  // here is the one that gets popped.
+  DynamicVector<NanoappMessageOffset> offsets;
+  if (gOutboundQueue.empty() ||
+      gOutboundQueue[0].type != PendingMessageType::NanoappMessageToHost ||
+      !offsets.reserve(kMaxBatchedMessages)) {
+    return generateMessageToHost(msgToHost, buffer, bufferSize, messageLen);
+  }
+
+  const MessageToHost *batch[kMaxBatchedMessages];
+  batch[0] = msgToHost;
+  size_t numMessages = 1;
+  size_t encodedSize = kBatchedFrameOverhead + kBatchedMessageOverhead +
+                       msgToHost->message.size();
+  while (numMessages < kMaxBatchedMessages && !gOutboundQueue.empty()) {
+    const PendingMessage &next = gOutboundQueue[0];
+    if (next.type != PendingMessageType::NanoappMessageToHost) {
+      break;
+    }
+    size_t nextSize =
+        kBatchedMessageOverhead + next.data.msgToHost->message.size();
+    if (encodedSize + nextSize > bufferSize) {
+      break;
+    }
+    encodedSize += nextSize;
+    batch[numMessages++] = gOutboundQueue.pop().data.msgToHost;
+  }
+
+  if (numMessages == 1) {
+    return generateMessageToHost(msgToHost, buffer, bufferSize, messageLen);
+  }
+
+  ChreFlatBufferBuilder builder(encodedSize);
+  for (size_t i = 0; i < numMessages; i++) {
+    HostProtocolChre::addBatchedNanoappMessage(
+        builder, offsets, batch[i]->appId, batch[i]->toHostData.messageType,
+        batch[i]->toHostData.hostEndpoint, batch[i]->message.data(),
+        batch[i]->message.size(), batch[i]->toHostData.appPermissions,
+        batch[i]->toHostData.messagePermissions,
+        batch[i]->toHostData.wokeHost);
+  }
+  HostProtocolChre::finishBatchedMessages(builder, offsets);
+
+  int result = copyToHostBuffer(builder, buffer, bufferSize, messageLen);
+
+  auto &hostCommsManager =
+      EventLoopManagerSingleton::get()->getHostCommsManager();
+  for (size_t i = 0; i < numMessages; i++) {
+    hostCommsManager.onMessageToHostComplete(batch[i]);
+  }
+
+  return result;
+}
+#endif  // CHRE_SLPI_BATCH_MESSAGES_TO_HOST
+
 int generateHubInfoResponse(uint16_t hostClientId, unsigned char *buffer,
                             size_t bufferSize, unsigned int *messageLen) {
   constexpr size_t kInitialBufferSize = 192;
@@ -490,8 +566,13 @@ extern "C" int chre_slpi_get_message_to_host(unsigned char *buffer,
         break;
 
       case PendingMessageType::NanoappMessageToHost:
+#ifdef CHRE_SLPI_BATCH_MESSAGES_TO_HOST
+        result = generateMessagesToHost(pendingMsg.data.msgToHost, buffer,
+                                        bufferSize, messageLen);
+#else
         result = generateMessageToHost(pendingMsg.data.msgToHost, buffer,
                                        bufferSize, messageLen);
+#endif  // CHRE_SLPI_BATCH_MESSAGES_TO_HOST
         break;
 
       case PendingMessageType::HubInfoResponse:
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/platform/shared/exported_symbol_table.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "chre/platform/shared/exported_symbols.h"
+#include "chre/util/macros.h"
+
+namespace chre {
+namespace {
+
+//! The names of the symbols exported by the nanoapp loader, in declaration
+//! order.
+constexpr const char *kExportedNames[] = {CHRE_LOADER_EXPORTED_SYMBOLS(
+    EXPORTED_SYMBOL_NAME, EXPORTED_C_SYMBOL_NAME)};
+
+constexpr size_t kNumExportedNames = ARRAY_SIZE(kExportedNames);
+
+//! Sorted at compile time, like the nanoapp loader's table.
+constexpr ExportedSymbolTable kExportedSymbols(kExportedNames);
+
+//! Equivalent to the lookup previously done by the nanoapp loader.
+size_t linearFind(const char *name) {
+  size_t nameLen = strlen(name);
+  for (size_t i = 0; i < kNumExportedNames; i++) {
+    if (nameLen == strlen(kExportedNames[i]) &&
+        strncmp(name, kExportedNames[i], nameLen) == 0) {
+      return i;
+    }
+  }
+  return kNumExportedNames;
+}
+
+}  // namespace
+
+TEST(ExportedSymbolTableTest, FindsEveryExportedSymbol) {
+  for (size_t i = 0; i < kNumExportedNames; i++) {
+    EXPECT_EQ(kExportedSymbols.find(kExportedNames[i]), i) << kExportedNames[i];
+  }
+}
+
+TEST(ExportedSymbolTableTest, MissingSymbolsAreNotFound) {
+  for (const char *name :
+       {"", "a", "chre", "chreSensorFin", "chreSensorFindDefaultX", "zzz",
+        "__cxa", "sqrtff"}) {
+    EXPECT_EQ(kExportedSymbols.find(name), kNumExportedNames) << name;
+  }
+}
+
+TEST(ExportedSymbolTableTest, DuplicateNamesResolveToFirstDeclared) {
+  static constexpr const char *kNames[] = {"b", "a", "a", "c"};
+  constexpr ExportedSymbolTable table(kNames);
+  EXPECT_EQ(table.find("a"), 1u);
+  EXPECT_EQ(table.find("c"), 3u);
+}
+
+/**
+ * Compares the cost of resolving the undefined symbols of a nanoapp with a few
+ * hundred relocations against exported symbols, using the sorted table and the
+ * linear search it replaces.
+ */
+TEST(ExportedSymbolTableTest, DISABLED_ResolveBenchmark) {
+  constexpr size_t kNumRelocations = 300;
+  constexpr size_t kNumLoads = 1000;
+
+  // Nanoapps mostly reference CHRE APIs declared towards the end of the table,
+  // and some symbols that are defined by the nanoapp itself.
+  std::vector<std::string> relocations;
+  for (size_t i = 0; i < kNumRelocations; i++) {
+    if (i % 10 == 0) {
+      relocations.push_back("nanoappLocalSymbol" + std::to_string(i));
+    } else {
+      relocations.push_back(
+          kExportedNames[kNumExportedNames - 1 - (i * 7) % 80]);
+    }
+  }
+
+  size_t linearHits = 0;
+  size_t tableHits = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t load = 0; load < kNumLoads; load++) {
+    for (const std::string &name : relocations) {
+      linearHits += (linearFind(name.c_str()) < kNumExportedNames);
+    }
+  }
+  auto linearNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+
+  start = std::chrono::steady_clock::now();
+  for (size_t load = 0; load < kNumLoads; load++) {
+    for (const std::string &name : relocations) {
+      tableHits += (kExportedSymbols.find(name.c_str()) < kNumExportedNames);
+    }
+  }
+  auto tableNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  EXPECT_EQ(linearHits, tableHits);
+  EXPECT_EQ(tableHits, kNumLoads * kNumRelocations * 9 / 10);
+  printf("%zu relocations against %zu exported symbols: linear search %" PRIu64
+         " ns/load, sorted table %" PRIu64 " ns/load\n",
+         kNumRelocations, kNumExportedNames,
+         static_cast<uint64_t>(linearNs) / kNumLoads,
+         static_cast<uint64_t>(tableNs) / kNumLoads);
+}
+
+}  // namespace chre
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "chre/platform/shared/generated/host_messages_generated.h"
+#include "chre/platform/shared/host_protocol_chre.h"
+#include "chre/util/dynamic_vector.h"
+#include "chre/util/flatbuffers/helpers.h"
+
+namespace chre {
+namespace {
+
+TEST(HostProtocolChre, BatchedMessagesKeepOrderAndFields) {
+  constexpr size_t kNumMessages = 3;
+  constexpr uint64_t kAppId = 0x0123456789abcdef;
+  constexpr uint16_t kHostEndpoint = 0x8001;
+  const uint8_t payloads[kNumMessages][4] = {
+      {1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+
+  ChreFlatBufferBuilder builder(256);
+  DynamicVector<NanoappMessageOffset> offsets;
+  for (size_t i = 0; i < kNumMessages; i++) {
+    HostProtocolChre::addBatchedNanoappMessage(
+        builder, offsets, kAppId, static_cast<uint32_t>(i) /* messageType */,
+        kHostEndpoint, payloads[i], sizeof(payloads[i]),
+        0x3 /* permissions */, 0x1 /* messagePermissions */,
+        i == 0 /* wokeHost */);
+  }
+  HostProtocolChre::finishBatchedMessages(builder, offsets);
+
+  ASSERT_TRUE(HostProtocolChre::verifyMessage(builder.GetBufferPointer(),
+                                              builder.GetSize()));
+  const fbs::MessageContainer *container =
+      fbs::GetMessageContainer(builder.GetBufferPointer());
+  EXPECT_EQ(container->host_addr()->client_id(), kHostClientIdUnspecified);
+  const fbs::BatchedMessages *batch = container->message_as_BatchedMessages();
+  ASSERT_NE(batch, nullptr);
+  ASSERT_NE(batch->nanoapp_messages(), nullptr);
+  ASSERT_EQ(batch->nanoapp_messages()->size(), kNumMessages);
+
+  for (size_t i = 0; i < kNumMessages; i++) {
+    const fbs::NanoappMessage *message = batch->nanoapp_messages()->Get(i);
+    EXPECT_EQ(message->app_id(), kAppId);
+    EXPECT_EQ(message->message_type(), i);
+    EXPECT_EQ(message->host_endpoint(), kHostEndpoint);
+    EXPECT_EQ(message->permissions(), 0x3);
+    EXPECT_EQ(message->message_permissions(), 0x1);
+    EXPECT_EQ(message->woke_host(), i == 0);
+    ASSERT_EQ(message->message()->size(), sizeof(payloads[i]));
+    EXPECT_EQ(memcmp(message->message()->data(), payloads[i],
+                     sizeof(payloads[i])),
+              0);
+  }
+}
+
+}  // namespace
+}  // namespace chre
@@ -15,11 +15,14 @@
  */
 
 #include <gtest/gtest.h>
+#include <chrono>
+#include <cinttypes>
 #include <string>
 
 #include "chre/platform/atomic.h"
 #include "chre/platform/condition_variable.h"
 #include "chre/platform/mutex.h"
+#include "chre/platform/shared/generated/host_messages_generated.h"
 #include "chre/platform/shared/log_buffer.h"
 
 namespace chre {
@@ -44,6 +47,23 @@ void copyStringWithOffset(char *destination, const char *source,
   memcpy(destination, source + sourceOffset, strlength + 1);
 }
 
+size_t encodeStructuredLog(uint8_t *buffer, size_t bufferSize,
+                           const char *logFormat, ...) {
+  va_list args;
+  va_start(args, logFormat);
+  size_t size =
+      LogBuffer::encodeStructuredLogVa(buffer, bufferSize, logFormat, args);
+  va_end(args);
+  return size;
+}
+
+void handleTextLog(LogBuffer &logBuffer, const char *logFormat, ...) {
+  va_list args;
+  va_start(args, logFormat);
+  logBuffer.handleLogVa(LogBufferLogLevel::INFO, 0, logFormat, args);
+  va_end(args);
+}
+
 TEST(LogBuffer, HandleOneLogAndCopy) {
   char buffer[kDefaultBufferSize];
   constexpr size_t kOutBufferSize = 20;
@@ -216,6 +236,56 @@ TEST(LogBuffer, TruncateLongLog) {
   EXPECT_EQ(bytesCopied, 255);
 }
 
+TEST(LogBuffer, HandleEncodedLogsAndCopyOne) {
+  char buffer[kDefaultBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  const uint8_t kEncodedLog[] = {0x12, 0x34, 0x56, 0x78};
+  logBuffer.handleEncodedLog(LogBufferLogLevel::WARN, 0, kEncodedLog,
+                             sizeof(kEncodedLog));
+  logBuffer.handleEncodedLog(LogBufferLogLevel::WARN, 0, kEncodedLog,
+                             sizeof(kEncodedLog));
+
+  // Only the first log fits, which requires finding where it ends without
+  // a null terminator.
+  uint8_t outBuffer[kDefaultBufferSize];
+  size_t logSize = LogBuffer::kLogDataOffset + 1 + sizeof(kEncodedLog);
+  size_t numLogsDropped;
+  ASSERT_EQ(logBuffer.copyLogs(outBuffer, logSize + 1, &numLogsDropped),
+            logSize);
+  EXPECT_EQ(outBuffer[0], 0x12);  // Tokenized, warning
+  EXPECT_EQ(outBuffer[LogBuffer::kLogDataOffset], sizeof(kEncodedLog));
+  EXPECT_EQ(memcmp(&outBuffer[LogBuffer::kLogDataOffset + 1], kEncodedLog,
+                   sizeof(kEncodedLog)),
+            0);
+  EXPECT_EQ(logBuffer.getBufferSize(), logSize);
+}
+
+TEST(LogBuffer, EncodedLogsOverwrittenBySize) {
+  char buffer[kDefaultBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  // Each log takes 206 bytes, so the fifth one overwrites the first.
+  constexpr size_t kNumLogs = 5;
+  uint8_t encodedLog[200];
+  for (size_t i = 0; i < kNumLogs; i++) {
+    memset(encodedLog, static_cast<int>('a' + i), sizeof(encodedLog));
+    logBuffer.handleEncodedLog(LogBufferLogLevel::INFO, 0, encodedLog,
+                               sizeof(encodedLog));
+  }
+
+  size_t logSize = LogBuffer::kLogDataOffset + 1 + sizeof(encodedLog);
+  EXPECT_EQ(logBuffer.getBufferSize(), (kNumLogs - 1) * logSize);
+  uint8_t outBuffer[kDefaultBufferSize];
+  size_t numLogsDropped;
+  EXPECT_EQ(logBuffer.copyLogs(outBuffer, sizeof(outBuffer), &numLogsDropped),
+            (kNumLogs - 1) * logSize);
+  EXPECT_EQ(outBuffer[LogBuffer::kLogDataOffset + 1], 'b');
+  EXPECT_EQ(numLogsDropped, 1);
+}
+
 TEST(LogBuffer, WouldCauseOverflowTest) {
   char buffer[kDefaultBufferSize];
   TestLogBufferCallback callback;
@@ -280,6 +350,122 @@ TEST(LogBuffer, TransferTest) {
   ASSERT_EQ(bytesCopied, 0);
 }
 
+TEST(LogBuffer, EncodeStructuredLog) {
+  uint8_t encoded[LogBuffer::kEncodedLogMaxSize];
+  const char *format = "%d %u %s %c";
+  size_t size = encodeStructuredLog(encoded, sizeof(encoded), format, -2, 300u,
+                                    "ab", 'z');
+
+  // The format string, then -2 as a zigzag varint, 300 as a varint, the
+  // length prefixed string and the character.
+  const uint8_t kExpectedArgs[] = {0x03, 0xac, 0x02, 0x02, 'a', 'b', 'z'};
+  size_t formatSize = strlen(format) + 1;
+  ASSERT_EQ(size, formatSize + sizeof(kExpectedArgs));
+  EXPECT_EQ(memcmp(encoded, format, formatSize), 0);
+  EXPECT_EQ(memcmp(&encoded[formatSize], kExpectedArgs, sizeof(kExpectedArgs)),
+            0);
+
+  double value;
+  size = encodeStructuredLog(encoded, sizeof(encoded), "%.2f%%", 1.5);
+  ASSERT_EQ(size, sizeof("%.2f%%") + sizeof(value));
+  memcpy(&value, &encoded[sizeof("%.2f%%")], sizeof(value));
+  EXPECT_EQ(value, 1.5);
+}
+
+TEST(LogBuffer, EncodeStructuredLogFallsBackToText) {
+  uint8_t encoded[LogBuffer::kEncodedLogMaxSize];
+  EXPECT_EQ(encodeStructuredLog(encoded, sizeof(encoded), "%*d", 3, 4), 0);
+  EXPECT_EQ(encodeStructuredLog(encoded, sizeof(encoded), "%n", nullptr), 0);
+  EXPECT_EQ(encodeStructuredLog(encoded, sizeof(encoded), "%Lf", 1.0L), 0);
+  EXPECT_EQ(encodeStructuredLog(encoded, sizeof(encoded), "trailing %"), 0);
+
+  // Doesn't fit: a varint needs more bytes than are left.
+  EXPECT_EQ(encodeStructuredLog(encoded, sizeof("%d") + 1, "%d", INT32_MAX),
+            0);
+  // Strings are truncated to fit instead.
+  EXPECT_EQ(encodeStructuredLog(encoded, sizeof("%s") + 3, "%s", "abcdef"),
+            sizeof("%s") + 3);
+  EXPECT_EQ(encoded[sizeof("%s")], 2);
+}
+
+TEST(LogBuffer, HandleStructuredLogsAndCopyOne) {
+  char buffer[kDefaultBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+
+  uint8_t encoded[LogBuffer::kEncodedLogMaxSize];
+  size_t size = encodeStructuredLog(encoded, sizeof(encoded), "value %d", 7);
+  logBuffer.handleStructuredLog(LogBufferLogLevel::WARN, 0, encoded, size);
+  logBuffer.handleStructuredLog(LogBufferLogLevel::WARN, 0, encoded, size);
+
+  // Only the first log fits, which requires finding where it ends without
+  // a null terminator.
+  uint8_t outBuffer[kDefaultBufferSize];
+  size_t logSize = LogBuffer::kLogDataOffset + 1 + size;
+  size_t numLogsDropped;
+  ASSERT_EQ(logBuffer.copyLogs(outBuffer, logSize + 1, &numLogsDropped),
+            logSize);
+  EXPECT_EQ(outBuffer[0], 0x32);  // Structured, warning
+  EXPECT_EQ(outBuffer[LogBuffer::kLogDataOffset], size);
+  EXPECT_EQ(memcmp(&outBuffer[LogBuffer::kLogDataOffset + 1], encoded, size),
+            0);
+  EXPECT_EQ(logBuffer.getBufferSize(), logSize);
+}
+
+TEST(LogBuffer, LogTypesMatchSchema) {
+  // The host decodes the upper nibble of the metadata by the values defined in
+  // host_messages.fbs
+  using fbs::LogType;
+  EXPECT_EQ(static_cast<int8_t>(LogType::STRING), 0);
+  EXPECT_EQ(static_cast<int8_t>(LogType::TOKENIZED), 1);
+  EXPECT_EQ(static_cast<int8_t>(LogType::BLUETOOTH), 2);
+  EXPECT_EQ(static_cast<int8_t>(LogType::STRUCTURED), 3);
+  EXPECT_EQ(LogType::MAX, LogType::STRUCTURED);
+  EXPECT_STREQ(fbs::EnumNameLogType(LogType::STRUCTURED), "STRUCTURED");
+}
+
+/**
+ * Compares the cost of a log call on the CHRE side between text logs, which
+ * are formatted with vsnprintf, and structured logs, which defer formatting to
+ * the host.
+ */
+TEST(LogBuffer, DISABLED_StructuredLogBenchmark) {
+  constexpr size_t kNumLogs = 20000;
+  constexpr char kFormat[] = "Sensor %s sample %" PRIu32 " at %" PRIu64
+                             " ns: x=%.3f y=%.3f z=%.3f";
+  char buffer[kDefaultBufferSize];
+  TestLogBufferCallback callback;
+  LogBuffer logBuffer(&callback, buffer, kDefaultBufferSize);
+  logBuffer.updateNotificationSetting(LogBufferNotificationSetting::NEVER);
+
+  auto start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kNumLogs; i++) {
+    handleTextLog(logBuffer, kFormat, "accel", i, uint64_t{1000000} * i, 0.5f,
+                  -9.81f, 0.25f);
+  }
+  auto textNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+
+  logBuffer.reset();
+  start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < kNumLogs; i++) {
+    uint8_t encoded[LogBuffer::kEncodedLogMaxSize];
+    size_t size = encodeStructuredLog(encoded, sizeof(encoded), kFormat,
+                                      "accel", i, uint64_t{1000000} * i, 0.5f,
+                                      -9.81f, 0.25f);
+    ASSERT_GT(size, 0);
+    logBuffer.handleStructuredLog(LogBufferLogLevel::INFO, 0, encoded, size);
+  }
+  auto structuredNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count();
+
+  printf("%zu logs: text %" PRIu64 " ns/log, structured %" PRIu64 " ns/log\n",
+         kNumLogs, static_cast<uint64_t>(textNs) / kNumLogs,
+         static_cast<uint64_t>(structuredNs) / kNumLogs);
+}
+
 // TODO(srok): Add multithreaded tests
 
 }  // namespace chre
@@ -19,6 +19,7 @@
 
 #include "chre/platform/log.h"
 #include "chre/platform/shared/authentication.h"
+#include "chre/platform/shared/memory.h"
 #include "chre/util/macros.h"
 
 #include "mbedtls/pk.h"
@@ -218,55 +219,163 @@ bool isValidProductionPublicKey(const uint8_t *publicKey,
   }
   return false;
 }
-}  // anonymous namespace
 
-bool authenticateBinary(const void *binary, size_t appBinaryLen,
-                        void **realBinaryStart) {
-#ifndef CHRE_NAPP_AUTHENTICATION_ENABLED
-  UNUSED_VAR(binary);
-  UNUSED_VAR(realBinaryStart);
-  LOGW(
-      "Nanoapp authentication is disabled, which exposes the device to "
-      "security risks!");
-  return true;
-#endif
-  if (appBinaryLen <= kHeaderSize) {
-    LOGE("Binary size %zu is too short.", appBinaryLen);
-    return false;
-  }
+/**
+ * Checks everything the image header provides but the hash of the image, which
+ * authenticates the hash provided in the header.
+ */
+bool verifyImageHeader(const ImageHeader *header, size_t appBinaryLen) {
   Authenticator authenticator;
-  auto *header = static_cast<const ImageHeader *>(binary);
-  const uint8_t *imageHash = header->headerInfo.binarySha256;
   const uint8_t *publicKey = header->publicKey;
-  const uint32_t expectedAppBinaryLength =
-      header->headerInfo.binaryLength + kHeaderSize;
 
-  if (header->headerInfo.magic != kChreMagicNumber) {
+  if (appBinaryLen <= kHeaderSize) {
+    LOGE("Binary size %zu is too short.", appBinaryLen);
+  } else if (header->headerInfo.magic != kChreMagicNumber) {
     LOGE("Mismatched magic number.");
   } else if (header->headerInfo.headerVersion != 1) {
     LOGE("Header version %" PRIu32 " is unsupported.",
          header->headerInfo.headerVersion);
-  } else if (expectedAppBinaryLength != appBinaryLen) {
+  } else if (header->headerInfo.binaryLength + kHeaderSize != appBinaryLen) {
     LOGE("Invalid binary length %zu. Expected %" PRIu32, appBinaryLen,
-         expectedAppBinaryLength);
+         header->headerInfo.binaryLength + kHeaderSize);
   } else if (!isValidProductionPublicKey(
                  publicKey, getPublicKeyLength(header->headerInfo.flags))) {
     LOGE("Invalid public key attached on the image.");
-  } else if (!hasCorrectHash(binary, header->headerInfo.binaryLength,
-                             imageHash)) {
-    LOGE("Hash of the nanoapp image is incorrect.");
   } else if (!authenticator.loadEcpGroup() ||
              !authenticator.loadPublicKey(publicKey) ||
              !authenticator.loadSignature(header)) {
     LOGE("Failed to load authentication data.");
-  } else if (!authenticator.authenticate(binary)) {
+  } else if (!authenticator.authenticate(header)) {
     LOGE("Failed to authenticate the image.");
   } else {
-    *realBinaryStart = reinterpret_cast<void *>(
-        reinterpret_cast<uintptr_t>(binary) + kHeaderSize);
-    LOGI("Image is authenticated successfully!");
     return true;
   }
   return false;
 }
+}  // anonymous namespace
+
+//! A binary authenticated while it is received. The image header is verified
+//! as soon as it arrives, and the image is hashed one fragment at a time.
+struct StreamingAuthentication {
+  //! The length of the binary once fully received, including the header.
+  size_t appBinaryLen;
+
+  //! The number of bytes of the binary authenticated so far.
+  size_t bytesAuthenticated;
+
+  //! Whether the image header has been received and verified.
+  bool headerVerified;
+
+  //! The hash of the image provided in the verified header.
+  uint8_t expectedSha256[kSha256HashSize];
+
+  //! The hash of the image received so far.
+  mbedtls_sha256_context sha256;
+};
+
+bool authenticateBinary(const void *binary, size_t appBinaryLen,
+                        void **realBinaryStart) {
+#ifndef CHRE_NAPP_AUTHENTICATION_ENABLED
+  UNUSED_VAR(binary);
+  UNUSED_VAR(realBinaryStart);
+  LOGW(
+      "Nanoapp authentication is disabled, which exposes the device to "
+      "security risks!");
+  return true;
+#endif
+  auto *header = static_cast<const ImageHeader *>(binary);
+  if (!verifyImageHeader(header, appBinaryLen)) {
+    return false;
+  }
+  if (!hasCorrectHash(binary, header->headerInfo.binaryLength,
+                      header->headerInfo.binarySha256)) {
+    LOGE("Hash of the nanoapp image is incorrect.");
+    return false;
+  }
+  *realBinaryStart = reinterpret_cast<void *>(
+      reinterpret_cast<uintptr_t>(binary) + kHeaderSize);
+  LOGI("Image is authenticated successfully!");
+  return true;
+}
+
+StreamingAuthentication *startStreamingAuthentication(size_t appBinaryLen) {
+  auto *auth = memoryAllocDram<StreamingAuthentication>();
+  if (auth == nullptr) {
+    LOG_OOM();
+  } else {
+    auth->appBinaryLen = appBinaryLen;
+    auth->bytesAuthenticated = 0;
+    auth->headerVerified = false;
+    mbedtls_sha256_init(&auth->sha256);
+    mbedtls_sha256_starts(&auth->sha256, /* is224= */ 0);
+  }
+  return auth;
+}
+
+bool updateStreamingAuthentication(StreamingAuthentication *auth,
+                                   const void *binary, size_t bytesReceived,
+                                   void **realBinaryStart) {
+#ifndef CHRE_NAPP_AUTHENTICATION_ENABLED
+  UNUSED_VAR(auth);
+  UNUSED_VAR(bytesReceived);
+  *realBinaryStart = const_cast<void *>(binary);
+  return true;
+#endif
+  auto *header = static_cast<const ImageHeader *>(binary);
+  if (!auth->headerVerified) {
+    if (bytesReceived < kHeaderSize) {
+      return true;
+    }
+    if (!verifyImageHeader(header, auth->appBinaryLen)) {
+      return false;
+    }
+    memcpy(auth->expectedSha256, header->headerInfo.binarySha256,
+           kSha256HashSize);
+    auth->bytesAuthenticated = kHeaderSize;
+    auth->headerVerified = true;
+  }
+
+  if (bytesReceived > auth->bytesAuthenticated) {
+    mbedtls_sha256_update(
+        &auth->sha256,
+        static_cast<const uint8_t *>(binary) + auth->bytesAuthenticated,
+        bytesReceived - auth->bytesAuthenticated);
+    auth->bytesAuthenticated = bytesReceived;
+  }
+  *realBinaryStart = reinterpret_cast<void *>(
+      reinterpret_cast<uintptr_t>(binary) + kHeaderSize);
+  return true;
+}
+
+bool finishStreamingAuthentication(StreamingAuthentication *auth) {
+  bool success = false;
+#ifndef CHRE_NAPP_AUTHENTICATION_ENABLED
+  LOGW(
+      "Nanoapp authentication is disabled, which exposes the device to "
+      "security risks!");
+  success = true;
+#else
+  if (!auth->headerVerified || auth->bytesAuthenticated != auth->appBinaryLen) {
+    LOGE("Only %zu of %zu bytes of the image were authenticated",
+         auth->bytesAuthenticated, auth->appBinaryLen);
+  } else {
+    uint8_t hashCalculated[kSha256HashSize] = {};
+    mbedtls_sha256_finish(&auth->sha256, hashCalculated);
+    if (memcmp(hashCalculated, auth->expectedSha256, kSha256HashSize) != 0) {
+      LOGE("Hash of the nanoapp image is incorrect.");
+    } else {
+      LOGI("Image is authenticated successfully!");
+      success = true;
+    }
+  }
+#endif
+  abortStreamingAuthentication(auth);
+  return success;
+}
+
+void abortStreamingAuthentication(StreamingAuthentication *auth) {
+  mbedtls_sha256_free(&auth->sha256);
+  memoryFreeDram(auth);
+}
+
 }  // namespace chre
@@ -0,0 +1,820 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/log.h"
+#include "chre/platform/system_time.h"
+#include "chre/util/nested_data_ptr.h"
+#include "chre_api/chre/event.h"
+#include "chre_api/chre/sensor.h"
+#include "chre_api/chre/wifi.h"
+
+#include "gtest/gtest.h"
+#include "inc/test_util.h"
+#include "test_base.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+//! A broadcast event type that the test nanoapps can subscribe to.
+constexpr uint16_t kBroadcastEventType = CHRE_SPECIFIC_SIMULATION_TEST_EVENT_ID(
+    0x800);
+
+void registerCurrentNanoappForBroadcast(uint16_t eventType) {
+  EventLoopManagerSingleton::get()
+      ->getEventLoop()
+      .getCurrentNanoapp()
+      ->registerForBroadcastEvent(eventType);
+}
+
+void unregisterCurrentNanoappForBroadcast(uint16_t eventType) {
+  EventLoopManagerSingleton::get()
+      ->getEventLoop()
+      .getCurrentNanoapp()
+      ->unregisterForBroadcastEvent(eventType);
+}
+
+TEST_F(TestBase, EventLoopBroadcastOnlyDeliveredToSubscribers) {
+  CREATE_CHRE_TEST_EVENT(GET_COUNT, 0);
+  CREATE_CHRE_TEST_EVENT(UNSUBSCRIBE, 1);
+
+  struct SubscribedApp : public TestNanoapp {
+    uint64_t id = 0x1234;
+
+    decltype(nanoappStart) *start = []() {
+      registerCurrentNanoappForBroadcast(kBroadcastEventType);
+      return true;
+    };
+
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static uint32_t count = 0;
+      switch (eventType) {
+        case kBroadcastEventType: {
+          count++;
+          break;
+        }
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          switch (event->type) {
+            case GET_COUNT: {
+              TestEventQueueSingleton::get()->pushEvent(GET_COUNT, count);
+              break;
+            }
+            case UNSUBSCRIBE: {
+              unregisterCurrentNanoappForBroadcast(kBroadcastEventType);
+              TestEventQueueSingleton::get()->pushEvent(UNSUBSCRIBE);
+              break;
+            }
+          }
+        }
+      }
+    };
+  };
+
+  struct UnsubscribedApp : public TestNanoapp {
+    uint64_t id = 0x5678;
+
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static uint32_t count = 0;
+      switch (eventType) {
+        case kBroadcastEventType: {
+          count++;
+          break;
+        }
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == GET_COUNT) {
+            TestEventQueueSingleton::get()->pushEvent(GET_COUNT, count);
+          }
+        }
+      }
+    };
+  };
+
+  auto unsubscribedApp = loadNanoapp<UnsubscribedApp>();
+  auto subscribedApp = loadNanoapp<SubscribedApp>();
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+
+  uint32_t count;
+  eventLoop.postEventOrDie(kBroadcastEventType, nullptr /* eventData */,
+                           nullptr /* freeCallback */);
+  sendEventToNanoapp(subscribedApp, GET_COUNT);
+  waitForEvent(GET_COUNT, &count);
+  EXPECT_EQ(count, 1);
+  sendEventToNanoapp(unsubscribedApp, GET_COUNT);
+  waitForEvent(GET_COUNT, &count);
+  EXPECT_EQ(count, 0);
+
+  sendEventToNanoapp(subscribedApp, UNSUBSCRIBE);
+  waitForEvent(UNSUBSCRIBE);
+  eventLoop.postEventOrDie(kBroadcastEventType, nullptr /* eventData */,
+                           nullptr /* freeCallback */);
+  sendEventToNanoapp(subscribedApp, GET_COUNT);
+  waitForEvent(GET_COUNT, &count);
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(TestBase, EventLoopEventSourceLaneDeliversInOrder) {
+  CREATE_CHRE_TEST_EVENT(DONE, 0);
+  constexpr uint16_t kSourceEventType =
+      CHRE_SPECIFIC_SIMULATION_TEST_EVENT_ID(0x802);
+  // Fewer than CHRE_EVENT_SOURCE_LANE_SIZE, so none overflow the lane
+  constexpr uint32_t kNumEvents = 24;
+
+  struct LaneApp : public TestNanoapp {
+    uint64_t id = 0x1a7e;
+
+    decltype(nanoappStart) *start = []() {
+      registerCurrentNanoappForBroadcast(kSourceEventType);
+      return true;
+    };
+
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static uint32_t expected = 0;
+      static bool inOrder = true;
+      if (eventType == kSourceEventType) {
+        uint32_t value = NestedDataPtr<uint32_t>(const_cast<void *>(eventData));
+        inOrder &= (value == expected);
+        if (++expected == kNumEvents) {
+          TestEventQueueSingleton::get()->pushEvent(DONE, inOrder);
+        }
+      }
+    };
+  };
+
+  loadNanoapp<LaneApp>();
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  EventLoop::EventSourceId sourceId = eventLoop.registerEventSource("test");
+  ASSERT_NE(sourceId, EventLoop::kInvalidEventSourceId);
+
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < kNumEvents; i++) {
+      eventLoop.postEventFromSource(sourceId, false /* isLowPriority */,
+                                    kSourceEventType, NestedDataPtr<uint32_t>(i),
+                                    nullptr /* freeCallback */);
+    }
+  });
+  producer.join();
+
+  bool inOrder;
+  waitForEvent(DONE, &inOrder);
+  EXPECT_TRUE(inOrder);
+  EXPECT_GT(eventLoop.getMaxEventSourceDepth(sourceId), 0);
+  EXPECT_EQ(eventLoop.getMaxEventSourceDepth(EventLoop::kInvalidEventSourceId),
+            0);
+}
+
+TEST_F(TestBase, EventLoopEventSourceOverflowKeepsOrder) {
+  CREATE_CHRE_TEST_EVENT(DONE, 0);
+  constexpr uint16_t kSourceEventType =
+      CHRE_SPECIFIC_SIMULATION_TEST_EVENT_ID(0x803);
+  constexpr uint32_t kNumEvents = 2000;
+  // Twice CHRE_EVENT_SOURCE_LANE_SIZE, so the lane keeps overflowing, while
+  // leaving room in the event pool
+  constexpr uint32_t kMaxInFlight = 64;
+  static std::atomic<uint32_t> numReceived;
+  numReceived = 0;
+
+  struct SlowApp : public TestNanoapp {
+    uint64_t id = 0x0f10;
+
+    decltype(nanoappStart) *start = []() {
+      registerCurrentNanoappForBroadcast(kSourceEventType);
+      return true;
+    };
+
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static bool inOrder = true;
+      if (eventType == kSourceEventType) {
+        uint32_t value = NestedDataPtr<uint32_t>(const_cast<void *>(eventData));
+        inOrder &= (value == numReceived);
+        // Slow enough for the producer to fill the lane
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+        if (++numReceived == kNumEvents) {
+          TestEventQueueSingleton::get()->pushEvent(DONE, inOrder);
+        }
+      }
+    };
+  };
+
+  loadNanoapp<SlowApp>();
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  EventLoop::EventSourceId sourceId = eventLoop.registerEventSource("overflow");
+  ASSERT_NE(sourceId, EventLoop::kInvalidEventSourceId);
+
+  std::thread producer([&]() {
+    for (uint32_t i = 0; i < kNumEvents; i++) {
+      while (i - numReceived >= kMaxInFlight) {
+        std::this_thread::yield();
+      }
+      eventLoop.postEventFromSource(sourceId, false /* isLowPriority */,
+                                    kSourceEventType, NestedDataPtr<uint32_t>(i),
+                                    nullptr /* freeCallback */);
+    }
+  });
+  producer.join();
+
+  bool inOrder;
+  waitForEvent(DONE, &inOrder);
+  EXPECT_TRUE(inOrder);
+}
+
+/**
+ * Blocks the event loop in a nanoapp while WiFi scan results and then another
+ * event are posted, to check the order the scheduler releases them in.
+ */
+class EventLoopPriorityTest : public TestBase {
+ protected:
+  /**
+   * @param eventType The type of the event posted after the scan results,
+   *        either CHRE_EVENT_SENSOR_ACCELEROMETER_DATA or
+   *        CHRE_EVENT_WIFI_ASYNC_RESULT.
+   * @param numScanResults The number of WiFi scan results to post, which must
+   *        fit in the scheduler along with the other event.
+   * @param eventDelay How long after the scan results the other event is
+   *        posted.
+   * @return The number of scan results the nanoapp received before the other
+   *         event.
+   */
+  uint32_t getEventPosition(uint16_t eventType, uint32_t numScanResults,
+                            std::chrono::milliseconds eventDelay) {
+    CREATE_CHRE_TEST_EVENT(BLOCK, 0);
+    CREATE_CHRE_TEST_EVENT(BLOCKED, 1);
+    CREATE_CHRE_TEST_EVENT(POSITION, 2);
+    static std::atomic<bool> released;
+    static uint32_t numExpected;
+
+    struct PriorityApp : public TestNanoapp {
+      uint64_t id = 0x9210;
+
+      decltype(nanoappStart) *start = []() {
+        registerCurrentNanoappForBroadcast(CHRE_EVENT_WIFI_SCAN_RESULT);
+        registerCurrentNanoappForBroadcast(
+            CHRE_EVENT_SENSOR_ACCELEROMETER_DATA);
+        registerCurrentNanoappForBroadcast(CHRE_EVENT_WIFI_ASYNC_RESULT);
+        return true;
+      };
+
+      decltype(nanoappHandleEvent) *handleEvent =
+          [](uint32_t, uint16_t eventType, const void *eventData) {
+            static uint32_t numReceived = 0;
+            static uint32_t eventPosition = 0;
+            switch (eventType) {
+              case CHRE_EVENT_SENSOR_ACCELEROMETER_DATA:
+              case CHRE_EVENT_WIFI_ASYNC_RESULT:
+                eventPosition = numReceived;
+                [[fallthrough]];
+              case CHRE_EVENT_WIFI_SCAN_RESULT: {
+                if (++numReceived == numExpected) {
+                  TestEventQueueSingleton::get()->pushEvent(
+                      POSITION, eventPosition);
+                }
+                break;
+              }
+              case CHRE_EVENT_TEST_EVENT: {
+                auto event = static_cast<const TestEvent *>(eventData);
+                if (event->type == BLOCK) {
+                  numReceived = 0;
+                  TestEventQueueSingleton::get()->pushEvent(BLOCKED);
+                  while (!released) {
+                    std::this_thread::yield();
+                  }
+                }
+              }
+            }
+          };
+    };
+
+    auto app = loadNanoapp<PriorityApp>();
+    EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+    released = false;
+    numExpected = numScanResults + 1;
+    sendEventToNanoapp(app, BLOCK);
+    waitForEvent(BLOCKED);
+
+    for (uint32_t i = 0; i < numScanResults; i++) {
+      eventLoop.postEventOrDie(CHRE_EVENT_WIFI_SCAN_RESULT,
+                               nullptr /* eventData */,
+                               nullptr /* freeCallback */);
+    }
+    std::this_thread::sleep_for(eventDelay);
+    eventLoop.postEventOrDie(eventType, nullptr /* eventData */,
+                             nullptr /* freeCallback */);
+    released = true;
+
+    uint32_t position;
+    waitForEvent(POSITION, &position);
+    unloadNanoapp(app);
+    return position;
+  }
+};
+
+TEST_F(EventLoopPriorityTest, RealtimeEventOvertakesBackgroundEvents) {
+  EXPECT_EQ(getEventPosition(CHRE_EVENT_SENSOR_ACCELEROMETER_DATA, 16,
+                             std::chrono::milliseconds(0)),
+            0);
+}
+
+TEST_F(EventLoopPriorityTest, AgedBackgroundEventIsNotStarved) {
+  // Longer than the maximum delay of background events
+  EXPECT_EQ(getEventPosition(CHRE_EVENT_SENSOR_ACCELEROMETER_DATA, 1,
+                             std::chrono::milliseconds(100)),
+            1);
+}
+
+TEST_F(EventLoopPriorityTest, SystemEventDoesNotOvertakeSameSubsystem) {
+  // The async result is in a higher class than the scan results, but comes
+  // from the same subsystem
+  EXPECT_EQ(getEventPosition(CHRE_EVENT_WIFI_ASYNC_RESULT, 16,
+                             std::chrono::milliseconds(0)),
+            16);
+}
+
+TEST_F(TestBase, EventLoopKeepsNanoappEventsInOrderAcrossClasses) {
+  CREATE_CHRE_TEST_EVENT(SEND, 0);
+  CREATE_CHRE_TEST_EVENT(RECEIVED_IN_ORDER, 1);
+  constexpr uint16_t kBackgroundEventType =
+      CHRE_SPECIFIC_SIMULATION_TEST_EVENT_ID(0x805);
+
+  struct SenderApp : public TestNanoapp {
+    uint64_t id = 0x0de5;
+
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static bool backgroundEventReceived = false;
+      switch (eventType) {
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == SEND) {
+            // Both are scheduled together, the second one in a higher class
+            chreSendEvent(kBackgroundEventType, nullptr /* eventData */,
+                          nullptr /* freeCallback */, chreGetInstanceId());
+            chreSendEvent(CHRE_EVENT_SENSOR_ACCELEROMETER_DATA,
+                          nullptr /* eventData */, nullptr /* freeCallback */,
+                          chreGetInstanceId());
+          }
+          break;
+        }
+        case kBackgroundEventType:
+          backgroundEventReceived = true;
+          break;
+        case CHRE_EVENT_SENSOR_ACCELEROMETER_DATA:
+          TestEventQueueSingleton::get()->pushEvent(RECEIVED_IN_ORDER,
+                                                    backgroundEventReceived);
+          break;
+      }
+    };
+  };
+
+  auto app = loadNanoapp<SenderApp>();
+  sendEventToNanoapp(app, SEND);
+  bool inOrder;
+  waitForEvent(RECEIVED_IN_ORDER, &inOrder);
+  EXPECT_TRUE(inOrder);
+}
+
+/**
+ * Measures the cost of dispatching a broadcast event that has a single
+ * subscriber, as the number of loaded nanoapps grows. The subscribed nanoapp
+ * re-broadcasts the event to itself upon each receipt, so the event queue
+ * depth stays at 1 and the measurement is dominated by the per-event dispatch
+ * path of the EventLoop.
+ */
+class EventLoopBroadcastBenchmark : public TestBase {
+ protected:
+  //! The number of broadcast events dispatched per measurement.
+  static constexpr uint32_t kNumEvents = 1000;
+
+  //! The app ID of the first unsubscribed nanoapp.
+  static constexpr uint64_t kIdleAppIdBase = 0x1000;
+
+  /**
+   * Loads numNanoapps nanoapps, only the last of which is subscribed to the
+   * broadcast event, and logs the average time to dispatch an event.
+   */
+  void measureDispatchCost(size_t numNanoapps) {
+    CREATE_CHRE_TEST_EVENT(START, 0);
+    CREATE_CHRE_TEST_EVENT(DONE, 1);
+
+    struct BroadcastApp : public TestNanoapp {
+      uint64_t id = 0xbeef;
+
+      decltype(nanoappHandleEvent) *handleEvent = [](uint32_t,
+                                                     uint16_t eventType,
+                                                     const void *eventData) {
+        static uint32_t remaining = 0;
+        static Nanoseconds startTime;
+        switch (eventType) {
+          case kBroadcastEventType: {
+            if (--remaining > 0) {
+              chreSendEvent(kBroadcastEventType, nullptr /* eventData */,
+                            nullptr /* freeCallback */, kBroadcastInstanceId);
+            } else {
+              uint64_t elapsedNs =
+                  (SystemTime::getMonotonicTime() - startTime)
+                      .toRawNanoseconds();
+              TestEventQueueSingleton::get()->pushEvent(DONE, elapsedNs);
+            }
+            break;
+          }
+          case CHRE_EVENT_TEST_EVENT: {
+            auto event = static_cast<const TestEvent *>(eventData);
+            if (event->type == START) {
+              registerCurrentNanoappForBroadcast(kBroadcastEventType);
+              remaining = *static_cast<const uint32_t *>(event->data);
+              startTime = SystemTime::getMonotonicTime();
+              chreSendEvent(kBroadcastEventType, nullptr /* eventData */,
+                            nullptr /* freeCallback */, kBroadcastInstanceId);
+            }
+          }
+        }
+      };
+    };
+
+    for (size_t i = 0; i + 1 < numNanoapps; i++) {
+      loadNanoapp("Idle", kIdleAppIdBase + i, 0 /* appVersion */,
+                  NanoappPermissions::CHRE_PERMS_NONE, defaultNanoappStart,
+                  defaultNanoappHandleEvent, defaultNanoappEnd);
+    }
+    auto app = loadNanoapp<BroadcastApp>();
+
+    uint64_t elapsedNs;
+    sendEventToNanoapp(app, START, kNumEvents);
+    waitForEvent(DONE, &elapsedNs);
+    LOGI("Broadcast dispatch with %zu nanoapps: %" PRIu64 " ns/event",
+         numNanoapps, elapsedNs / kNumEvents);
+
+    unloadNanoapp(app);
+    for (size_t i = 0; i + 1 < numNanoapps; i++) {
+      unloadNanoapp<uint64_t>(kIdleAppIdBase + i);
+    }
+  }
+
+  uint64_t getTimeoutNs() const override {
+    return 30 * kOneSecondInNanoseconds;
+  }
+};
+
+TEST_F(EventLoopBroadcastBenchmark, DISABLED_DispatchCostVersusNanoappCount) {
+  for (size_t numNanoapps : {1, 8, 32}) {
+    measureDispatchCost(numNanoapps);
+  }
+}
+
+/**
+ * Measures event loop throughput for various batch sizes. The nanoapp sends
+ * itself bursts of unicast events, sending the next burst once the previous one
+ * has been fully received, so the inbound queue always holds enough events for
+ * run() to fill its batches.
+ */
+class EventLoopBatchBenchmark : public TestBase {
+ protected:
+  //! The number of events dispatched per measurement.
+  static constexpr uint32_t kNumEvents = 20000;
+
+  //! The number of events the nanoapp sends to itself at once. Must be less
+  //! than the event pool capacity.
+  static constexpr uint32_t kBurstSize = 64;
+
+  //! The event type of the events sent in bursts.
+  static constexpr uint16_t kBurstEventType =
+      CHRE_SPECIFIC_SIMULATION_TEST_EVENT_ID(0x801);
+
+  //! Configures a measurement, sent to the nanoapp in the START event.
+  struct BenchmarkConfig {
+    uint32_t batchSize;
+    uint32_t numEvents;
+  };
+
+  /**
+   * Dispatches kNumEvents events with the given event loop batch size, and
+   * logs the resulting throughput.
+   */
+  void measureThroughput(uint32_t batchSize) {
+    CREATE_CHRE_TEST_EVENT(START, 0);
+    CREATE_CHRE_TEST_EVENT(DONE, 1);
+
+    struct BurstApp : public TestNanoapp {
+      uint64_t id = 0xba7c;
+
+      decltype(nanoappHandleEvent) *handleEvent = [](uint32_t,
+                                                     uint16_t eventType,
+                                                     const void *eventData) {
+        static uint32_t remaining = 0;
+        static uint32_t pendingInBurst = 0;
+        static Nanoseconds startTime;
+
+        auto sendBurst = []() {
+          pendingInBurst = (remaining < kBurstSize) ? remaining : kBurstSize;
+          for (uint32_t i = 0; i < pendingInBurst; i++) {
+            chreSendEvent(kBurstEventType, nullptr /* eventData */,
+                          nullptr /* freeCallback */, chreGetInstanceId());
+          }
+        };
+
+        switch (eventType) {
+          case kBurstEventType: {
+            remaining--;
+            if (--pendingInBurst == 0) {
+              if (remaining > 0) {
+                sendBurst();
+              } else {
+                uint64_t elapsedNs =
+                    (SystemTime::getMonotonicTime() - startTime)
+                        .toRawNanoseconds();
+                TestEventQueueSingleton::get()->pushEvent(DONE, elapsedNs);
+              }
+            }
+            break;
+          }
+          case CHRE_EVENT_TEST_EVENT: {
+            auto event = static_cast<const TestEvent *>(eventData);
+            if (event->type == START) {
+              auto config = static_cast<const BenchmarkConfig *>(event->data);
+              EventLoopManagerSingleton::get()
+                  ->getEventLoop()
+                  .setEventBatchSize(config->batchSize);
+              remaining = config->numEvents;
+              startTime = SystemTime::getMonotonicTime();
+              sendBurst();
+            }
+          }
+        }
+      };
+    };
+
+    auto app = loadNanoapp<BurstApp>();
+
+    uint64_t elapsedNs;
+    BenchmarkConfig config = {
+        .batchSize = batchSize,
+        .numEvents = kNumEvents,
+    };
+    sendEventToNanoapp(app, START, config);
+    waitForEvent(DONE, &elapsedNs);
+    LOGI("Event loop batch size %" PRIu32 ": %" PRIu64 " events/sec", batchSize,
+         kNumEvents * kOneSecondInNanoseconds / elapsedNs);
+
+    unloadNanoapp(app);
+  }
+
+  uint64_t getTimeoutNs() const override {
+    return 30 * kOneSecondInNanoseconds;
+  }
+};
+
+TEST_F(EventLoopBatchBenchmark, DISABLED_ThroughputVersusBatchSize) {
+  for (uint32_t batchSize : {1, 8, 32}) {
+    measureThroughput(batchSize);
+  }
+}
+
+#ifdef CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+/**
+ * Runs worker event loops alongside the main one, each on its own thread.
+ */
+class MultiEventLoopTest : public TestBase {
+ protected:
+  void TearDown() override {
+    // Stop the worker event loops first, so they don't forward events to a
+    // stopped main event loop
+    for (size_t i = 0; i < mWorkerThreads.size(); i++) {
+      EventLoopManagerSingleton::get()->getEventLoop(i + 1).stop();
+      mWorkerThreads[i].join();
+    }
+    TestBase::TearDown();
+  }
+
+  void addEventLoops(size_t count) {
+    for (size_t i = 0; i < count; i++) {
+      size_t index = EventLoopManagerSingleton::get()->addEventLoop();
+      ASSERT_NE(index, 0);
+      mWorkerThreads.emplace_back([index]() {
+        EventLoopManagerSingleton::get()->getEventLoop(index).run();
+      });
+    }
+  }
+
+  /**
+   * Loads a nanoapp onto the given event loop, and waits for it to be started
+   * there, as the main event loop hands it over asynchronously.
+   */
+  void loadNanoappOnEventLoop(size_t index, const char *name, uint64_t appId,
+                              decltype(nanoappStart) *startFunc,
+                              decltype(nanoappHandleEvent) *handleEventFunc) {
+    EventLoopManager *eventLoopManager = EventLoopManagerSingleton::get();
+    ASSERT_TRUE(eventLoopManager->setEventLoopAffinity(appId, index));
+    loadNanoapp(name, appId, 0 /* appVersion */,
+                NanoappPermissions::CHRE_PERMS_NONE, startFunc,
+                handleEventFunc, defaultNanoappEnd);
+
+    uint16_t instanceId;
+    while (!eventLoopManager->findNanoappInstanceIdByAppId(appId,
+                                                           &instanceId)) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(eventLoopManager->findEventLoopByInstanceId(instanceId),
+              &eventLoopManager->getEventLoop(index));
+  }
+
+  //! @return true if called from the event loop the current nanoapp is
+  //!         assigned to.
+  static bool inAssignedEventLoop() {
+    return EventLoop::getCurrentThreadEventLoop() ==
+           &EventLoopManagerSingleton::get()->getEventLoopForAppId(
+               chreGetAppId());
+  }
+
+  std::vector<std::thread> mWorkerThreads;
+};
+
+TEST_F(MultiEventLoopTest, EventsReachNanoappsOnAllEventLoops) {
+  CREATE_CHRE_TEST_EVENT(RECEIVED, 0);
+  CREATE_CHRE_TEST_EVENT(FREED, 1);
+  CREATE_CHRE_TEST_EVENT(SEND, 2);
+  constexpr uint64_t kMainAppId = 0x3a1;
+  constexpr uint64_t kWorkerAppId = 0x3a2;
+  constexpr uint16_t kUnicastEventType =
+      CHRE_SPECIFIC_SIMULATION_TEST_EVENT_ID(0x803);
+
+  struct WorkerApp : public TestNanoapp {
+    uint64_t id = kWorkerAppId;
+  };
+
+  auto start = []() {
+    registerCurrentNanoappForBroadcast(kBroadcastEventType);
+    return true;
+  };
+  auto handleEvent = [](uint32_t, uint16_t eventType, const void *eventData) {
+    switch (eventType) {
+      case kBroadcastEventType:
+      case kUnicastEventType: {
+        TestEventQueueSingleton::get()->pushEvent(RECEIVED,
+                                                  inAssignedEventLoop());
+        break;
+      }
+      case CHRE_EVENT_TEST_EVENT: {
+        auto event = static_cast<const TestEvent *>(eventData);
+        if (event->type == SEND) {
+          auto freeCallback = [](uint16_t, void *) {
+            TestEventQueueSingleton::get()->pushEvent(FREED,
+                                                      inAssignedEventLoop());
+          };
+          chreSendEvent(kUnicastEventType, nullptr /* eventData */,
+                        freeCallback,
+                        *static_cast<const uint16_t *>(event->data));
+        }
+      }
+    }
+  };
+
+  addEventLoops(1);
+  loadNanoappOnEventLoop(0, "Main", kMainAppId, start, handleEvent);
+  loadNanoappOnEventLoop(1, "Worker", kWorkerAppId, start, handleEvent);
+
+  // A broadcast is only freed on the event loop it was posted to, once the
+  // nanoapps on every event loop have handled it
+  auto freeCallback = [](uint16_t, void *) {
+    TestEventQueueSingleton::get()->pushEvent(
+        FREED, EventLoop::getCurrentThreadEventLoop() ==
+                   &EventLoopManagerSingleton::get()->getEventLoop(0));
+  };
+  EventLoopManagerSingleton::get()->getEventLoop().postEventOrDie(
+      kBroadcastEventType, nullptr /* eventData */, freeCallback);
+  bool inExpectedEventLoop;
+  for (int i = 0; i < 2; i++) {
+    waitForEvent(RECEIVED, &inExpectedEventLoop);
+    EXPECT_TRUE(inExpectedEventLoop);
+  }
+  waitForEvent(FREED, &inExpectedEventLoop);
+  EXPECT_TRUE(inExpectedEventLoop);
+
+  // A unicast from the worker event loop is handled on the main one, and
+  // freed back on the worker event loop
+  uint16_t mainInstanceId;
+  ASSERT_TRUE(EventLoopManagerSingleton::get()->findNanoappInstanceIdByAppId(
+      kMainAppId, &mainInstanceId));
+  sendEventToNanoapp(WorkerApp(), SEND, mainInstanceId);
+  waitForEvent(RECEIVED, &inExpectedEventLoop);
+  EXPECT_TRUE(inExpectedEventLoop);
+  waitForEvent(FREED, &inExpectedEventLoop);
+  EXPECT_TRUE(inExpectedEventLoop);
+}
+
+/**
+ * Measures the aggregate event throughput of nanoapps that each keep their
+ * own event loop busy, as the number of event loops they are spread across
+ * grows. Each nanoapp sends itself events one at a time, doing a fixed amount
+ * of work per event.
+ */
+class MultiEventLoopBenchmark : public MultiEventLoopTest {
+ protected:
+  //! The number of events dispatched per nanoapp and measurement.
+  static constexpr uint32_t kNumEvents = 2000;
+
+  //! The number of iterations of busy work done for each event.
+  static constexpr uint32_t kWorkPerEvent = 2000;
+
+  static constexpr uint16_t kWorkEventType =
+      CHRE_SPECIFIC_SIMULATION_TEST_EVENT_ID(0x804);
+
+  void measureThroughput(size_t numEventLoops, uint64_t appIdBase) {
+    CREATE_CHRE_TEST_EVENT(START, 0);
+    CREATE_CHRE_TEST_EVENT(DONE, 1);
+
+    struct WorkApp : public TestNanoapp {
+      uint64_t id;
+    };
+
+    // Each nanoapp runs on its own thread, so the state is kept per thread
+    auto handleEvent = [](uint32_t, uint16_t eventType, const void *eventData) {
+      thread_local uint32_t remaining = 0;
+      switch (eventType) {
+        case kWorkEventType: {
+          volatile uint32_t work = 0;
+          for (uint32_t i = 0; i < kWorkPerEvent; i++) {
+            work = work + i;
+          }
+          if (--remaining > 0) {
+            chreSendEvent(kWorkEventType, nullptr /* eventData */,
+                          nullptr /* freeCallback */, chreGetInstanceId());
+          } else {
+            TestEventQueueSingleton::get()->pushEvent(DONE);
+          }
+          break;
+        }
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == START) {
+            remaining = *static_cast<const uint32_t *>(event->data);
+            chreSendEvent(kWorkEventType, nullptr /* eventData */,
+                          nullptr /* freeCallback */, chreGetInstanceId());
+          }
+        }
+      }
+    };
+
+    WorkApp apps[CHRE_MAX_WORKER_EVENT_LOOPS + 1];
+    for (size_t i = 0; i < numEventLoops; i++) {
+      apps[i].id = appIdBase + i;
+      loadNanoappOnEventLoop(i, "Work", apps[i].id, defaultNanoappStart,
+                             handleEvent);
+    }
+
+    Nanoseconds startTime = SystemTime::getMonotonicTime();
+    for (size_t i = 0; i < numEventLoops; i++) {
+      sendEventToNanoapp(apps[i], START, kNumEvents);
+    }
+    for (size_t i = 0; i < numEventLoops; i++) {
+      waitForEvent(DONE);
+    }
+    uint64_t elapsedNs =
+        (SystemTime::getMonotonicTime() - startTime).toRawNanoseconds();
+    LOGI("%zu event loops: %" PRIu64 " events/sec", numEventLoops,
+         numEventLoops * kNumEvents * kOneSecondInNanoseconds / elapsedNs);
+  }
+
+  uint64_t getTimeoutNs() const override {
+    return 60 * kOneSecondInNanoseconds;
+  }
+};
+
+TEST_F(MultiEventLoopBenchmark, DISABLED_ThroughputVersusEventLoopCount) {
+  addEventLoops(3);
+  uint64_t appIdBase = 0x4000;
+  for (size_t numEventLoops : {1, 2, 4}) {
+    measureThroughput(numEventLoops, appIdBase);
+    appIdBase += numEventLoops;
+  }
+}
+#endif  // CHRE_MULTI_EVENT_LOOP_SUPPORT_ENABLED
+
+}  // namespace
+}  // namespace chre
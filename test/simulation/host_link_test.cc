@@ -0,0 +1,357 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "test_base.h"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "chre/core/event_loop_manager.h"
+#include "chre/platform/shared/generated/host_messages_generated.h"
+#include "chre/util/nanoapp/host_message_queue.h"
+#include "chre_api/chre/event.h"
+#include "chre_api/chre/re.h"
+#include "test_event.h"
+#include "test_event_queue.h"
+#include "test_util.h"
+
+namespace chre {
+namespace {
+
+constexpr uint16_t kHostEndpointId = 0x8001;
+constexpr uint32_t kMessageType = 1234;
+
+/**
+ * Replies to every message from the host with a copy of it, so that the host
+ * side of the socket sees a full round trip through CHRE.
+ */
+struct EchoApp : public TestNanoapp {
+  decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                 const void *eventData) {
+    if (eventType == CHRE_EVENT_MESSAGE_FROM_HOST) {
+      auto *message = static_cast<const chreMessageFromHostData *>(eventData);
+      void *reply = chreHeapAlloc(message->messageSize);
+      if (reply != nullptr) {
+        memcpy(reply, message->message, message->messageSize);
+        chreSendMessageToHostEndpoint(
+            reply, message->messageSize, message->messageType,
+            message->hostEndpoint,
+            [](void *data, size_t /* size */) { chreHeapFree(data); });
+      }
+    }
+  };
+};
+
+class HostLinkTest : public TestBase {
+ protected:
+  void SetUp() override {
+    TestBase::SetUp();
+    mSocketPath = testing::TempDir() + "chre_host_link_test.sock";
+    ASSERT_TRUE(getHostCommsManager().startSocketServer(mSocketPath.c_str()));
+
+    mClientFd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    ASSERT_GE(mClientFd, 0);
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, mSocketPath.c_str(), sizeof(addr.sun_path) - 1);
+    ASSERT_EQ(connect(mClientFd, reinterpret_cast<struct sockaddr *>(&addr),
+                      sizeof(addr)),
+              0);
+
+    // Fail rather than hang if CHRE never replies.
+    struct timeval timeout = {.tv_sec = 2, .tv_usec = 0};
+    setsockopt(mClientFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  }
+
+  void TearDown() override {
+    if (mClientFd >= 0) {
+      close(mClientFd);
+    }
+    getHostCommsManager().stopSocketServer();
+    unlink(mSocketPath.c_str());
+    TestBase::TearDown();
+  }
+
+  uint64_t getTimeoutNs() const override {
+    return 30 * kOneSecondInNanoseconds;
+  }
+
+  static HostCommsManager &getHostCommsManager() {
+    return EventLoopManagerSingleton::get()->getHostCommsManager();
+  }
+
+  void sendNanoappMessage(uint64_t appId, const std::vector<uint8_t> &payload) {
+    flatbuffers::FlatBufferBuilder builder(payload.size() + 128);
+    auto message = fbs::CreateNanoappMessage(
+        builder, appId, kMessageType, kHostEndpointId,
+        builder.CreateVector(payload));
+    fbs::HostAddress hostAddr(0);
+    builder.Finish(fbs::CreateMessageContainer(
+        builder, fbs::ChreMessage::NanoappMessage, message.Union(),
+        &hostAddr));
+    ASSERT_EQ(send(mClientFd, builder.GetBufferPointer(), builder.GetSize(), 0),
+              static_cast<ssize_t>(builder.GetSize()));
+  }
+
+  void sendHubInfoRequest() {
+    flatbuffers::FlatBufferBuilder builder(64);
+    auto request = fbs::CreateHubInfoRequest(builder);
+    fbs::HostAddress hostAddr(0);
+    builder.Finish(fbs::CreateMessageContainer(
+        builder, fbs::ChreMessage::HubInfoRequest, request.Union(),
+        &hostAddr));
+    ASSERT_EQ(send(mClientFd, builder.GetBufferPointer(), builder.GetSize(), 0),
+              static_cast<ssize_t>(builder.GetSize()));
+  }
+
+  //! @return The next message container received, or nullptr on timeout.
+  const fbs::MessageContainer *receive() {
+    mRecvBuffer.resize(64 * 1024);
+    ssize_t len = recv(mClientFd, mRecvBuffer.data(), mRecvBuffer.size(), 0);
+    if (len <= 0) {
+      return nullptr;
+    }
+    flatbuffers::Verifier verifier(mRecvBuffer.data(),
+                                   static_cast<size_t>(len));
+    return fbs::VerifyMessageContainerBuffer(verifier)
+               ? fbs::GetMessageContainer(mRecvBuffer.data())
+               : nullptr;
+  }
+
+  //! @return The payload of the next nanoapp message received.
+  std::vector<uint8_t> receiveNanoappMessage() {
+    const fbs::MessageContainer *container = receive();
+    if (container == nullptr ||
+        container->message_type() != fbs::ChreMessage::NanoappMessage) {
+      return {};
+    }
+    auto *message = static_cast<const fbs::NanoappMessage *>(
+        container->message());
+    EXPECT_EQ(message->message_type(), kMessageType);
+    EXPECT_EQ(message->host_endpoint(), kHostEndpointId);
+    return std::vector<uint8_t>(message->message()->begin(),
+                                message->message()->end());
+  }
+
+  std::string mSocketPath;
+  int mClientFd = -1;
+  std::vector<uint8_t> mRecvBuffer;
+};
+
+TEST_F(HostLinkTest, HubInfoRequestIsAnswered) {
+  sendHubInfoRequest();
+  const fbs::MessageContainer *container = receive();
+  ASSERT_NE(container, nullptr);
+  ASSERT_EQ(container->message_type(), fbs::ChreMessage::HubInfoResponse);
+  auto *response =
+      static_cast<const fbs::HubInfoResponse *>(container->message());
+  EXPECT_EQ(response->max_msg_len(),
+            static_cast<uint32_t>(CHRE_MESSAGE_TO_HOST_MAX_SIZE));
+  // The response is addressed to the client ID assigned on connection.
+  EXPECT_NE(container->host_addr()->client_id(), 0);
+}
+
+TEST_F(HostLinkTest, NanoappMessageRoundTrip) {
+  EchoApp app = loadNanoapp<EchoApp>();
+
+  std::vector<uint8_t> payload = {1, 2, 3, 4, 5};
+  sendNanoappMessage(app.id, payload);
+  EXPECT_EQ(receiveNanoappMessage(), payload);
+}
+
+/**
+ * Measures message throughput and round-trip latency between a host client and
+ * a nanoapp over the socket for a range of payload sizes.
+ */
+TEST_F(HostLinkTest, DISABLED_RoundTripBenchmark) {
+  constexpr size_t kNumRoundTrips = 500;
+  EchoApp app = loadNanoapp<EchoApp>();
+
+  for (size_t payloadSize : {16, 256, 2048}) {
+    std::vector<uint8_t> payload(payloadSize);
+    for (size_t i = 0; i < payloadSize; i++) {
+      payload[i] = static_cast<uint8_t>(i);
+    }
+
+    std::vector<uint64_t> latenciesNs;
+    latenciesNs.reserve(kNumRoundTrips);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kNumRoundTrips; i++) {
+      auto sendTime = std::chrono::steady_clock::now();
+      sendNanoappMessage(app.id, payload);
+      ASSERT_EQ(receiveNanoappMessage(), payload);
+      latenciesNs.push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - sendTime)
+              .count());
+    }
+    uint64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+
+    std::sort(latenciesNs.begin(), latenciesNs.end());
+    printf("Host link, %zu byte payloads: %" PRIu64
+           " msgs/s, RTT p50 %" PRIu64 " us, p99 %" PRIu64 " us\n",
+           payloadSize,
+           static_cast<uint64_t>(kNumRoundTrips * kOneSecondInNanoseconds /
+                                 std::max<uint64_t>(elapsedNs, 1)),
+           latenciesNs[kNumRoundTrips / 2] / 1000,
+           latenciesNs[kNumRoundTrips * 99 / 100] / 1000);
+  }
+}
+
+TEST_F(TestBase, HostMessageQuotaAndBackpressure) {
+  CREATE_CHRE_TEST_EVENT(SEND_BURST, 0);
+  CREATE_CHRE_TEST_EVENT(QUEUE_NEARLY_FULL, 1);
+  CREATE_CHRE_TEST_EVENT(QUEUE_DRAINED, 2);
+
+  // More than the whole message pool, so some sends must be rejected.
+  constexpr uint32_t kBurstSize = 160;
+
+  struct App : public TestNanoapp {
+    decltype(nanoappStart) *start = []() {
+      platform_chreConfigureHostMessageQueueEvents(true);
+      return true;
+    };
+
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static uint8_t payload[4];
+      switch (eventType) {
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == SEND_BURST) {
+            // Messages with a free callback stay outstanding until this
+            // handler returns, so they all count against the quota.
+            uint32_t numAccepted = 0;
+            for (uint32_t i = 0; i < kBurstSize; i++) {
+              if (chreSendMessageToHostEndpoint(
+                      payload, sizeof(payload), 1 /* messageType */,
+                      CHRE_HOST_ENDPOINT_BROADCAST,
+                      [](void *, size_t) {})) {
+                numAccepted++;
+              }
+            }
+            TestEventQueueSingleton::get()->pushEvent(SEND_BURST, numAccepted);
+          }
+          break;
+        }
+        case CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL:
+          TestEventQueueSingleton::get()->pushEvent(QUEUE_NEARLY_FULL);
+          break;
+        case CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED:
+          TestEventQueueSingleton::get()->pushEvent(QUEUE_DRAINED);
+          break;
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+
+  for (int round = 0; round < 2; round++) {
+    uint32_t numAccepted;
+    sendEventToNanoapp(app, SEND_BURST);
+    waitForEvent(SEND_BURST, &numAccepted);
+    EXPECT_GT(numAccepted, 0u);
+    EXPECT_LT(numAccepted, kBurstSize);
+
+    // The quota is released once the messages are freed, so the second round
+    // behaves the same as the first.
+    waitForEvent(QUEUE_NEARLY_FULL);
+    waitForEvent(QUEUE_DRAINED);
+  }
+}
+
+TEST_F(TestBase, HostMessageQueueEventsAreOptIn) {
+  CREATE_CHRE_TEST_EVENT(SEND_BURST, 0);
+  CREATE_CHRE_TEST_EVENT(ENABLE_QUEUE_EVENTS, 1);
+  CREATE_CHRE_TEST_EVENT(QUEUE_DRAINED, 2);
+  CREATE_CHRE_TEST_EVENT(GET_NUM_QUEUE_EVENTS, 3);
+
+  constexpr uint32_t kBurstSize = 160;
+  static uint32_t numQueueEvents;
+  numQueueEvents = 0;
+
+  struct App : public TestNanoapp {
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static uint8_t payload[4];
+      switch (eventType) {
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          switch (event->type) {
+            case SEND_BURST:
+              for (uint32_t i = 0; i < kBurstSize; i++) {
+                chreSendMessageToHostEndpoint(
+                    payload, sizeof(payload), 1 /* messageType */,
+                    CHRE_HOST_ENDPOINT_BROADCAST, [](void *, size_t) {});
+              }
+              TestEventQueueSingleton::get()->pushEvent(SEND_BURST);
+              break;
+            case ENABLE_QUEUE_EVENTS:
+              platform_chreConfigureHostMessageQueueEvents(true);
+              TestEventQueueSingleton::get()->pushEvent(ENABLE_QUEUE_EVENTS);
+              break;
+            case GET_NUM_QUEUE_EVENTS:
+              TestEventQueueSingleton::get()->pushEvent(GET_NUM_QUEUE_EVENTS,
+                                                        numQueueEvents);
+              break;
+          }
+          break;
+        }
+        case CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL:
+          numQueueEvents++;
+          break;
+        case CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED:
+          numQueueEvents++;
+          TestEventQueueSingleton::get()->pushEvent(QUEUE_DRAINED);
+          break;
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+
+  // Without opting in, filling the queue isn't reported.
+  sendEventToNanoapp(app, SEND_BURST);
+  waitForEvent(SEND_BURST);
+
+  sendEventToNanoapp(app, ENABLE_QUEUE_EVENTS);
+  waitForEvent(ENABLE_QUEUE_EVENTS);
+  sendEventToNanoapp(app, SEND_BURST);
+  waitForEvent(SEND_BURST);
+  waitForEvent(QUEUE_DRAINED);
+
+  // Only the NEARLY_FULL and DRAINED events of the second burst were sent.
+  uint32_t numEvents;
+  sendEventToNanoapp(app, GET_NUM_QUEUE_EVENTS);
+  waitForEvent(GET_NUM_QUEUE_EVENTS, &numEvents);
+  EXPECT_EQ(numEvents, 2u);
+}
+
+}  // namespace
+}  // namespace chre
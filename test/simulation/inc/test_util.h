@@ -183,9 +183,8 @@ template <class Nanoapp>
 void sendEventToNanoapp(const Nanoapp &app, uint16_t eventType) {
   static_assert(std::is_base_of<TestNanoapp, Nanoapp>::value);
   uint16_t instanceId;
-  if (EventLoopManagerSingleton::get()
-          ->getEventLoop()
-          .findNanoappInstanceIdByAppId(app.id, &instanceId)) {
+  if (EventLoopManagerSingleton::get()->findNanoappInstanceIdByAppId(
+          app.id, &instanceId)) {
     auto event = memoryAlloc<TestEvent>();
     ASSERT_NE(event, nullptr);
     event->type = eventType;
@@ -218,9 +217,8 @@ void sendEventToNanoapp(const Nanoapp &app, uint16_t eventType,
   static_assert(std::is_base_of<TestNanoapp, Nanoapp>::value);
   static_assert(std::is_trivial<T>::value);
   uint16_t instanceId;
-  if (EventLoopManagerSingleton::get()
-          ->getEventLoop()
-          .findNanoappInstanceIdByAppId(app.id, &instanceId)) {
+  if (EventLoopManagerSingleton::get()->findNanoappInstanceIdByAppId(
+          app.id, &instanceId)) {
     auto event = memoryAlloc<TestEvent>();
     ASSERT_NE(event, nullptr);
     event->type = eventType;
@@ -16,11 +16,13 @@
 
 #include "chre_api/chre/re.h"
 
+#include <cinttypes>
 #include <cstdint>
 
 #include "chre/core/event_loop_manager.h"
 #include "chre/platform/log.h"
 #include "chre/platform/memory_manager.h"
+#include "chre/platform/system_time.h"
 #include "chre_api/chre/event.h"
 
 #include "gtest/gtest.h"
@@ -260,5 +262,62 @@ TEST_F(TestBase, MemoryStressTestShouldNotTriggerErrors) {
   EXPECT_EQ(memManager.getAllocationCount(), 0);
 }
 
+/**
+ * Measures chreHeapAlloc/chreHeapFree throughput while the nanoapp holds 1k
+ * live blocks. Blocks are freed oldest first, which is the worst case for a
+ * list that has to be searched from its most recently allocated block.
+ */
+TEST_F(TestBase, DISABLED_MemoryAllocFreeThroughputWithLiveBlocks) {
+  CREATE_CHRE_TEST_EVENT(RUN, 0);
+
+  static constexpr size_t kNumLiveBlocks = 1000;
+  static constexpr uint32_t kNumIterations = 100000;
+  static constexpr uint32_t kBlockSize = 16;
+
+  struct App : public TestNanoapp {
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static void *blocks[kNumLiveBlocks];
+
+      if (eventType == CHRE_EVENT_TEST_EVENT &&
+          static_cast<const TestEvent *>(eventData)->type == RUN) {
+        for (void *&block : blocks) {
+          block = chreHeapAlloc(kBlockSize);
+        }
+
+        bool success = true;
+        Nanoseconds startTime = SystemTime::getMonotonicTime();
+        for (uint32_t i = 0; i < kNumIterations; i++) {
+          void *&block = blocks[i % kNumLiveBlocks];
+          chreHeapFree(block);
+          block = chreHeapAlloc(kBlockSize);
+          success &= (block != nullptr);
+        }
+        uint64_t elapsedNs =
+            (SystemTime::getMonotonicTime() - startTime).toRawNanoseconds();
+
+        for (void *block : blocks) {
+          chreHeapFree(block);
+        }
+        TestEventQueueSingleton::get()->pushEvent(RUN,
+                                                  success ? elapsedNs : 0);
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+  MemoryManager &memManager =
+      EventLoopManagerSingleton::get()->getMemoryManager();
+
+  uint64_t elapsedNs;
+  sendEventToNanoapp(app, RUN);
+  waitForEvent(RUN, &elapsedNs);
+  ASSERT_GT(elapsedNs, 0);
+  EXPECT_EQ(memManager.getTotalAllocatedBytes(), 0);
+  EXPECT_EQ(memManager.getAllocationCount(), 0);
+  LOGI("Heap alloc/free with %zu live blocks: %" PRIu64 " pairs/sec",
+       kNumLiveBlocks, kNumIterations * kOneSecondInNanoseconds / elapsedNs);
+}
+
 }  // namespace
 }  // namespace chre
\ No newline at end of file
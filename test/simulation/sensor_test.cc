@@ -16,7 +16,10 @@
 
 #include "chre_api/chre/sensor.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <thread>
 
 #include "chre/core/event_loop_manager.h"
 #include "chre/core/settings.h"
@@ -159,5 +162,173 @@ TEST_F(TestBase, SensorUnsubscribeToDataEventsOnUnload) {
   EXPECT_FALSE(chrePalSensorIsSensor0Enabled());
 }
 
+TEST_F(TestBase, OnChangeSensorBatchPostsOneEvent) {
+  CREATE_CHRE_TEST_EVENT(CONFIGURE, 0);
+
+  struct Reading {
+    bool isNear;
+    bool lastEventRecorded;
+  };
+
+  struct App : public TestNanoapp {
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t,
+                                                   uint16_t eventType,
+                                                   const void *eventData) {
+      switch (eventType) {
+        case CHRE_EVENT_SENSOR_SAMPLING_CHANGE: {
+          TestEventQueueSingleton::get()->pushEvent(
+              CHRE_EVENT_SENSOR_SAMPLING_CHANGE);
+          break;
+        }
+
+        case CHRE_EVENT_SENSOR_PROXIMITY_DATA: {
+          auto *data = static_cast<const chreSensorByteData *>(eventData);
+          Sensor *sensor = EventLoopManagerSingleton::get()
+                               ->getSensorRequestManager()
+                               .getSensor(data->header.sensorHandle);
+          Reading reading = {
+              .isNear = data->readings[0].isNear != 0,
+              .lastEventRecorded =
+                  sensor != nullptr && sensor->getLastEvent() != nullptr};
+          TestEventQueueSingleton::get()->pushEvent(
+              CHRE_EVENT_SENSOR_PROXIMITY_DATA, reading);
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          switch (event->type) {
+            case CONFIGURE: {
+              const bool success = chreSensorConfigure(
+                  1 /* sensorHandle */, CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS,
+                  CHRE_SENSOR_INTERVAL_DEFAULT, CHRE_SENSOR_LATENCY_DEFAULT);
+              TestEventQueueSingleton::get()->pushEvent(CONFIGURE, success);
+              break;
+            }
+          }
+        }
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+  bool success;
+  sendEventToNanoapp(app, CONFIGURE);
+  waitForEvent(CONFIGURE, &success);
+  ASSERT_TRUE(success);
+  waitForEvent(CHRE_EVENT_SENSOR_SAMPLING_CHANGE);
+  EXPECT_TRUE(chrePalSensorIsSensor1Enabled());
+
+  // Each batch of an on-change sensor must only cost its data event, with the
+  // last event recorded by the time nanoapps see it.
+  constexpr uint32_t kNumBatches = 3;
+  EventLoop &eventLoop = EventLoopManagerSingleton::get()->getEventLoop();
+  for (uint32_t i = 0; i < kNumBatches; i++) {
+    uint32_t numEventsPosted = eventLoop.getNumEventsPosted();
+    chrePalSensorSendSensor1Event(i % 2 == 0 /* isNear */);
+    EXPECT_EQ(eventLoop.getNumEventsPosted() - numEventsPosted, 1);
+
+    Reading reading;
+    waitForEvent(CHRE_EVENT_SENSOR_PROXIMITY_DATA, &reading);
+    EXPECT_EQ(reading.isNear, i % 2 == 0);
+    EXPECT_TRUE(reading.lastEventRecorded);
+  }
+
+  unloadNanoapp(app);
+  EXPECT_FALSE(chrePalSensorIsSensor1Enabled());
+}
+
+#ifdef CHRE_SENSOR_EVENT_COALESCING_ENABLED
+TEST_F(TestBase, SensorDataBatchesAreMergedUnderBacklog) {
+  CREATE_CHRE_TEST_EVENT(CONFIGURE, 0);
+  CREATE_CHRE_TEST_EVENT(BLOCK, 1);
+  CREATE_CHRE_TEST_EVENT(BLOCKED, 2);
+  CREATE_CHRE_TEST_EVENT(GET_STATS, 3);
+
+  struct Stats {
+    uint32_t numEvents;
+    uint32_t numReadings;
+    uint16_t maxReadingCount;
+    bool timestampsInOrder;
+  };
+
+  static std::atomic<bool> released(false);
+
+  struct App : public TestNanoapp {
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t,
+                                                   uint16_t eventType,
+                                                   const void *eventData) {
+      static Stats stats = {0, 0, 0, true};
+      static uint64_t lastTimestamp = 0;
+      switch (eventType) {
+        case CHRE_EVENT_SENSOR_UNCALIBRATED_ACCELEROMETER_DATA: {
+          auto *data = static_cast<const chreSensorThreeAxisData *>(eventData);
+          stats.numEvents++;
+          stats.numReadings += data->header.readingCount;
+          if (data->header.readingCount > stats.maxReadingCount) {
+            stats.maxReadingCount = data->header.readingCount;
+          }
+          uint64_t timestamp = data->header.baseTimestamp;
+          for (uint16_t i = 0; i < data->header.readingCount; i++) {
+            timestamp += data->readings[i].timestampDelta;
+            stats.timestampsInOrder &= (timestamp >= lastTimestamp);
+            lastTimestamp = timestamp;
+          }
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          switch (event->type) {
+            case CONFIGURE: {
+              const bool success = chreSensorConfigure(
+                  0 /* sensorHandle */, CHRE_SENSOR_CONFIGURE_MODE_CONTINUOUS,
+                  kOneMillisecondInNanoseconds, 0 /* latency */);
+              TestEventQueueSingleton::get()->pushEvent(CONFIGURE, success);
+              break;
+            }
+            case BLOCK: {
+              TestEventQueueSingleton::get()->pushEvent(BLOCKED);
+              while (!released) {
+                std::this_thread::yield();
+              }
+              break;
+            }
+            case GET_STATS: {
+              TestEventQueueSingleton::get()->pushEvent(GET_STATS, stats);
+              break;
+            }
+          }
+        }
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+  bool success;
+  sendEventToNanoapp(app, CONFIGURE);
+  waitForEvent(CONFIGURE, &success);
+  ASSERT_TRUE(success);
+
+  // Let data batches pile up while the event loop is blocked
+  sendEventToNanoapp(app, BLOCK);
+  waitForEvent(BLOCKED);
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  released = true;
+
+  Stats stats;
+  sendEventToNanoapp(app, GET_STATS);
+  waitForEvent(GET_STATS, &stats);
+  EXPECT_GT(stats.maxReadingCount, 1);
+  EXPECT_LT(stats.numEvents, stats.numReadings);
+  EXPECT_TRUE(stats.timestampsInOrder);
+  EXPECT_GT(EventLoopManagerSingleton::get()
+                ->getSensorRequestManager()
+                .getSensor(0)
+                ->getNumCoalescedEvents(),
+            0);
+}
+#endif  // CHRE_SENSOR_EVENT_COALESCING_ENABLED
+
 }  // namespace
-}  // namespace chre
\ No newline at end of file
+}  // namespace chre
@@ -16,11 +16,14 @@
 
 #include "chre_api/chre/re.h"
 
+#include <cinttypes>
 #include <cstdint>
 
 #include "chre/core/event_loop_manager.h"
 #include "chre/core/settings.h"
 #include "chre/platform/log.h"
+#include "chre/platform/shared/timer_slack.h"
+#include "chre/platform/system_time.h"
 #include "chre/util/time.h"
 #include "chre_api/chre/event.h"
 
@@ -39,6 +42,19 @@ class TestTimer : public TestBase {
   bool hasNanoappTimers(TimerPool &pool, uint16_t instanceId) {
     return pool.hasNanoappTimers(instanceId);
   }
+
+  //! @return The next expiration of a periodic timer that expired at
+  //!     expirationMs and is handled at currentMs.
+  static uint64_t getNextPeriodicExpirationMs(uint64_t expirationMs,
+                                              uint64_t periodMs,
+                                              uint64_t currentMs) {
+    TimerPool::TimerRequest request = {};
+    request.expirationTime = Milliseconds(expirationMs);
+    request.duration = Milliseconds(periodMs);
+    Nanoseconds nextExpirationTime = TimerPool::getNextPeriodicExpirationTime(
+        request, Milliseconds(currentMs));
+    return Milliseconds(nextExpirationTime).getMilliseconds();
+  }
 };
 
 namespace {
@@ -175,5 +191,220 @@ TEST_F(TestTimer, CancelPeriodicTimerOnUnload) {
   EXPECT_FALSE(hasNanoappTimers(timerPool, instanceId));
 }
 
+TEST_F(TestTimer, StaleTimerHandleCannotCancelNewTimer) {
+  CREATE_CHRE_TEST_EVENT(SET_TIMER, 0);
+  CREATE_CHRE_TEST_EVENT(CANCEL_TIMER, 1);
+
+  struct App : public TestNanoapp {
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      if (eventType == CHRE_EVENT_TEST_EVENT) {
+        auto event = static_cast<const TestEvent *>(eventData);
+        switch (event->type) {
+          case SET_TIMER: {
+            uint32_t handle = chreTimerSet(kOneSecondInNanoseconds,
+                                           nullptr /*cookie*/, true /*oneShot*/);
+            TestEventQueueSingleton::get()->pushEvent(SET_TIMER, handle);
+            break;
+          }
+          case CANCEL_TIMER: {
+            auto handle = static_cast<const uint32_t *>(event->data);
+            bool success = chreTimerCancel(*handle);
+            TestEventQueueSingleton::get()->pushEvent(CANCEL_TIMER, success);
+            break;
+          }
+        }
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+
+  uint32_t firstHandle;
+  sendEventToNanoapp(app, SET_TIMER);
+  waitForEvent(SET_TIMER, &firstHandle);
+  ASSERT_NE(firstHandle, CHRE_TIMER_INVALID);
+
+  bool success;
+  sendEventToNanoapp(app, CANCEL_TIMER, firstHandle);
+  waitForEvent(CANCEL_TIMER, &success);
+  EXPECT_TRUE(success);
+
+  // The new timer may reuse the storage of the cancelled one, but must not be
+  // reachable through the old handle.
+  uint32_t secondHandle;
+  sendEventToNanoapp(app, SET_TIMER);
+  waitForEvent(SET_TIMER, &secondHandle);
+  ASSERT_NE(secondHandle, CHRE_TIMER_INVALID);
+  EXPECT_NE(secondHandle, firstHandle);
+
+  sendEventToNanoapp(app, CANCEL_TIMER, firstHandle);
+  waitForEvent(CANCEL_TIMER, &success);
+  EXPECT_FALSE(success);
+  sendEventToNanoapp(app, CANCEL_TIMER, secondHandle);
+  waitForEvent(CANCEL_TIMER, &success);
+  EXPECT_TRUE(success);
+}
+
+TEST_F(TestTimer, TimersWithinSlackFireInOneWakeup) {
+  CREATE_CHRE_TEST_EVENT(START_TIMERS, 0);
+  CREATE_CHRE_TEST_EVENT(TIMERS_FIRED, 1);
+
+  static constexpr uint32_t kNumTimers = 3;
+
+  struct App : public TestNanoapp {
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static uint64_t expirationTimes[kNumTimers];
+      static uint32_t numFired = 0;
+      static bool firedEarly = false;
+
+      switch (eventType) {
+        case CHRE_EVENT_TIMER: {
+          auto index = *static_cast<const uint32_t *>(eventData);
+          firedEarly |= (chreGetTime() < expirationTimes[index]);
+          if (++numFired == kNumTimers) {
+            TestEventQueueSingleton::get()->pushEvent(TIMERS_FIRED,
+                                                      firedEarly);
+          }
+          break;
+        }
+
+        case CHRE_EVENT_TEST_EVENT: {
+          auto event = static_cast<const TestEvent *>(eventData);
+          if (event->type == START_TIMERS) {
+            static const uint32_t kCookies[kNumTimers] = {0, 1, 2};
+            platform_chreTimerSetSlack(100 * kOneMillisecondInNanoseconds);
+            for (uint32_t i = 0; i < kNumTimers; i++) {
+              uint64_t duration = (i + 1) * 10 * kOneMillisecondInNanoseconds;
+              expirationTimes[i] = chreGetTime() + duration;
+              chreTimerSet(duration, &kCookies[i], true /*oneShot*/);
+            }
+          }
+        }
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+  TimerPool &timerPool =
+      EventLoopManagerSingleton::get()->getEventLoop().getTimerPool();
+  uint32_t numUncoalesced = timerPool.getNumUncoalescedTimerFires();
+  uint32_t numCoalesced = timerPool.getNumCoalescedTimerFires();
+
+  // The wakeup is deferred until the first timer's slack has elapsed, by which
+  // time all timers have expired.
+  bool firedEarly;
+  sendEventToNanoapp(app, START_TIMERS);
+  waitForEvent(TIMERS_FIRED, &firedEarly);
+  EXPECT_FALSE(firedEarly);
+  EXPECT_EQ(timerPool.getNumUncoalescedTimerFires(), numUncoalesced + 1);
+  EXPECT_EQ(timerPool.getNumCoalescedTimerFires(),
+            numCoalesced + kNumTimers - 1);
+}
+
+TEST_F(TestTimer, PeriodicTimerRearmsFromPreviousExpiration) {
+  // A fire handled late is re-armed one period after its expiration, not one
+  // period after it was handled.
+  EXPECT_EQ(getNextPeriodicExpirationMs(100 /*expirationMs*/, 20 /*periodMs*/,
+                                        103 /*currentMs*/),
+            120);
+  EXPECT_EQ(getNextPeriodicExpirationMs(100 /*expirationMs*/, 20 /*periodMs*/,
+                                        100 /*currentMs*/),
+            120);
+}
+
+TEST_F(TestTimer, PeriodicTimerSkipsMissedPeriods) {
+  // The fires at 120 and 140 ms were missed entirely, and are skipped rather
+  // than delivered back to back.
+  EXPECT_EQ(getNextPeriodicExpirationMs(100 /*expirationMs*/, 20 /*periodMs*/,
+                                        145 /*currentMs*/),
+            160);
+}
+
+TEST_F(TestTimer, PeriodicTimerWithSlackDoesNotDrift) {
+  static constexpr uint64_t kNumFires = 10;
+  static constexpr uint64_t kPeriodMs = 20;
+  static constexpr uint64_t kFireDelayMs = 7;
+
+  // Every fire is handled late, within a 10 ms slack, and the expirations stay
+  // aligned on the period.
+  uint64_t expirationMs = 100;
+  for (uint64_t i = 1; i <= kNumFires; i++) {
+    expirationMs = getNextPeriodicExpirationMs(expirationMs, kPeriodMs,
+                                               expirationMs + kFireDelayMs);
+    EXPECT_EQ(expirationMs, 100 + i * kPeriodMs);
+  }
+}
+
+/**
+ * Measures the cost of cancelling and re-arming a timer while the nanoapp
+ * holds the maximum number of timers, as done by nanoapps that frequently
+ * reschedule their timers. The first timer expires earliest and is never
+ * cancelled, so the measurement isn't dominated by reprogramming the
+ * SystemTimer. The timers are long enough to never fire during the
+ * measurement. Run chre_simulation_tests_indexed_timer_pool to compare the
+ * backends.
+ */
+TEST_F(TestTimer, DISABLED_CancelAndRearmBenchmark) {
+  CREATE_CHRE_TEST_EVENT(RUN, 0);
+
+  static constexpr size_t kNumTimers = 32;
+  static constexpr uint32_t kNumIterations = 20000;
+  static constexpr uint64_t kTimerDurationNs = 60 * kOneMinuteInNanoseconds;
+
+  struct App : public TestNanoapp {
+    decltype(nanoappHandleEvent) *handleEvent = [](uint32_t, uint16_t eventType,
+                                                   const void *eventData) {
+      static uint32_t handles[kNumTimers];
+
+      if (eventType == CHRE_EVENT_TEST_EVENT &&
+          static_cast<const TestEvent *>(eventData)->type == RUN) {
+        bool success = true;
+        for (size_t i = 0; i < kNumTimers; i++) {
+          handles[i] =
+              chreTimerSet(kTimerDurationNs + i * kOneSecondInNanoseconds,
+                           nullptr /*cookie*/, false /*oneShot*/);
+          success &= (handles[i] != CHRE_TIMER_INVALID);
+        }
+
+        Nanoseconds startTime = SystemTime::getMonotonicTime();
+        for (uint32_t i = 0; i < kNumIterations; i++) {
+          // Re-arm the other timers in turn, each to expire after all others.
+          uint32_t &handle = handles[1 + i % (kNumTimers - 1)];
+          success &= chreTimerCancel(handle);
+          handle = chreTimerSet(
+              kTimerDurationNs + (kNumTimers + i) * kOneSecondInNanoseconds,
+              nullptr /*cookie*/, false /*oneShot*/);
+          success &= (handle != CHRE_TIMER_INVALID);
+        }
+        uint64_t elapsedNs =
+            (SystemTime::getMonotonicTime() - startTime).toRawNanoseconds();
+
+        for (uint32_t handle : handles) {
+          chreTimerCancel(handle);
+        }
+        TestEventQueueSingleton::get()->pushEvent(RUN,
+                                                  success ? elapsedNs : 0);
+      }
+    };
+  };
+
+  auto app = loadNanoapp<App>();
+
+  uint64_t elapsedNs;
+  sendEventToNanoapp(app, RUN);
+  waitForEvent(RUN, &elapsedNs);
+  ASSERT_GT(elapsedNs, 0);
+  LOGI("Timer cancel and re-arm with %zu timers (%s): %" PRIu64 " ns",
+       kNumTimers,
+#ifdef CHRE_INDEXED_TIMER_POOL_ENABLED
+       "indexed heap",
+#else
+       "priority queue",
+#endif
+       elapsedNs / kNumIterations);
+}
+
 }  // namespace
 }  // namespace chre
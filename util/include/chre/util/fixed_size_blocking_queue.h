@@ -70,6 +70,21 @@ class BlockingQueueCore : public QueueStorageType {
    */
   ElementType pop();
 
+  /**
+   * Pops up to maxCount elements from the front of the queue with a single
+   * acquisition of the queue lock. If the queue is empty, the thread will
+   * block until an element has been pushed.
+   *
+   * @param elements An array of at least maxCount elements that the popped
+   *        elements are moved into, in queue order.
+   * @param maxCount The maximum number of elements to pop; must be non-zero.
+   * @param numRemaining If non-null, set to the number of elements left in the
+   *        queue after popping.
+   * @return The number of elements that were popped, in range [1, maxCount].
+   */
+  size_t popMultiple(ElementType *elements, size_t maxCount,
+                     size_t *numRemaining = nullptr);
+
   /**
    * Removes an element from the array queue given an index. It returns false if
    * the index is out of bounds of the underlying array queue.
@@ -17,6 +17,9 @@
 #ifndef CHRE_UTIL_FIXED_SIZE_BLOCKING_QUEUE_IMPL_H_
 #define CHRE_UTIL_FIXED_SIZE_BLOCKING_QUEUE_IMPL_H_
 
+#include <utility>
+
+#include "chre/util/container_support.h"
 #include "chre/util/fixed_size_blocking_queue.h"
 #include "chre/util/lock_guard.h"
 
@@ -96,6 +99,26 @@ ElementType BlockingQueueCore<ElementType, QueueStorageType>::pop() {
   return element;
 }
 
+template <typename ElementType, typename QueueStorageType>
+size_t BlockingQueueCore<ElementType, QueueStorageType>::popMultiple(
+    ElementType *elements, size_t maxCount, size_t *numRemaining) {
+  CHRE_ASSERT(maxCount > 0);
+  LockGuard<Mutex> lock(mMutex);
+  while (QueueStorageType::empty()) {
+    mConditionVariable.wait(mMutex);
+  }
+
+  size_t count = 0;
+  while (count < maxCount && !QueueStorageType::empty()) {
+    elements[count++] = std::move(QueueStorageType::front());
+    QueueStorageType::pop();
+  }
+  if (numRemaining != nullptr) {
+    *numRemaining = QueueStorageType::size();
+  }
+  return count;
+}
+
 }  // namespace blocking_queue_internal
 
 }  // namespace chre
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_INDEXED_PRIORITY_QUEUE_H_
+#define CHRE_UTIL_INDEXED_PRIORITY_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "chre/util/non_copyable.h"
+#include "chre/util/raw_storage.h"
+
+namespace chre {
+
+/**
+ * A fixed capacity priority queue whose elements stay at a stable storage slot
+ * for as long as they are in the queue. The heap only orders slot indices, so
+ * an element can be located from its slot in constant time, e.g. to remove it
+ * from the queue, instead of having to search the queue for it.
+ *
+ * Like PriorityQueue, the element at index 0 is the top element and there is
+ * no ordering guarantee for the elements at other indices.
+ *
+ * @tparam ElementType The type of element stored in the queue
+ * @tparam kCapacity The maximum number of elements in the queue
+ * @tparam CompareFunction The comparator that returns true if left < right
+ */
+template <typename ElementType, size_t kCapacity,
+          typename CompareFunction = std::less<ElementType>>
+class IndexedPriorityQueue : public NonCopyable {
+ public:
+  static_assert(kCapacity > 0 && kCapacity < UINT16_MAX,
+                "Capacity must fit in a 16-bit slot index");
+
+  IndexedPriorityQueue();
+
+  ~IndexedPriorityQueue();
+
+  /**
+   * @return The number of elements in the queue.
+   */
+  size_t size() const {
+    return mSize;
+  }
+
+  /**
+   * @return The maximum number of elements that can be stored in the queue.
+   */
+  size_t capacity() const {
+    return kCapacity;
+  }
+
+  /**
+   * @return true if the queue is empty.
+   */
+  bool empty() const {
+    return mSize == 0;
+  }
+
+  /**
+   * @return true if the queue is full.
+   */
+  bool full() const {
+    return mSize == kCapacity;
+  }
+
+  /**
+   * Pushes an element onto the queue. References to elements remain valid, but
+   * indices returned by getIndexOfSlot() are invalidated.
+   *
+   * @param element The element to push onto the queue.
+   * @return false if the queue is full.
+   */
+  bool push(const ElementType &element);
+
+  /**
+   * Obtains an element of the queue given an index in range [0, size()). The
+   * top element is at index 0.
+   *
+   * @param index The index of the element.
+   * @return The element.
+   */
+  ElementType &operator[](size_t index);
+
+  /**
+   * @see operator[]
+   */
+  const ElementType &operator[](size_t index) const;
+
+  /**
+   * Obtains the top element of the queue. The queue must not be empty.
+   *
+   * @return The element.
+   */
+  ElementType &top();
+
+  /**
+   * @see top()
+   */
+  const ElementType &top() const;
+
+  /**
+   * Removes the top element from the queue if the queue is not empty.
+   */
+  void pop();
+
+  /**
+   * Removes an element from the queue given an index in range [0, size()).
+   *
+   * @param index The index of the element to remove.
+   */
+  void remove(size_t index);
+
+  /**
+   * @return The storage slot that the next pushed element will occupy, or
+   *         capacity() if the queue is full.
+   */
+  size_t getNextFreeSlot() const;
+
+  /**
+   * @param index The index of an element in range [0, size()).
+   * @return The storage slot occupied by the element.
+   */
+  size_t getSlotOfIndex(size_t index) const;
+
+  /**
+   * Finds the current index of the element occupying a storage slot, in
+   * constant time.
+   *
+   * @param slot The storage slot.
+   * @return The index of the element in the slot, or size() if the slot is out
+   *         of range or unoccupied.
+   */
+  size_t getIndexOfSlot(size_t slot) const;
+
+ private:
+  //! Value of mIndexOfSlot for slots that do not hold an element.
+  static constexpr uint16_t kUnoccupied = UINT16_MAX;
+
+  //! Element storage, indexed by slot.
+  RawStorage<ElementType, kCapacity> mSlots;
+
+  //! The slots of the elements in heap order; the first mSize are valid.
+  uint16_t mHeap[kCapacity];
+
+  //! The position of each slot's element within mHeap, or kUnoccupied.
+  uint16_t mIndexOfSlot[kCapacity];
+
+  //! Stack of unoccupied slots; the first kCapacity - mSize are valid.
+  uint16_t mFreeSlots[kCapacity];
+
+  //! The number of elements in the queue.
+  size_t mSize = 0;
+
+  //! The comparator used to order the elements.
+  CompareFunction mCompare;
+
+  //! @return true if the element at index a has lower priority than the one at
+  //!         index b.
+  bool isLess(size_t a, size_t b) const {
+    return mCompare(mSlots[mHeap[a]], mSlots[mHeap[b]]);
+  }
+
+  //! Swaps the elements at two heap indices, updating the slot index.
+  void swapIndices(size_t a, size_t b);
+
+  //! Moves the element at the given index up until the heap is valid.
+  void siftUp(size_t index);
+
+  //! Moves the element at the given index down until the heap is valid.
+  void siftDown(size_t index);
+};
+
+}  // namespace chre
+
+#include "chre/util/indexed_priority_queue_impl.h"
+
+#endif  // CHRE_UTIL_INDEXED_PRIORITY_QUEUE_H_
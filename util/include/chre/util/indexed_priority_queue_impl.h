@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_INDEXED_PRIORITY_QUEUE_IMPL_H_
+#define CHRE_UTIL_INDEXED_PRIORITY_QUEUE_IMPL_H_
+
+#include "chre/util/indexed_priority_queue.h"
+
+#include <new>
+
+#include "chre/util/container_support.h"
+
+namespace chre {
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+IndexedPriorityQueue<ElementType, kCapacity,
+                     CompareFunction>::IndexedPriorityQueue() {
+  for (size_t i = 0; i < kCapacity; i++) {
+    mIndexOfSlot[i] = kUnoccupied;
+    // Hand out the lowest slots first.
+    mFreeSlots[i] = static_cast<uint16_t>(kCapacity - 1 - i);
+  }
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+IndexedPriorityQueue<ElementType, kCapacity,
+                     CompareFunction>::~IndexedPriorityQueue() {
+  for (size_t i = 0; i < mSize; i++) {
+    mSlots[mHeap[i]].~ElementType();
+  }
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+bool IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::push(
+    const ElementType &element) {
+  if (full()) {
+    return false;
+  }
+
+  uint16_t slot = mFreeSlots[kCapacity - 1 - mSize];
+  new (&mSlots[slot]) ElementType(element);
+  mHeap[mSize] = slot;
+  mIndexOfSlot[slot] = static_cast<uint16_t>(mSize);
+  mSize++;
+  siftUp(mSize - 1);
+  return true;
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+ElementType &
+IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::operator[](
+    size_t index) {
+  CHRE_ASSERT(index < mSize);
+  return mSlots[mHeap[index]];
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+const ElementType &
+IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::operator[](
+    size_t index) const {
+  CHRE_ASSERT(index < mSize);
+  return mSlots[mHeap[index]];
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+ElementType &IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::top() {
+  return operator[](0);
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+const ElementType &
+IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::top() const {
+  return operator[](0);
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+void IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::pop() {
+  if (!empty()) {
+    remove(0);
+  }
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+void IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::remove(
+    size_t index) {
+  CHRE_ASSERT(index < mSize);
+  if (index < mSize) {
+    uint16_t slot = mHeap[index];
+    size_t last = mSize - 1;
+    if (index != last) {
+      swapIndices(index, last);
+    }
+
+    mSlots[slot].~ElementType();
+    mIndexOfSlot[slot] = kUnoccupied;
+    mFreeSlots[kCapacity - mSize] = slot;
+    mSize--;
+
+    if (index < mSize) {
+      // The element moved into the removed position may need to go either way.
+      uint16_t movedSlot = mHeap[index];
+      siftUp(index);
+      siftDown(mIndexOfSlot[movedSlot]);
+    }
+  }
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+size_t IndexedPriorityQueue<ElementType, kCapacity,
+                            CompareFunction>::getNextFreeSlot() const {
+  return full() ? kCapacity : mFreeSlots[kCapacity - 1 - mSize];
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+size_t IndexedPriorityQueue<ElementType, kCapacity,
+                            CompareFunction>::getSlotOfIndex(size_t index)
+    const {
+  CHRE_ASSERT(index < mSize);
+  return mHeap[index];
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+size_t IndexedPriorityQueue<ElementType, kCapacity,
+                            CompareFunction>::getIndexOfSlot(size_t slot)
+    const {
+  if (slot >= kCapacity || mIndexOfSlot[slot] == kUnoccupied) {
+    return mSize;
+  }
+  return mIndexOfSlot[slot];
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+void IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::swapIndices(
+    size_t a, size_t b) {
+  uint16_t slotA = mHeap[a];
+  mHeap[a] = mHeap[b];
+  mHeap[b] = slotA;
+  mIndexOfSlot[mHeap[a]] = static_cast<uint16_t>(a);
+  mIndexOfSlot[mHeap[b]] = static_cast<uint16_t>(b);
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+void IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::siftUp(
+    size_t index) {
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (!isLess(parent, index)) {
+      break;
+    }
+    swapIndices(parent, index);
+    index = parent;
+  }
+}
+
+template <typename ElementType, size_t kCapacity, typename CompareFunction>
+void IndexedPriorityQueue<ElementType, kCapacity, CompareFunction>::siftDown(
+    size_t index) {
+  while (true) {
+    size_t largest = index;
+    size_t left = 2 * index + 1;
+    size_t right = left + 1;
+    if (left < mSize && isLess(largest, left)) {
+      largest = left;
+    }
+    if (right < mSize && isLess(largest, right)) {
+      largest = right;
+    }
+    if (largest == index) {
+      break;
+    }
+    swapIndices(index, largest);
+    index = largest;
+  }
+}
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_INDEXED_PRIORITY_QUEUE_IMPL_H_
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_NANOAPP_HOST_MESSAGE_QUEUE_H_
+#define CHRE_UTIL_NANOAPP_HOST_MESSAGE_QUEUE_H_
+
+#include <chre/event.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @file
+ * Implementation-specific events that this CHRE sends to a nanoapp to report
+ * the state of its outbound queue of messages to the host. Nanoapps that send
+ * bursts of messages can use them to throttle rather than have
+ * chreSendMessageToHostEndpoint() start failing. Both events carry no data
+ * (eventData is NULL), and are only sent to the nanoapp they concern once it
+ * opted in through platform_chreConfigureHostMessageQueueEvents().
+ */
+
+/**
+ * The range of event types reserved for these events. It is taken from the
+ * internal range that the CHRE implementation owns, rather than the extended
+ * internal range, whose event types may also be used by vendor extensions.
+ */
+#define CHRE_EVENT_HOST_MESSAGE_QUEUE_FIRST_EVENT CHRE_EVENT_INTERNAL_FIRST_EVENT
+#define CHRE_EVENT_HOST_MESSAGE_QUEUE_LAST_EVENT \
+  (CHRE_EVENT_INTERNAL_FIRST_EVENT + 0x000F)
+
+/**
+ * Sent to a nanoapp after one of its messages to the host was accepted when
+ * either the nanoapp's own share of the message queue or the queue as a whole
+ * is nearly full. Further messages may be rejected until
+ * CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED is received.
+ */
+#define CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL \
+  CHRE_EVENT_HOST_MESSAGE_QUEUE_FIRST_EVENT
+
+/**
+ * Sent to a nanoapp that previously received
+ * CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL once all of its messages to the
+ * host have been released.
+ */
+#define CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED \
+  (CHRE_EVENT_HOST_MESSAGE_QUEUE_FIRST_EVENT + 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Platform extension allowing a nanoapp to opt in to the host message queue
+ * state events. Nanoapps are not sent these events by default.
+ *
+ * @param enable true to receive CHRE_EVENT_HOST_MESSAGE_QUEUE_NEARLY_FULL and
+ *        CHRE_EVENT_HOST_MESSAGE_QUEUE_DRAINED, false otherwise.
+ */
+void platform_chreConfigureHostMessageQueueEvents(bool enable);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // CHRE_UTIL_NANOAPP_HOST_MESSAGE_QUEUE_H_
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_SORTED_VECTOR_SET_H_
+#define CHRE_UTIL_SORTED_VECTOR_SET_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "chre/util/dynamic_vector.h"
+#include "chre/util/non_copyable.h"
+
+namespace chre {
+
+namespace internal {
+
+/**
+ * A fixed size bitmap tracking which of the keys in [0, kNumKeys) are present
+ * in a SortedVectorSet.
+ */
+template <size_t kNumKeys>
+class DenseKeyBitmap {
+ protected:
+  bool isDenseKey(size_t key) const {
+    return key < kNumKeys;
+  }
+
+  bool testDenseKey(size_t key) const {
+    return (mBits[key / kBitsPerWord] & (1u << (key % kBitsPerWord))) != 0;
+  }
+
+  void setDenseKey(size_t key, bool present) {
+    uint32_t mask = 1u << (key % kBitsPerWord);
+    if (present) {
+      mBits[key / kBitsPerWord] |= mask;
+    } else {
+      mBits[key / kBitsPerWord] &= ~mask;
+    }
+  }
+
+  void clearDenseKeys() {
+    for (uint32_t &word : mBits) {
+      word = 0;
+    }
+  }
+
+ private:
+  static constexpr size_t kBitsPerWord = 32;
+
+  uint32_t mBits[(kNumKeys + kBitsPerWord - 1) / kBitsPerWord] = {};
+};
+
+//! Specialization used when the dense fast path is disabled, which takes no
+//! space when used as a base class.
+template <>
+class DenseKeyBitmap<0> {
+ protected:
+  bool isDenseKey(size_t /* key */) const {
+    return false;
+  }
+
+  bool testDenseKey(size_t /* key */) const {
+    return false;
+  }
+
+  void setDenseKey(size_t /* key */, bool /* present */) {}
+
+  void clearDenseKeys() {}
+};
+
+}  // namespace internal
+
+/**
+ * A set container for small collections that stores its elements in a
+ * DynamicVector sorted by key, providing compact storage and O(log n) lookup.
+ *
+ * Elements are identified by an unsigned integral key: the element itself if
+ * ElementType is integral, otherwise the value returned by its getKey() method.
+ * At most one element per key is stored. Fields of an element other than its
+ * key may be modified in place through operator[].
+ *
+ * If kNumDenseKeys is non-zero, membership of keys in [0, kNumDenseKeys) is
+ * additionally tracked in a bitmap of kNumDenseKeys bits, so lookups of these
+ * keys complete in O(1) when the key is not present and skip the search
+ * entirely for contains(). This is intended for sets that are mostly queried
+ * with keys from a known, densely packed range (e.g. the CHRE_EVENT_* system
+ * event types).
+ *
+ * @tparam ElementType The type of element stored in the set
+ * @tparam kNumDenseKeys The number of keys, starting from 0, covered by the
+ *         dense bitmap, or 0 to disable it
+ */
+template <typename ElementType, size_t kNumDenseKeys = 0>
+class SortedVectorSet : public NonCopyable,
+                        private internal::DenseKeyBitmap<kNumDenseKeys> {
+ public:
+  typedef typename DynamicVector<ElementType>::const_iterator const_iterator;
+  typedef ElementType value_type;
+  typedef size_t size_type;
+
+  /**
+   * @return The number of elements in the set.
+   */
+  size_type size() const {
+    return mElements.size();
+  }
+
+  /**
+   * @return true if the set contains no elements.
+   */
+  bool empty() const {
+    return mElements.empty();
+  }
+
+  /**
+   * Obtains a reference to the element at the given index, in increasing key
+   * order. The key of the element must not be modified through the returned
+   * reference.
+   *
+   * @param index The index of the element; must be less than size().
+   * @return A reference to the element at the index.
+   */
+  ElementType &operator[](size_type index);
+
+  /**
+   * @see operator[]
+   */
+  const ElementType &operator[](size_type index) const;
+
+  /**
+   * @param key The key to search for.
+   * @return true if an element with the given key is in the set.
+   */
+  bool contains(size_t key) const;
+
+  /**
+   * Searches for the element with the given key.
+   *
+   * @param key The key to search for.
+   * @return The index of the element with the given key, or size() if there is
+   *         none.
+   */
+  size_type find(size_t key) const;
+
+  /**
+   * Inserts an element into the set, keeping the elements sorted by key. If an
+   * element with the same key is already present, the set is left unmodified.
+   *
+   * @param element The element to insert.
+   * @return false if memory allocation failed, true otherwise.
+   */
+  bool insert(const ElementType &element);
+
+  /**
+   * Removes the element with the given key if it is present.
+   *
+   * @param key The key of the element to remove.
+   * @return true if an element was removed.
+   */
+  bool remove(size_t key);
+
+  /**
+   * Removes the element at the given index.
+   *
+   * @param index The index of the element to remove; must be less than size().
+   */
+  void erase(size_type index);
+
+  /**
+   * Removes all elements from the set.
+   */
+  void clear();
+
+  /**
+   * @return An iterator to the element with the smallest key.
+   */
+  const_iterator begin() const {
+    return mElements.begin();
+  }
+
+  /**
+   * @return An iterator past the element with the largest key.
+   */
+  const_iterator end() const {
+    return mElements.end();
+  }
+
+ private:
+  typedef internal::DenseKeyBitmap<kNumDenseKeys> DenseBitmap;
+
+  //! The elements of the set, sorted in increasing key order.
+  DynamicVector<ElementType> mElements;
+
+  /**
+   * @return The index of the first element with a key not less than the given
+   *         key, or size() if there is none.
+   */
+  size_type lowerBound(size_t key) const;
+
+  //! @return The key of an integral element, i.e. its value.
+  static size_t getKey(const ElementType &element, std::true_type) {
+    return static_cast<size_t>(element);
+  }
+
+  //! @return The key of a non-integral element.
+  static size_t getKey(const ElementType &element, std::false_type) {
+    return static_cast<size_t>(element.getKey());
+  }
+
+  static size_t getKey(const ElementType &element) {
+    return getKey(element, std::is_integral<ElementType>());
+  }
+};
+
+}  // namespace chre
+
+#include "chre/util/sorted_vector_set_impl.h"
+
+#endif  // CHRE_UTIL_SORTED_VECTOR_SET_H_
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_SORTED_VECTOR_SET_IMPL_H_
+#define CHRE_UTIL_SORTED_VECTOR_SET_IMPL_H_
+
+#include "chre/util/sorted_vector_set.h"
+
+#include "chre/util/container_support.h"
+
+namespace chre {
+
+template <typename ElementType, size_t kNumDenseKeys>
+ElementType &SortedVectorSet<ElementType, kNumDenseKeys>::operator[](
+    size_type index) {
+  CHRE_ASSERT(index < size());
+  return mElements[index];
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+const ElementType &SortedVectorSet<ElementType, kNumDenseKeys>::operator[](
+    size_type index) const {
+  CHRE_ASSERT(index < size());
+  return mElements[index];
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+bool SortedVectorSet<ElementType, kNumDenseKeys>::contains(size_t key) const {
+  if (DenseBitmap::isDenseKey(key)) {
+    return DenseBitmap::testDenseKey(key);
+  }
+  return find(key) < size();
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+typename SortedVectorSet<ElementType, kNumDenseKeys>::size_type
+SortedVectorSet<ElementType, kNumDenseKeys>::find(size_t key) const {
+  if (DenseBitmap::isDenseKey(key) && !DenseBitmap::testDenseKey(key)) {
+    return size();
+  }
+
+  size_type index = lowerBound(key);
+  if (index < size() && getKey(mElements[index]) != key) {
+    index = size();
+  }
+  return index;
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+bool SortedVectorSet<ElementType, kNumDenseKeys>::insert(
+    const ElementType &element) {
+  size_t key = getKey(element);
+  size_type index = lowerBound(key);
+  if (index < size() && getKey(mElements[index]) == key) {
+    return true;
+  }
+
+  bool success = mElements.insert(index, element);
+  if (success && DenseBitmap::isDenseKey(key)) {
+    DenseBitmap::setDenseKey(key, true /* present */);
+  }
+  return success;
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+bool SortedVectorSet<ElementType, kNumDenseKeys>::remove(size_t key) {
+  size_type index = find(key);
+  bool found = (index < size());
+  if (found) {
+    erase(index);
+  }
+  return found;
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+void SortedVectorSet<ElementType, kNumDenseKeys>::erase(size_type index) {
+  CHRE_ASSERT(index < size());
+  size_t key = getKey(mElements[index]);
+  if (DenseBitmap::isDenseKey(key)) {
+    DenseBitmap::setDenseKey(key, false /* present */);
+  }
+  mElements.erase(index);
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+void SortedVectorSet<ElementType, kNumDenseKeys>::clear() {
+  mElements.clear();
+  DenseBitmap::clearDenseKeys();
+}
+
+template <typename ElementType, size_t kNumDenseKeys>
+typename SortedVectorSet<ElementType, kNumDenseKeys>::size_type
+SortedVectorSet<ElementType, kNumDenseKeys>::lowerBound(size_t key) const {
+  size_type low = 0;
+  size_type high = size();
+  while (low < high) {
+    size_type mid = low + (high - low) / 2;
+    if (getKey(mElements[mid]) < key) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_SORTED_VECTOR_SET_IMPL_H_
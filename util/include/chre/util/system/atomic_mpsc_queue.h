@@ -0,0 +1,320 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_ATOMIC_MPSC_QUEUE_H_
+#define CHRE_UTIL_ATOMIC_MPSC_QUEUE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "chre/platform/assert.h"
+#include "chre/platform/atomic.h"
+#include "chre/platform/condition_variable.h"
+#include "chre/platform/mutex.h"
+#include "chre/util/lock_guard.h"
+#include "chre/util/non_copyable.h"
+
+/**
+ * @file
+ * AtomicMpscQueue is a bounded FIFO queue around a contiguous array where any
+ * number of threads can push without taking a lock, and a single consumer
+ * thread pops, blocking while the queue is empty. It is meant as a drop-in
+ * replacement for BlockingSegmentedQueue where producers on several threads
+ * would otherwise contend on the queue mutex.
+ *
+ * A producer first reserves room in the queue by incrementing a counter, then
+ * takes a ticket that identifies its slot, constructs the element in place and
+ * publishes it by storing the ticket in the slot's sequence number. The
+ * consumer takes elements in ticket order, and stops at the first slot that is
+ * not yet published, so FIFO order is preserved across producers. As the room
+ * is reserved before the ticket is taken, a producer's slot is always free by
+ * the time it writes to it.
+ *
+ * Producers only take a lock to wake the consumer when it is blocked on an
+ * empty queue. The consumer takes an uncontended lock once per batch of
+ * elements, which is only shared with removeMatchedFromBack().
+ *
+ * Elements removed by removeMatchedFromBack() keep their slot until the
+ * consumer reaches it, so the capacity should leave some headroom above the
+ * number of elements that are expected to be queued at once.
+ *
+ * @tparam ElementType The type of the elements, typically a pointer.
+ * @tparam kCapacity The maximum number of slots, which must be a power of 2.
+ */
+
+namespace chre {
+
+template <typename ElementType, size_t kCapacity>
+class AtomicMpscQueue : public NonCopyable {
+  static_assert(kCapacity > 0 && (kCapacity & (kCapacity - 1)) == 0,
+                "Capacity must be a power of 2");
+  static_assert(kCapacity <= UINT32_MAX / 2,
+                "Capacity must leave room for the ticket to wrap around");
+
+ public:
+  typedef ElementType value_type;
+
+  //! @see SegmentedQueue::MatchingFunction
+  using MatchingFunction =
+      typename std::conditional<std::is_pointer<ElementType>::value ||
+                                    std::is_fundamental<ElementType>::value,
+                                bool(ElementType), bool(ElementType &)>::type;
+
+  //! @see SegmentedQueue::FreeFunction
+  using FreeFunction =
+      typename std::conditional<std::is_pointer<ElementType>::value ||
+                                    std::is_fundamental<ElementType>::value,
+                                void(ElementType, void *),
+                                void(ElementType &, void *)>::type;
+
+  /**
+   * Destroying the queue must only be done when it is guaranteed that no
+   * producer or consumer is using it.
+   */
+  ~AtomicMpscQueue() {
+    while (!empty()) {
+      pop();
+    }
+  }
+
+  /**
+   * Constructs an element at the back of the queue. Safe to call from any
+   * thread.
+   *
+   * @return true if the element was pushed, false if the queue was full.
+   */
+  template <typename... Args>
+  bool emplace(Args &&...args) {
+    bool success = false;
+    if (mNumReserved.fetch_increment() >= kCapacity) {
+      mNumReserved.fetch_decrement();
+    } else {
+      uint32_t ticket = mTail.fetch_increment();
+      Slot &slot = mSlots[ticket & kIndexMask];
+      new (slot.data()) ElementType(std::forward<Args>(args)...);
+      slot.sequence.store(ticket + 1);
+      success = true;
+
+      // Must be checked after publishing; see waitForPublished().
+      if (mConsumerWaiting.load()) {
+        LockGuard<Mutex> lock(mWaitMutex);
+        mConditionVariable.notify_one();
+      }
+    }
+    return success;
+  }
+
+  //! @see emplace
+  bool push(const ElementType &element) {
+    return emplace(element);
+  }
+  bool push(ElementType &&element) {
+    return emplace(std::move(element));
+  }
+
+  /**
+   * Gets a snapshot of the number of elements in the queue, including ones
+   * that are still being pushed. Safe to call from any thread.
+   */
+  size_t size() const {
+    uint32_t reserved = mNumReserved.load();
+    uint32_t removed = mNumRemoved.load();
+    reserved = (reserved > kCapacity) ? kCapacity : reserved;
+    return (reserved > removed) ? (reserved - removed) : 0;
+  }
+
+  bool empty() const {
+    return (size() == 0);
+  }
+
+  size_t capacity() const {
+    return kCapacity;
+  }
+
+  /**
+   * Pops the oldest element from the queue. If the queue is empty, blocks
+   * until an element is pushed. Must only be called from the consumer thread.
+   */
+  ElementType pop() {
+    ElementType element;
+    popMultiple(&element, 1);
+    return element;
+  }
+
+  /**
+   * Pops up to maxCount elements from the front of the queue with a single
+   * acquisition of the consumer lock. If the queue is empty, blocks until an
+   * element is pushed. Must only be called from the consumer thread.
+   *
+   * @param elements An array of at least maxCount elements that the popped
+   *        elements are moved into, in queue order.
+   * @param maxCount The maximum number of elements to pop; must be non-zero.
+   * @param numRemaining If non-null, set to the number of elements left in the
+   *        queue after popping.
+   * @return The number of elements that were popped, in range [1, maxCount].
+   *
+   * @see BlockingQueueCore::popMultiple
+   */
+  size_t popMultiple(ElementType *elements, size_t maxCount,
+                     size_t *numRemaining = nullptr) {
+    CHRE_ASSERT(maxCount > 0);
+    size_t count;
+    while ((count = tryPopMultiple(elements, maxCount)) == 0) {
+      waitForPublished();
+    }
+
+    if (numRemaining != nullptr) {
+      *numRemaining = size();
+    }
+    return count;
+  }
+
+  /**
+   * Removes up to maxNumOfElementsRemoved elements that satisfy matchFunction,
+   * searching from the back of the queue. Elements that are still being
+   * pushed are not considered. Safe to call from any thread, but excludes the
+   * consumer while it runs.
+   *
+   * @param matchFunction Function used to decide if an element should be
+   *        removed.
+   * @param maxNumOfElementsRemoved The maximum number of elements to remove.
+   * @param freeFunction If non-null, takes ownership of each removed element
+   *        instead of it being destroyed.
+   * @param extraDataForFreeFunction Passed to freeFunction.
+   *
+   * @return The number of elements removed.
+   *
+   * @see SegmentedQueue::removeMatchedFromBack
+   */
+  size_t removeMatchedFromBack(MatchingFunction *matchFunction,
+                               size_t maxNumOfElementsRemoved,
+                               FreeFunction *freeFunction = nullptr,
+                               void *extraDataForFreeFunction = nullptr) {
+    LockGuard<Mutex> lock(mConsumerMutex);
+    size_t numRemoved = 0;
+    uint32_t ticket = mTail.load();
+    while (ticket != mHead && numRemoved < maxNumOfElementsRemoved) {
+      ticket--;
+      Slot &slot = mSlots[ticket & kIndexMask];
+      if (slot.sequence.load() == ticket + 1 && !slot.removed &&
+          matchFunction(*slot.data())) {
+        if (freeFunction == nullptr) {
+          slot.data()->~ElementType();
+        } else {
+          freeFunction(*slot.data(), extraDataForFreeFunction);
+        }
+        slot.removed = true;
+        mNumRemoved.fetch_increment();
+        numRemoved++;
+      }
+    }
+    return numRemoved;
+  }
+
+ private:
+  static constexpr uint32_t kIndexMask = static_cast<uint32_t>(kCapacity - 1);
+
+  struct Slot {
+    //! Set to the ticket + 1 of the element in this slot once it is
+    //! constructed. Tickets are unique within a window of kCapacity, so a
+    //! stale value from an earlier use of the slot never matches.
+    AtomicUint32 sequence{0};
+
+    //! true if the element was removed by removeMatchedFromBack(). Only
+    //! accessed with mConsumerMutex held.
+    bool removed = false;
+
+    typename std::aligned_storage<sizeof(ElementType),
+                                  alignof(ElementType)>::type storage;
+
+    ElementType *data() {
+      return reinterpret_cast<ElementType *>(&storage);
+    }
+  };
+
+  Slot mSlots[kCapacity];
+
+  //! The number of slots reserved by producers, including removed elements
+  //! that the consumer has yet to skip over.
+  AtomicUint32 mNumReserved{0};
+
+  //! The number of removed elements that still hold a slot.
+  AtomicUint32 mNumRemoved{0};
+
+  //! The ticket that will be given to the next producer.
+  AtomicUint32 mTail{0};
+
+  //! The ticket of the oldest element. Only modified by the consumer with
+  //! mConsumerMutex held.
+  uint32_t mHead = 0;
+
+  //! Serializes the consumer with removeMatchedFromBack().
+  Mutex mConsumerMutex;
+
+  //! Used to block the consumer while the queue is empty.
+  Mutex mWaitMutex;
+  ConditionVariable mConditionVariable;
+  AtomicBool mConsumerWaiting{false};
+
+  /**
+   * Moves up to maxCount of the oldest published elements into elements,
+   * skipping over removed ones.
+   *
+   * @return The number of elements popped, which is 0 if none are published.
+   */
+  size_t tryPopMultiple(ElementType *elements, size_t maxCount) {
+    LockGuard<Mutex> lock(mConsumerMutex);
+    size_t count = 0;
+    while (count < maxCount) {
+      Slot &slot = mSlots[mHead & kIndexMask];
+      if (slot.sequence.load() != mHead + 1) {
+        break;
+      }
+      if (slot.removed) {
+        slot.removed = false;
+        mNumRemoved.fetch_decrement();
+      } else {
+        elements[count++] = std::move(*slot.data());
+        slot.data()->~ElementType();
+      }
+      mHead++;
+      // Releasing the reservation last hands the slot back to producers.
+      mNumReserved.fetch_decrement();
+    }
+    return count;
+  }
+
+  /**
+   * Blocks until the slot at the head of the queue is published. A producer
+   * publishes before checking mConsumerWaiting, and the consumer sets it
+   * before checking the slot, so at least one of them sees the other.
+   */
+  void waitForPublished() {
+    LockGuard<Mutex> lock(mWaitMutex);
+    mConsumerWaiting = true;
+    while (mSlots[mHead & kIndexMask].sequence.load() != mHead + 1) {
+      mConditionVariable.wait(mWaitMutex);
+    }
+    mConsumerWaiting = false;
+  }
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_ATOMIC_MPSC_QUEUE_H_
@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CHRE_UTIL_SYSTEM_LOG_HISTOGRAM_H_
+#define CHRE_UTIL_SYSTEM_LOG_HISTOGRAM_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace chre {
+
+/**
+ * A histogram of unsigned values with power-of-two bucket boundaries, using a
+ * fixed amount of memory regardless of the number of values added.
+ *
+ * Bucket 0 counts values of 0, bucket i counts values in [2^(i-1), 2^i), and
+ * the last bucket also counts every larger value. Counts saturate at
+ * UINT16_MAX.
+ *
+ * @tparam kNumBuckets The number of buckets, at most 33 to cover every
+ *     uint32_t value.
+ */
+template <size_t kNumBuckets>
+class LogHistogram {
+  static_assert(kNumBuckets >= 2 && kNumBuckets <= 33,
+                "Number of buckets must be between 2 and 33");
+
+ public:
+  /**
+   * Counts a value in the bucket covering it.
+   */
+  void addValue(uint32_t value) {
+    uint16_t &count = mCounts[getBucketIndex(value)];
+    if (count < UINT16_MAX) {
+      count++;
+    }
+  }
+
+  /**
+   * @return The number of values counted in the given bucket.
+   */
+  uint16_t getCount(size_t bucket) const {
+    return mCounts[bucket];
+  }
+
+  /**
+   * @return The number of values counted in all buckets.
+   */
+  uint32_t getTotalCount() const {
+    uint32_t total = 0;
+    for (size_t i = 0; i < kNumBuckets; i++) {
+      total += mCounts[i];
+    }
+    return total;
+  }
+
+  /**
+   * @param percentile A percentile between 0 and 100.
+   *
+   * @return The index of the bucket containing the given percentile, or 0 if
+   *     no values were added.
+   */
+  size_t getPercentileBucket(uint8_t percentile) const {
+    uint32_t total = getTotalCount();
+    // Rank of the value at the percentile, rounding up so that the 100th
+    // percentile is the largest value.
+    uint32_t rank = (total * percentile + 99) / 100;
+    uint32_t seen = 0;
+    size_t bucket = 0;
+    while (bucket < kNumBuckets - 1 && seen + mCounts[bucket] < rank) {
+      seen += mCounts[bucket];
+      bucket++;
+    }
+    return bucket;
+  }
+
+  /**
+   * @return The index of the bucket a value is counted in.
+   */
+  static constexpr size_t getBucketIndex(uint32_t value) {
+    size_t index = 0;
+    while (value != 0 && index < kNumBuckets - 1) {
+      value >>= 1;
+      index++;
+    }
+    return index;
+  }
+
+  /**
+   * @return The smallest value counted in the given bucket.
+   */
+  static constexpr uint32_t getBucketLowerBound(size_t bucket) {
+    return (bucket == 0) ? 0 : (UINT32_C(1) << (bucket - 1));
+  }
+
+  /**
+   * @return The number of buckets in the histogram.
+   */
+  static constexpr size_t getNumBuckets() {
+    return kNumBuckets;
+  }
+
+ private:
+  uint16_t mCounts[kNumBuckets] = {};
+};
+
+}  // namespace chre
+
+#endif  // CHRE_UTIL_SYSTEM_LOG_HISTOGRAM_H_
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/system/atomic_mpsc_queue.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using chre::AtomicMpscQueue;
+
+namespace {
+
+bool isOdd(uint64_t value) {
+  return (value % 2) == 1;
+}
+
+void countFreed(uint64_t /* value */, void *count) {
+  (*static_cast<size_t *>(count))++;
+}
+
+}  // namespace
+
+TEST(AtomicMpscQueueTest, PushPopInOrder) {
+  AtomicMpscQueue<uint64_t, 8> q;
+  EXPECT_TRUE(q.empty());
+
+  for (uint64_t i = 0; i < 8; i++) {
+    EXPECT_TRUE(q.push(i));
+  }
+  EXPECT_EQ(q.size(), 8);
+  EXPECT_FALSE(q.push(8));
+
+  uint64_t values[8];
+  size_t numRemaining;
+  EXPECT_EQ(q.popMultiple(values, 3, &numRemaining), 3);
+  EXPECT_EQ(numRemaining, 5);
+  for (uint64_t i = 0; i < 3; i++) {
+    EXPECT_EQ(values[i], i);
+  }
+
+  // The freed slots are reused as the tail wraps around
+  for (uint64_t i = 8; i < 11; i++) {
+    EXPECT_TRUE(q.push(i));
+  }
+  for (uint64_t i = 3; i < 11; i++) {
+    EXPECT_EQ(q.pop(), i);
+  }
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(AtomicMpscQueueTest, RemoveMatchedFromBack) {
+  AtomicMpscQueue<uint64_t, 8> q;
+  for (uint64_t i = 0; i < 8; i++) {
+    EXPECT_TRUE(q.push(i));
+  }
+
+  size_t numFreed = 0;
+  EXPECT_EQ(q.removeMatchedFromBack(isOdd, 2, countFreed, &numFreed), 2);
+  EXPECT_EQ(numFreed, 2);
+  EXPECT_EQ(q.size(), 6);
+
+  // Removed elements hold their slot until the consumer skips over them
+  EXPECT_FALSE(q.push(8));
+
+  uint64_t values[8];
+  EXPECT_EQ(q.popMultiple(values, 8), 6);
+  const uint64_t expected[] = {0, 1, 2, 3, 4, 6};
+  for (size_t i = 0; i < 6; i++) {
+    EXPECT_EQ(values[i], expected[i]);
+  }
+  EXPECT_TRUE(q.empty());
+  EXPECT_TRUE(q.push(8));
+}
+
+TEST(AtomicMpscQueueTest, PopBlocksUntilPush) {
+  AtomicMpscQueue<uint64_t, 4> q;
+  std::thread producer([&q]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    q.push(42);
+  });
+  EXPECT_EQ(q.pop(), 42);
+  producer.join();
+}
+
+namespace {
+
+/**
+ * Pushes values tagged with their producer from several threads while a
+ * consumer drains the queue in batches and another thread removes odd values
+ * from the back, then checks that every value was either consumed or removed
+ * exactly once, and that each producer's values were consumed in order.
+ */
+void runStressTest(uint64_t numProducers) {
+  constexpr size_t kCapacity = 256;
+  constexpr uint64_t kValuesPerProducer = 100000;
+  constexpr size_t kBatchSize = 32;
+  // Even, so it is never removed, and distinct from any producer's values
+  constexpr uint64_t kDoneValue = UINT64_MAX - 1;
+  AtomicMpscQueue<uint64_t, kCapacity> q;
+
+  std::atomic<bool> producersDone(false);
+  std::atomic<size_t> numFullRetries(0);
+  size_t numRemoved = 0;
+  uint64_t numConsumed = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (uint64_t producer = 0; producer < numProducers; producer++) {
+    producers.emplace_back([&q, &numFullRetries, producer]() {
+      for (uint64_t i = 0; i < kValuesPerProducer; i++) {
+        while (!q.push((producer << 32) | i)) {
+          numFullRetries++;
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::thread remover([&]() {
+    while (!producersDone) {
+      numRemoved += q.removeMatchedFromBack(isOdd, 4);
+      std::this_thread::yield();
+    }
+  });
+
+  std::thread consumer([&]() {
+    std::vector<uint64_t> nextValue(numProducers, 0);
+    uint64_t batch[kBatchSize];
+    bool done = false;
+    while (!done) {
+      size_t count = q.popMultiple(batch, kBatchSize);
+      for (size_t i = 0; i < count; i++) {
+        if (batch[i] == kDoneValue) {
+          done = true;
+          break;
+        }
+        uint64_t producer = batch[i] >> 32;
+        uint64_t value = batch[i] & UINT32_MAX;
+        ASSERT_LT(producer, numProducers);
+        ASSERT_GE(value, nextValue[producer]);
+        nextValue[producer] = value + 1;
+        numConsumed++;
+      }
+    }
+  });
+
+  for (std::thread &thread : producers) {
+    thread.join();
+  }
+  producersDone = true;
+  remover.join();
+  ASSERT_TRUE(q.push(kDoneValue));
+  consumer.join();
+
+  uint64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  uint64_t total = numProducers * kValuesPerProducer;
+  EXPECT_EQ(numConsumed + numRemoved, total);
+  EXPECT_TRUE(q.empty());
+  printf("AtomicMpscQueue, %" PRIu64 " producers: %" PRIu64
+         " pushes/s, %zu removed, %zu full retries\n",
+         numProducers, total * 1000000000 / (elapsedNs ? elapsedNs : 1),
+         numRemoved, numFullRetries.load());
+}
+
+}  // namespace
+
+TEST(AtomicMpscQueueStressTest, FourProducers) {
+  runStressTest(4);
+}
+
+TEST(AtomicMpscQueueStressTest, EightProducers) {
+  runStressTest(8);
+}
@@ -74,6 +74,41 @@ TEST(BlockingQueue, PushPopMove) {
   ASSERT_EQ(*(blockingQueue.pop()), kVal);
 }
 
+TEST(BlockingQueue, PopMultipleVerifyOrder) {
+  FixedSizeBlockingQueue<int, 16> blockingQueue;
+  for (int i = 0; i < 5; i++) {
+    ASSERT_TRUE(blockingQueue.push(i));
+  }
+
+  int elements[3];
+  size_t numRemaining;
+  ASSERT_EQ(blockingQueue.popMultiple(elements, 3, &numRemaining), 3);
+  EXPECT_EQ(numRemaining, 2);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(elements[i], i);
+  }
+
+  // Only the remaining elements are popped if fewer than maxCount are queued.
+  ASSERT_EQ(blockingQueue.popMultiple(elements, 3), 2);
+  EXPECT_EQ(elements[0], 3);
+  EXPECT_EQ(elements[1], 4);
+  EXPECT_TRUE(blockingQueue.empty());
+}
+
+TEST(BlockingQueue, PopMultipleMove) {
+  static constexpr int kVal = 0xbeef;
+  UniquePtr<int> ptr = MakeUnique<int>();
+  *ptr = kVal;
+
+  FixedSizeBlockingQueue<UniquePtr<int>, 16> blockingQueue;
+  ASSERT_TRUE(blockingQueue.push(std::move(ptr)));
+
+  UniquePtr<int> elements[2];
+  ASSERT_EQ(blockingQueue.popMultiple(elements, 2), 1);
+  ASSERT_FALSE(elements[0].isNull());
+  EXPECT_EQ(*elements[0], kVal);
+}
+
 TEST(BlockingSegmentedQueue, InitState) {
   constexpr uint8_t blockSize = 16;
   constexpr uint8_t maxBlockCount = 3;
@@ -83,3 +118,22 @@ TEST(BlockingSegmentedQueue, InitState) {
   ASSERT_TRUE(blockingQueue.empty());
   ASSERT_EQ(blockingQueue.block_count(), staticBlockCount);
 }
+
+TEST(BlockingSegmentedQueue, PopMultipleAcrossBlocks) {
+  constexpr uint8_t blockSize = 4;
+  constexpr uint8_t maxBlockCount = 3;
+  BlockingSegmentedQueue<int, blockSize> blockingQueue(maxBlockCount);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(blockingQueue.push(i));
+  }
+
+  int elements[8];
+  size_t numRemaining;
+  ASSERT_EQ(blockingQueue.popMultiple(elements, 8, &numRemaining), 8);
+  EXPECT_EQ(numRemaining, 2);
+  for (int i = 0; i < 8; i++) {
+    EXPECT_EQ(elements[i], i);
+  }
+  EXPECT_EQ(blockingQueue.pop(), 8);
+  EXPECT_EQ(blockingQueue.pop(), 9);
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/indexed_priority_queue.h"
+
+#include <cstdlib>
+#include <functional>
+
+#include "gtest/gtest.h"
+
+using chre::IndexedPriorityQueue;
+
+namespace {
+
+//! Counts live instances to verify elements are destroyed.
+class CountedElement {
+ public:
+  CountedElement(int value) : mValue(value) {
+    sNumInstances++;
+  }
+  CountedElement(const CountedElement &other) : mValue(other.mValue) {
+    sNumInstances++;
+  }
+  ~CountedElement() {
+    sNumInstances--;
+  }
+
+  bool operator<(const CountedElement &other) const {
+    return mValue < other.mValue;
+  }
+
+  int getValue() const {
+    return mValue;
+  }
+
+  static int sNumInstances;
+
+ private:
+  int mValue;
+};
+
+int CountedElement::sNumInstances = 0;
+
+}  // namespace
+
+TEST(IndexedPriorityQueue, IsEmptyInitially) {
+  IndexedPriorityQueue<int, 4> q;
+  EXPECT_TRUE(q.empty());
+  EXPECT_FALSE(q.full());
+  EXPECT_EQ(q.size(), 0);
+  EXPECT_EQ(q.capacity(), 4);
+  EXPECT_EQ(q.getNextFreeSlot(), 0);
+}
+
+TEST(IndexedPriorityQueue, PushUntilFull) {
+  IndexedPriorityQueue<int, 4> q;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(q.push(i));
+  }
+  EXPECT_TRUE(q.full());
+  EXPECT_EQ(q.getNextFreeSlot(), q.capacity());
+  EXPECT_FALSE(q.push(4));
+  EXPECT_EQ(q.top(), 3);
+}
+
+TEST(IndexedPriorityQueue, PopInPriorityOrder) {
+  IndexedPriorityQueue<int, 8, std::greater<int>> q;
+  for (int value : {5, 1, 7, 3, 2, 8, 6, 4}) {
+    ASSERT_TRUE(q.push(value));
+  }
+
+  for (int expected = 1; expected <= 8; expected++) {
+    ASSERT_FALSE(q.empty());
+    EXPECT_EQ(q.top(), expected);
+    q.pop();
+  }
+  EXPECT_TRUE(q.empty());
+}
+
+TEST(IndexedPriorityQueue, SlotsAreStable) {
+  IndexedPriorityQueue<int, 8, std::greater<int>> q;
+  size_t slots[8];
+  for (int i = 0; i < 8; i++) {
+    slots[i] = q.getNextFreeSlot();
+    ASSERT_TRUE(q.push(8 - i));
+  }
+
+  // Elements are found at their original slot regardless of heap reordering.
+  for (int i = 0; i < 8; i++) {
+    size_t index = q.getIndexOfSlot(slots[i]);
+    ASSERT_LT(index, q.size());
+    EXPECT_EQ(q[index], 8 - i);
+    EXPECT_EQ(q.getSlotOfIndex(index), slots[i]);
+  }
+
+  // Remove the element with value 5 by slot, and verify the others.
+  q.remove(q.getIndexOfSlot(slots[3]));
+  EXPECT_EQ(q.getIndexOfSlot(slots[3]), q.size());
+  for (int i = 0; i < 8; i++) {
+    if (i != 3) {
+      EXPECT_EQ(q[q.getIndexOfSlot(slots[i])], 8 - i);
+    }
+  }
+
+  // The freed slot is reused by the next push.
+  EXPECT_EQ(q.getNextFreeSlot(), slots[3]);
+}
+
+TEST(IndexedPriorityQueue, OutOfRangeSlotIsNotFound) {
+  IndexedPriorityQueue<int, 4> q;
+  ASSERT_TRUE(q.push(1));
+  EXPECT_EQ(q.getIndexOfSlot(1), q.size());
+  EXPECT_EQ(q.getIndexOfSlot(100), q.size());
+}
+
+TEST(IndexedPriorityQueue, RandomRemovalKeepsHeapOrder) {
+  constexpr size_t kCapacity = 64;
+  IndexedPriorityQueue<int, kCapacity, std::greater<int>> q;
+  srand(0);
+
+  for (int iteration = 0; iteration < 1000; iteration++) {
+    if (!q.full() && (q.empty() || rand() % 3 != 0)) {
+      ASSERT_TRUE(q.push(rand() % 1000));
+    } else {
+      q.remove(static_cast<size_t>(rand()) % q.size());
+    }
+
+    // Every element must be no smaller than its parent.
+    for (size_t i = 1; i < q.size(); i++) {
+      ASSERT_LE(q[(i - 1) / 2], q[i]);
+    }
+    for (size_t i = 0; i < q.size(); i++) {
+      ASSERT_EQ(q.getIndexOfSlot(q.getSlotOfIndex(i)), i);
+    }
+  }
+}
+
+TEST(IndexedPriorityQueue, ElementsAreDestroyed) {
+  {
+    IndexedPriorityQueue<CountedElement, 4> q;
+    ASSERT_TRUE(q.push(CountedElement(1)));
+    ASSERT_TRUE(q.push(CountedElement(2)));
+    ASSERT_TRUE(q.push(CountedElement(3)));
+    EXPECT_EQ(CountedElement::sNumInstances, 3);
+
+    q.pop();
+    EXPECT_EQ(CountedElement::sNumInstances, 2);
+    EXPECT_EQ(q.top().getValue(), 2);
+  }
+  EXPECT_EQ(CountedElement::sNumInstances, 0);
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/system/log_histogram.h"
+#include "gtest/gtest.h"
+
+using chre::LogHistogram;
+
+TEST(LogHistogram, BucketBoundaries) {
+  using Histogram = LogHistogram<8>;
+
+  EXPECT_EQ(Histogram::getBucketIndex(0), 0);
+  EXPECT_EQ(Histogram::getBucketIndex(1), 1);
+  EXPECT_EQ(Histogram::getBucketIndex(2), 2);
+  EXPECT_EQ(Histogram::getBucketIndex(3), 2);
+  EXPECT_EQ(Histogram::getBucketIndex(4), 3);
+  EXPECT_EQ(Histogram::getBucketIndex(63), 6);
+  EXPECT_EQ(Histogram::getBucketIndex(64), 7);
+  EXPECT_EQ(Histogram::getBucketIndex(UINT32_MAX), 7);
+
+  for (size_t i = 1; i < Histogram::getNumBuckets(); i++) {
+    EXPECT_EQ(Histogram::getBucketIndex(Histogram::getBucketLowerBound(i)), i);
+    EXPECT_EQ(Histogram::getBucketIndex(Histogram::getBucketLowerBound(i) - 1),
+              i - 1);
+  }
+}
+
+TEST(LogHistogram, CountsAndPercentiles) {
+  LogHistogram<20> histogram;
+  EXPECT_EQ(histogram.getTotalCount(), 0);
+  EXPECT_EQ(histogram.getPercentileBucket(50), 0);
+
+  // 90 values in [8, 16) and 10 values in [1024, 2048)
+  for (uint32_t i = 0; i < 90; i++) {
+    histogram.addValue(8 + i % 8);
+  }
+  for (uint32_t i = 0; i < 10; i++) {
+    histogram.addValue(1024 + i);
+  }
+
+  EXPECT_EQ(histogram.getTotalCount(), 100);
+  EXPECT_EQ(histogram.getCount(4), 90);
+  EXPECT_EQ(histogram.getCount(11), 10);
+  EXPECT_EQ(histogram.getPercentileBucket(50), 4);
+  EXPECT_EQ(histogram.getPercentileBucket(90), 4);
+  EXPECT_EQ(histogram.getPercentileBucket(91), 11);
+  EXPECT_EQ(histogram.getPercentileBucket(100), 11);
+}
+
+TEST(LogHistogram, CountsSaturate) {
+  LogHistogram<4> histogram;
+  for (uint32_t i = 0; i < UINT16_MAX + 10; i++) {
+    histogram.addValue(1);
+  }
+  EXPECT_EQ(histogram.getCount(1), UINT16_MAX);
+}
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2023 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "chre/util/sorted_vector_set.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+
+#include "chre/util/dynamic_vector.h"
+#include "gtest/gtest.h"
+
+using chre::DynamicVector;
+using chre::SortedVectorSet;
+
+namespace {
+
+struct KeyedElement {
+  KeyedElement(uint16_t key_, uint32_t value_) : key(key_), value(value_) {}
+
+  uint16_t getKey() const {
+    return key;
+  }
+
+  uint16_t key;
+  uint32_t value;
+};
+
+}  // namespace
+
+TEST(SortedVectorSet, EmptyByDefault) {
+  SortedVectorSet<uint16_t> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_EQ(set.size(), 0);
+  EXPECT_FALSE(set.contains(0));
+  EXPECT_EQ(set.find(0), set.size());
+}
+
+TEST(SortedVectorSet, InsertKeepsElementsSorted) {
+  SortedVectorSet<uint16_t> set;
+  ASSERT_TRUE(set.insert(30));
+  ASSERT_TRUE(set.insert(10));
+  ASSERT_TRUE(set.insert(20));
+
+  ASSERT_EQ(set.size(), 3);
+  EXPECT_EQ(set[0], 10);
+  EXPECT_EQ(set[1], 20);
+  EXPECT_EQ(set[2], 30);
+
+  uint16_t previous = 0;
+  for (uint16_t element : set) {
+    EXPECT_GT(element, previous);
+    previous = element;
+  }
+}
+
+TEST(SortedVectorSet, InsertDuplicateIsNoOp) {
+  SortedVectorSet<uint16_t> set;
+  ASSERT_TRUE(set.insert(5));
+  ASSERT_TRUE(set.insert(5));
+  EXPECT_EQ(set.size(), 1);
+}
+
+TEST(SortedVectorSet, FindAndContains) {
+  SortedVectorSet<uint16_t> set;
+  for (uint16_t i = 0; i < 10; i++) {
+    ASSERT_TRUE(set.insert(i * 2));
+  }
+
+  for (uint16_t i = 0; i < 20; i++) {
+    bool expected = (i % 2 == 0);
+    EXPECT_EQ(set.contains(i), expected);
+    if (expected) {
+      EXPECT_EQ(set.find(i), i / 2);
+    } else {
+      EXPECT_EQ(set.find(i), set.size());
+    }
+  }
+}
+
+TEST(SortedVectorSet, RemoveAndErase) {
+  SortedVectorSet<uint16_t> set;
+  ASSERT_TRUE(set.insert(1));
+  ASSERT_TRUE(set.insert(2));
+  ASSERT_TRUE(set.insert(3));
+
+  EXPECT_TRUE(set.remove(2));
+  EXPECT_FALSE(set.remove(2));
+  EXPECT_FALSE(set.contains(2));
+  ASSERT_EQ(set.size(), 2);
+
+  set.erase(0);
+  ASSERT_EQ(set.size(), 1);
+  EXPECT_EQ(set[0], 3);
+
+  set.clear();
+  EXPECT_TRUE(set.empty());
+  EXPECT_FALSE(set.contains(3));
+}
+
+TEST(SortedVectorSet, NonIntegralElementsAreKeyed) {
+  SortedVectorSet<KeyedElement> set;
+  ASSERT_TRUE(set.insert(KeyedElement(7, 100)));
+  ASSERT_TRUE(set.insert(KeyedElement(3, 200)));
+
+  // An element with an existing key doesn't replace the original.
+  ASSERT_TRUE(set.insert(KeyedElement(7, 300)));
+  ASSERT_EQ(set.size(), 2);
+
+  size_t index = set.find(7);
+  ASSERT_LT(index, set.size());
+  EXPECT_EQ(set[index].value, 100);
+
+  // Non-key fields can be modified in place.
+  set[index].value = 400;
+  EXPECT_EQ(set[set.find(7)].value, 400);
+  EXPECT_EQ(set[0].getKey(), 3);
+}
+
+TEST(SortedVectorSet, DenseKeysTrackedInBitmap) {
+  constexpr size_t kNumDenseKeys = 64;
+  SortedVectorSet<KeyedElement, kNumDenseKeys> set;
+
+  // Both dense and sparse keys
+  ASSERT_TRUE(set.insert(KeyedElement(63, 1)));
+  ASSERT_TRUE(set.insert(KeyedElement(0, 2)));
+  ASSERT_TRUE(set.insert(KeyedElement(64, 3)));
+  ASSERT_TRUE(set.insert(KeyedElement(1000, 4)));
+
+  for (uint16_t key = 0; key < 128; key++) {
+    bool expected = (key == 0 || key == 63 || key == 64);
+    EXPECT_EQ(set.contains(key), expected) << "key " << key;
+  }
+  EXPECT_EQ(set[set.find(63)].value, 1);
+  EXPECT_EQ(set[set.find(1000)].value, 4);
+
+  EXPECT_TRUE(set.remove(63));
+  EXPECT_FALSE(set.contains(63));
+  EXPECT_EQ(set.find(63), set.size());
+
+  set.clear();
+  EXPECT_FALSE(set.contains(0));
+  EXPECT_FALSE(set.contains(64));
+}
+
+namespace {
+
+//! The number of lookups performed per measurement in the benchmark below.
+constexpr size_t kNumBenchmarkLookups = 100000;
+
+//! Keys in the range of sensor data events that registrations are spread over.
+constexpr uint16_t kBenchmarkKeyBase = 0x100;
+
+template <typename LookupFunc>
+uint64_t measureLookupNs(size_t numKeys, LookupFunc lookup) {
+  size_t hits = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kNumBenchmarkLookups; i++) {
+    // Alternate between registered and unregistered keys.
+    auto key = static_cast<uint16_t>(kBenchmarkKeyBase + (i % (numKeys * 2)));
+    if (lookup(key)) {
+      hits++;
+    }
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(hits, kNumBenchmarkLookups / 2);
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+}  // namespace
+
+/**
+ * Compares the lookup cost of SortedVectorSet against a linear
+ * DynamicVector::find() for various registration counts.
+ */
+TEST(SortedVectorSet, DISABLED_LookupBenchmark) {
+  for (size_t numKeys : {1, 16, 128}) {
+    DynamicVector<uint16_t> vector;
+    SortedVectorSet<uint16_t> set;
+    SortedVectorSet<uint16_t, 0x400> denseSet;
+    for (size_t i = 0; i < numKeys; i++) {
+      // Insert every other key, in reverse order.
+      auto key =
+          static_cast<uint16_t>(kBenchmarkKeyBase + (numKeys - 1 - i) * 2);
+      ASSERT_TRUE(vector.push_back(key));
+      ASSERT_TRUE(set.insert(key));
+      ASSERT_TRUE(denseSet.insert(key));
+    }
+
+    uint64_t vectorNs = measureLookupNs(numKeys, [&](uint16_t key) {
+      return vector.find(key) != vector.size();
+    });
+    uint64_t setNs = measureLookupNs(
+        numKeys, [&](uint16_t key) { return set.contains(key); });
+    uint64_t denseSetNs = measureLookupNs(
+        numKeys, [&](uint16_t key) { return denseSet.contains(key); });
+
+    printf("%zu keys: DynamicVector::find %" PRIu64
+           " ps/lookup, SortedVectorSet %" PRIu64
+           " ps/lookup, SortedVectorSet (dense) %" PRIu64 " ps/lookup\n",
+           numKeys, vectorNs * 1000 / kNumBenchmarkLookups,
+           setNs * 1000 / kNumBenchmarkLookups,
+           denseSetNs * 1000 / kNumBenchmarkLookups);
+  }
+}
@@ -23,6 +23,7 @@ COMMON_SRCS += $(CHRE_PREFIX)/util/system/debug_dump.cc
 # GoogleTest Source Files ######################################################
 
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/array_queue_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/atomic_mpsc_queue_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/atomic_spsc_queue_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/blocking_queue_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/buffer_test.cc
@@ -31,8 +32,10 @@ GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/debug_dump_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/dynamic_vector_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/fixed_size_vector_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/heap_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/indexed_priority_queue_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/intrusive_list_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/lock_guard_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/log_histogram_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/memory_pool_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/optional_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/priority_queue_test.cc
@@ -41,6 +44,7 @@ GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/ref_base_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/segmented_queue_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/shared_ptr_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/singleton_test.cc
+GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/sorted_vector_set_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/stats_container_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/synchronized_expandable_memory_pool_test.cc
 GOOGLETEST_SRCS += $(CHRE_PREFIX)/util/tests/time_test.cc